@@ -1,14 +1,19 @@
 #include "AllProgramsEnumerator.h"
 #include "Diagnostics.h"
+#include "ShellLinkParser.h"
 
 #include <shlobj.h>       // SHGetKnownFolderPath, FOLDERID_*, IShellLinkW, IPersistFile
 #include <shobjidl.h>     // CLSID_ShellLink (via shlobj.h on MSVC, but explicit is safer)
 #include <objbase.h>      // CoCreateInstance, IID_*
+#include <psapi.h>        // GetProcessMemoryInfo (build log)
 #include <algorithm>
+#include <chrono>
 #include <cwctype>        // towlower
+#include <thread>         // hardware_concurrency
 
 #pragma comment(lib, "shell32.lib")
 #pragma comment(lib, "ole32.lib")
+#pragma comment(lib, "psapi.lib")
 
 namespace GlassBar {
 
@@ -23,77 +28,120 @@ static std::wstring GetExtLower(const std::wstring& filename) {
     return ext;
 }
 
-/// Alphabetical, case-insensitive node comparator: folders first, then shortcuts.
-static bool NodeLess(const MenuNode& a, const MenuNode& b) {
-    if (a.isFolder != b.isFolder) return a.isFolder > b.isFolder;   // folders first
-    return _wcsicmp(a.name.c_str(), b.name.c_str()) < 0;
+// ── ResolveShortcutTarget ─────────────────────────────────────────────────────
+
+/// Upper bound for files read whole into memory. Real .lnk/.url files are a
+/// few KB; anything larger is left to IShellLinkW / the profile API.
+static constexpr LONGLONG kMaxShortcutFileSize = 64 * 1024;
+
+/// Read a small file into |buffer| (resized to the file length).
+static bool ReadSmallFile(const std::wstring& path, std::vector<std::uint8_t>& buffer) {
+    HANDLE h = CreateFileW(path.c_str(), GENERIC_READ,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                           nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (h == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size = {};
+    bool ok = GetFileSizeEx(h, &size) && size.QuadPart > 0 &&
+              size.QuadPart <= kMaxShortcutFileSize;
+    if (ok) {
+        buffer.resize(static_cast<size_t>(size.QuadPart));
+        DWORD read = 0;
+        ok = ReadFile(h, buffer.data(), static_cast<DWORD>(buffer.size()), &read, nullptr) &&
+             read == buffer.size();
+    }
+    CloseHandle(h);
+    return ok;
 }
 
-// ── ResolveShortcutTarget ─────────────────────────────────────────────────────
+/// IShellLinkW path — handles everything the native parser declines
+/// (advertised shortcuts, IDList-only targets, non-ASCII ANSI links).
+static bool ResolveShortcutViaCom(const std::wstring& path,
+                                  std::wstring&       outTarget,
+                                  std::wstring&       outArgs) {
+    IShellLinkW* psl = nullptr;
+    HRESULT hr = CoCreateInstance(CLSID_ShellLink, nullptr,
+                                  CLSCTX_INPROC_SERVER,
+                                  IID_IShellLinkW,
+                                  reinterpret_cast<void**>(&psl));
+    if (FAILED(hr)) {
+        CF_LOG(Warning, "ResolveShortcutTarget: CoCreateInstance(ShellLink) failed hr=0x"
+               << std::hex << hr << " for " << path.size() << "-char path");
+        return false;
+    }
 
-bool ResolveShortcutTarget(const std::wstring& path,
-                           std::wstring&       outTarget,
-                           std::wstring&       outArgs) {
-    outTarget.clear();
-    outArgs.clear();
+    IPersistFile* ppf = nullptr;
+    hr = psl->QueryInterface(IID_IPersistFile, reinterpret_cast<void**>(&ppf));
+    if (FAILED(hr)) {
+        CF_LOG(Warning, "ResolveShortcutTarget: QueryInterface(IPersistFile) failed hr=0x"
+               << std::hex << hr);
+        psl->Release();
+        return false;
+    }
 
-    const std::wstring ext = GetExtLower(path);
+    hr = ppf->Load(path.c_str(), STGM_READ);
+    ppf->Release();
 
-    // ── .lnk — resolve via IShellLinkW ───────────────────────────────────────
-    if (ext == L".lnk") {
-        IShellLinkW* psl = nullptr;
-        HRESULT hr = CoCreateInstance(CLSID_ShellLink, nullptr,
-                                      CLSCTX_INPROC_SERVER,
-                                      IID_IShellLinkW,
-                                      reinterpret_cast<void**>(&psl));
-        if (FAILED(hr)) {
-            CF_LOG(Warning, "ResolveShortcutTarget: CoCreateInstance(ShellLink) failed hr=0x"
-                   << std::hex << hr << " for " << path.size() << "-char path");
-            return false;
-        }
+    if (FAILED(hr)) {
+        CF_LOG(Warning, "ResolveShortcutTarget: IPersistFile::Load failed hr=0x"
+               << std::hex << hr);
+        psl->Release();
+        return false;
+    }
 
-        IPersistFile* ppf = nullptr;
-        hr = psl->QueryInterface(IID_IPersistFile, reinterpret_cast<void**>(&ppf));
-        if (FAILED(hr)) {
-            CF_LOG(Warning, "ResolveShortcutTarget: QueryInterface(IPersistFile) failed hr=0x"
-                   << std::hex << hr);
-            psl->Release();
-            return false;
-        }
+    // Resolve the link (SLR_NO_UI suppresses any UI on broken shortcuts)
+    psl->Resolve(nullptr, SLR_NO_UI | SLR_NOSEARCH | SLR_NOTRACK);
 
-        hr = ppf->Load(path.c_str(), STGM_READ);
-        ppf->Release();
+    wchar_t targetBuf[MAX_PATH] = {};
+    hr = psl->GetPath(targetBuf, MAX_PATH, nullptr, SLGP_RAWPATH);
+    if (SUCCEEDED(hr) && targetBuf[0] != L'\0')
+        outTarget = targetBuf;
 
-        if (FAILED(hr)) {
-            CF_LOG(Warning, "ResolveShortcutTarget: IPersistFile::Load failed hr=0x"
-                   << std::hex << hr);
-            psl->Release();
-            return false;
-        }
+    wchar_t argsBuf[INFOTIPSIZE] = {};
+    if (SUCCEEDED(psl->GetArguments(argsBuf, INFOTIPSIZE)) && argsBuf[0] != L'\0')
+        outArgs = argsBuf;
 
-        // Resolve the link (SLR_NO_UI suppresses any UI on broken shortcuts)
-        psl->Resolve(nullptr, SLR_NO_UI | SLR_NOSEARCH | SLR_NOTRACK);
+    psl->Release();
 
-        wchar_t targetBuf[MAX_PATH] = {};
-        hr = psl->GetPath(targetBuf, MAX_PATH, nullptr, SLGP_RAWPATH);
-        if (SUCCEEDED(hr) && targetBuf[0] != L'\0')
-            outTarget = targetBuf;
+    if (outTarget.empty()) {
+        CF_LOG(Warning, "ResolveShortcutTarget: empty target after GetPath");
+        return false;
+    }
+    return true;
+}
+
+bool ResolveShortcutTarget(const std::wstring& path,
+                           std::wstring&       outTarget,
+                           std::wstring&       outArgs) {
+    outTarget.clear();
+    outArgs.clear();
 
-        wchar_t argsBuf[INFOTIPSIZE] = {};
-        if (SUCCEEDED(psl->GetArguments(argsBuf, INFOTIPSIZE)) && argsBuf[0] != L'\0')
-            outArgs = argsBuf;
+    const std::wstring ext = GetExtLower(path);
 
-        psl->Release();
+    // Scan workers call this in a tight loop; reuse one buffer per thread.
+    thread_local std::vector<std::uint8_t> fileBytes;
 
-        if (outTarget.empty()) {
-            CF_LOG(Warning, "ResolveShortcutTarget: empty target after GetPath");
-            return false;
+    // ── .lnk — decode the file directly, IShellLinkW as fallback ─────────────
+    if (ext == L".lnk") {
+        thread_local ShellLinkInfo link;
+        if (ReadSmallFile(path, fileBytes) &&
+            ParseShellLink(fileBytes.data(), fileBytes.size(), link)) {
+            outTarget = link.target;
+            outArgs   = link.arguments;
+            return true;
         }
-        return true;
+        return ResolveShortcutViaCom(path, outTarget, outArgs);
     }
 
-    // ── .url — parse [InternetShortcut] URL= ─────────────────────────────────
+    // ── .url — scan [InternetShortcut] once, profile API as fallback ─────────
     if (ext == L".url") {
+        thread_local InternetShortcutInfo shortcut;
+        if (ReadSmallFile(path, fileBytes) &&
+            ParseInternetShortcut(fileBytes.data(), fileBytes.size(), shortcut)) {
+            outTarget = shortcut.url;
+            return true;
+        }
+
         wchar_t urlBuf[2048] = {};
         DWORD got = GetPrivateProfileStringW(L"InternetShortcut", L"URL",
                                              L"", urlBuf,
@@ -111,142 +159,391 @@ bool ResolveShortcutTarget(const std::wstring& path,
     return false;
 }
 
+// ── ResolveIconLocationKey ────────────────────────────────────────────────────
+
+std::wstring ResolveIconLocationKey(const std::wstring& path) {
+    std::wstring file;
+    int          index = 0;
+    const std::wstring ext = GetExtLower(path);
+    thread_local std::vector<std::uint8_t> fileBytes;
+    if (ext == L".lnk") {
+        thread_local ShellLinkInfo link;
+        if (!ReadSmallFile(path, fileBytes) ||
+            !ParseShellLink(fileBytes.data(), fileBytes.size(), link))
+            return {};
+        if (!link.iconLocation.empty()) {
+            file  = link.iconLocation;
+            index = link.iconIndex;
+        } else {
+            file = link.target;   // no icon of its own: the target's
+        }
+    } else if (ext == L".url") {
+        thread_local InternetShortcutInfo shortcut;
+        if (!ReadSmallFile(path, fileBytes) ||
+            !ParseInternetShortcut(fileBytes.data(), fileBytes.size(), shortcut))
+            return {};
+        file  = shortcut.iconFile;
+        index = shortcut.iconIndex;
+    } else {
+        file = path;
+    }
+    if (file.empty()) return {};
+
+    if (file.find(L'%') != std::wstring::npos) {
+        wchar_t expanded[MAX_PATH] = {};
+        const DWORD len = ExpandEnvironmentStringsW(file.c_str(), expanded, MAX_PATH);
+        if (len == 0 || len > MAX_PATH) return {};
+        file = expanded;
+    }
+    for (wchar_t& c : file) c = FoldNameChar(c);
+    file += L',';
+    file += std::to_wstring(index);
+    return file;
+}
+
 // ── Internal tree-building helpers ────────────────────────────────────────────
 
-/// Recursively scan a directory and return a MenuNode for it.
-/// name is set by the caller (the node's display name).
-static MenuNode ScanFolder(const std::wstring& folderPath) {
-    MenuNode folder;
-    folder.isFolder   = true;
-    folder.folderPath = folderPath;
+/// Peak working set of this process in KB (0 if unavailable).
+static size_t PeakWorkingSetKB() {
+    PROCESS_MEMORY_COUNTERS pmc = {};
+    pmc.cb = sizeof(pmc);
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return 0;
+    return pmc.PeakWorkingSetSize / 1024;
+}
 
+/// Win32 side of ScanAndMerge(): FindFirstFileExW listing and
+/// ResolveShortcutTarget (native parsers, then IShellLinkW / the profile API).
+static void ListFolderWin32(const std::wstring& dir, std::vector<ScanBackend::Entry>& out) {
     WIN32_FIND_DATAW fd{};
-    const std::wstring pattern = folderPath + L"\\*";
-    HANDLE hf = FindFirstFileW(pattern.c_str(), &fd);
-    if (hf == INVALID_HANDLE_VALUE) return folder;
-
+    const std::wstring pattern = dir + L"\\*";
+    HANDLE hf = FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &fd,
+                                 FindExSearchNameMatch, nullptr,
+                                 FIND_FIRST_EX_LARGE_FETCH);
+    if (hf == INVALID_HANDLE_VALUE) return;
     do {
         // Skip hidden/system entries and . / ..
         if (fd.dwFileAttributes & (FILE_ATTRIBUTE_HIDDEN | FILE_ATTRIBUTE_SYSTEM)) continue;
-        const std::wstring entryName = fd.cFileName;
-        if (entryName == L"." || entryName == L"..") continue;
-
-        const std::wstring fullPath = folderPath + L"\\" + entryName;
-
-        if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
-            MenuNode child = ScanFolder(fullPath);
-            child.name = entryName;
-            folder.children.push_back(std::move(child));
-        } else {
-            const std::wstring ext = GetExtLower(entryName);
-            if (ext != L".lnk" && ext != L".url") continue;  // skip unrecognised files
-
-            MenuNode item;
-            item.isFolder = false;
-            item.lnkPath  = fullPath;  // S6.5: kept for icon extraction in Initialize()
-            // Strip extension for display
-            auto dot = entryName.rfind(L'.');
-            item.name = (dot != std::wstring::npos) ? entryName.substr(0, dot) : entryName;
-
-            if (!ResolveShortcutTarget(fullPath, item.target, item.args)) {
-                CF_LOG(Warning, "ScanFolder: could not resolve shortcut, skipping entry");
-                continue;  // omit unresolvable shortcuts — no dead UI
-            }
-            folder.children.push_back(std::move(item));
-        }
+        if (wcscmp(fd.cFileName, L".") == 0 || wcscmp(fd.cFileName, L"..") == 0) continue;
+        out.push_back({ fd.cFileName, (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0 });
     } while (FindNextFileW(hf, &fd));
-
     FindClose(hf);
+}
+
+/// Same filter as ParallelScanner::Enumerate: no hidden/system entries,
+/// and only .lnk/.url for files.
+static bool IsVisibleEntry(const std::wstring& path, bool wantDir) {
+    DWORD attrs = GetFileAttributesW(path.c_str());
+    if (attrs == INVALID_FILE_ATTRIBUTES) return false;
+    if (attrs & (FILE_ATTRIBUTE_HIDDEN | FILE_ATTRIBUTE_SYSTEM)) return false;
+    const bool isDir = (attrs & FILE_ATTRIBUTE_DIRECTORY) != 0;
+    if (isDir != wantDir) return false;
+    if (isDir) return true;
+    const std::wstring ext = GetExtLower(path);
+    return ext == L".lnk" || ext == L".url";
+}
 
-    std::sort(folder.children.begin(), folder.children.end(), NodeLess);
-    return folder;
+/// Extra scan workers get their own COM apartment under the same contract as
+/// BuildAllProgramsTree(): balance every successful init; RPC_E_CHANGED_MODE
+/// still allows in-proc CLSID_ShellLink.
+static thread_local HRESULT t_workerCom = E_FAIL;
+
+static const ScanBackend& Win32ScanBackend() {
+    static const ScanBackend backend = [] {
+        ScanBackend b;
+        b.listFolder  = ListFolderWin32;
+        b.resolve     = ResolveShortcutTarget;
+        b.isFolder    = [](const std::wstring& path) { return IsVisibleEntry(path, /*wantDir=*/true); };
+        b.threadStart = [] { t_workerCom = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED); };
+        b.threadStop  = [] { if (SUCCEEDED(t_workerCom)) CoUninitialize(); };
+        b.separator   = L'\\';
+        return b;
+    }();
+    return backend;
 }
 
-/// Merge overlay tree INTO base (user-profile overlays common programs).
-/// Same-name folder → recursive merge; same-name shortcut → overlay wins.
-static void MergeTree(std::vector<MenuNode>& base, std::vector<MenuNode>&& overlay) {
-    for (auto& oNode : overlay) {
-        auto it = std::find_if(base.begin(), base.end(), [&](const MenuNode& b) {
-            return b.isFolder == oNode.isFolder &&
-                   _wcsicmp(b.name.c_str(), oNode.name.c_str()) == 0;
-        });
+/// Default worker count for tree scans: enough to overlap shortcut I/O with
+/// COM resolution without flooding a cold disk.
+static unsigned DefaultScanThreads() {
+    unsigned hw = std::thread::hardware_concurrency();
+    if (hw == 0) hw = 2;
+    return (std::min)(hw, 8u);
+}
+
+/// COM apartment for a tree build on the calling thread.
+///
+/// Per MSDN, every successful CoInitializeEx call — including S_FALSE —
+/// increments the reference count and must be balanced by CoUninitialize().
+///   S_OK              — fresh init; SUCCEEDED() → CoUninitialize on exit.
+///   S_FALSE           — already init (same apt); still increments refcount
+///                       → SUCCEEDED() → CoUninitialize on exit.
+///   RPC_E_CHANGED_MODE — different apartment already active; FAILED() so no
+///                        CoUninitialize needed; CoCreateInstance still works
+///                        for in-process servers (CLSID_ShellLink).
+/// Any other FAILED code means COM is unusable on this thread.
+class ScopedComApartment {
+public:
+    ScopedComApartment() : m_hr(CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED)) {}
+    ~ScopedComApartment() { if (SUCCEEDED(m_hr)) CoUninitialize(); }
+    ScopedComApartment(const ScopedComApartment&) = delete;
+    ScopedComApartment& operator=(const ScopedComApartment&) = delete;
+
+    bool    Usable() const { return SUCCEEDED(m_hr) || m_hr == RPC_E_CHANGED_MODE; }
+    HRESULT Result() const { return m_hr; }
+
+private:
+    HRESULT m_hr;
+};
+
+void ResolveProgramsRoots(std::wstring roots[2]) {
+    roots[0].clear();
+    roots[1].clear();
+
+    // Measurement override: "<common>;<user>", either side may be empty.
+    wchar_t over[2 * MAX_PATH + 2] = {};
+    const DWORD got = GetEnvironmentVariableW(L"GLASSBAR_PROGRAMS_ROOTS", over,
+                                              static_cast<DWORD>(std::size(over)));
+    if (got > 0 && got < std::size(over)) {
+        const std::wstring spec(over, got);
+        const size_t semi = spec.find(L';');
+        roots[0] = spec.substr(0, semi);
+        if (semi != std::wstring::npos) roots[1] = spec.substr(semi + 1);
+        CF_LOG(Info, "ResolveProgramsRoots: using GLASSBAR_PROGRAMS_ROOTS override");
+        return;
+    }
 
-        if (it == base.end()) {
-            base.push_back(std::move(oNode));
-        } else if (oNode.isFolder && it->isFolder) {
-            MergeTree(it->children, std::move(oNode.children));
+    static const KNOWNFOLDERID* const ids[2] = { &FOLDERID_CommonPrograms, &FOLDERID_Programs };
+    static const char* const          names[2] = { "FOLDERID_CommonPrograms", "FOLDERID_Programs" };
+    for (int i = 0; i < 2; ++i) {
+        PWSTR p = nullptr;
+        HRESULT hr = SHGetKnownFolderPath(*ids[i], KF_FLAG_DEFAULT, nullptr, &p);
+        if (SUCCEEDED(hr) && p) {
+            roots[i] = p;
         } else {
-            *it = std::move(oNode);  // user shortcut wins
+            CF_LOG(Warning, "ResolveProgramsRoots: " << names[i] << " unavailable hr=0x"
+                   << std::hex << hr);
         }
+        CoTaskMemFree(p);
+    }
+}
+
+/// The folder |rel| under each root, or empty where that root lacks it.
+static void ResolveLevelDirs(const std::wstring roots[2], const std::wstring& rel,
+                             std::wstring dirs[2]) {
+    for (int i = 0; i < 2; ++i) {
+        dirs[i].clear();
+        if (roots[i].empty()) continue;
+        std::wstring full = roots[i] + L"\\" + rel;
+        if (IsVisibleEntry(full, /*wantDir=*/true)) dirs[i] = std::move(full);
     }
-    std::sort(base.begin(), base.end(), NodeLess);
+}
+
+/// ScanAndMerge() over the Win32 backend. Stage times are added to |times|
+/// when given.
+static std::vector<MenuNode> ScanAndMerge(const std::wstring dirs[2], unsigned threads,
+                                          size_t& outShortcuts, bool& outFound,
+                                          bool shallow = false,
+                                          ScanStageTimes* times = nullptr) {
+    return ScanAndMerge(Win32ScanBackend(), dirs, threads, outShortcuts, outFound, shallow, times);
 }
 
 // ── BuildAllProgramsTree ──────────────────────────────────────────────────────
 
-std::vector<MenuNode> BuildAllProgramsTree() {
+std::vector<MenuNode> BuildAllProgramsTree(unsigned threadCount) {
     // Ensure COM is initialised on this thread so that IShellLinkW can be
-    // created for every .lnk we encounter.  Per MSDN, every successful
-    // CoInitializeEx call — including S_FALSE — increments the reference count
-    // and must be balanced by CoUninitialize().
-    //   S_OK              — fresh init; SUCCEEDED() → CoUninitialize on exit.
-    //   S_FALSE           — already init (same apt); still increments refcount
-    //                       → SUCCEEDED() → CoUninitialize on exit.
-    //   RPC_E_CHANGED_MODE — different apartment already active; FAILED() so no
-    //                        CoUninitialize needed; CoCreateInstance still works
-    //                        for in-process servers (CLSID_ShellLink).
-    // Any other FAILED code means COM is unusable on this thread — bail out.
-    HRESULT hrCom    = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
-
-    if (FAILED(hrCom) && hrCom != RPC_E_CHANGED_MODE) {
+    // created for any .lnk the native parser declines.
+    ScopedComApartment com;
+    if (!com.Usable()) {
         CF_LOG(Warning, "BuildAllProgramsTree: CoInitializeEx failed hr=0x"
-               << std::hex << hrCom << " — aborting tree build");
+               << std::hex << com.Result() << " — aborting tree build");
         return {};
     }
 
-    // Balance every successful CoInitializeEx call — both S_OK (we initialised
-    // COM fresh) and S_FALSE (COM was already up on this thread but the call still
-    // increments the reference count) require a matching CoUninitialize().
-    // RPC_E_CHANGED_MODE is FAILED, so SUCCEEDED() correctly excludes it.
-    struct ComGuard {
-        bool active;
-        ~ComGuard() { if (active) CoUninitialize(); }
-    } comGuard{ SUCCEEDED(hrCom) };
-
-    std::vector<MenuNode> tree;
-
-    // 1. Common programs (%ProgramData%\Microsoft\Windows\Start Menu\Programs)
-    {
-        PWSTR commonPath = nullptr;
-        HRESULT hr = SHGetKnownFolderPath(FOLDERID_CommonPrograms,
-                                          KF_FLAG_DEFAULT, nullptr, &commonPath);
-        if (SUCCEEDED(hr) && commonPath) {
-            MenuNode root = ScanFolder(commonPath);
-            tree = std::move(root.children);
-            CoTaskMemFree(commonPath);
-        } else {
-            CF_LOG(Warning, "BuildAllProgramsTree: FOLDERID_CommonPrograms unavailable hr=0x"
-                   << std::hex << hr);
-        }
+    // Resolve both roots first so a single pool scans them together.
+    std::wstring roots[2];   // [0] = common, [1] = user
+    ResolveProgramsRoots(roots);
+
+    const unsigned threads = threadCount ? threadCount : DefaultScanThreads();
+    const auto     t0      = std::chrono::steady_clock::now();
+
+    size_t shortcuts = 0;
+    bool   found     = false;
+    ScanStageTimes times;
+    std::vector<MenuNode> tree = ScanAndMerge(roots, threads, shortcuts, found,
+                                              /*shallow=*/false, &times);
+
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - t0).count();
+    CF_LOG(Info, "BuildAllProgramsTree: scanned " << shortcuts
+           << " shortcuts with " << threads << " thread(s) in " << ms << " ms");
+    CF_LOG(Info, "BuildAllProgramsTree: stages (us, worker sums) enumerate="
+           << times.enumerateUs << " resolve=" << times.resolveUs
+           << " assemble=" << times.assembleUs << " merge=" << times.mergeUs
+           << "; peak working set " << PeakWorkingSetKB() << " KB");
+
+    CF_LOG(Info, "BuildAllProgramsTree: " << tree.size() << " top-level nodes");
+    return tree;
+}
+
+// ── Lazy expansion ────────────────────────────────────────────────────────────
+
+/// Expand, in |level| (the folder at |rel|), every pending folder that is
+/// expanded in the matching |shape| level, recursively. Both levels are
+/// sorted by NodeLess, so counterparts are found by binary search.
+static void ExpandLike(std::vector<MenuNode>& level, const std::vector<MenuNode>& shape,
+                       const std::wstring roots[2], const std::wstring& rel,
+                       unsigned threads, size_t& shortcuts, size_t& folders) {
+    if (shape.empty()) return;
+    for (MenuNode& node : level) {
+        if (!node.isFolder || !node.childrenPending) continue;
+        auto it = std::lower_bound(shape.begin(), shape.end(), node, NodeLess);
+        if (it == shape.end() || !SameNodeKey(*it, node) || it->childrenPending) continue;
+
+        const std::wstring childRel = rel.empty() ? node.name : rel + L"\\" + node.name;
+        std::wstring dirs[2];
+        ResolveLevelDirs(roots, childRel, dirs);
+        size_t n = 0;
+        bool   found = false;
+        node.children = ScanAndMerge(dirs, threads, n, found, /*shallow=*/true);
+        node.childrenPending = false;
+        shortcuts += n;
+        ++folders;
+        ExpandLike(node.children, it->children, roots, childRel, threads, shortcuts, folders);
     }
+}
 
-    // 2. User programs (%AppData%\Microsoft\Windows\Start Menu\Programs) — overlaid on top
-    {
-        PWSTR userPath = nullptr;
-        HRESULT hr = SHGetKnownFolderPath(FOLDERID_Programs,
-                                          KF_FLAG_DEFAULT, nullptr, &userPath);
-        if (SUCCEEDED(hr) && userPath) {
-            MenuNode root = ScanFolder(userPath);
-            MergeTree(tree, std::move(root.children));
-            CoTaskMemFree(userPath);
-        } else {
-            CF_LOG(Warning, "BuildAllProgramsTree: FOLDERID_Programs unavailable hr=0x"
-                   << std::hex << hr);
-        }
+std::vector<MenuNode> BuildLazyProgramsTree(const std::vector<MenuNode>& expandLike) {
+    ScopedComApartment com;
+    if (!com.Usable()) {
+        CF_LOG(Warning, "BuildLazyProgramsTree: CoInitializeEx failed hr=0x"
+               << std::hex << com.Result() << " — aborting tree build");
+        return {};
     }
 
-    CF_LOG(Info, "BuildAllProgramsTree: " << tree.size() << " top-level nodes");
+    std::wstring roots[2];
+    ResolveProgramsRoots(roots);
+
+    const unsigned threads = DefaultScanThreads();
+    const auto     t0      = std::chrono::steady_clock::now();
+
+    size_t shortcuts = 0, folders = 0;
+    bool   found     = false;
+    ScanStageTimes times;
+    std::vector<MenuNode> tree = ScanAndMerge(roots, threads, shortcuts, found,
+                                              /*shallow=*/true, &times);
+    ExpandLike(tree, expandLike, roots, std::wstring(), threads, shortcuts, folders);
+
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - t0).count();
+    CF_LOG(Info, "BuildLazyProgramsTree: " << tree.size() << " top-level nodes, "
+           << folders << " folder(s) re-expanded, " << shortcuts
+           << " shortcuts in " << ms << " ms (top level: enumerate=" << times.enumerateUs
+           << " resolve=" << times.resolveUs << " merge=" << times.mergeUs << " us)");
     return tree;
 }
 
+bool ScanProgramFolderLevel(const std::wstring& relativePath, std::vector<MenuNode>& outChildren) {
+    outChildren.clear();
+    ScopedComApartment com;
+    if (!com.Usable()) return false;
+
+    std::wstring roots[2];
+    ResolveProgramsRoots(roots);
+    std::wstring dirs[2];
+    ResolveLevelDirs(roots, relativePath, dirs);
+
+    const auto t0 = std::chrono::steady_clock::now();
+    size_t shortcuts = 0;
+    bool   found     = false;
+    outChildren = ScanAndMerge(dirs, DefaultScanThreads(), shortcuts, found, /*shallow=*/true);
+
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - t0).count();
+    CF_LOG(Debug, "ScanProgramFolderLevel: " << outChildren.size() << " nodes, "
+           << shortcuts << " shortcuts in " << us << " us");
+    return found;
+}
+
+/// Depth-first search of |dir| for the shortcuts Enumerate would keep whose
+/// display names match |names|; each folder's own files before its subfolders.
+/// Fills the still-empty |outPaths| slots, first match wins; |remaining|
+/// counts the empty ones so the walk stops once every name is resolved.
+static void FindShortcutsUnder(const std::wstring& dir, const std::vector<std::wstring>& names,
+                               std::vector<std::wstring>& outPaths, size_t& remaining) {
+    WIN32_FIND_DATAW fd{};
+    const std::wstring pattern = dir + L"\\*";
+    HANDLE hf = FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &fd,
+                                 FindExSearchNameMatch, nullptr,
+                                 FIND_FIRST_EX_LARGE_FETCH);
+    if (hf == INVALID_HANDLE_VALUE) return;
+
+    std::vector<std::wstring> subfolders;
+    do {
+        if (fd.dwFileAttributes & (FILE_ATTRIBUTE_HIDDEN | FILE_ATTRIBUTE_SYSTEM)) continue;
+        const std::wstring entryName = fd.cFileName;
+        if (entryName == L"." || entryName == L"..") continue;
+
+        if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            subfolders.push_back(dir + L"\\" + entryName);
+            continue;
+        }
+        const std::wstring ext = GetExtLower(entryName);
+        if (ext != L".lnk" && ext != L".url") continue;
+        const std::wstring_view stem(entryName.data(), entryName.size() - ext.size());
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (!outPaths[i].empty() || CompareNodeNames(stem, names[i]) != 0) continue;
+            outPaths[i] = dir + L"\\" + entryName;
+            --remaining;
+        }
+    } while (remaining > 0 && FindNextFileW(hf, &fd));
+    FindClose(hf);
+
+    for (const std::wstring& sub : subfolders) {
+        if (remaining == 0) return;
+        FindShortcutsUnder(sub, names, outPaths, remaining);
+    }
+}
+
+void FindProgramShortcuts(const std::vector<std::wstring>& relativePaths,
+                          const std::vector<std::wstring>& names,
+                          std::vector<std::wstring>& outPaths) {
+    outPaths.assign(names.size(), std::wstring());
+    size_t remaining = names.size();
+    if (remaining == 0) return;
+
+    std::wstring roots[2];
+    ResolveProgramsRoots(roots);
+    for (const std::wstring& rel : relativePaths) {
+        std::wstring dirs[2];
+        ResolveLevelDirs(roots, rel, dirs);
+        for (int i = 1; i >= 0 && remaining > 0; --i)   // user root first: its shortcut wins the merge
+            if (!dirs[i].empty()) FindShortcutsUnder(dirs[i], names, outPaths, remaining);
+        if (remaining == 0) return;
+    }
+}
+
+// ── ApplyProgramTreeChanges ───────────────────────────────────────────────────
+
+bool ApplyProgramTreeChanges(std::vector<MenuNode>& tree,
+                             const std::vector<ProgramTreeChange>& changes,
+                             bool lazy) {
+    ScopedComApartment com;
+    if (!com.Usable()) return false;
+
+    std::wstring roots[2];
+    ResolveProgramsRoots(roots);
+    if (roots[0].empty() && roots[1].empty()) return false;
+
+    const auto t0 = std::chrono::steady_clock::now();
+    ProgramTreePatchStats stats;
+    PatchProgramTree(Win32ScanBackend(), roots, tree, changes, lazy, &stats);
+
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - t0).count();
+    CF_LOG(Info, "ApplyProgramTreeChanges: " << changes.size() << " record(s) → "
+           << stats.folders << " folder rescan(s), " << stats.shortcuts
+           << " shortcut(s) resolved in " << ms << " ms, " << stats.deferred
+           << " inside unexpanded folders");
+    return true;
+}
+
 } // namespace GlassBar
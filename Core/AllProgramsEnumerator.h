@@ -1,94 +1,23 @@
 #pragma once
+#include "ProgramTree.h"     // MenuNode, collation, MergeTree, ScanAndMerge
 #include <Windows.h>
+#include <cstdint>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <vector>
 #include <shellapi.h>  // HICON (via Windows.h already, but explicit for clarity)
 
 namespace GlassBar {
 
 /// <summary>
-/// IconCache — deduplicated HICON lifetime manager.
-///
-/// Maps canonical file paths to HICON handles so that every unique path is
-/// loaded exactly once. DestroyIcon is called for all handles on ReleaseAll().
-/// Not thread-safe: call exclusively from the icon-loading thread, then call
-/// ReleaseAll() from the UI thread only after the loading thread has exited.
+/// Where the icon of |path| comes from, as a case-folded "file,index" key: a
+/// .lnk's IconLocation (else its target), a .url's IconFile, or any other
+/// path itself at index 0, with environment variables expanded. Empty when
+/// the file alone does not tell (advertised or IDList-only links, .url files
+/// without IconFile). Paths with equal keys show the same icon. Reads the
+/// shortcut file; no COM.
 /// </summary>
-class IconCache {
-public:
-    /// Return a cached HICON for |path|, or load+cache it via SHGetFileInfoW.
-    /// Returns nullptr on failure (file not found, SHGetFileInfoW fails, etc.).
-    HICON GetIcon(const std::wstring& path, bool smallIcon = false) {
-        auto key = path + (smallIcon ? L"|S" : L"|L");
-        auto it = m_cache.find(key);
-        if (it != m_cache.end())
-            return it->second;
-
-        SHFILEINFOW sfi = {};
-        UINT flags = SHGFI_ICON | (smallIcon ? SHGFI_SMALLICON : SHGFI_LARGEICON);
-        if (SHGetFileInfoW(path.c_str(), 0, &sfi, sizeof(sfi), flags) && sfi.hIcon) {
-            m_cache[key] = sfi.hIcon;
-            return sfi.hIcon;
-        }
-        return nullptr;
-    }
-
-    /// Return a cached stock icon, loading it if not yet cached.
-    HICON GetStockIcon(SHSTOCKICONID id, bool smallIcon = false) {
-        int key = static_cast<int>(id) * 2 + (smallIcon ? 1 : 0);
-        auto it = m_stock.find(key);
-        if (it != m_stock.end())
-            return it->second;
-
-        SHSTOCKICONINFO sii = {};
-        sii.cbSize = sizeof(sii);
-        UINT flags = SHGSI_ICON | (smallIcon ? SHGSI_SMALLICON : SHGSI_LARGEICON);
-        if (SUCCEEDED(SHGetStockIconInfo(id, flags, &sii)) && sii.hIcon) {
-            m_stock[key] = sii.hIcon;
-            return sii.hIcon;
-        }
-        return nullptr;
-    }
-
-    /// Call DestroyIcon on every cached handle and clear the maps.
-    void ReleaseAll() {
-        for (auto& kv : m_cache) {
-            if (kv.second) DestroyIcon(kv.second);
-        }
-        m_cache.clear();
-        for (auto& kv : m_stock) {
-            if (kv.second) DestroyIcon(kv.second);
-        }
-        m_stock.clear();
-    }
-
-    ~IconCache() { ReleaseAll(); }
-
-private:
-    std::unordered_map<std::wstring, HICON> m_cache;
-    std::unordered_map<int, HICON>          m_stock;
-};
-
-
-
-/// <summary>
-/// One node in the All Programs tree.
-/// Leaf nodes (isFolder == false) hold a resolved launch target.
-/// Folder nodes have their children populated after BuildAllProgramsTree().
-/// </summary>
-struct MenuNode {
-    std::wstring          name;        // Display name (no file extension)
-    bool                  isFolder;    // true  → children populated; target/args unused
-    std::wstring          target;      // Resolved exe / URL (empty for folders)
-    std::wstring          args;        // Command-line arguments from .lnk (may be empty)
-    std::wstring          folderPath;  // Absolute filesystem path (folders only)
-    std::wstring          lnkPath;     // S6.5: original .lnk/.url file path (shortcuts only)
-    HICON                 hIcon = nullptr; // S6.5: loaded by StartMenuWindow::Initialize();
-                                           // never set during BuildAllProgramsTree() so
-                                           // MergeTree/sort operate safely on null handles.
-    std::vector<MenuNode> children;    // Sub-items (folders first, then shortcuts, alpha)
-};
+std::wstring ResolveIconLocationKey(const std::wstring& path);
 
 /// <summary>
 /// Resolve a .lnk or .url file to a launchable target and optional arguments.
@@ -98,8 +27,8 @@ struct MenuNode {
 ///               initialises COM itself, so this precondition is satisfied when
 ///               called from there.  Direct callers must ensure COM is ready.
 ///
-/// .lnk  → IShellLinkW::GetPath / GetArguments
-/// .url  → GetPrivateProfileStringW "URL=" key from [InternetShortcut]
+/// .lnk  → ParseShellLink, IShellLinkW::GetPath / GetArguments as fallback
+/// .url  → ParseInternetShortcut, GetPrivateProfileStringW "URL=" as fallback
 ///
 /// Returns true when outTarget is non-empty; false on any failure (logged internally).
 /// </summary>
@@ -107,6 +36,17 @@ bool ResolveShortcutTarget(const std::wstring& path,
                            std::wstring&       outTarget,
                            std::wstring&       outArgs);
 
+/// <summary>
+/// Resolve the two Programs roots: [0] = FOLDERID_CommonPrograms,
+/// [1] = FOLDERID_Programs. An unavailable root is left empty (logged).
+///
+/// The GLASSBAR_PROGRAMS_ROOTS environment variable ("&lt;common&gt;;&lt;user&gt;",
+/// either part may be empty) replaces both, so the scan, snapshot key and
+/// folder watcher can be pointed at a generated corpus for measurement.
+/// Every component that needs the roots goes through this function.
+/// </summary>
+void ResolveProgramsRoots(std::wstring roots[2]);
+
 /// <summary>
 /// Enumerate the two Windows Start Menu Programs folders
 ///   • FOLDERID_CommonPrograms  (%ProgramData%\...\Programs)
@@ -116,14 +56,72 @@ bool ResolveShortcutTarget(const std::wstring& path,
 /// Merge rules:
 ///   • Folders with the same name (case-insensitive) are merged recursively.
 ///   • Same-name shortcuts: the user-profile version wins.
-///   • Sort order: folders first (alpha), then shortcuts (alpha), both case-insensitive.
+///   • Sort order: folders first (alpha), then shortcuts (alpha), both case-insensitive
+///     (NodeLess — every node carries its precomputed sort key).
+///
+/// Scanning: both roots are walked by one work-stealing pool of threadCount
+///   workers (0 = min(hardware threads, 8)); the calling thread is worker 0.
+///   Folder enumeration and shortcut resolution are separate tasks, so a
+///   single huge folder is still resolved in parallel.  The result is
+///   identical to a sequential scan; elapsed time is logged at Info level.
 ///
 /// COM: this function calls CoInitializeEx(COINIT_APARTMENTTHREADED) and
 ///      always balances it with CoUninitialize() on exit for any successful
 ///      return (S_OK or S_FALSE — both increment the reference count per MSDN).
 ///      RPC_E_CHANGED_MODE (different apartment already active) is tolerated
-///      and requires no balancing call.
+///      and requires no balancing call.  Pool workers initialise their own
+///      apartments under the same rules.
+///
+/// Logging: total time, per-stage time (enumerate / resolve / assemble /
+///   merge) and the process's peak working set, at Info level.
+/// </summary>
+std::vector<MenuNode> BuildAllProgramsTree(unsigned threadCount = 0);
+
+/// <summary>
+/// Lazy counterpart of BuildAllProgramsTree(): scan only the top level of both
+/// roots (shortcuts resolved, subfolders returned with childrenPending set and
+/// no children), then re-expand every folder that is expanded in |expandLike|
+/// — matched by name path — so a rescan keeps the shape of the tree it
+/// replaces. Startup cost depends on the top level, not the whole Start Menu.
+///
+/// COM: same contract as BuildAllProgramsTree().
+/// </summary>
+std::vector<MenuNode> BuildLazyProgramsTree(const std::vector<MenuNode>& expandLike = {});
+
+/// <summary>
+/// Enumerate one level of the merged tree for on-demand expansion: the
+/// children of the folder at |relativePath| (e.g. L"Vendor\\Tools") in both
+/// roots, merged and sorted as in a full build, subfolders again pending.
+/// Returns false when the folder exists in neither root.
+///
+/// COM: same contract as BuildAllProgramsTree(). Safe on any thread.
+/// </summary>
+bool ScanProgramFolderLevel(const std::wstring& relativePath, std::vector<MenuNode>& outChildren);
+
+/// <summary>
+/// Look on disk, under the folders at |relativePaths| in both roots (user root
+/// first) and everything below them, for the shortcuts the tree would show as
+/// each of |names| (CompareNodeNames), in a single walk that stops once all
+/// are found. |outPaths[i]| gets the path for |names[i]|, or empty. For name
+/// lookups in a lazy tree, whose childrenPending folders hold no nodes yet.
+///
+/// Walks directories: call it from a worker thread, not the UI thread.
+/// </summary>
+void FindProgramShortcuts(const std::vector<std::wstring>& relativePaths,
+                          const std::vector<std::wstring>& names,
+                          std::vector<std::wstring>& outPaths);
+
+/// <summary>
+/// PatchProgramTree() on the Win32 backend, for a tree produced by
+/// BuildAllProgramsTree() or BuildLazyProgramsTree() (|lazy|), with
+/// |changes| from ReadDirectoryChangesW on either Programs root.
+///
+/// COM: same contract as BuildAllProgramsTree().
+/// Returns false when the roots cannot be resolved — the caller should fall
+/// back to a full rebuild.
 /// </summary>
-std::vector<MenuNode> BuildAllProgramsTree();
+bool ApplyProgramTreeChanges(std::vector<MenuNode>& tree,
+                             const std::vector<ProgramTreeChange>& changes,
+                             bool lazy = false);
 
 } // namespace GlassBar
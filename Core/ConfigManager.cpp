@@ -141,6 +141,7 @@ bool ConfigManager::Load() {
         if (ParseIntLine(line, "HotkeyVk", tempConfig.hotkeyVk, 0, 0xFF)) continue;
         if (ParseIntLine(line, "HotkeyModifiers", tempConfig.hotkeyModifiers, 0, 0xFFFF)) continue;
         if (ParseIntLine(line, "BlurAmount", tempConfig.blurAmount, 0, 100)) continue;
+        if (ParseBoolLine(line, "StartLazyProgramTree", tempConfig.startLazyProgramTree)) continue;
     }
 
     file.close();
@@ -202,7 +203,8 @@ bool ConfigManager::Save() {
     file << "  \"IsFirstRun\": " << (m_config.isFirstRun ? "true" : "false") << ",\n";
     file << "  \"HotkeyVk\": " << m_config.hotkeyVk << ",\n";
     file << "  \"HotkeyModifiers\": " << m_config.hotkeyModifiers << ",\n";
-    file << "  \"BlurAmount\": " << m_config.blurAmount << "\n";
+    file << "  \"BlurAmount\": " << m_config.blurAmount << ",\n";
+    file << "  \"StartLazyProgramTree\": " << (m_config.startLazyProgramTree ? "true" : "false") << "\n";
     file << "}\n";
 
     file.close();
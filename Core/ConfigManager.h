@@ -37,6 +37,7 @@ struct Config {
     int hotkeyVk        = 0;      // 0 = disabled; virtual-key code (e.g. 'G' = 0x47)
     int hotkeyModifiers = 0;      // MOD_CONTROL | MOD_ALT | MOD_SHIFT | MOD_WIN
     int blurAmount      = 0;      // 0 = off; 1-100 = XamlBridge blur intensity
+    bool startLazyProgramTree = true;   // scan All Programs folders when first opened
 };
 
 class ConfigManager {
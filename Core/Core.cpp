@@ -97,6 +97,7 @@ bool Core::Initialize() {
     // a blocked hook thread causes Windows to time out the hooks and stutter the
     // mouse cursor for the entire duration of initialization.
     m_startMenuWindow = std::make_unique<StartMenuWindow>();
+    m_startMenuWindow->SetLazyProgramTree(config.startLazyProgramTree);
     if (!m_startMenuWindow->Initialize()) {
         CF_LOG(Error, "StartMenuWindow initialization failed");
         return false;
@@ -153,7 +154,7 @@ bool Core::Initialize() {
         return RECT{};
     });
 
-    // Forward nav/dismiss keys (Up/Down/Enter/Esc) to the non-activating Start Menu window.
+    // Forward nav/dismiss keys (Up/Down/Enter/Esc/Backspace) to the non-activating Start Menu window.
     // The window never receives keyboard focus (WS_EX_NOACTIVATE), so we PostMessage from
     // the low-level hook instead of relying on normal focus-based WM_KEYDOWN delivery.
     m_startMenuHook->SetForwardKeyCallback([this](UINT vk) {
@@ -162,6 +163,13 @@ bool Core::Initialize() {
         }
     });
 
+    // Typed characters for type-to-search, translated by the hook.
+    m_startMenuHook->SetForwardCharCallback([this](wchar_t ch) {
+        if (m_startMenuWindow && m_startMenuWindow->IsVisible()) {
+            PostMessage(m_startMenuWindow->GetMenuHwnd(), WM_CHAR, static_cast<WPARAM>(ch), 0);
+        }
+    });
+
     // Disabled by default - Dashboard will enable when configured
     m_startMenuHook->SetEnabled(false);
 
@@ -1,5 +1,7 @@
 #include "Diagnostics.h"
+#include <filesystem>
 #include <iostream>
+#include <thread>
 
 namespace GlassBar {
 
@@ -15,7 +17,7 @@ void Logger::Initialize(const std::wstring& logFilePath) {
         return;
     }
     
-    m_logFile.open(logFilePath, std::ios::out | std::ios::app);
+    m_logFile.open(std::filesystem::path(logFilePath), std::ios::out | std::ios::app);
     
     if (!m_logFile.is_open()) {
         std::wcerr << L"Failed to open log file: " << logFilePath << std::endl;
@@ -88,12 +90,14 @@ void Logger::Log(LogLevel level, const std::string& message, const char* file, i
     m_logFile << L"\n";
     m_logFile.flush();
     
+#if defined(_WIN32)
     // Also output to debugger
     if (IsDebuggerPresent()) {
         std::wostringstream debugMsg;
         debugMsg << L"[CF][" << LevelToString(level) << L"] " << wmessage << L"\n";
         OutputDebugStringW(debugMsg.str().c_str());
     }
+#endif
 }
 
 std::wstring Logger::GetTimestamp() {
@@ -101,7 +105,11 @@ std::wstring Logger::GetTimestamp() {
     auto time = std::chrono::system_clock::to_time_t(now);
     
     std::tm localTime;
+#if defined(_WIN32)
     localtime_s(&localTime, &time);
+#else
+    localtime_r(&time, &localTime);
+#endif
     
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
         now.time_since_epoch()) % 1000;
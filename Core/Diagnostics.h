@@ -1,5 +1,7 @@
 #pragma once
+#if defined(_WIN32)
 #include <Windows.h>
+#endif
 #include <string>
 #include <fstream>
 #include <mutex>
@@ -0,0 +1,269 @@
+#include "FrecencyStore.h"
+#include "NameFold.h"
+#include "Diagnostics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+namespace GlassBar {
+
+// ── On-disk layout ────────────────────────────────────────────────────────────
+//   Header  { magic 'GBFR', version, half-life in seconds, reserved }
+//   Record* { key u64, rank f64, path length u16, path UTF-16 units }
+// Little-endian. Records are appended as launches happen; a torn last record
+// (crash mid-append) is dropped on load and removed by the next rewrite.
+
+namespace {
+
+constexpr std::uint32_t kStoreMagic   = 0x52464247;  // 'GBFR'
+constexpr std::uint32_t kStoreVersion = 1;
+
+struct StoreHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t halfLifeSeconds;
+    std::uint32_t reserved;
+};
+static_assert(sizeof(StoreHeader) == 16, "frecency header layout changed");
+
+constexpr size_t kRecordFixedBytes = 8 + 8 + 2;
+constexpr size_t kMaxPathUnits     = 0xFFFF;
+
+constexpr double kHalfLifeSeconds = FrecencyStore::kHalfLifeDays * 86400.0;
+constexpr double kTicksPerSecond  = 1e7;
+
+// Entries beyond this are dropped (lowest rank first) when the file is rewritten.
+constexpr size_t kMaxEntries = 1024;
+// Rewrite once the log holds more than 2 records per entry plus this slack,
+// or there are this many entries over kMaxEntries.
+constexpr size_t kCompactSlack = 64;
+
+// UserAssist credit (see RankFromUserAssist).
+constexpr std::uint32_t kUserAssistMaxRuns = 16;
+constexpr double        kUserAssistWeight  = 0.5;
+
+// Search boost: kBoostPerDoubling points per doubling of (1 + weight).
+constexpr double kBoostPerDoubling = 30.0;
+
+double HalfLives(std::uint64_t ticks) {
+    return static_cast<double>(ticks) / kTicksPerSecond / kHalfLifeSeconds;
+}
+
+void AppendRecord(std::vector<char>& buf, std::uint64_t key, double rank, std::wstring_view path) {
+    const std::uint16_t len = static_cast<std::uint16_t>((std::min)(path.size(), kMaxPathUnits));
+    const size_t at = buf.size();
+    buf.resize(at + kRecordFixedBytes + len * sizeof(std::uint16_t));
+    char* p = buf.data() + at;
+    std::memcpy(p, &key, 8);
+    std::memcpy(p + 8, &rank, 8);
+    std::memcpy(p + 16, &len, 2);
+    p += kRecordFixedBytes;
+    for (size_t i = 0; i < len; ++i) {
+        const std::uint16_t unit = static_cast<std::uint16_t>(path[i]);
+        std::memcpy(p + i * 2, &unit, 2);
+    }
+}
+
+StoreHeader MakeHeader() {
+    return { kStoreMagic, kStoreVersion, static_cast<std::uint32_t>(kHalfLifeSeconds), 0 };
+}
+
+} // namespace
+
+// ── Rank arithmetic ───────────────────────────────────────────────────────────
+
+double FrecencyStore::NoRank() {
+    return -std::numeric_limits<double>::infinity();
+}
+
+std::uint64_t FrecencyStore::KeyOf(std::wstring_view path) {
+    std::uint64_t h = 0xCBF29CE484222325ull;
+    for (wchar_t c : path) {
+        h ^= static_cast<std::uint16_t>(FoldNameChar(c));
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+
+double FrecencyStore::RankFromUsage(std::uint64_t ticks, double launches) {
+    return launches > 0.0 ? std::log2(launches) + HalfLives(ticks) : NoRank();
+}
+
+double FrecencyStore::RankFromUserAssist(std::uint64_t lastRunTicks, std::uint32_t runCount) {
+    const std::uint32_t runs = (std::min)(runCount, kUserAssistMaxRuns);
+    return RankFromUsage(lastRunTicks, kUserAssistWeight * runs);
+}
+
+double FrecencyStore::Combine(double a, double b) {
+    if (a < b) std::swap(a, b);
+    if (b == NoRank()) return a;
+    return a + std::log2(1.0 + std::exp2(b - a));
+}
+
+double FrecencyStore::WeightAt(double rank, std::uint64_t nowTicks) {
+    return rank == NoRank() ? 0.0 : std::exp2(rank - HalfLives(nowTicks));
+}
+
+int FrecencyStore::SearchBoost(double rank, std::uint64_t nowTicks) {
+    const double boost = kBoostPerDoubling * std::log2(1.0 + WeightAt(rank, nowTicks));
+    return static_cast<int>((std::min)(boost, static_cast<double>(kMaxSearchBoost)));
+}
+
+// ── State ─────────────────────────────────────────────────────────────────────
+
+void FrecencyStore::Upsert(std::uint64_t key, double rank, std::wstring_view path) {
+    auto it = m_byKey.find(key);
+    if (it == m_byKey.end()) {
+        m_byKey.emplace(key, m_entries.size());
+        m_entries.push_back({ key, rank, std::wstring(path) });
+    } else {
+        m_entries[it->second].rank = rank;
+    }
+}
+
+double FrecencyStore::Rank(std::wstring_view target) const {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto it = m_byKey.find(KeyOf(target));
+    return it == m_byKey.end() ? NoRank() : m_entries[it->second].rank;
+}
+
+std::vector<FrecencyStore::Entry> FrecencyStore::Snapshot() const {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_entries;
+}
+
+size_t FrecencyStore::Size() const {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_entries.size();
+}
+
+// ── Persistence ───────────────────────────────────────────────────────────────
+
+bool FrecencyStore::Load(const std::wstring& path) {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_entries.clear();
+    m_byKey.clear();
+    m_path         = path;
+    m_logRecords   = 0;
+    m_needsRewrite = false;
+
+    std::ifstream f(std::filesystem::path(path), std::ios::binary);
+    if (!f.is_open()) {
+        m_needsRewrite = true;   // the first launch writes a fresh file
+        return false;
+    }
+    const std::vector<char> buf((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+    const StoreHeader want = MakeHeader();
+    if (buf.size() < sizeof(StoreHeader) || std::memcmp(buf.data(), &want, sizeof(want)) != 0) {
+        CF_LOG(Warning, "FrecencyStore: " << buf.size() << "-byte file has another format, starting over");
+        m_needsRewrite = true;
+        return false;
+    }
+
+    size_t pos = sizeof(StoreHeader);
+    std::wstring recPath;
+    while (pos + kRecordFixedBytes <= buf.size()) {
+        std::uint64_t key;
+        double        rank;
+        std::uint16_t len;
+        std::memcpy(&key,  buf.data() + pos,      8);
+        std::memcpy(&rank, buf.data() + pos + 8,  8);
+        std::memcpy(&len,  buf.data() + pos + 16, 2);
+        const size_t end = pos + kRecordFixedBytes + len * sizeof(std::uint16_t);
+        if (end > buf.size() || !std::isfinite(rank)) break;
+
+        recPath.resize(len);
+        for (size_t i = 0; i < len; ++i) {
+            std::uint16_t unit;
+            std::memcpy(&unit, buf.data() + pos + kRecordFixedBytes + i * 2, 2);
+            recPath[i] = static_cast<wchar_t>(unit);
+        }
+        Upsert(key, rank, recPath);
+        ++m_logRecords;
+        pos = end;
+    }
+    if (pos != buf.size()) {
+        CF_LOG(Warning, "FrecencyStore: dropped " << (buf.size() - pos) << " trailing bytes");
+        m_needsRewrite = true;
+    }
+    CF_LOG(Info, "FrecencyStore: " << m_entries.size() << " targets from "
+           << m_logRecords << " records");
+    return !m_needsRewrite;
+}
+
+bool FrecencyStore::RecordLaunch(std::wstring_view target, std::uint64_t nowTicks) {
+    if (target.empty()) return false;
+    std::lock_guard<std::mutex> lk(m_mutex);
+
+    const std::uint64_t key = KeyOf(target);
+    auto it = m_byKey.find(key);
+    const double old  = it == m_byKey.end() ? NoRank() : m_entries[it->second].rank;
+    const double rank = Combine(old, RankFromUsage(nowTicks, 1.0));
+    Upsert(key, rank, target);
+
+    if (m_path.empty()) return true;
+    if (m_needsRewrite || m_logRecords >= 2 * m_entries.size() + kCompactSlack ||
+        m_entries.size() > kMaxEntries + kCompactSlack)
+        return Rewrite();
+
+    std::vector<char> rec;
+    AppendRecord(rec, key, rank, target);
+    std::ofstream f(std::filesystem::path(m_path), std::ios::binary | std::ios::app);
+    if (!f.is_open() || !f.write(rec.data(), static_cast<std::streamsize>(rec.size()))) {
+        CF_LOG(Warning, "FrecencyStore: append failed");
+        m_needsRewrite = true;
+        return false;
+    }
+    ++m_logRecords;
+    return true;
+}
+
+bool FrecencyStore::Rewrite() {
+    // Keep the kMaxEntries best-ranked targets; rank order is time-invariant,
+    // so the dropped ones are the least frecent now and at any later time.
+    if (m_entries.size() > kMaxEntries) {
+        std::nth_element(m_entries.begin(), m_entries.begin() + kMaxEntries, m_entries.end(),
+                         [](const Entry& a, const Entry& b) { return a.rank > b.rank; });
+        m_entries.resize(kMaxEntries);
+        m_byKey.clear();
+        for (size_t i = 0; i < m_entries.size(); ++i)
+            m_byKey.emplace(m_entries[i].key, i);
+    }
+
+    std::vector<char> buf(sizeof(StoreHeader));
+    const StoreHeader hdr = MakeHeader();
+    std::memcpy(buf.data(), &hdr, sizeof(hdr));
+    for (const Entry& e : m_entries)
+        AppendRecord(buf, e.key, e.rank, e.path);
+
+    const std::filesystem::path target(m_path);
+    std::filesystem::path tmp = target;
+    tmp += L".tmp";
+    std::error_code ec;
+    std::filesystem::create_directories(target.parent_path(), ec);
+    bool ok = false;
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        ok = f.is_open() && f.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+    }
+    if (ok) {
+        std::filesystem::rename(tmp, target, ec);
+        ok = !ec;
+    }
+    if (!ok) {
+        CF_LOG(Warning, "FrecencyStore: rewrite failed");
+        std::filesystem::remove(tmp, ec);
+        m_needsRewrite = true;
+        return false;
+    }
+    m_logRecords   = m_entries.size();
+    m_needsRewrite = false;
+    return true;
+}
+
+} // namespace GlassBar
@@ -0,0 +1,105 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace GlassBar {
+
+/// <summary>
+/// Frecency (frequency + recency) of launched programs, kept across sessions.
+///
+/// Every launch adds one unit of weight that halves every kHalfLifeDays.
+/// Rather than a decayed score that would need re-evaluating as time passes,
+/// each target keeps a time-invariant rank:
+///     rank = log2(sum of launch weights at time t) + t / halfLife
+/// The current weight is 2^(rank - now / halfLife), so ordering targets by
+/// rank is ordering them by current frecency at any moment: rankings never
+/// need recomputing on open, and a new launch only touches its own target.
+///
+/// Targets are identified by KeyOf(path) (case-folded); the path itself is
+/// kept so launches the shell did not record can still be listed.
+///
+/// State lives in a small append-only file: a header followed by one record
+/// per launch holding that target's new rank. Replaying keeps the last record
+/// per target; the file is rewritten compactly once the log holds well over
+/// one record per target. All methods are thread-safe.
+/// </summary>
+class FrecencyStore {
+public:
+    struct Entry {
+        std::uint64_t key  = 0;
+        double        rank = 0.0;
+        std::wstring  path;
+    };
+
+    static constexpr double kHalfLifeDays = 14.0;
+
+    /// Rank of no launches at all (-infinity).
+    static double NoRank();
+
+    /// Stable identity of a launch target: 64-bit FNV-1a of the folded path.
+    static std::uint64_t KeyOf(std::wstring_view path);
+
+    /// Rank of |launches| (> 0) units of weight at |ticks| (FILETIME, 100 ns).
+    static double RankFromUsage(std::uint64_t ticks, double launches);
+
+    /// <summary>
+    /// Rank for a UserAssist record. Its run count is a lifetime total with
+    /// only the last run's time, so it is credited as at most 16 launches at
+    /// half weight, all at that time.
+    /// </summary>
+    static double RankFromUserAssist(std::uint64_t lastRunTicks, std::uint32_t runCount);
+
+    /// Rank of two launch histories together (log-sum of their weights).
+    static double Combine(double a, double b);
+
+    /// Decayed launch weight of |rank| at |nowTicks|.
+    static double WeightAt(double rank, std::uint64_t nowTicks);
+
+    /// <summary>
+    /// Score bonus for search results, 0..kMaxSearchBoost, growing with the
+    /// log of the current weight (one recent launch ≈ a quarter of the cap).
+    /// </summary>
+    static int SearchBoost(double rank, std::uint64_t nowTicks);
+    static constexpr int kMaxSearchBoost = 120;
+
+    /// <summary>
+    /// Replace the in-memory state with the file at |path|, which also becomes
+    /// the file RecordLaunch() appends to. A missing, foreign or damaged file
+    /// loads what it can (possibly nothing), returns false, and is rewritten
+    /// on the next launch.
+    /// </summary>
+    bool Load(const std::wstring& path);
+
+    /// <summary>
+    /// Credit one launch of |target| at |nowTicks| and persist it: one record
+    /// appended, or a compact rewrite when the log has grown. Returns false if
+    /// the file could not be written (the in-memory state is still updated).
+    /// </summary>
+    bool RecordLaunch(std::wstring_view target, std::uint64_t nowTicks);
+
+    /// Rank of |target|, or NoRank() if it was never launched from the menu.
+    double Rank(std::wstring_view target) const;
+
+    /// Copy of every entry (unordered).
+    std::vector<Entry> Snapshot() const;
+
+    size_t Size() const;
+
+private:
+    void Upsert(std::uint64_t key, double rank, std::wstring_view path);
+    bool Rewrite();   // m_mutex held
+
+    mutable std::mutex                       m_mutex;
+    std::vector<Entry>                       m_entries;
+    std::unordered_map<std::uint64_t, size_t> m_byKey;   // key → m_entries index
+    std::wstring                             m_path;
+    size_t                                   m_logRecords   = 0;   // records in the file
+    bool                                     m_needsRewrite = false;
+};
+
+} // namespace GlassBar
@@ -0,0 +1,352 @@
+#include "FuzzyMatch.h"
+
+#include <algorithm>
+#include <bit>
+
+#if !defined(GLASSBAR_NO_SIMD) && \
+    (defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define GLASSBAR_FUZZY_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define GLASSBAR_TARGET_AVX2
+#else
+#define GLASSBAR_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace GlassBar {
+
+namespace {
+
+constexpr size_t kNotFound = static_cast<size_t>(-1);
+
+// Score components (see FuzzyScore).
+constexpr int kMatch          = 16;
+constexpr int kBoundaryBonus  = 24;
+constexpr int kFirstCharBonus = 8;    // on top of the boundary bonus at index 0
+constexpr int kConsecutive    = 12;
+constexpr int kGapOpen        = 3;
+constexpr int kGapExtend      = 1;
+constexpr int kMaxGapCost     = 12;
+constexpr int kMaxLeadingCost = 10;
+
+enum class SimdLevel { Scalar, Sse2, Avx2 };
+
+SimdLevel DetectSimd() {
+#if GLASSBAR_FUZZY_X86
+#if defined(_MSC_VER)
+    // AVX2 needs the CPU bit (leaf 7, EBX bit 5) and OS-enabled YMM state.
+    int r[4];
+    __cpuid(r, 0);
+    if (r[0] >= 7) {
+        __cpuid(r, 1);
+        const bool osxsave = (r[2] & (1 << 27)) != 0;
+        const bool avx     = (r[2] & (1 << 28)) != 0;
+        if (osxsave && avx && (_xgetbv(0) & 6) == 6) {
+            __cpuidex(r, 7, 0);
+            if (r[1] & (1 << 5)) return SimdLevel::Avx2;
+        }
+    }
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::Avx2;
+#endif
+    return SimdLevel::Sse2;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+SimdLevel Simd() {
+    static const SimdLevel level = DetectSimd();
+    return level;
+}
+
+// ── Prefilter kernels ─────────────────────────────────────────────────────────
+// Each returns how many masks it consumed; the caller finishes the tail.
+
+#if GLASSBAR_FUZZY_X86
+void EmitBits(unsigned bits, size_t base, std::vector<uint32_t>& out) {
+    while (bits) {
+        out.push_back(static_cast<uint32_t>(base + std::countr_zero(bits)));
+        bits &= bits - 1;
+    }
+}
+
+GLASSBAR_TARGET_AVX2
+size_t PrefilterAvx2(const uint64_t* masks, size_t count, uint64_t need,
+                     std::vector<uint32_t>& out) {
+    const __m256i q = _mm256_set1_epi64x(static_cast<long long>(need));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(masks + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(masks + i + 4));
+        const __m256i ea = _mm256_cmpeq_epi64(_mm256_and_si256(a, q), q);
+        const __m256i eb = _mm256_cmpeq_epi64(_mm256_and_si256(b, q), q);
+        const unsigned bits =
+            static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(ea))) |
+            (static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(eb))) << 4);
+        EmitBits(bits, i, out);
+    }
+    return i;
+}
+
+size_t PrefilterSse2(const uint64_t* masks, size_t count, uint64_t need,
+                     std::vector<uint32_t>& out) {
+    // SSE2 has no 64-bit compare: compare 32-bit halves, then AND each half
+    // with its neighbour so a lane is all-ones only if both matched.
+    const __m128i q = _mm_set1_epi64x(static_cast<long long>(need));
+    auto lanes = [&q](const uint64_t* p) {
+        __m128i eq = _mm_cmpeq_epi32(
+            _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), q), q);
+        eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+        return static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(eq)));
+    };
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        EmitBits(lanes(masks + i) | (lanes(masks + i + 2) << 2), i, out);
+    return i;
+}
+#endif
+
+// ── Occurrence masks ──────────────────────────────────────────────────────────
+// Names of up to 64 units are scored on bitmasks: one compare sweep per
+// pattern character gives every position it occurs at, and placement is
+// then a few bit operations instead of character scans.
+
+constexpr size_t kMaskChars = 64;
+
+// The SIMD kernels OR each chunk into the mask; a last chunk overlapping the
+// previous one is harmless, so names of at least one chunk need no scalar
+// tail.
+
+uint64_t OccurrenceMaskScalar(const wchar_t* s, size_t n, wchar_t c) {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < n; ++i)
+        if (s[i] == c) mask |= uint64_t{1} << i;
+    return mask;
+}
+
+#if GLASSBAR_FUZZY_X86
+uint64_t OccurrenceMaskSse2(const wchar_t* s, size_t n, wchar_t c) {
+    constexpr size_t kLanes = 16 / sizeof(wchar_t);
+    if (n < kLanes) return OccurrenceMaskScalar(s, n, c);
+    uint64_t mask = 0;
+    if constexpr (sizeof(wchar_t) == 2) {
+        const __m128i needle = _mm_set1_epi16(static_cast<short>(c));
+        for (size_t i = 0; i < n; i += kLanes) {
+            const size_t at = (std::min)(i, n - kLanes);
+            const __m128i eq = _mm_cmpeq_epi16(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + at)), needle);
+            // Narrow the 16-bit results to bytes: one movemask bit per unit.
+            mask |= static_cast<uint64_t>(static_cast<unsigned>(
+                _mm_movemask_epi8(_mm_packs_epi16(eq, _mm_setzero_si128())))) << at;
+        }
+    } else {
+        const __m128i needle = _mm_set1_epi32(static_cast<int>(c));
+        for (size_t i = 0; i < n; i += kLanes) {
+            const size_t at = (std::min)(i, n - kLanes);
+            const __m128i eq = _mm_cmpeq_epi32(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + at)), needle);
+            mask |= static_cast<uint64_t>(static_cast<unsigned>(
+                _mm_movemask_ps(_mm_castsi128_ps(eq)))) << at;
+        }
+    }
+    return mask;
+}
+
+GLASSBAR_TARGET_AVX2
+uint64_t OccurrenceMaskAvx2(const wchar_t* s, size_t n, wchar_t c) {
+    constexpr size_t kLanes = 32 / sizeof(wchar_t);
+    if (n < kLanes) return OccurrenceMaskSse2(s, n, c);
+    uint64_t mask = 0;
+    if constexpr (sizeof(wchar_t) == 2) {
+        const __m256i needle = _mm256_set1_epi16(static_cast<short>(c));
+        for (size_t i = 0; i < n; i += kLanes) {
+            const size_t at = (std::min)(i, n - kLanes);
+            const __m256i eq = _mm256_cmpeq_epi16(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + at)), needle);
+            // packs works per 128-bit half: unit bits land in movemask
+            // bits 0-7 and 16-23.
+            const unsigned mm = static_cast<unsigned>(
+                _mm256_movemask_epi8(_mm256_packs_epi16(eq, _mm256_setzero_si256())));
+            mask |= static_cast<uint64_t>((mm & 0xFFu) | ((mm >> 8) & 0xFF00u)) << at;
+        }
+    } else {
+        const __m256i needle = _mm256_set1_epi32(static_cast<int>(c));
+        for (size_t i = 0; i < n; i += kLanes) {
+            const size_t at = (std::min)(i, n - kLanes);
+            const __m256i eq = _mm256_cmpeq_epi32(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + at)), needle);
+            mask |= static_cast<uint64_t>(static_cast<unsigned>(
+                _mm256_movemask_ps(_mm256_castsi256_ps(eq)))) << at;
+        }
+    }
+    return mask;
+}
+#endif
+
+/// Bit i set where s[i] == c, for n <= kMaskChars.
+uint64_t OccurrenceMask(const wchar_t* s, size_t n, wchar_t c) {
+#if GLASSBAR_FUZZY_X86
+    switch (Simd()) {
+    case SimdLevel::Avx2: return OccurrenceMaskAvx2(s, n, c);
+    case SimdLevel::Sse2: return OccurrenceMaskSse2(s, n, c);
+    default: break;
+    }
+#endif
+    return OccurrenceMaskScalar(s, n, c);
+}
+
+/// Bit i set where bounds[i] != 0, for n <= kMaskChars.
+uint64_t BoundaryMask(const uint8_t* bounds, size_t n) {
+    uint64_t mask = 0;
+    size_t i = 0;
+#if GLASSBAR_FUZZY_X86
+    if (Simd() != SimdLevel::Scalar) {
+        for (; i + 16 <= n; i += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bounds + i));
+            const unsigned zero = static_cast<unsigned>(
+                _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())));
+            mask |= static_cast<uint64_t>(~zero & 0xFFFFu) << i;
+        }
+    }
+#endif
+    for (; i < n; ++i)
+        if (bounds[i]) mask |= uint64_t{1} << i;
+    return mask;
+}
+
+// ── Scoring ───────────────────────────────────────────────────────────────────
+
+/// Points for matching one pattern character at |at|, the previous one having
+/// matched at |prev| (kNotFound for the first character).
+int PlacementScore(size_t at, size_t prev, bool boundary) {
+    int score = kMatch;
+    if (boundary) score += kBoundaryBonus + (at == 0 ? kFirstCharBonus : 0);
+    if (prev == kNotFound)
+        return score - static_cast<int>((std::min)(at, static_cast<size_t>(kMaxLeadingCost)));
+    if (at == prev + 1)
+        return score + kConsecutive;
+    const int gap = static_cast<int>(at - prev - 1);
+    return score - (std::min)(kGapOpen + kGapExtend * (gap - 1), kMaxGapCost);
+}
+
+/// FuzzyScore for names of at most kMaskChars units.
+int ScoreShort(const wchar_t* s, size_t n, const uint8_t* bounds, std::wstring_view pattern) {
+    const size_t m = pattern.size();
+    uint64_t occ[kFuzzyMaxPattern];
+    size_t latest[kFuzzyMaxPattern];
+
+    // Backward greedy pass: latest[j] is the last index pattern[j] may take
+    // with the rest of the pattern still matching after it. Running out of
+    // name means |pattern| is not a subsequence.
+    uint64_t below = (n == kMaskChars) ? ~uint64_t{0} : (uint64_t{1} << n) - 1;
+    for (size_t j = m; j-- > 0;) {
+        occ[j] = OccurrenceMask(s, n, pattern[j]);
+        const uint64_t allowed = occ[j] & below;
+        if (!allowed) return -1;
+        latest[j] = static_cast<size_t>(63 - std::countl_zero(allowed));
+        below = (uint64_t{1} << latest[j]) - 1;
+    }
+
+    // Placement: any occurrence in [lo, latest[j]] keeps the match feasible,
+    // so each character takes the most rewarding one — right after the
+    // previous match, else the first word start, else the first occurrence.
+    const uint64_t starts = BoundaryMask(bounds, n);
+    int score = 0;
+    size_t prev = kNotFound;
+    for (size_t j = 0; j < m; ++j) {
+        const size_t lo = (prev == kNotFound) ? 0 : prev + 1;
+        size_t at;
+        if (prev != kNotFound && ((occ[j] >> lo) & 1)) {
+            at = lo;
+        } else {
+            const uint64_t upTo  = (latest[j] == 63) ? ~uint64_t{0}
+                                                     : (uint64_t{2} << latest[j]) - 1;
+            const uint64_t range = occ[j] & upTo & ~((uint64_t{1} << lo) - 1);
+            const uint64_t atStart = range & starts;
+            at = static_cast<size_t>(std::countr_zero(atStart ? atStart : range));
+        }
+        score += PlacementScore(at, prev, (starts >> at) & 1);
+        prev = at;
+    }
+    return score;
+}
+
+/// FuzzyScore for longer names: the same placement with plain scans.
+int ScoreLong(const wchar_t* s, size_t n, const uint8_t* bounds, std::wstring_view pattern) {
+    const size_t m = pattern.size();
+    size_t latest[kFuzzyMaxPattern];
+    size_t end = n;
+    for (size_t j = m; j-- > 0;) {
+        while (end > 0 && s[end - 1] != pattern[j]) --end;
+        if (end == 0) return -1;
+        latest[j] = --end;
+    }
+
+    int score = 0;
+    size_t prev = kNotFound;
+    for (size_t j = 0; j < m; ++j) {
+        const size_t lo = (prev == kNotFound) ? 0 : prev + 1;
+        size_t at = kNotFound;
+        if (prev != kNotFound && s[lo] == pattern[j]) {
+            at = lo;
+        } else {
+            for (size_t k = lo; k <= latest[j]; ++k) {
+                if (s[k] != pattern[j]) continue;
+                if (at == kNotFound) at = k;
+                if (bounds[k]) { at = k; break; }
+            }
+        }
+        score += PlacementScore(at, prev, bounds[at] != 0);
+        prev = at;
+    }
+    return score;
+}
+
+} // namespace
+
+// ── Public API ────────────────────────────────────────────────────────────────
+
+uint64_t FuzzyCharMask(std::wstring_view folded) {
+    uint64_t mask = 0;
+    for (wchar_t c : folded) {
+        if (c >= L'a' && c <= L'z')      mask |= uint64_t{1} << (c - L'a');
+        else if (c >= L'0' && c <= L'9') mask |= uint64_t{1} << (26 + (c - L'0'));
+        else if (c != L' ')              mask |= uint64_t{1} << (36 + static_cast<uint32_t>(c) % 28);
+    }
+    return mask;
+}
+
+void FuzzyPrefilter(const uint64_t* masks, size_t count, uint64_t need,
+                    std::vector<uint32_t>& out) {
+    size_t i = 0;
+#if GLASSBAR_FUZZY_X86
+    switch (Simd()) {
+    case SimdLevel::Avx2: i = PrefilterAvx2(masks, count, need, out); break;
+    case SimdLevel::Sse2: i = PrefilterSse2(masks, count, need, out); break;
+    default: break;
+    }
+#endif
+    for (; i < count; ++i)
+        if ((masks[i] & need) == need) out.push_back(static_cast<uint32_t>(i));
+}
+
+int FuzzyScore(std::wstring_view name, const uint8_t* bounds, std::wstring_view pattern) {
+    const size_t n = name.size(), m = pattern.size();
+    if (m == 0 || m > n || m > kFuzzyMaxPattern) return -1;
+    return n <= kMaskChars ? ScoreShort(name.data(), n, bounds, pattern)
+                           : ScoreLong(name.data(), n, bounds, pattern);
+}
+
+const char* FuzzySimdLevel() {
+    switch (Simd()) {
+    case SimdLevel::Avx2: return "avx2";
+    case SimdLevel::Sse2: return "sse2";
+    default:              return "scalar";
+    }
+}
+
+} // namespace GlassBar
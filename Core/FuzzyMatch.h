@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace GlassBar {
+
+// ── Fuzzy subsequence matching ────────────────────────────────────────────────
+// Second-tier matching for type-to-search: "vsc" finds "Visual Studio Code".
+// All strings here are already case-folded (FoldNameChar).  The hot loops use
+// SSE2 on x86/x64 and AVX2 when the CPU has it; GLASSBAR_NO_SIMD forces the
+// scalar code, which gives identical results.
+
+/// Longest pattern FuzzyScore() accepts, in UTF-16 units.
+constexpr size_t kFuzzyMaxPattern = 32;
+
+/// <summary>
+/// Character-set summary of a folded string for FuzzyPrefilter(): one bit per
+/// a–z and 0–9, everything else hashed into the remaining 28 bits. Spaces are
+/// ignored. If |pattern| is a subsequence of |name| then the mask of |pattern|
+/// is a subset of the mask of |name| (the converse does not hold).
+/// </summary>
+uint64_t FuzzyCharMask(std::wstring_view folded);
+
+/// <summary>
+/// Appends to |out| every index i in [0, count) with
+/// (masks[i] &amp; need) == need, in ascending order.
+/// </summary>
+void FuzzyPrefilter(const uint64_t* masks, size_t count, uint64_t need,
+                    std::vector<uint32_t>& out);
+
+/// <summary>
+/// Score of |pattern| as a subsequence of |name|, or -1 when it is not one.
+/// |bounds|[i] is nonzero where a word or a camel-case hump starts in |name|.
+/// Each pattern character is placed at the best spot that still lets the rest
+/// match: right after the previous one, else at the next word start, else at
+/// its next occurrence. Matches on word starts and consecutive runs score
+/// higher; gaps between matches and before the first one cost points.
+/// </summary>
+int FuzzyScore(std::wstring_view name, const uint8_t* bounds, std::wstring_view pattern);
+
+/// Kernel in use: "avx2", "sse2" or "scalar" (for logs).
+const char* FuzzySimdLevel();
+
+} // namespace GlassBar
@@ -0,0 +1,85 @@
+#include "GlyphCache.h"
+
+namespace GlassBar {
+
+// ── Fonts ─────────────────────────────────────────────────────────────────────
+
+GlyphCache::Font& GlyphCache::FontFor(HDC hdc, HFONT font) {
+    auto [it, inserted] = m_fonts.try_emplace(font);
+    if (inserted) {
+        TEXTMETRICW tm = {};
+        GetTextMetricsW(hdc, &tm);
+        it->second.metrics = { static_cast<int>(tm.tmAscent), static_cast<int>(tm.tmDescent) };
+    }
+    return it->second;
+}
+
+GlyphCache::Metrics GlyphCache::FontMetrics(HDC hdc, HFONT font) {
+    return FontFor(hdc, font).metrics;
+}
+
+const std::vector<RasterGlyph>& GlyphCache::Ellipsis(HDC hdc, HFONT font) {
+    Font& f = FontFor(hdc, font);
+    if (f.ellipsis.empty()) {
+        const Glyph& dot = GlyphFor(hdc, f, L'.');
+        f.ellipsis.assign(3, dot.glyph);
+    }
+    return f.ellipsis;
+}
+
+// ── Glyphs ────────────────────────────────────────────────────────────────────
+
+const GlyphCache::Glyph& GlyphCache::GlyphFor(HDC hdc, Font& font, wchar_t ch) {
+    auto [it, inserted] = font.glyphs.try_emplace(ch);
+    Glyph& g = it->second;
+    if (!inserted) return g;
+
+    WORD index = 0;
+    if ((ch >= 0xD800 && ch <= 0xDFFF) ||
+        GetGlyphIndicesW(hdc, &ch, 1, &index, GGI_MARK_NONEXISTING_GLYPHS) == GDI_ERROR ||
+        index == 0xFFFF) {
+        g.missing = true;
+        return g;
+    }
+
+    static const MAT2 kIdentity = { { 0, 1 }, { 0, 0 }, { 0, 0 }, { 0, 1 } };
+    GLYPHMETRICS gm = {};
+    const DWORD size = GetGlyphOutlineW(hdc, ch, GGO_GRAY8_BITMAP, &gm, 0, nullptr, &kIdentity);
+    if (size == GDI_ERROR) {
+        g.missing = true;
+        return g;
+    }
+    g.glyph.advance = gm.gmCellIncX;
+    if (size == 0) return g;   // blank (a space): advance only
+
+    g.coverage.resize(size);
+    if (GetGlyphOutlineW(hdc, ch, GGO_GRAY8_BITMAP, &gm, size, g.coverage.data(),
+                         &kIdentity) == GDI_ERROR) {
+        g.missing = true;
+        return g;
+    }
+    // Rows are DWORD aligned; levels run 0..64.
+    for (std::uint8_t& c : g.coverage)
+        c = static_cast<std::uint8_t>((c * 255u + 32u) / 64u);
+    g.glyph.coverage = g.coverage.data();
+    g.glyph.width    = static_cast<int>(gm.gmBlackBoxX);
+    g.glyph.height   = static_cast<int>(gm.gmBlackBoxY);
+    g.glyph.pitch    = (g.glyph.width + 3) & ~3;
+    g.glyph.offsetX  = gm.gmptGlyphOrigin.x;
+    g.glyph.offsetY  = -gm.gmptGlyphOrigin.y;
+    return g;
+}
+
+bool GlyphCache::Shape(HDC hdc, HFONT font, const wchar_t* text, size_t len,
+                       std::vector<RasterGlyph>& run) {
+    Font& f = FontFor(hdc, font);
+    run.clear();
+    for (size_t i = 0; i < len; ++i) {
+        const Glyph& g = GlyphFor(hdc, f, text[i]);
+        if (g.missing) return false;
+        run.push_back(g.glyph);
+    }
+    return true;
+}
+
+} // namespace GlassBar
@@ -0,0 +1,62 @@
+#pragma once
+#include "RasterSurface.h"   // RasterGlyph
+#include <Windows.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace GlassBar {
+
+/// <summary>
+/// GlyphCache — grayscale coverage masks of GDI fonts for
+/// RasterSurface::DrawGlyphRun().
+///
+/// Each UTF-16 unit is rasterized once per font with GetGlyphOutlineW
+/// (GGO_GRAY8_BITMAP, its 65 levels rescaled to 256) and kept until Clear().
+/// Masks are grayscale, not ClearType: ClearType needs an opaque destination,
+/// and the frame they are drawn into carries per-pixel alpha.
+///
+/// GetGlyphOutlineW sees only the font itself, without the font linking
+/// DrawTextW does, so Shape() refuses text with a unit the font lacks (or a
+/// surrogate) and the caller draws that label with GDI. UI thread only; the
+/// HFONTs are the caller's, and Clear() must run before one is deleted.
+/// </summary>
+class GlyphCache {
+public:
+    struct Metrics {
+        int ascent  = 0;
+        int descent = 0;
+    };
+
+    /// Glyphs of |len| units of |text| in |font| (selected into |hdc|) into
+    /// |run|, replacing its contents; false if one of them has no glyph.
+    bool Shape(HDC hdc, HFONT font, const wchar_t* text, size_t len,
+               std::vector<RasterGlyph>& run);
+
+    /// Line metrics of |font|, as GetTextMetricsW() gives them.
+    Metrics FontMetrics(HDC hdc, HFONT font);
+
+    /// The "..." DrawTextW appends with DT_END_ELLIPSIS, in |font|.
+    const std::vector<RasterGlyph>& Ellipsis(HDC hdc, HFONT font);
+
+    void Clear() { m_fonts.clear(); }
+
+private:
+    struct Glyph {
+        RasterGlyph               glyph;
+        std::vector<std::uint8_t> coverage;
+        bool                      missing = false;
+    };
+    struct Font {
+        Metrics                             metrics;
+        std::vector<RasterGlyph>            ellipsis;
+        std::unordered_map<wchar_t, Glyph>  glyphs;   // nodes stay put: coverage pointers hold
+    };
+
+    Font&        FontFor(HDC hdc, HFONT font);
+    const Glyph& GlyphFor(HDC hdc, Font& font, wchar_t ch);
+
+    std::unordered_map<HFONT, Font> m_fonts;
+};
+
+} // namespace GlassBar
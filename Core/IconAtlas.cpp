@@ -0,0 +1,160 @@
+#include "IconAtlas.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if !defined(GLASSBAR_NO_SIMD) && \
+    (defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define GLASSBAR_ATLAS_X86 1
+#include <emmintrin.h>
+#endif
+
+namespace GlassBar {
+
+// ── Packing ───────────────────────────────────────────────────────────────────
+
+IconAtlas::SizeClass& IconAtlas::ClassOf(int size) {
+    for (SizeClass& sc : m_classes)
+        if (sc.size == size) return sc;
+    m_classes.push_back({});
+    m_classes.back().size = size;
+    return m_classes.back();
+}
+
+IconAtlas::Slot IconAtlas::Allocate(SizeClass& sc) {
+    if (!sc.free.empty()) {
+        const Slot slot = sc.free.back();
+        sc.free.pop_back();
+        return slot;
+    }
+    if (sc.shelfY < 0 || sc.nextX + sc.size > kWidth) {
+        sc.shelfY = m_height;
+        sc.nextX  = 0;
+        m_height += sc.size;
+        const size_t need = static_cast<size_t>(kWidth) * m_height;
+        if (m_pixels.size() < need) m_pixels.resize(need);
+    }
+    const Slot slot{ sc.nextX, sc.shelfY, sc.size };
+    sc.nextX += sc.size;
+    return slot;
+}
+
+const IconAtlas::Slot* IconAtlas::Find(std::uint64_t id, int size) const {
+    auto it = m_icons.find(id);
+    if (it == m_icons.end()) return nullptr;
+    const Icon& icon = it->second;
+    for (int i = 0; i < icon.count; ++i)
+        if (icon.slots[i].size == size) return &icon.slots[i];
+    return nullptr;
+}
+
+const IconAtlas::Slot* IconAtlas::Insert(std::uint64_t id, int size, const std::uint32_t* pixels) {
+    if (size < 1 || size > kWidth) return nullptr;
+    Icon& icon = m_icons[id];
+    Slot* slot = nullptr;
+    for (int i = 0; i < icon.count && !slot; ++i)
+        if (icon.slots[i].size == size) slot = &icon.slots[i];
+    if (!slot) {
+        if (icon.count == kSizesPerIcon) return nullptr;
+        slot  = &icon.slots[icon.count++];
+        *slot = Allocate(ClassOf(size));
+    }
+    for (int row = 0; row < size; ++row)
+        std::memcpy(&m_pixels[static_cast<size_t>(slot->y + row) * kWidth + slot->x],
+                    pixels + static_cast<size_t>(row) * size, size * sizeof(std::uint32_t));
+    return slot;
+}
+
+void IconAtlas::Remove(std::uint64_t id) {
+    auto it = m_icons.find(id);
+    if (it == m_icons.end()) return;
+    for (int i = 0; i < it->second.count; ++i)
+        ClassOf(it->second.slots[i].size).free.push_back(it->second.slots[i]);
+    m_icons.erase(it);
+}
+
+void IconAtlas::Clear() {
+    m_icons.clear();
+    m_classes.clear();
+    m_height = 0;
+}
+
+// ── Blending ──────────────────────────────────────────────────────────────────
+// out = src + dst * (255 - srcAlpha) / 255 per channel, rounded and capped at
+// 255; the division is (t + (t >> 8)) >> 8 with t = x + 128, exact for
+// x <= 255 * 255.
+
+namespace {
+
+inline std::uint32_t BlendPixel(std::uint32_t s, std::uint32_t d) {
+    const std::uint32_t inv = 255u - (s >> 24);
+    std::uint32_t out = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        std::uint32_t t = ((d >> shift) & 0xFFu) * inv + 128u;
+        t = (t + (t >> 8)) >> 8;
+        out |= (std::min)(((s >> shift) & 0xFFu) + t, 255u) << shift;
+    }
+    return out;
+}
+
+#if GLASSBAR_ATLAS_X86
+// Two pixels widened to 16-bit lanes.
+inline __m128i BlendHalf(__m128i s16, __m128i d16) {
+    const __m128i c255 = _mm_set1_epi16(255);
+    const __m128i c128 = _mm_set1_epi16(128);
+    __m128i a = _mm_shufflelo_epi16(s16, _MM_SHUFFLE(3, 3, 3, 3));
+    a = _mm_shufflehi_epi16(a, _MM_SHUFFLE(3, 3, 3, 3));
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(d16, _mm_sub_epi16(c255, a)), c128);
+    t = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+    return _mm_add_epi16(s16, t);
+}
+
+// Four pixels at a time; returns how many were done.
+int BlendRowSse2(std::uint32_t* dst, const std::uint32_t* src, int n) {
+    const __m128i zero   = _mm_setzero_si128();
+    const __m128i alphas = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i a = _mm_and_si128(s, alphas);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(a, zero)) == 0xFFFF) continue;          // transparent
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(a, alphas)) == 0xFFFF) {                // opaque
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), s);
+            continue;
+        }
+        const __m128i d  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        const __m128i lo = BlendHalf(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+        const __m128i hi = BlendHalf(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    return i;
+}
+#endif
+
+} // namespace
+
+void BlendPremultiplied(std::uint32_t* dst, int dstStride, int dstW, int dstH,
+                        int x, int y,
+                        const std::uint32_t* src, int srcStride, int w, int h) {
+    // Clip the block to the destination.
+    const int x0 = (std::max)(x, 0), x1 = (std::min)(x + w, dstW);
+    const int y0 = (std::max)(y, 0), y1 = (std::min)(y + h, dstH);
+    if (x0 >= x1 || y0 >= y1) return;
+    const int n = x1 - x0;
+
+    for (int row = y0; row < y1; ++row) {
+        std::uint32_t*       d = dst + static_cast<size_t>(row) * dstStride + x0;
+        const std::uint32_t* s = src + static_cast<size_t>(row - y) * srcStride + (x0 - x);
+        int i = 0;
+#if GLASSBAR_ATLAS_X86
+        i = BlendRowSse2(d, s, n);
+#endif
+        for (; i < n; ++i) {
+            const std::uint32_t alpha = s[i] >> 24;
+            if (alpha == 255)    d[i] = s[i];
+            else if (alpha != 0) d[i] = BlendPixel(s[i], d[i]);
+        }
+    }
+}
+
+} // namespace GlassBar
@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace GlassBar {
+
+// ── Icon atlas ────────────────────────────────────────────────────────────────
+// Every icon the menu paints, rasterized once at the exact size it is shown
+// at and packed into one premultiplied 32-bit image (top-down 0xAARRGGBB rows,
+// the layout of a BI_RGB DIB). Painting an icon is then an unscaled blend of
+// a rectangle of it (BlendPremultiplied) into the frame. Plain C++: the
+// rasterizing and the frame buffer belong to the caller.
+
+/// <summary>
+/// Square icon rasters of a few sizes, packed into fixed-width shelves: each
+/// size has its own shelves, so every slot of one size is interchangeable and
+/// a removed icon's slot is simply reused by the next icon of that size.
+/// The image grows downwards (its width never changes) when a size runs out
+/// of shelf space; Pixels() may move then.
+/// </summary>
+class IconAtlas {
+public:
+    struct Slot {
+        int x    = 0;
+        int y    = 0;
+        int size = 0;
+    };
+
+    static constexpr int kWidth        = 256;
+    static constexpr int kSizesPerIcon = 4;   // distinct sizes one id can have
+
+    /// Slot holding |id| at |size| px, or nullptr.
+    const Slot* Find(std::uint64_t id, int size) const;
+
+    /// <summary>
+    /// Copy a |size|² raster of |id| in (replacing one already there) and
+    /// return its slot, or nullptr when |size| is not in 1..kWidth or |id|
+    /// already has kSizesPerIcon other sizes.
+    /// </summary>
+    const Slot* Insert(std::uint64_t id, int size, const std::uint32_t* pixels);
+
+    /// Free every size of |id|; its slots go to the next Insert() of that size.
+    void Remove(std::uint64_t id);
+
+    /// Drop everything (keeps the image's memory).
+    void Clear();
+
+    const std::uint32_t* Pixels() const { return m_pixels.data(); }
+    int    Height()    const { return m_height; }
+    size_t IconCount() const { return m_icons.size(); }
+
+private:
+    struct SizeClass {
+        int               size   = 0;
+        int               shelfY = -1;   // the shelf being filled, -1 = none
+        int               nextX  = 0;
+        std::vector<Slot> free;
+    };
+
+    struct Icon {
+        Slot slots[kSizesPerIcon];
+        int  count = 0;
+    };
+
+    SizeClass& ClassOf(int size);
+    Slot       Allocate(SizeClass& sc);
+
+    std::vector<std::uint32_t>              m_pixels;
+    int                                     m_height = 0;   // rows in use
+    std::vector<SizeClass>                  m_classes;
+    std::unordered_map<std::uint64_t, Icon> m_icons;
+};
+
+/// <summary>
+/// Source-over blend of the premultiplied |w|×|h| block at |src| (row pitch
+/// |srcStride| pixels) onto |dst| (|dstW|×|dstH|, pitch |dstStride|) with its
+/// top-left corner at (|x|, |y|), clipped to |dst|. Fully opaque pixels are
+/// copied and fully transparent ones skipped. SSE2 on x86/x64
+/// (GLASSBAR_NO_SIMD forces the scalar loop, which gives identical results).
+/// </summary>
+void BlendPremultiplied(std::uint32_t* dst, int dstStride, int dstW, int dstH,
+                        int x, int y,
+                        const std::uint32_t* src, int srcStride, int w, int h);
+
+} // namespace GlassBar
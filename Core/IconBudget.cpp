@@ -0,0 +1,60 @@
+#include "IconBudget.h"
+
+namespace GlassBar {
+
+void IconBudget::Insert(std::uint64_t id, size_t bytes) {
+    if (m_index.count(id)) return;
+    m_lru.push_front({ id, bytes, 0, m_epoch });
+    m_index.emplace(id, m_lru.begin());
+    m_bytes += bytes;
+}
+
+bool IconBudget::Touch(std::uint64_t id) {
+    auto it = m_index.find(id);
+    if (it == m_index.end()) return false;
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    it->second->epoch = m_epoch;
+    return true;
+}
+
+void IconBudget::Erase(std::uint64_t id) {
+    auto it = m_index.find(id);
+    if (it == m_index.end()) return;
+    m_bytes -= it->second->bytes;
+    m_lru.erase(it->second);
+    m_index.erase(it);
+}
+
+bool IconBudget::MarkVisible(std::uint64_t id) {
+    auto it = m_index.find(id);
+    if (it == m_index.end()) return false;
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    it->second->frame = m_frame;
+    it->second->epoch = m_epoch;
+    return true;
+}
+
+size_t IconBudget::Evict(std::vector<std::uint64_t>& out) {
+    size_t evicted = 0;
+    // Walk from the cold end; what is skipped was used recently, so the
+    // walk rarely passes more than the visible set.
+    for (auto it = m_lru.end(); OverBudget() && it != m_lru.begin();) {
+        --it;
+        if (it->frame == m_frame || it->epoch == m_epoch) continue;
+        out.push_back(it->id);
+        m_bytes -= it->bytes;
+        m_index.erase(it->id);
+        it = m_lru.erase(it);
+        ++evicted;
+    }
+    ++m_epoch;
+    return evicted;
+}
+
+void IconBudget::Clear() {
+    m_lru.clear();
+    m_index.clear();
+    m_bytes = 0;
+}
+
+} // namespace GlassBar
@@ -0,0 +1,88 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace GlassBar {
+
+// ── Icon budget ───────────────────────────────────────────────────────────────
+// The bookkeeping behind IconCache's limits: which cached icons were used
+// least recently, how many there are and how much memory they hold. Plain
+// C++ keyed by the caller's ids (IconCache uses the HICON value); destroying
+// what Evict() picks is the caller's job.
+
+/// <summary>
+/// Least-recently-used order over a set of ids, each with a byte cost, and
+/// two limits: an id count and a byte total. Evict() picks ids from the cold
+/// end until both hold again, skipping two kinds of id:
+///   • visible ones — marked by MarkVisible() since the latest BeginFrame(),
+///     i.e. drawn in the frame on screen now;
+///   • ones inserted or used since the previous Evict(), which a loader may
+///     still be about to store in a slot.
+/// When every id is skipped the set stays over its limits until some go
+/// cold. Not thread-safe; IconCache calls it under its own lock.
+/// </summary>
+class IconBudget {
+public:
+    struct Limits {
+        size_t maxIcons = 1500;              // ~3 GDI/USER handles each
+        size_t maxBytes = 8 * 1024 * 1024;   // bitmap memory behind them
+    };
+
+    void          SetLimits(const Limits& limits) { m_limits = limits; }
+    const Limits& GetLimits() const { return m_limits; }
+
+    /// Track |id| (not tracked yet) as the most recently used, costing |bytes|.
+    void Insert(std::uint64_t id, size_t bytes);
+
+    /// Mark |id| the most recently used; false if it is not tracked.
+    bool Touch(std::uint64_t id);
+
+    /// Stop tracking |id| (no-op if it is not tracked).
+    void Erase(std::uint64_t id);
+
+    bool Contains(std::uint64_t id) const { return m_index.count(id) != 0; }
+
+    /// A new frame is being drawn: what the last one showed may go cold.
+    void BeginFrame() { ++m_frame; }
+
+    /// |id| is drawn in the current frame: touched, and kept by Evict() until
+    /// a frame goes by without it. False if it is not tracked.
+    bool MarkVisible(std::uint64_t id);
+
+    bool OverBudget() const {
+        return m_lru.size() > m_limits.maxIcons || m_bytes > m_limits.maxBytes;
+    }
+
+    /// <summary>
+    /// Untrack the coldest evictable ids until within both limits, append
+    /// them to |out| (coldest first) and return how many. Ids used from here
+    /// on are protected until the next call.
+    /// </summary>
+    size_t Evict(std::vector<std::uint64_t>& out);
+
+    void Clear();
+
+    size_t Count() const { return m_lru.size(); }
+    size_t Bytes() const { return m_bytes; }
+
+private:
+    struct Entry {
+        std::uint64_t id;
+        size_t        bytes;
+        std::uint32_t frame;   // last BeginFrame() it was drawn in
+        std::uint32_t epoch;   // last Evict() round it was used in
+    };
+    using List = std::list<Entry>;   // front = most recently used
+
+    Limits                                            m_limits;
+    List                                              m_lru;
+    std::unordered_map<std::uint64_t, List::iterator> m_index;
+    size_t                                            m_bytes = 0;
+    std::uint32_t                                     m_frame = 1;   // 0 = never drawn
+    std::uint32_t                                     m_epoch = 1;
+};
+
+} // namespace GlassBar
@@ -0,0 +1,233 @@
+#include "IconCache.h"
+#include "AllProgramsEnumerator.h"   // ResolveIconLocationKey
+
+#include <algorithm>
+
+namespace GlassBar {
+
+// ── Lookup ────────────────────────────────────────────────────────────────────
+
+HICON IconCache::GetIcon(const std::wstring& path, bool smallIcon, bool diskOnly) {
+    const wchar_t* suffix = smallIcon ? L"|S" : L"|L";
+    std::wstring key = path + suffix;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        auto it = m_cache.find(key);
+        if (it != m_cache.end()) {
+            m_budget.Touch(Id(it->second));
+            ++m_stats.hits;
+            return it->second;
+        }
+    }
+
+    // A cached raster is checked against the held images before any
+    // handle is made for it.
+    std::uint64_t pixels = 0;
+    HICON icon = nullptr;
+    IconDiskCache::Raster cached;
+    if (m_disk && m_disk->FindRaster(path, smallIcon, cached)) {
+        pixels = cached.hash;
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            auto it = m_byPixels.find(pixels);
+            if (it != m_byPixels.end()) {
+                const HICON held = it->second;
+                Share(held, std::move(key), std::wstring());
+                ++m_stats.pixelShares;
+                return held;
+            }
+        }
+        icon = IconDiskCache::CreateIcon(cached);
+    }
+
+    // Before asking the shell: is the resource it would read held already?
+    std::wstring location;
+    bool fromShell = false;
+    if (!icon && !diskOnly) {
+        location = ResolveIconLocationKey(path);
+        if (!location.empty()) {
+            location += suffix;
+            std::lock_guard<std::mutex> lk(m_mutex);
+            auto it = m_byLocation.find(location);
+            if (it != m_byLocation.end()) {
+                const HICON held = it->second;
+                Share(held, std::move(key), std::wstring());
+                ++m_stats.locationShares;
+                return held;
+            }
+        }
+        SHFILEINFOW sfi = {};
+        UINT flags = SHGFI_ICON | (smallIcon ? SHGFI_SMALLICON : SHGFI_LARGEICON);
+        if (SHGetFileInfoW(path.c_str(), 0, &sfi, sizeof(sfi), flags) && sfi.hIcon) {
+            icon      = sfi.hIcon;
+            fromShell = true;
+        }
+    }
+    if (!icon) return nullptr;
+
+    // Hashed at the disk cache's raster size, so icons from either source meet.
+    std::vector<std::uint32_t> raster;
+    if (fromShell) {
+        const std::uint32_t px = IconDiskCache::RasterPx(smallIcon);
+        raster.resize(static_cast<size_t>(px) * px);
+        if (RasterizeIcon(icon, static_cast<int>(px), raster.data()))
+            pixels = RasterHash(raster.data(), raster.size());
+        else
+            raster.clear();
+    }
+
+    bool store = fromShell && m_disk;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        HICON held = nullptr;
+        if (auto it = m_cache.find(key); it != m_cache.end()) {
+            held  = it->second;   // another worker loaded this very path
+            store = false;
+        } else if (auto loc = location.empty() ? m_byLocation.end() : m_byLocation.find(location);
+                   loc != m_byLocation.end()) {
+            held = loc->second;
+            ++m_stats.locationShares;
+        } else if (auto px = pixels ? m_byPixels.find(pixels) : m_byPixels.end();
+                   px != m_byPixels.end()) {
+            held = px->second;
+            ++m_stats.pixelShares;
+        }
+        if (held) {
+            DestroyIcon(icon);
+            icon = held;
+            Share(icon, std::move(key), std::move(location));
+        } else {
+            Held& h = m_held[icon];
+            h.paths.push_back(&m_cache.emplace(std::move(key), icon).first->first);
+            if (!location.empty())
+                h.locations.push_back(&m_byLocation.emplace(std::move(location), icon).first->first);
+            if (pixels) {
+                m_byPixels.emplace(pixels, icon);
+                h.pixels = pixels;
+            }
+            m_budget.Insert(Id(icon), IconBytes(smallIcon));
+            ++(fromShell ? m_stats.fromShell : m_stats.fromDisk);
+            m_stats.peakIcons = (std::max)(m_stats.peakIcons, m_budget.Count());
+        }
+    }
+    // Rasterized for this path even when its handle was shared: the next
+    // start finds it on disk.
+    if (store) m_disk->Store(path, smallIcon, icon, raster.empty() ? nullptr : raster.data());
+    return icon;
+}
+
+HICON IconCache::GetStockIcon(SHSTOCKICONID id, bool smallIcon) {
+    int key = static_cast<int>(id) * 2 + (smallIcon ? 1 : 0);
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        auto it = m_stock.find(key);
+        if (it != m_stock.end())
+            return it->second;
+    }
+
+    SHSTOCKICONINFO sii = {};
+    sii.cbSize = sizeof(sii);
+    UINT flags = SHGSI_ICON | (smallIcon ? SHGSI_SMALLICON : SHGSI_LARGEICON);
+    if (FAILED(SHGetStockIconInfo(id, flags, &sii)) || !sii.hIcon)
+        return nullptr;
+    HICON icon = sii.hIcon;
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto [it, added] = m_stock.emplace(key, icon);
+    if (!added) DestroyIcon(icon);
+    return it->second;
+}
+
+void IconCache::Share(HICON icon, std::wstring key, std::wstring location) {
+    Held& h = m_held[icon];
+    auto [it, added] = m_cache.emplace(std::move(key), icon);
+    if (added) h.paths.push_back(&it->first);
+    if (!location.empty()) {
+        auto [loc, fresh] = m_byLocation.emplace(std::move(location), icon);
+        if (fresh) h.locations.push_back(&loc->first);
+    }
+    m_budget.Touch(Id(icon));
+}
+
+// ── Budget ────────────────────────────────────────────────────────────────────
+
+void IconCache::SetLimits(const IconBudget::Limits& limits) {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_budget.SetLimits(limits);
+}
+
+size_t IconCache::IconBytes(bool smallIcon) {
+    const int px = GetSystemMetrics(smallIcon ? SM_CXSMICON : SM_CXICON);
+    return static_cast<size_t>(px) * px * 4 + static_cast<size_t>((px + 15) / 16 * 2) * px;
+}
+
+bool IconCache::Owns(HICON icon) {
+    if (!icon) return false;
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_budget.Contains(Id(icon))) return true;
+    for (const auto& kv : m_stock)
+        if (kv.second == icon) return true;
+    return false;
+}
+
+void IconCache::BeginFrame() {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_budget.BeginFrame();
+}
+
+void IconCache::MarkVisible(HICON icon) {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_budget.MarkVisible(Id(icon));
+}
+
+bool IconCache::OverBudget() {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_budget.OverBudget();
+}
+
+size_t IconCache::Trim(std::vector<HICON>& evicted) {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_evictIds.clear();
+    const size_t count = m_budget.Evict(m_evictIds);
+    for (std::uint64_t id : m_evictIds) {
+        HICON icon = reinterpret_cast<HICON>(static_cast<std::uintptr_t>(id));
+        auto held = m_held.find(icon);
+        if (held != m_held.end()) {
+            for (const std::wstring* key : held->second.paths)
+                m_cache.erase(m_cache.find(*key));
+            for (const std::wstring* key : held->second.locations)
+                m_byLocation.erase(m_byLocation.find(*key));
+            if (held->second.pixels)
+                m_byPixels.erase(held->second.pixels);
+            m_held.erase(held);
+        }
+        evicted.push_back(icon);
+    }
+    m_stats.evictions += count;
+    return count;
+}
+
+IconCache::Stats IconCache::GetStats() {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    Stats stats = m_stats;
+    stats.paths = m_cache.size();
+    stats.icons = m_budget.Count();
+    stats.bytes = m_budget.Bytes();
+    return stats;
+}
+
+void IconCache::ReleaseAll() {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    for (auto& kv : m_held)
+        DestroyIcon(kv.first);
+    m_held.clear();
+    m_cache.clear();
+    m_byLocation.clear();
+    m_byPixels.clear();
+    m_budget.Clear();
+    for (auto& kv : m_stock) {
+        if (kv.second) DestroyIcon(kv.second);
+    }
+    m_stock.clear();
+}
+
+} // namespace GlassBar
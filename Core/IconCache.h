@@ -0,0 +1,131 @@
+#pragma once
+#include "IconBudget.h"      // IconBudget
+#include "IconDiskCache.h"   // IconDiskCache
+#include <Windows.h>
+#include <shellapi.h>        // SHSTOCKICONID
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace GlassBar {
+
+/// <summary>
+/// IconCache — deduplicated, budgeted HICON lifetime manager.
+///
+/// Maps canonical file paths to HICON handles so that every unique icon is
+/// kept exactly once. Paths share a handle at two levels:
+///   • pixels — a path whose raster (RasterHash at RasterPx) matches a held
+///     icon's takes that handle: a disk-cached raster before any handle is
+///     built from it, a shell load right after (the new handle is destroyed);
+///   • icon location — before the shell is asked, a path whose
+///     ResolveIconLocationKey() matches one the shell already loaded
+///     (uninstallers and help links of one suite, a link and the .exe it
+///     points at) takes its handle.
+/// Identical images therefore also share one IconAtlas slot.
+///
+/// GetIcon / GetStockIcon may run on several icon workers at once: the maps
+/// are locked only around lookups and inserts, never around the shell or
+/// GDI. Two workers missing the same icon both load it; the first insert
+/// wins and the other handle is destroyed. Call ReleaseAll(),
+/// SetDiskCache() and SetLimits() only while no icon pass runs.
+///
+/// Path icons are held within an IconBudget (handle count and bytes), so a
+/// huge Start Menu cannot walk the process towards its GDI/USER handle quota.
+/// Trim() hands back the least recently used handles beyond it; the owner
+/// clears every slot holding one, then destroys them. Handles drawn in the
+/// frame on screen (MarkVisible) are never picked. An evicted path's next
+/// GetIcon() rebuilds it from its raster in the disk cache rather than asking
+/// the shell again. Stock icons are few and shared; they are not budgeted.
+/// </summary>
+class IconCache {
+public:
+    struct Stats {
+        std::uint64_t hits           = 0;   // GetIcon() answered from the cache
+        std::uint64_t fromDisk       = 0;   // misses rebuilt from a cached raster
+        std::uint64_t fromShell      = 0;   // misses the shell loaded
+        std::uint64_t locationShares = 0;   // misses given the handle of the same icon location
+        std::uint64_t pixelShares    = 0;   // loads dropped for a handle with the same pixels
+        std::uint64_t evictions      = 0;
+        size_t        paths          = 0;   // path keys held now...
+        size_t        icons          = 0;   // ...on this many handles
+        size_t        bytes          = 0;
+        size_t        peakIcons      = 0;
+    };
+
+    ~IconCache() { ReleaseAll(); }
+
+    /// <summary>
+    /// Back GetIcon() with |disk| (nullptr to stop): icons it still holds are
+    /// built from its rasters, and shell-loaded ones are handed to it for its
+    /// next Save(). Not owned.
+    /// </summary>
+    void SetDiskCache(IconDiskCache* disk) { m_disk = disk; }
+
+    void SetLimits(const IconBudget::Limits& limits);
+
+    /// Return a cached HICON for |path|, or load+cache it via SHGetFileInfoW.
+    /// Returns nullptr on failure (file not found, SHGetFileInfoW fails, etc.).
+    /// With |diskOnly| the shell is not asked: a path the disk cache lacks
+    /// gives nullptr and is tried again by the next call.
+    HICON GetIcon(const std::wstring& path, bool smallIcon = false, bool diskOnly = false);
+
+    /// Return a cached stock icon, loading it if not yet cached.
+    HICON GetStockIcon(SHSTOCKICONID id, bool smallIcon = false);
+
+    /// True while |icon| is a live handle of this cache (not evicted).
+    bool Owns(HICON icon);
+
+    /// UI thread, before painting a frame.
+    void BeginFrame();
+
+    /// |icon| is drawn in this frame: it stays until a frame goes by without
+    /// it. Handles the cache does not own are ignored.
+    void MarkVisible(HICON icon);
+
+    bool OverBudget();
+
+    /// <summary>
+    /// Drop the least recently used path icons beyond the budget and append
+    /// their handles to |evicted|. They are no longer the cache's: the caller
+    /// clears every slot holding one, then calls DestroyIcon on it.
+    /// </summary>
+    size_t Trim(std::vector<HICON>& evicted);
+
+    Stats GetStats();
+
+    /// Call DestroyIcon on every cached handle and clear the maps.
+    void ReleaseAll();
+
+private:
+    // Every key leading to one held handle, so eviction can drop them all.
+    struct Held {
+        std::vector<const std::wstring*> paths;       // in m_cache
+        std::vector<const std::wstring*> locations;   // in m_byLocation
+        std::uint64_t                    pixels = 0;  // in m_byPixels, 0 = none
+    };
+
+    static std::uint64_t Id(HICON icon) {
+        return static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(icon));
+    }
+
+    // Colour bitmap plus AND mask (WORD-aligned rows) at the system icon size.
+    static size_t IconBytes(bool smallIcon);
+
+    // Point |key| (and |location|, when new) at the held |icon|. Locked.
+    void Share(HICON icon, std::wstring key, std::wstring location);
+
+    std::mutex                                     m_mutex;
+    std::unordered_map<std::wstring, HICON>        m_cache;        // path|S/L → handle
+    std::unordered_map<std::wstring, HICON>        m_byLocation;   // icon location|S/L → handle
+    std::unordered_map<std::uint64_t, HICON>       m_byPixels;     // RasterHash → handle
+    std::unordered_map<HICON, Held>                m_held;         // one per handle
+    std::unordered_map<int, HICON>                 m_stock;
+    IconBudget                                     m_budget;
+    std::vector<std::uint64_t>                     m_evictIds;
+    Stats                                          m_stats;
+    IconDiskCache*                                 m_disk = nullptr;
+};
+
+} // namespace GlassBar
@@ -0,0 +1,439 @@
+#include "IconDiskCache.h"
+#include "Diagnostics.h"
+#include "NameFold.h"
+
+#include <shlobj.h>       // SHGetKnownFolderPath, FOLDERID_LocalAppData
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace GlassBar {
+
+// ── On-disk layout ────────────────────────────────────────────────────────────
+
+struct IconDiskCache::Entry {
+    std::uint64_t key;           // PathKey()
+    std::uint64_t stamp;         // ReadStamp() when rasterized
+    std::uint32_t pixelOffset;   // in pixels from the start of the pixel block
+    std::uint32_t sizePx;
+
+    bool operator<(const Entry& o) const {
+        return key != o.key ? key < o.key : sizePx < o.sizePx;
+    }
+};
+
+namespace {
+
+constexpr std::uint32_t kCacheMagic   = 0x43494247;  // 'GBIC'
+constexpr std::uint32_t kCacheVersion = 1;
+
+struct CacheHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t entryCount;
+    std::uint32_t pixelCount;
+};
+static_assert(sizeof(CacheHeader) == 16, "icon cache header layout changed");
+
+constexpr std::uint32_t kSmallSizes[] = { 16 };
+constexpr std::uint32_t kLargeSizes[] = { 24, 32 };
+constexpr std::uint32_t kSmallIconPx  = IconDiskCache::RasterPx(true);
+constexpr std::uint32_t kLargeIconPx  = IconDiskCache::RasterPx(false);
+
+// Rasters a rewrite keeps besides the ones this run used; ~1000 large
+// icons, about 6.5 MB.
+constexpr size_t kMaxEntries = 2048;
+
+enum EntryState : std::uint8_t { EntryUnused, EntryUsed, EntryStale };
+
+std::uint64_t FileTimeToU64(const FILETIME& ft) {
+    return (static_cast<std::uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+}
+
+/// FNV-1a over the case-folded UTF-16 code units.
+std::uint64_t PathKey(const std::wstring& path) {
+    std::uint64_t h = 0xCBF29CE484222325ull;
+    for (wchar_t c : path) {
+        h ^= static_cast<std::uint16_t>(FoldNameChar(c));
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+
+/// What the icon of |path| depends on; 0 when the path is not a file system
+/// object (shell: URLs, CLSIDs), which are never cached.
+std::uint64_t ReadStamp(const std::wstring& path) {
+    WIN32_FILE_ATTRIBUTE_DATA fad = {};
+    if (path.empty() || !GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &fad))
+        return 0;
+    // A folder's LastWriteTime moves with every child; its icon does not.
+    if (fad.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        return FileTimeToU64(fad.ftCreationTime);
+    const std::uint64_t size = (static_cast<std::uint64_t>(fad.nFileSizeHigh) << 32) | fad.nFileSizeLow;
+    return FileTimeToU64(fad.ftLastWriteTime) ^ (size * 0x9E3779B97F4A7C15ull);
+}
+
+BITMAPINFO TopDownDib(int px) {
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize        = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth       = px;
+    bmi.bmiHeader.biHeight      = -px;
+    bmi.bmiHeader.biPlanes      = 1;
+    bmi.bmiHeader.biBitCount    = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+    return bmi;
+}
+
+} // namespace
+
+// Drawn once over black and once over white: over black the result is the
+// premultiplied colour; how far white shows through is the transparency.
+// Works alike for alpha icons and old AND-mask ones.
+bool RasterizeIcon(HICON icon, int px, std::uint32_t* out) {
+    HDC dc = CreateCompatibleDC(nullptr);
+    if (!dc) return false;
+    const BITMAPINFO bmi = TopDownDib(px);
+    const size_t count = static_cast<size_t>(px) * px;
+    HBITMAP bmp[2]  = {};
+    void*   bits[2] = {};
+    bool ok = true;
+    for (int pass = 0; pass < 2 && ok; ++pass) {
+        bmp[pass] = CreateDIBSection(dc, &bmi, DIB_RGB_COLORS, &bits[pass], nullptr, 0);
+        ok = bmp[pass] && bits[pass];
+        if (!ok) break;
+        std::memset(bits[pass], pass ? 0xFF : 0x00, count * 4);
+        HGDIOBJ old = SelectObject(dc, bmp[pass]);
+        ok = DrawIconEx(dc, 0, 0, icon, px, px, 0, nullptr, DI_NORMAL) != FALSE;
+        SelectObject(dc, old);
+    }
+    GdiFlush();
+
+    if (ok) {
+        const auto* black = static_cast<const std::uint32_t*>(bits[0]);
+        const auto* white = static_cast<const std::uint32_t*>(bits[1]);
+        for (size_t i = 0; i < count; ++i) {
+            int showThrough = 0;
+            for (int shift = 0; shift < 24; shift += 8) {
+                const int w = static_cast<int>((white[i] >> shift) & 0xFF);
+                const int b = static_cast<int>((black[i] >> shift) & 0xFF);
+                showThrough = (std::max)(showThrough, w - b);
+            }
+            const std::uint32_t alpha = 255u - static_cast<std::uint32_t>(showThrough);
+            std::uint32_t pixel = alpha << 24;
+            for (int shift = 0; shift < 24; shift += 8)
+                pixel |= (std::min)((black[i] >> shift) & 0xFFu, alpha) << shift;
+            out[i] = pixel;
+        }
+    }
+    for (HBITMAP b : bmp)
+        if (b) DeleteObject(b);
+    DeleteDC(dc);
+    return ok;
+}
+
+std::uint64_t RasterHash(const std::uint32_t* pixels, size_t count) {
+    // FNV-1a over whole pixels, seeded with the count so sizes never meet.
+    std::uint64_t h = 0xCBF29CE484222325ull ^ count;
+    for (size_t i = 0; i < count; ++i) {
+        h ^= pixels[i];
+        h *= 0x100000001B3ull;
+    }
+    return h ? h : 1;
+}
+
+namespace {
+
+/// An icon from a premultiplied raster. Icon colour bitmaps carry straight
+/// alpha, so the colour is divided back out; the AND mask marks alpha 0.
+HICON IconFromRaster(const std::uint32_t* pixels, int px) {
+    const BITMAPINFO bmi = TopDownDib(px);
+    void* bits = nullptr;
+    HBITMAP color = CreateDIBSection(nullptr, &bmi, DIB_RGB_COLORS, &bits, nullptr, 0);
+    if (!color || !bits) {
+        if (color) DeleteObject(color);
+        return nullptr;
+    }
+
+    const int maskStride = ((px + 15) / 16) * 2;   // monochrome rows are WORD-aligned
+    std::vector<std::uint8_t> maskBits(static_cast<size_t>(maskStride) * px, 0);
+    auto* dst = static_cast<std::uint32_t*>(bits);
+    for (int y = 0; y < px; ++y) {
+        for (int x = 0; x < px; ++x) {
+            const std::uint32_t p     = pixels[y * px + x];
+            const std::uint32_t alpha = p >> 24;
+            std::uint32_t straight = 0;
+            if (alpha == 255) {
+                straight = p;
+            } else if (alpha != 0) {
+                straight = alpha << 24;
+                for (int shift = 0; shift < 24; shift += 8) {
+                    const std::uint32_t c = ((p >> shift) & 0xFFu) * 255u + alpha / 2;
+                    straight |= (std::min)(c / alpha, 255u) << shift;
+                }
+            } else {
+                maskBits[y * maskStride + x / 8] |= static_cast<std::uint8_t>(0x80 >> (x % 8));
+            }
+            dst[y * px + x] = straight;
+        }
+    }
+
+    HBITMAP mask = CreateBitmap(px, px, 1, 1, maskBits.data());
+    HICON icon = nullptr;
+    if (mask) {
+        ICONINFO ii = {};
+        ii.fIcon    = TRUE;
+        ii.hbmMask  = mask;
+        ii.hbmColor = color;
+        icon = CreateIconIndirect(&ii);
+        DeleteObject(mask);
+    }
+    DeleteObject(color);
+    return icon;
+}
+
+} // namespace
+
+// ── Mapping ───────────────────────────────────────────────────────────────────
+
+std::wstring IconDiskCache::DefaultPath() {
+    PWSTR lap = nullptr;
+    std::wstring path;
+    if (SUCCEEDED(SHGetKnownFolderPath(FOLDERID_LocalAppData, KF_FLAG_DEFAULT, nullptr, &lap)) && lap)
+        path = std::wstring(lap) + L"\\GlassBar\\icons.bin";
+    if (lap) CoTaskMemFree(lap);
+    return path;
+}
+
+bool IconDiskCache::Open(const std::wstring& path) {
+    static_assert(sizeof(Entry) == 24, "icon cache entry layout changed");
+    Close();
+    m_path = path;
+    if (path.empty()) return false;
+
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size = {};
+    if (!GetFileSizeEx(file, &size) ||
+        size.QuadPart < static_cast<LONGLONG>(sizeof(CacheHeader)) ||
+        size.QuadPart > 0x7FFFFFFF) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) return false;
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view) return false;
+
+    const auto* bytes = static_cast<const std::uint8_t*>(view);
+    const auto* hdr   = reinterpret_cast<const CacheHeader*>(bytes);
+    const std::uint64_t expected =
+        sizeof(CacheHeader) +
+        static_cast<std::uint64_t>(hdr->entryCount) * sizeof(Entry) +
+        static_cast<std::uint64_t>(hdr->pixelCount) * sizeof(std::uint32_t);
+    bool ok = hdr->magic   == kCacheMagic   &&
+              hdr->version == kCacheVersion &&
+              expected == static_cast<std::uint64_t>(size.QuadPart);
+
+    const auto* entries = reinterpret_cast<const Entry*>(bytes + sizeof(CacheHeader));
+    for (std::uint32_t i = 0; ok && i < hdr->entryCount; ++i) {
+        const Entry& e = entries[i];
+        ok = (e.sizePx == 16 || e.sizePx == 24 || e.sizePx == 32) &&
+             static_cast<std::uint64_t>(e.pixelOffset) + e.sizePx * e.sizePx <= hdr->pixelCount &&
+             (i == 0 || entries[i - 1] < e);
+    }
+    if (!ok) {
+        CF_LOG(Warning, "IconDiskCache: " << size.QuadPart << "-byte file unusable, starting over");
+        UnmapViewOfFile(view);
+        return false;
+    }
+
+    m_view       = view;
+    m_entries    = entries;
+    m_entryCount = hdr->entryCount;
+    m_pixels     = reinterpret_cast<const std::uint32_t*>(entries + hdr->entryCount);
+    m_state.assign(m_entryCount, EntryUnused);
+    CF_LOG(Info, "IconDiskCache: " << m_entryCount << " rasters mapped");
+    return true;
+}
+
+void IconDiskCache::Close() {
+    if (m_view) UnmapViewOfFile(m_view);
+    m_view       = nullptr;
+    m_entries    = nullptr;
+    m_pixels     = nullptr;
+    m_entryCount = 0;
+    m_state.clear();
+    m_pending.clear();
+    m_pendingIndex.clear();
+}
+
+// ── Lookup and store ──────────────────────────────────────────────────────────
+
+bool IconDiskCache::FindRaster(const std::wstring& path, bool smallIcon, Raster& out) {
+    if (!m_entryCount) {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        if (m_pending.empty()) return false;
+    }
+    const std::uint64_t  key   = PathKey(path);
+    const std::uint64_t  stamp = ReadStamp(path);
+    const std::uint32_t  want  = smallIcon ? kSmallIconPx : kLargeIconPx;
+    const std::uint32_t* hit   = nullptr;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        // Rasterized this run and not saved yet: an icon the shell loaded
+        // and IconCache has since evicted.
+        auto p = m_pendingIndex.find(PendingSlot(key, want));
+        if (p != m_pendingIndex.end()) {
+            const Pending& pending = m_pending[p->second];
+            if (pending.key == key && pending.sizePx == want && stamp != 0 && pending.stamp == stamp)
+                hit = pending.pixels.data();
+        }
+
+        const Entry* end   = m_entries + m_entryCount;
+        const Entry* first = std::lower_bound(m_entries, end, key,
+                                              [](const Entry& e, std::uint64_t k) { return e.key < k; });
+        for (const Entry* e = first; e != end && e->key == key; ++e) {
+            std::uint8_t& state = m_state[static_cast<size_t>(e - m_entries)];
+            if (stamp == 0 || e->stamp != stamp) {
+                state = EntryStale;
+                continue;
+            }
+            if ((e->sizePx == kSmallIconPx) == smallIcon) state = EntryUsed;
+            if (e->sizePx == want && !hit) hit = m_pixels + e->pixelOffset;
+        }
+    }
+    // Pending pixel buffers stay put when m_pending grows; Save() and Close()
+    // never run alongside.
+    if (!hit) return false;
+    out.pixels = hit;
+    out.px     = want;
+    out.hash   = RasterHash(hit, static_cast<size_t>(want) * want);
+    return true;
+}
+
+HICON IconDiskCache::CreateIcon(const Raster& raster) {
+    return raster.pixels ? IconFromRaster(raster.pixels, static_cast<int>(raster.px)) : nullptr;
+}
+
+void IconDiskCache::Store(const std::wstring& path, bool smallIcon, HICON icon,
+                          const std::uint32_t* raster) {
+    const std::uint64_t stamp = icon ? ReadStamp(path) : 0;
+    if (!stamp) return;
+    const std::uint64_t key = PathKey(path);
+    const std::uint32_t* sizes = smallIcon ? kSmallSizes : kLargeSizes;
+    const size_t count = smallIcon ? std::size(kSmallSizes) : std::size(kLargeSizes);
+    Pending rasters[std::size(kLargeSizes)];
+    for (size_t i = 0; i < count; ++i) {
+        const std::uint32_t px = sizes[i];
+        if (raster && px == (smallIcon ? kSmallIconPx : kLargeIconPx)) {
+            rasters[i] = { key, stamp, px, std::vector<std::uint32_t>(raster, raster + px * px) };
+            continue;
+        }
+        rasters[i] = { key, stamp, px, std::vector<std::uint32_t>(px * px) };
+        if (!RasterizeIcon(icon, static_cast<int>(px), rasters[i].pixels.data())) return;
+    }
+    std::lock_guard<std::mutex> lk(m_mutex);
+    for (size_t i = 0; i < count; ++i) {
+        m_pendingIndex[PendingSlot(key, sizes[i])] = m_pending.size();
+        m_pending.push_back(std::move(rasters[i]));
+    }
+}
+
+// ── Rewrite ───────────────────────────────────────────────────────────────────
+
+bool IconDiskCache::Save() {
+    if (m_pending.empty()) return true;
+    if (m_path.empty()) {
+        m_pending.clear();
+        m_pendingIndex.clear();
+        return false;
+    }
+
+    struct Out {
+        Entry                entry;
+        const std::uint32_t* pixels;
+        bool                 used;     // this run loaded or read it
+    };
+    std::vector<Out> out;
+    out.reserve(m_pending.size() + m_entryCount);
+
+    // New rasters; a later Store() of the same path and size wins.
+    for (auto it = m_pending.rbegin(); it != m_pending.rend(); ++it)
+        out.push_back({ { it->key, it->stamp, 0, it->sizePx }, it->pixels.data(), true });
+    std::stable_sort(out.begin(), out.end(), [](const Out& a, const Out& b) { return a.entry < b.entry; });
+    out.erase(std::unique(out.begin(), out.end(), [](const Out& a, const Out& b) {
+                  return a.entry.key == b.entry.key && a.entry.sizePx == b.entry.sizePx; }),
+              out.end());
+    const size_t fresh = out.size();
+
+    // Mapped rasters not replaced above: all the ones this run used (IconCache
+    // rebuilds evicted icons from them), then the rest up to the budget.
+    auto replaced = [&](const Entry& e) {
+        return std::binary_search(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(fresh),
+                                  Out{ e, nullptr, false },
+                                  [](const Out& a, const Out& b) { return a.entry < b.entry; });
+    };
+    for (std::uint8_t keep : { EntryUsed, EntryUnused }) {
+        for (std::uint32_t i = 0; i < m_entryCount; ++i) {
+            if (keep == EntryUnused && out.size() >= kMaxEntries) break;
+            if (m_state[i] == keep && !replaced(m_entries[i]))
+                out.push_back({ m_entries[i], m_pixels + m_entries[i].pixelOffset, keep == EntryUsed });
+        }
+    }
+    std::sort(out.begin(), out.end(), [](const Out& a, const Out& b) { return a.entry < b.entry; });
+
+    CacheHeader hdr = { kCacheMagic, kCacheVersion, static_cast<std::uint32_t>(out.size()), 0 };
+    std::vector<Entry> entries;
+    entries.reserve(out.size());
+    for (Out& o : out) {
+        o.entry.pixelOffset = hdr.pixelCount;
+        hdr.pixelCount += o.entry.sizePx * o.entry.sizePx;
+        entries.push_back(o.entry);
+    }
+
+    const std::wstring dir = m_path.substr(0, m_path.find_last_of(L'\\'));
+    CreateDirectoryW(dir.c_str(), NULL);
+
+    const std::wstring tmp = m_path + L".tmp";
+    HANDLE file = CreateFileW(tmp.c_str(), GENERIC_WRITE, 0, nullptr,
+                              CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        CF_LOG(Warning, "IconDiskCache: cannot create temp file, error=" << GetLastError());
+        m_pending.clear();
+        m_pendingIndex.clear();
+        return false;
+    }
+    auto writeAll = [file](const void* data, size_t len) {
+        DWORD written = 0;
+        return WriteFile(file, data, static_cast<DWORD>(len), &written, nullptr) &&
+               written == len;
+    };
+    bool ok = writeAll(&hdr, sizeof(hdr)) &&
+              writeAll(entries.data(), entries.size() * sizeof(Entry));
+    for (size_t i = 0; ok && i < out.size(); ++i)
+        ok = writeAll(out[i].pixels, out[i].entry.sizePx * out[i].entry.sizePx * sizeof(std::uint32_t));
+    CloseHandle(file);
+
+    // The old file stays mapped until its rasters have been copied out.
+    const std::wstring path = m_path;
+    Close();
+    if (ok)
+        ok = MoveFileExW(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != FALSE;
+    if (!ok) {
+        CF_LOG(Warning, "IconDiskCache: write failed, error=" << GetLastError());
+        DeleteFileW(tmp.c_str());
+    } else {
+        CF_LOG(Info, "IconDiskCache: saved " << out.size() << " rasters (" << fresh << " new)");
+    }
+    // Still used once remapped, so the next Save() keeps them too.
+    if (Open(path) && ok && m_entryCount == out.size())
+        for (size_t i = 0; i < out.size(); ++i)
+            if (out[i].used) m_state[i] = EntryUsed;
+    return ok;
+}
+
+} // namespace GlassBar
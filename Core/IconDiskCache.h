@@ -0,0 +1,124 @@
+#pragma once
+#include <Windows.h>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace GlassBar {
+
+/// <summary>
+/// Shell icons pre-rasterized to premultiplied BGRA and kept across runs in
+/// %LOCALAPPDATA%\GlassBar\icons.bin, so a start paints real icons before the
+/// shell has been asked about anything.
+///
+/// Rasters are keyed by the case-folded path, a stamp of the file behind it
+/// (LastWriteTime and size; CreationTime for folders) and the pixel size.
+/// Small icons are kept at 16 px, large ones at 24 px (the list size) and
+/// 32 px. A file whose stamp moved no longer matches and goes back to the
+/// shell; only those are rasterized again.
+///
+/// File layout (little-endian, versioned):
+///   Header  { magic 'GBIC', version, entryCount, pixelCount }
+///   Entry[entryCount]  { key, stamp, pixel offset, size }, sorted by (key, size)
+///   uint32_t[pixelCount]  0xAARRGGBB premultiplied, rows top-down
+///
+/// FindRaster(), CreateIcon() and Store() may run on several icon workers at
+/// once (the GDI work is done outside the lock); Open(), Close() and Save()
+/// only while none of them runs — the UI thread before an icon pass starts,
+/// or the worker that finishes one.
+/// </summary>
+class IconDiskCache {
+public:
+    IconDiskCache() = default;
+    IconDiskCache(const IconDiskCache&) = delete;
+    IconDiskCache& operator=(const IconDiskCache&) = delete;
+    ~IconDiskCache() { Close(); }
+
+    /// %LOCALAPPDATA%\GlassBar\icons.bin, or empty if LocalAppData cannot be resolved.
+    static std::wstring DefaultPath();
+
+    /// Size of the raster a small / large HICON is built from (and hashed at).
+    static constexpr std::uint32_t RasterPx(bool smallIcon) { return smallIcon ? 16 : 32; }
+
+    /// <summary>
+    /// Map the cache file at |path|. A missing, truncated or other-version file
+    /// leaves the cache empty and returns false; Save() still writes to |path|.
+    /// </summary>
+    bool Open(const std::wstring& path);
+
+    /// Unmap the file and drop rasters not saved yet.
+    void Close();
+
+    /// A cached raster: RasterPx² premultiplied pixels, valid until the next
+    /// Save() or Close(), and their RasterHash().
+    struct Raster {
+        const std::uint32_t* pixels = nullptr;
+        std::uint32_t        px     = 0;
+        std::uint64_t        hash   = 0;
+    };
+
+    /// <summary>
+    /// The raster |path|'s icon is kept as (RasterPx) — mapped, or stored
+    /// this run and not saved yet. False when there is none or the file
+    /// changed since.
+    /// </summary>
+    bool FindRaster(const std::wstring& path, bool smallIcon, Raster& out);
+
+    /// An icon built from |raster| (FindRaster), or nullptr. The caller owns it.
+    static HICON CreateIcon(const Raster& raster);
+
+    /// True when no file is mapped or it holds no rasters.
+    bool Empty() const { return m_entryCount == 0; }
+
+    /// Rasterize |icon|, just loaded by the shell for |path|, for the next
+    /// Save(). |raster|, if given, is the icon already rasterized at RasterPx.
+    void Store(const std::wstring& path, bool smallIcon, HICON icon,
+               const std::uint32_t* raster = nullptr);
+
+    /// <summary>
+    /// Rewrite the file when Store() added rasters since Open(): those, every
+    /// mapped one this run used, then other current ones up to a fixed budget.
+    /// Writes a temporary file, renames it over the old one and maps it.
+    /// Returns true when nothing needed writing.
+    /// </summary>
+    bool Save();
+
+private:
+    struct Entry;   // on-disk record, see IconDiskCache.cpp
+
+    struct Pending {
+        std::uint64_t              key;
+        std::uint64_t              stamp;
+        std::uint32_t              sizePx;
+        std::vector<std::uint32_t> pixels;
+    };
+
+    static std::uint64_t PendingSlot(std::uint64_t key, std::uint32_t sizePx) {
+        return key ^ (static_cast<std::uint64_t>(sizePx) * 0x9E3779B97F4A7C15ull);
+    }
+
+    std::wstring              m_path;
+    const void*               m_view       = nullptr;
+    const Entry*              m_entries    = nullptr;
+    const std::uint32_t*      m_pixels     = nullptr;
+    std::uint32_t             m_entryCount = 0;
+    std::mutex                m_mutex;                   // m_state, m_pending*
+    std::vector<std::uint8_t> m_state;                   // per mapped entry: unused / used / stale
+    std::vector<Pending>      m_pending;
+    std::unordered_map<std::uint64_t, size_t> m_pendingIndex;   // PendingSlot() → latest in m_pending
+};
+
+/// <summary>
+/// Rasterize |icon| at |px|×|px| into |out| as premultiplied 0xAARRGGBB,
+/// rows top-down (the cache's pixel format). False if GDI failed.
+/// </summary>
+bool RasterizeIcon(HICON icon, int px, std::uint32_t* out);
+
+/// 64-bit hash of |count| raster pixels (never 0): equal hashes of rasters
+/// of one size are taken to be the same image.
+std::uint64_t RasterHash(const std::uint32_t* pixels, size_t count);
+
+} // namespace GlassBar
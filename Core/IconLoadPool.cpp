@@ -0,0 +1,102 @@
+#include "IconLoadPool.h"
+
+#include <algorithm>
+
+namespace GlassBar {
+
+unsigned IconLoadPool::DefaultWorkers() {
+    return std::clamp(std::thread::hardware_concurrency() / 2, 2u, 4u);
+}
+
+void IconLoadPool::Start(unsigned workers, ThreadHook threadStart, ThreadHook threadStop) {
+    if (!m_threads.empty()) return;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_stopping = false;
+    }
+    workers = (std::max)(workers, 1u);
+    m_workerCount = workers;
+    m_threads.reserve(workers);
+    for (unsigned i = 0; i < workers; ++i)
+        m_threads.emplace_back([this, threadStart, threadStop]() {
+            WorkerMain(threadStart, threadStop);
+        });
+}
+
+void IconLoadPool::Stop() {
+    if (m_threads.empty()) return;
+    Cancel();
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (auto& t : m_threads) t.join();
+    m_threads.clear();
+}
+
+std::uint64_t IconLoadPool::Begin(NextFn next, LoadFn load, DoneFn done) {
+    Cancel();
+    auto pass = std::make_shared<Pass>();
+    pass->next    = std::move(next);
+    pass->load    = std::move(load);
+    pass->done    = std::move(done);
+    pass->started = std::chrono::steady_clock::now();
+    std::uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        generation = pass->generation = m_generation.load(std::memory_order_relaxed);
+        m_pass = std::move(pass);
+    }
+    m_wake.notify_all();
+    return generation;
+}
+
+void IconLoadPool::Cancel() {
+    std::unique_lock<std::mutex> lk(m_mutex);
+    m_generation.fetch_add(1, std::memory_order_acq_rel);
+    m_pass.reset();
+    m_idle.wait(lk, [this]() { return m_active == 0; });
+}
+
+void IconLoadPool::WorkerMain(const ThreadHook& threadStart, const ThreadHook& threadStop) {
+    if (threadStart) threadStart();
+    std::unique_lock<std::mutex> lk(m_mutex);
+    for (;;) {
+        m_wake.wait(lk, [this]() { return m_stopping || (m_pass && !m_pass->drained); });
+        if (m_stopping) break;
+
+        const std::shared_ptr<Pass> pass = m_pass;
+        ++pass->running;
+        ++m_active;
+        lk.unlock();
+
+        bool more = true;
+        std::uint32_t id = 0;
+        while (Current(pass->generation) && (more = pass->next(id))) {
+            pass->load(id);
+            pass->loads.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        lk.lock();
+        if (!more) pass->drained = true;
+        if (--pass->running == 0 && pass->drained && pass == m_pass) {
+            // The last load of a pass nobody cancelled: report it.  Still
+            // counted in m_active, so Cancel() waits for |done| too.
+            m_pass.reset();
+            lk.unlock();
+            PassStats stats;
+            stats.loads   = pass->loads.load(std::memory_order_relaxed);
+            stats.workers = m_workerCount;
+            stats.seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - pass->started).count();
+            if (pass->done) pass->done(stats);
+            lk.lock();
+        }
+        if (--m_active == 0) m_idle.notify_all();
+    }
+    lk.unlock();
+    if (threadStop) threadStop();
+}
+
+} // namespace GlassBar
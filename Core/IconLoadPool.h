@@ -0,0 +1,105 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace GlassBar {
+
+/// <summary>
+/// A small fixed set of worker threads that load icons in parallel.
+///
+/// Work comes in passes. Begin() hands the pool |next|, which yields the
+/// ids to load, and |load|, which loads one. Every worker pulls from the
+/// pass until |next| runs dry, and the worker finishing the last load then
+/// calls |done| with the pass's timing.
+///
+/// Each pass has a generation. Cancel() (and Begin() over a running pass)
+/// moves to a new generation. Workers stop pulling at once, and Cancel()
+/// returns as soon as the loads already in flight have returned, so a
+/// refresh or shutdown waits for at most one load per worker rather than
+/// the rest of the pass. |done| is not called for a cancelled pass.
+///
+/// |next| and |load| run on the workers, several at a time, with no pool
+/// lock held; they must not wait on the thread that calls Cancel().
+/// Start, Stop, Begin and Cancel belong to one controlling thread (the UI
+/// thread).
+/// </summary>
+class IconLoadPool {
+public:
+    struct PassStats {
+        std::size_t loads   = 0;
+        unsigned    workers = 0;
+        double      seconds = 0.0;   // Begin() until the last load returned
+    };
+
+    using NextFn     = std::function<bool(std::uint32_t& id)>;
+    using LoadFn     = std::function<void(std::uint32_t id)>;
+    using DoneFn     = std::function<void(const PassStats& stats)>;
+    using ThreadHook = std::function<void()>;
+
+    IconLoadPool() = default;
+    IconLoadPool(const IconLoadPool&) = delete;
+    IconLoadPool& operator=(const IconLoadPool&) = delete;
+    ~IconLoadPool() { Stop(); }
+
+    /// Half the hardware threads, 2 to 4: icon loads mostly wait on the disk
+    /// and the shell, and more threads only contend for the same locks.
+    static unsigned DefaultWorkers();
+
+    /// <summary>
+    /// Start |workers| threads (at least one). Each calls |threadStart| before
+    /// its first load and |threadStop| when it exits (COM setup on Windows).
+    /// No-op if already started.
+    /// </summary>
+    void Start(unsigned workers, ThreadHook threadStart = {}, ThreadHook threadStop = {});
+
+    /// Cancel the pass and join every worker.
+    void Stop();
+
+    /// Cancel any running pass and start a new one (after Start()); returns
+    /// its generation.
+    std::uint64_t Begin(NextFn next, LoadFn load, DoneFn done);
+
+    /// Abandon the running pass, if any, once its in-flight loads return.
+    void Cancel();
+
+    /// True while |generation| is the latest pass, i.e. not cancelled.
+    bool Current(std::uint64_t generation) const {
+        return m_generation.load(std::memory_order_acquire) == generation;
+    }
+
+    unsigned Workers() const { return m_workerCount; }
+
+private:
+    struct Pass {
+        NextFn                                next;
+        LoadFn                                load;
+        DoneFn                                done;
+        std::uint64_t                         generation = 0;
+        std::chrono::steady_clock::time_point started;
+        std::atomic<std::size_t>              loads{0};
+        unsigned                              running = 0;       // workers inside it
+        bool                                  drained = false;   // |next| ran dry
+    };
+
+    void WorkerMain(const ThreadHook& threadStart, const ThreadHook& threadStop);
+
+    std::vector<std::thread>   m_threads;
+    unsigned                   m_workerCount = 0;
+    std::mutex                 m_mutex;
+    std::condition_variable    m_wake;   // a pass to work on, or stopping
+    std::condition_variable    m_idle;   // m_active dropped
+    std::shared_ptr<Pass>      m_pass;   // the pass taking work, or null
+    unsigned                   m_active   = 0;   // workers inside any pass
+    bool                       m_stopping = false;
+    std::atomic<std::uint64_t> m_generation{0};
+};
+
+} // namespace GlassBar
@@ -0,0 +1,59 @@
+#include "IconLoadQueue.h"
+
+#include <algorithm>
+
+namespace GlassBar {
+
+bool IconLoadQueue::LoadsLater(const Record& a, const Record& b) {
+    if (a.tier != b.tier)   return a.tier > b.tier;
+    if (a.batch != b.batch) return a.batch < b.batch;
+    return a.seq > b.seq;
+}
+
+void IconLoadQueue::PushRecord(std::uint32_t id, Rank rank) {
+    m_heap.push_back({ rank.tier, rank.batch, m_seq++, id });
+    std::push_heap(m_heap.begin(), m_heap.end(), LoadsLater);
+}
+
+void IconLoadQueue::Push(std::uint32_t id, IconTier tier) {
+    const Rank rank{ tier, m_batch };
+    auto [it, added] = m_pending.emplace(id, rank);
+    if (added)
+        PushRecord(id, rank);
+    else
+        Raise(id, tier);
+}
+
+bool IconLoadQueue::Raise(std::uint32_t id, IconTier tier) {
+    auto it = m_pending.find(id);
+    if (it == m_pending.end()) return false;
+    Rank& live = it->second;
+    if (live.tier < tier || (live.tier == tier && live.batch == m_batch)) return false;
+    live = { tier, m_batch };
+    PushRecord(id, live);
+    return true;
+}
+
+bool IconLoadQueue::Pop(std::uint32_t& id) {
+    while (!m_heap.empty()) {
+        std::pop_heap(m_heap.begin(), m_heap.end(), LoadsLater);
+        const Record top = m_heap.back();
+        m_heap.pop_back();
+        // Skip records superseded by a Raise() or already taken.
+        auto it = m_pending.find(top.id);
+        if (it == m_pending.end() ||
+            it->second.tier != top.tier || it->second.batch != top.batch)
+            continue;
+        m_pending.erase(it);
+        id = top.id;
+        return true;
+    }
+    return false;
+}
+
+void IconLoadQueue::Clear() {
+    m_heap.clear();
+    m_pending.clear();
+}
+
+} // namespace GlassBar
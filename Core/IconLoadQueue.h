@@ -0,0 +1,75 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace GlassBar {
+
+/// How visible the slot an icon is loaded for is; lower loads first.
+enum class IconTier : std::uint8_t {
+    Pinned,          // left column, always on screen
+    RightColumn,     // right column links
+    CurrentLevel,    // the All Programs level being shown
+    HoveredFolder,   // children of the folder under the mouse / in the submenu
+    Background,      // everything else in the tree
+};
+
+/// <summary>
+/// Pending icon loads, most visible first. Ids are the caller's (opaque, one
+/// per slot). Within a tier, ids raised by a later batch (BeginBatch) come
+/// before older ones — the level just opened before the one left behind —
+/// and ids of one batch come out in the order they were pushed.
+///
+/// A binary heap with lazy deletion: raising an id pushes a new heap record
+/// and leaves the old one to be skipped by Pop(), so every operation is
+/// O(log n). Not thread-safe; StartMenuWindow guards it with a mutex shared
+/// by the UI thread (Push / Raise) and the icon thread (Pop).
+/// </summary>
+class IconLoadQueue {
+public:
+    /// Start a batch that outranks every earlier one within a tier.
+    void BeginBatch() { ++m_batch; }
+
+    /// Queue |id| at |tier|; an id already pending is raised as by Raise().
+    void Push(std::uint32_t id, IconTier tier);
+
+    /// <summary>
+    /// Move a pending |id| to |tier| in the current batch, unless it already
+    /// sits in a better tier. Ids not pending (loaded, or never queued) are
+    /// left alone. Returns true if it moved.
+    /// </summary>
+    bool Raise(std::uint32_t id, IconTier tier);
+
+    /// Take the most visible pending id; false when none is left.
+    bool Pop(std::uint32_t& id);
+
+    size_t Pending() const { return m_pending.size(); }
+    void   Clear();
+
+private:
+    struct Rank {
+        IconTier      tier;
+        std::uint32_t batch;
+    };
+
+    struct Record {
+        IconTier      tier;
+        std::uint32_t batch;
+        std::uint64_t seq;
+        std::uint32_t id;
+    };
+
+    // Heap order: std::push_heap keeps the "largest" on top, so a record is
+    // smaller when it should load later.
+    static bool LoadsLater(const Record& a, const Record& b);
+
+    void PushRecord(std::uint32_t id, Rank rank);
+
+    std::vector<Record>                     m_heap;
+    std::unordered_map<std::uint32_t, Rank> m_pending;   // live rank per id
+    std::uint32_t                           m_batch = 0;
+    std::uint64_t                           m_seq   = 0;
+};
+
+} // namespace GlassBar
@@ -0,0 +1,315 @@
+#include "MenuTree.h"
+
+#include <algorithm>
+#include <cwchar>
+#include <unordered_map>
+
+namespace GlassBar {
+
+// ── Assign ────────────────────────────────────────────────────────────────────
+
+void MenuTree::Assign(const std::vector<MenuNode>& nodes) {
+    Clear();
+
+    // Pass 1: count nodes and an upper bound on pool size so nothing below
+    // reallocates mid-build.
+    size_t nodeCount = 0, charBound = 1;
+    {
+        std::vector<const std::vector<MenuNode>*> stack{ &nodes };
+        while (!stack.empty()) {
+            const auto* level = stack.back();
+            stack.pop_back();
+            for (const MenuNode& n : *level) {
+                ++nodeCount;
+                charBound += n.name.size() + n.target.size() + n.args.size() +
+                             n.folderPath.size() + n.lnkPath.size() + 5;
+                if (!n.children.empty()) stack.push_back(&n.children);
+            }
+        }
+    }
+
+    for (auto* v : { &m_name, &m_target, &m_args, &m_folderPath, &m_lnkPath,
+                     &m_firstChild, &m_childCount, &m_parent })
+        v->reserve(nodeCount);
+    m_sortKey.reserve(nodeCount);
+    m_flags.reserve(nodeCount);
+    m_icons.reserve(nodeCount);
+    m_chars.reserve(charBound);
+
+    // Interning index: keys view the source strings, which outlive this call.
+    std::unordered_map<std::wstring_view, uint32_t> interned;
+    interned.reserve(nodeCount * 2);
+    m_chars.push_back(L'\0');
+    m_strOffset.push_back(0);
+    m_strLength.push_back(0);
+    interned.emplace(std::wstring_view(), 0);
+
+    auto intern = [&](std::wstring_view s) -> uint32_t {
+        auto it = interned.find(s);
+        if (it != interned.end()) return it->second;
+        const uint32_t id = AddString(s);
+        interned.emplace(s, id);
+        return id;
+    };
+
+    // Pass 2: breadth-first, so each folder's children form one index run.
+    AppendBreadthFirst(nodes, kNone, intern);
+    m_rootCount = static_cast<uint32_t>(nodes.size());
+}
+
+// ── AssignRecords ─────────────────────────────────────────────────────────────
+
+bool MenuTree::RecordsValid(const std::vector<MenuTreeRecord>& records, uint32_t rootCount) {
+    const size_t count = records.size();
+    if (count >= kNone || rootCount > count) return false;
+    size_t next = rootCount;   // where the next child run must start
+    for (size_t i = 0; i < count; ++i) {
+        const MenuTreeRecord& r = records[i];
+        if (r.childCount == 0) continue;
+        if (!r.isFolder || r.firstChild != next || r.firstChild <= i ||
+            r.childCount > count - next)
+            return false;
+        next += r.childCount;
+    }
+    return next == count;
+}
+
+void MenuTree::AssignRecords(const std::vector<MenuTreeRecord>& records, uint32_t rootCount) {
+    Clear();
+
+    const size_t nodeCount = records.size();
+    size_t charBound = 1;
+    for (const MenuTreeRecord& r : records)
+        charBound += r.name.size() + r.target.size() + r.args.size() +
+                     r.folderPath.size() + r.lnkPath.size() + 5;
+
+    for (auto* v : { &m_name, &m_target, &m_args, &m_folderPath, &m_lnkPath,
+                     &m_firstChild, &m_childCount })
+        v->reserve(nodeCount);
+    m_parent.assign(nodeCount, kNone);
+    m_sortKey.reserve(nodeCount);
+    m_flags.reserve(nodeCount);
+    m_icons.assign(nodeCount, nullptr);
+    m_chars.reserve(charBound);
+
+    // Keys view the caller's strings, as Assign()'s view the MenuNodes.
+    std::unordered_map<std::wstring_view, uint32_t> interned;
+    interned.reserve(nodeCount * 2);
+    m_chars.push_back(L'\0');
+    m_strOffset.push_back(0);
+    m_strLength.push_back(0);
+    interned.emplace(std::wstring_view(), 0);
+    auto intern = [&](std::wstring_view s) -> uint32_t {
+        auto it = interned.find(s);
+        if (it != interned.end()) return it->second;
+        const uint32_t id = AddString(s);
+        interned.emplace(s, id);
+        return id;
+    };
+
+    for (uint32_t i = 0; i < nodeCount; ++i) {
+        const MenuTreeRecord& r = records[i];
+        m_name.push_back(intern(r.name));
+        m_target.push_back(intern(r.target));
+        m_args.push_back(intern(r.args));
+        m_folderPath.push_back(intern(r.folderPath));
+        m_lnkPath.push_back(intern(r.lnkPath));
+        m_firstChild.push_back(r.childCount ? r.firstChild : 0);
+        m_childCount.push_back(r.childCount);
+        m_sortKey.push_back(MakeNameSortKey(r.name));
+        m_flags.push_back(static_cast<uint8_t>(
+            (r.isFolder ? kFlagFolder : 0) |
+            (r.isFolder && r.childrenPending ? kFlagPending : 0)));
+        for (uint32_t c = 0; c < r.childCount; ++c)
+            m_parent[r.firstChild + c] = i;
+    }
+    m_rootCount = rootCount;
+}
+
+template <typename InternFn>
+void MenuTree::AppendBreadthFirst(const std::vector<MenuNode>& level, uint32_t parent,
+                                  InternFn& intern) {
+    auto append = [&](const std::vector<MenuNode>& run, uint32_t runParent) {
+        for (const MenuNode& n : run) {
+            m_name.push_back(intern(n.name));
+            m_target.push_back(intern(n.target));
+            m_args.push_back(intern(n.args));
+            m_folderPath.push_back(intern(n.folderPath));
+            m_lnkPath.push_back(intern(n.lnkPath));
+            m_firstChild.push_back(0);
+            m_childCount.push_back(0);
+            m_parent.push_back(runParent);
+            m_sortKey.push_back(n.sortKey);
+            m_flags.push_back(static_cast<uint8_t>((n.isFolder ? kFlagFolder : 0) |
+                                                   (n.childrenPending ? kFlagPending : 0)));
+            m_icons.push_back(n.hIcon);
+        }
+    };
+
+    // |sources[k]| is the builder node for record base + k.
+    const uint32_t base = static_cast<uint32_t>(m_name.size());
+    std::vector<const MenuNode*> sources;
+    append(level, parent);
+    for (const MenuNode& n : level) sources.push_back(&n);
+
+    for (uint32_t k = 0; k < sources.size(); ++k) {
+        const uint32_t  i   = base + k;
+        const MenuNode& src = *sources[k];
+        m_firstChild[i] = static_cast<uint32_t>(m_name.size());
+        m_childCount[i] = static_cast<uint32_t>(src.children.size());
+        append(src.children, i);
+        for (const MenuNode& c : src.children) sources.push_back(&c);
+    }
+}
+
+// ── ExpandFolder ──────────────────────────────────────────────────────────────
+
+void MenuTree::ExpandFolder(uint32_t index, const std::vector<MenuNode>& children) {
+    // No interning index survives Assign(); a lazily opened folder adds a
+    // handful of strings, so they are simply appended.
+    auto addString = [this](std::wstring_view s) -> uint32_t {
+        return s.empty() ? 0 : AddString(s);
+    };
+
+    const uint32_t first = static_cast<uint32_t>(m_name.size());
+    AppendBreadthFirst(children, index, addString);
+    m_firstChild[index] = first;
+    m_childCount[index] = static_cast<uint32_t>(children.size());
+    m_flags[index] &= static_cast<uint8_t>(~kFlagPending);
+}
+
+uint32_t MenuTree::AddString(std::wstring_view s) {
+    const uint32_t id = static_cast<uint32_t>(m_strOffset.size());
+    m_strOffset.push_back(static_cast<uint32_t>(m_chars.size()));
+    m_strLength.push_back(static_cast<uint32_t>(s.size()));
+    m_chars.insert(m_chars.end(), s.begin(), s.end());
+    m_chars.push_back(L'\0');
+    return id;
+}
+
+void MenuTree::Clear() {
+    for (auto* v : { &m_name, &m_target, &m_args, &m_folderPath, &m_lnkPath,
+                     &m_firstChild, &m_childCount, &m_parent, &m_strOffset, &m_strLength })
+        v->clear();
+    m_sortKey.clear();
+    m_flags.clear();
+    m_icons.clear();
+    m_chars.clear();
+    m_rootCount = 0;
+}
+
+// ── Thaw ──────────────────────────────────────────────────────────────────────
+
+std::vector<MenuNode> MenuTree::Thaw() const {
+    std::vector<MenuNode> out;
+    ThawInto(0, m_rootCount, out);
+    return out;
+}
+
+void MenuTree::ThawInto(uint32_t first, uint32_t count, std::vector<MenuNode>& out) const {
+    out.resize(count);
+    for (uint32_t k = 0; k < count; ++k) {
+        const uint32_t i = first + k;
+        MenuNode& n  = out[k];
+        n.name       = String(m_name[i]);
+        n.sortKey    = m_sortKey[i];
+        n.isFolder   = (m_flags[i] & kFlagFolder) != 0;
+        n.childrenPending = (m_flags[i] & kFlagPending) != 0;
+        n.target     = String(m_target[i]);
+        n.args       = String(m_args[i]);
+        n.folderPath = String(m_folderPath[i]);
+        n.lnkPath    = String(m_lnkPath[i]);
+        n.hIcon      = m_icons[i];
+        if (m_childCount[i])
+            ThawInto(m_firstChild[i], m_childCount[i], n.children);
+    }
+}
+
+// ── Queries ───────────────────────────────────────────────────────────────────
+
+void MenuTree::ClearIcons() {
+    std::fill(m_icons.begin(), m_icons.end(), nullptr);
+    for (uint8_t& flags : m_flags)
+        flags &= static_cast<uint8_t>(~kFlagIconEvicted);
+}
+
+uint32_t MenuTree::FindShortcutByName(std::wstring_view name) const {
+    const uint64_t key = MakeNameSortKey(name);
+    // Explicit stack of (next, end) sibling ranges for a depth-first walk.
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+    stack.emplace_back(0, m_rootCount);
+    while (!stack.empty()) {
+        auto& top = stack.back();
+        if (top.first == top.second) { stack.pop_back(); continue; }
+        const uint32_t i = top.first++;
+        if (m_flags[i] & kFlagFolder) {
+            if (m_childCount[i])
+                stack.emplace_back(m_firstChild[i], m_firstChild[i] + m_childCount[i]);
+        } else if (m_sortKey[i] == key && m_strLength[m_name[i]] == name.size() &&
+                   CompareNodeNames(String(m_name[i]), name) == 0 &&
+                   m_strLength[m_lnkPath[i]] != 0) {
+            return i;
+        }
+    }
+    return kNone;
+}
+
+int MenuTree::FindNextByInitial(MenuNodeRange level, wchar_t ch, int after) const {
+    if (level.empty()) return -1;
+    const uint64_t lo = static_cast<uint64_t>(static_cast<uint16_t>(FoldNameChar(ch))) << 48;
+    const uint64_t hi = lo + (uint64_t{1} << 48);   // wraps to 0 for U+FFFF, see below
+
+    const auto begin   = m_flags.begin() + level.first();
+    const auto end     = begin + level.size();
+    const auto folders = std::partition_point(begin, end,
+                                              [](uint8_t f) { return (f & kFlagFolder) != 0; });
+
+    // Matching index span within each sorted run.
+    struct Span { size_t first, last; } spans[2];
+    const size_t runs[3] = { 0, static_cast<size_t>(folders - begin), level.size() };
+    for (int r = 0; r < 2; ++r) {
+        const auto keys = m_sortKey.begin() + level.first();
+        auto from = std::lower_bound(keys + runs[r], keys + runs[r + 1], lo);
+        auto to   = hi ? std::lower_bound(from, keys + runs[r + 1], hi) : keys + runs[r + 1];
+        spans[r] = { static_cast<size_t>(from - keys), static_cast<size_t>(to - keys) };
+    }
+
+    int firstMatch = -1;
+    for (const Span& sp : spans) {
+        if (sp.first == sp.last) continue;
+        if (firstMatch < 0) firstMatch = static_cast<int>(sp.first);
+        if (after < static_cast<int>(sp.last) - 1)
+            return (std::max)(after + 1, static_cast<int>(sp.first));
+    }
+    return firstMatch;
+}
+
+size_t MenuTree::MemoryBytes() const {
+    size_t bytes = 0;
+    for (auto* v : { &m_name, &m_target, &m_args, &m_folderPath, &m_lnkPath,
+                     &m_firstChild, &m_childCount, &m_parent, &m_strOffset, &m_strLength })
+        bytes += v->capacity() * sizeof(uint32_t);
+    bytes += m_sortKey.capacity() * sizeof(uint64_t);
+    bytes += m_flags.capacity() * sizeof(uint8_t);
+    bytes += m_icons.capacity() * sizeof(HICON);
+    bytes += m_chars.capacity() * sizeof(wchar_t);
+    return bytes;
+}
+
+size_t MenuTree::NestedLayoutBytes(const std::vector<MenuNode>& nodes) {
+    // std::wstring keeps short strings inline; longer ones own a heap block
+    // of capacity + 1 characters.
+    auto heapChars = [](const std::wstring& s) -> size_t {
+        const size_t inlineCap = std::wstring().capacity();
+        return s.capacity() > inlineCap ? (s.capacity() + 1) * sizeof(wchar_t) : 0;
+    };
+    size_t bytes = nodes.capacity() * sizeof(MenuNode);
+    for (const MenuNode& n : nodes) {
+        bytes += heapChars(n.name) + heapChars(n.target) + heapChars(n.args) +
+                 heapChars(n.folderPath) + heapChars(n.lnkPath);
+        bytes += NestedLayoutBytes(n.children);
+    }
+    return bytes;
+}
+
+} // namespace GlassBar
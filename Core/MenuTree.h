@@ -0,0 +1,241 @@
+#pragma once
+#include "ProgramTree.h"   // MenuNode, HICON
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace GlassBar {
+
+class MenuTree;
+class MenuNodeRange;
+
+/// <summary>
+/// Read-only view of one node in a MenuTree: the owning tree plus an index.
+/// Accessors mirror MenuNode's fields. String views point into the tree's
+/// interned pool and are always NUL-terminated, so data() may be passed to
+/// Win32 directly. A view is valid until the tree is reassigned or cleared.
+/// </summary>
+class MenuNodeView {
+public:
+    MenuNodeView() = default;
+    MenuNodeView(const MenuTree* tree, uint32_t index) : m_tree(tree), m_index(index) {}
+
+    std::wstring_view name()       const;
+    bool              isFolder()   const;
+    bool              childrenPending() const;   // lazy folder not expanded yet
+    std::wstring_view target()     const;
+    std::wstring_view args()       const;
+    std::wstring_view folderPath() const;
+    std::wstring_view lnkPath()    const;
+    HICON             hIcon()      const;
+    std::uint64_t     sortKey()    const;
+    MenuNodeRange     children()   const;
+
+    uint32_t index() const { return m_index; }
+
+private:
+    const MenuTree* m_tree  = nullptr;
+    uint32_t        m_index = 0;
+};
+
+/// <summary>
+/// Contiguous run of sibling nodes (a folder's children, or the top level).
+/// Indexable like the std::vector&lt;MenuNode&gt; it replaces.
+/// </summary>
+class MenuNodeRange {
+public:
+    class Iterator {
+    public:
+        Iterator(const MenuTree* tree, uint32_t index) : m_tree(tree), m_index(index) {}
+        MenuNodeView operator*() const { return MenuNodeView(m_tree, m_index); }
+        Iterator&    operator++()      { ++m_index; return *this; }
+        bool operator!=(const Iterator& o) const { return m_index != o.m_index; }
+        bool operator==(const Iterator& o) const { return m_index == o.m_index; }
+    private:
+        const MenuTree* m_tree;
+        uint32_t        m_index;
+    };
+
+    MenuNodeRange() = default;
+    MenuNodeRange(const MenuTree* tree, uint32_t first, uint32_t count)
+        : m_tree(tree), m_first(first), m_count(count) {}
+
+    uint32_t     first() const { return m_first; }
+    size_t       size()  const { return m_count; }
+    bool         empty() const { return m_count == 0; }
+    MenuNodeView operator[](size_t i) const {
+        return MenuNodeView(m_tree, m_first + static_cast<uint32_t>(i));
+    }
+    Iterator begin() const { return Iterator(m_tree, m_first); }
+    Iterator end()   const { return Iterator(m_tree, m_first + m_count); }
+
+private:
+    const MenuTree* m_tree  = nullptr;
+    uint32_t        m_first = 0;
+    uint32_t        m_count = 0;
+};
+
+/// <summary>
+/// One node of an already flattened tree for MenuTree::AssignRecords(): its
+/// strings (viewed; the call copies them) and the index run of its children.
+/// </summary>
+struct MenuTreeRecord {
+    std::wstring_view name;
+    std::wstring_view target;
+    std::wstring_view args;
+    std::wstring_view folderPath;
+    std::wstring_view lnkPath;
+    uint32_t          firstChild      = 0;
+    uint32_t          childCount      = 0;
+    bool              isFolder        = false;
+    bool              childrenPending = false;
+};
+
+/// <summary>
+/// Frozen All Programs tree stored in one arena.
+///
+/// Nodes are struct-of-arrays records laid out breadth-first, so every
+/// folder's children are one contiguous index range and a whole level can
+/// be painted without chasing pointers. ExpandFolder() appends a lazily
+/// scanned level at the end, which keeps every existing index valid. The
+/// five strings per node are ids into a shared, interned UTF-16 pool
+/// (folder paths and targets repeat a lot). After Assign() only icons
+/// change, plus ExpandFolder() on folders that are still childrenPending.
+///
+/// std::vector&lt;MenuNode&gt; stays the builder form: scanning, merging,
+/// patching and snapshots work on it, and the result is frozen here with
+/// Assign(). Thaw() converts back (icons included) for the rare edit.
+///
+/// Not thread-safe: callers serialise Assign/SetIcon with readers, as they
+/// did for the nested vector (StartMenuWindow uses m_treeMutex).
+/// </summary>
+class MenuTree {
+public:
+    static constexpr uint32_t kNone = 0xFFFFFFFFu;
+
+    /// Replace the contents with a frozen copy of |nodes|.
+    void Assign(const std::vector<MenuNode>& nodes);
+
+    /// <summary>
+    /// Replace the contents with |records|, already in the layout Assign()
+    /// produces: roots are [0, |rootCount|) and every folder's children one
+    /// later run, the runs in breadth-first order (see RecordsValid()). No
+    /// MenuNode is built; strings are interned as by Assign().
+    /// </summary>
+    void AssignRecords(const std::vector<MenuTreeRecord>& records, uint32_t rootCount);
+
+    /// True when |records| has the layout AssignRecords() requires: each run
+    /// starts where the previous one ended, after its parent, and together
+    /// the runs cover every record once.
+    static bool RecordsValid(const std::vector<MenuTreeRecord>& records, uint32_t rootCount);
+
+    /// Rebuild the nested builder form, hIcon included.
+    std::vector<MenuNode> Thaw() const;
+
+    void Clear();
+
+    /// <summary>
+    /// Give the childrenPending folder |index| its scanned |children| (and
+    /// any descendants they carry). The new records are appended, so indices
+    /// and views held by callers stay valid; only string views obtained before
+    /// the call must not be kept across it. Appended strings are not interned.
+    /// </summary>
+    void ExpandFolder(uint32_t index, const std::vector<MenuNode>& children);
+
+    MenuNodeRange Roots() const { return MenuNodeRange(this, 0, m_rootCount); }
+    MenuNodeView  Node(uint32_t index) const { return MenuNodeView(this, index); }
+    MenuNodeRange Children(uint32_t index) const {
+        return MenuNodeRange(this, m_firstChild[index], m_childCount[index]);
+    }
+
+    size_t   NodeCount() const { return m_flags.size(); }
+    uint32_t Parent(uint32_t index) const { return m_parent[index]; }
+
+    // Icons — the only per-node state that changes after Assign().
+    HICON Icon(uint32_t index) const { return m_icons[index]; }
+    void  SetIcon(uint32_t index, HICON h) {
+        m_icons[index] = h;
+        m_flags[index] &= static_cast<uint8_t>(~kFlagIconEvicted);
+    }
+    void  ClearIcons();
+
+    /// Drop |index|'s icon because IconCache evicted its handle. Unlike a
+    /// slot never loaded, it is reloaded only once it is shown again.
+    void EvictIcon(uint32_t index) {
+        m_icons[index] = nullptr;
+        m_flags[index] |= kFlagIconEvicted;
+    }
+    bool IconEvicted(uint32_t index) const { return (m_flags[index] & kFlagIconEvicted) != 0; }
+
+    /// First shortcut (depth-first, like the old recursive search) whose name
+    /// matches case-insensitively, or kNone. Compares sort keys first.
+    uint32_t FindShortcutByName(std::wstring_view name) const;
+
+    /// <summary>
+    /// Jump table lookup for type-a-letter navigation: the position within
+    /// |level| of the next node after |after| whose name starts with |ch|
+    /// (case-insensitive), wrapping to the first match; -1 if none.
+    /// A level is two runs sorted by sort key (folders, then shortcuts) and the
+    /// key's top 16 bits are the folded initial, so each run is binary-searched.
+    /// </summary>
+    int FindNextByInitial(MenuNodeRange level, wchar_t ch, int after) const;
+
+    /// Heap bytes owned by the arena (capacity, not size).
+    size_t MemoryBytes() const;
+
+    /// Approximate heap bytes the same tree takes as nested MenuNode vectors,
+    /// for BenchMenuTree's comparison.
+    static size_t NestedLayoutBytes(const std::vector<MenuNode>& nodes);
+
+private:
+    friend class MenuNodeView;
+
+    std::wstring_view String(uint32_t id) const {
+        return std::wstring_view(m_chars.data() + m_strOffset[id], m_strLength[id]);
+    }
+    void ThawInto(uint32_t first, uint32_t count, std::vector<MenuNode>& out) const;
+    // Append |s| plus a NUL to the pool; returns its id.
+    uint32_t AddString(std::wstring_view s);
+    template <typename InternFn>
+    void AppendBreadthFirst(const std::vector<MenuNode>& level, uint32_t parent, InternFn& intern);
+
+    static constexpr uint8_t kFlagFolder      = 0x1;
+    static constexpr uint8_t kFlagPending     = 0x2;   // MenuNode::childrenPending
+    static constexpr uint8_t kFlagIconEvicted = 0x4;   // see EvictIcon()
+
+    // ── Node records (struct of arrays, breadth-first) ────────────────────────
+    std::vector<uint32_t> m_name;         // string ids
+    std::vector<uint32_t> m_target;
+    std::vector<uint32_t> m_args;
+    std::vector<uint32_t> m_folderPath;
+    std::vector<uint32_t> m_lnkPath;
+    std::vector<uint32_t> m_firstChild;
+    std::vector<uint32_t> m_childCount;
+    std::vector<uint32_t> m_parent;       // kNone for top-level nodes
+    std::vector<uint64_t> m_sortKey;      // MenuNode::sortKey
+    std::vector<uint8_t>  m_flags;        // kFlag*
+    std::vector<HICON>    m_icons;
+    uint32_t              m_rootCount = 0;
+
+    // ── Interned string pool ──────────────────────────────────────────────────
+    // Id 0 is the empty string. Every string is followed by a NUL.
+    std::vector<wchar_t>  m_chars;
+    std::vector<uint32_t> m_strOffset;
+    std::vector<uint32_t> m_strLength;
+};
+
+// ── MenuNodeView inline accessors ─────────────────────────────────────────────
+
+inline std::wstring_view MenuNodeView::name()       const { return m_tree->String(m_tree->m_name[m_index]); }
+inline bool              MenuNodeView::isFolder()   const { return (m_tree->m_flags[m_index] & MenuTree::kFlagFolder) != 0; }
+inline bool              MenuNodeView::childrenPending() const { return (m_tree->m_flags[m_index] & MenuTree::kFlagPending) != 0; }
+inline std::wstring_view MenuNodeView::target()     const { return m_tree->String(m_tree->m_target[m_index]); }
+inline std::wstring_view MenuNodeView::args()       const { return m_tree->String(m_tree->m_args[m_index]); }
+inline std::wstring_view MenuNodeView::folderPath() const { return m_tree->String(m_tree->m_folderPath[m_index]); }
+inline std::wstring_view MenuNodeView::lnkPath()    const { return m_tree->String(m_tree->m_lnkPath[m_index]); }
+inline HICON             MenuNodeView::hIcon()      const { return m_tree->m_icons[m_index]; }
+inline std::uint64_t     MenuNodeView::sortKey()    const { return m_tree->m_sortKey[m_index]; }
+inline MenuNodeRange     MenuNodeView::children()   const { return m_tree->Children(m_index); }
+
+} // namespace GlassBar
@@ -0,0 +1,16 @@
+#pragma once
+#include <cwctype>     // towlower
+
+namespace GlassBar {
+
+/// <summary>
+/// Case fold shared by every All Programs name comparison (ordering, merge,
+/// dedup, jump-to-letter) and by the search, frecency and recent-list code.
+/// ASCII is folded inline; everything else goes through towlower.
+/// </summary>
+inline wchar_t FoldNameChar(wchar_t c) {
+    if (c < 0x80) return (c >= L'A' && c <= L'Z') ? static_cast<wchar_t>(c + 32) : c;
+    return static_cast<wchar_t>(towlower(c));
+}
+
+} // namespace GlassBar
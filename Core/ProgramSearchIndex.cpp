@@ -0,0 +1,416 @@
+#include "ProgramSearchIndex.h"
+#include "NameFold.h"
+#include "FuzzyMatch.h"
+
+#include <algorithm>
+#include <cwctype>
+#include <string>
+
+namespace GlassBar {
+
+// ── Helpers ───────────────────────────────────────────────────────────────────
+
+namespace {
+
+constexpr size_t kMaxNameChars = 0xFFFF;
+constexpr size_t kMaxTerms     = 8;
+
+// Score components (see ProgramSearchIndex).
+constexpr int kScoreWholeName  = 1000;
+constexpr int kScoreNamePrefix = 800;
+constexpr int kScoreWordPrefix = 600;
+constexpr int kScoreSubstring  = 300;
+constexpr int kMaxLengthCost   = 100;
+constexpr int kMaxBoost        = 1000;
+
+// Narrowing rescores at most this many previous matches directly; a larger
+// set is first cut down by the changed terms' posting lists.
+constexpr size_t kMaxDirectRescore = 512;
+
+bool IsWordChar(wchar_t c) { return iswalnum(c) != 0; }
+
+bool IsWordStart(std::wstring_view name, size_t i) {
+    return IsWordChar(name[i]) && (i == 0 || !IsWordChar(name[i - 1]));
+}
+
+/// Word start, or the upper-case letter of a camel-case hump ("PowerShell").
+/// Needs the original, unfolded name.
+bool IsBoundary(std::wstring_view name, size_t i) {
+    return IsWordStart(name, i) ||
+           (i > 0 && iswupper(name[i]) && iswlower(name[i - 1]));
+}
+
+uint64_t TrigramKey(const wchar_t* p) {
+    return (static_cast<uint64_t>(static_cast<uint16_t>(p[0])) << 32) |
+           (static_cast<uint64_t>(static_cast<uint16_t>(p[1])) << 16) |
+            static_cast<uint64_t>(static_cast<uint16_t>(p[2]));
+}
+
+uint64_t PrefixKey(wchar_t first, wchar_t second) {
+    return (static_cast<uint64_t>(static_cast<uint16_t>(first)) << 16) |
+            static_cast<uint64_t>(static_cast<uint16_t>(second));
+}
+
+int SourceBonus(SearchSource s) {
+    switch (s) {
+    case SearchSource::Pinned: return 40;
+    case SearchSource::Recent: return 20;
+    default:                   return 0;
+    }
+}
+
+} // namespace
+
+// ── PostingTable ──────────────────────────────────────────────────────────────
+
+void ProgramSearchIndex::PostingTable::Build(std::vector<std::pair<uint64_t, uint32_t>>& pairs) {
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+    keys.clear();
+    offsets.clear();
+    postings.clear();
+    postings.reserve(pairs.size());
+    for (const auto& [key, entry] : pairs) {
+        if (keys.empty() || keys.back() != key) {
+            keys.push_back(key);
+            offsets.push_back(static_cast<uint32_t>(postings.size()));
+        }
+        postings.push_back(entry);
+    }
+    offsets.push_back(static_cast<uint32_t>(postings.size()));
+}
+
+void ProgramSearchIndex::PostingTable::Collect(uint64_t lo, uint64_t hi,
+                                               std::vector<uint32_t>& out) const {
+    auto it = std::lower_bound(keys.begin(), keys.end(), lo);
+    for (; it != keys.end() && *it <= hi; ++it) {
+        const size_t k = static_cast<size_t>(it - keys.begin());
+        out.insert(out.end(), postings.begin() + offsets[k], postings.begin() + offsets[k + 1]);
+    }
+}
+
+size_t ProgramSearchIndex::PostingTable::MemoryBytes() const {
+    return keys.capacity() * sizeof(uint64_t) +
+           (offsets.capacity() + postings.capacity()) * sizeof(uint32_t);
+}
+
+// ── Build ─────────────────────────────────────────────────────────────────────
+
+void ProgramSearchIndex::Clear() {
+    m_chars.clear();
+    m_bounds.clear();
+    m_offset.clear();
+    m_length.clear();
+    m_source.clear();
+    m_ref.clear();
+    m_boost.clear();
+    m_masks.clear();
+    m_trigrams = {};
+    m_prefixes = {};
+    m_built    = false;
+}
+
+void ProgramSearchIndex::Add(std::wstring_view name, SearchSource source, uint32_t ref,
+                             int boost) {
+    const size_t len = (std::min)(name.size(), kMaxNameChars);
+    m_offset.push_back(static_cast<uint32_t>(m_chars.size()));
+    m_length.push_back(static_cast<uint16_t>(len));
+    for (size_t i = 0; i < len; ++i) {
+        m_chars.push_back(FoldNameChar(name[i]));
+        m_bounds.push_back(IsBoundary(name, i) ? 1 : 0);
+    }
+    m_source.push_back(source);
+    m_ref.push_back(ref);
+    m_boost.push_back(static_cast<int16_t>((std::clamp)(boost, -kMaxBoost, kMaxBoost)));
+    m_masks.push_back(FuzzyCharMask(Folded(static_cast<uint32_t>(m_source.size() - 1))));
+    m_built = false;
+}
+
+void ProgramSearchIndex::Build() {
+    std::vector<std::pair<uint64_t, uint32_t>> trigrams, prefixes;
+    trigrams.reserve(m_chars.size());
+    prefixes.reserve(m_source.size() * 2);
+
+    for (uint32_t e = 0; e < static_cast<uint32_t>(m_source.size()); ++e) {
+        const std::wstring_view name = Folded(e);
+        for (size_t i = 0; i + 3 <= name.size(); ++i)
+            trigrams.emplace_back(TrigramKey(name.data() + i), e);
+        for (size_t i = 0; i < name.size(); ++i) {
+            // Position 0 too: ScoreTerm() takes a name prefix even when the
+            // name starts with punctuation ("(x86) Tools").
+            if (i != 0 && !IsWordStart(name, i)) continue;
+            prefixes.emplace_back(PrefixKey(name[i], i + 1 < name.size() ? name[i + 1] : 0), e);
+        }
+    }
+
+    m_trigrams.Build(trigrams);
+    m_prefixes.Build(prefixes);
+    m_built = true;
+    ++m_buildId;
+}
+
+size_t ProgramSearchIndex::MemoryBytes() const {
+    return m_chars.capacity() * sizeof(wchar_t) + m_bounds.capacity() +
+           (m_offset.capacity() + m_ref.capacity()) * sizeof(uint32_t) +
+           m_masks.capacity() * sizeof(uint64_t) +
+           (m_length.capacity() + m_boost.capacity()) * sizeof(uint16_t) +
+           m_source.capacity() * sizeof(SearchSource) +
+           m_trigrams.MemoryBytes() + m_prefixes.MemoryBytes();
+}
+
+// ── Query ─────────────────────────────────────────────────────────────────────
+
+/// Entries that may match |term|, ascending and unique: a superset of the
+/// entries ScoreTerm() accepts. Short terms only match at word starts (or the
+/// name start); longer ones need every trigram of the term.
+void ProgramSearchIndex::TermCandidates(std::wstring_view term, std::vector<uint32_t>& out) const {
+    out.clear();
+    if (term.size() < 3) {
+        const uint64_t lo = PrefixKey(term[0], term.size() > 1 ? term[1] : 0);
+        const uint64_t hi = term.size() > 1 ? lo : (lo | 0xFFFF);
+        m_prefixes.Collect(lo, hi, out);
+        if (lo != hi) {
+            // One entry can sit under several keys; dedupe and re-sort in one
+            // sweep over a bitmap rather than sorting thousands of postings.
+            std::vector<bool> hit(m_source.size());
+            for (uint32_t e : out) hit[e] = true;
+            out.clear();
+            for (uint32_t e = 0; e < static_cast<uint32_t>(hit.size()); ++e)
+                if (hit[e]) out.push_back(e);
+        }
+        return;
+    }
+
+    // Posting runs of every trigram in the term, rarest first.
+    struct Run { const uint32_t* first; const uint32_t* last; };
+    Run runs[64];
+    size_t runCount = 0;
+    for (size_t i = 0; i + 3 <= term.size() && runCount < std::size(runs); ++i) {
+        const uint64_t key = TrigramKey(term.data() + i);
+        auto it = std::lower_bound(m_trigrams.keys.begin(), m_trigrams.keys.end(), key);
+        if (it == m_trigrams.keys.end() || *it != key) return;   // trigram absent
+        const size_t k = static_cast<size_t>(it - m_trigrams.keys.begin());
+        runs[runCount++] = { m_trigrams.postings.data() + m_trigrams.offsets[k],
+                             m_trigrams.postings.data() + m_trigrams.offsets[k + 1] };
+    }
+    std::sort(runs, runs + runCount, [](const Run& a, const Run& b) {
+        return (a.last - a.first) < (b.last - b.first);
+    });
+
+    out.assign(runs[0].first, runs[0].last);
+    for (size_t r = 1; r < runCount && !out.empty(); ++r) {
+        auto end = std::set_intersection(out.begin(), out.end(),
+                                         runs[r].first, runs[r].last, out.begin());
+        out.erase(end, out.end());
+    }
+}
+
+/// Score of |term| against the folded |name|, or -1 when it does not match.
+int ProgramSearchIndex::ScoreTerm(std::wstring_view name, std::wstring_view term) {
+    if (name.size() < term.size()) return -1;
+    if (name == term) return kScoreWholeName;
+
+    int best = -1;
+    for (size_t pos = name.find(term); pos != std::wstring_view::npos;
+         pos = name.find(term, pos + 1)) {
+        if (pos == 0) return kScoreNamePrefix;
+        if (IsWordStart(name, pos)) best = kScoreWordPrefix;
+        else if (term.size() >= 3 && best < 0) best = kScoreSubstring;
+    }
+    return best;
+}
+
+void ProgramSearchIndex::Query(std::wstring_view query, size_t limit,
+                               std::vector<SearchHit>& out, Narrowing* narrowing) const {
+    out.clear();
+    if (!m_built || limit == 0) {
+        if (narrowing) narrowing->build = 0;
+        return;
+    }
+
+    // Fold and split on whitespace, keeping query order (Narrowing relies on it).
+    std::wstring folded(query.size(), L'\0');
+    for (size_t i = 0; i < query.size(); ++i) folded[i] = FoldNameChar(query[i]);
+    std::wstring_view terms[kMaxTerms];
+    size_t termCount = 0;
+    for (size_t i = 0; i < folded.size() && termCount < kMaxTerms;) {
+        while (i < folded.size() && iswspace(folded[i])) ++i;
+        const size_t start = i;
+        while (i < folded.size() && !iswspace(folded[i])) ++i;
+        if (i > start) terms[termCount++] = std::wstring_view(folded).substr(start, i - start);
+    }
+    if (termCount == 0) {
+        if (narrowing) narrowing->build = 0;
+        return;
+    }
+
+    // Can the previous query's matches seed this one? Only if this query
+    // extends it: every term then matches a subset of what it matched before,
+    // except a term growing from two characters to three, which starts to
+    // match mid-word as well.
+    bool narrowExact = false;
+    bool narrowFuzzy = false;
+    bool lastChanged = false;
+    if (narrowing && narrowing->build == m_buildId &&
+        std::wstring_view(folded).substr(0, narrowing->folded.size()) == narrowing->folded) {
+        const size_t k = narrowing->termCount;
+        lastChanged = terms[k - 1].size() != narrowing->lastTermLen;
+        narrowExact = !(lastChanged && narrowing->lastTermLen < 3 && terms[k - 1].size() >= 3);
+        narrowFuzzy = narrowing->fuzzyValid;
+    }
+
+    // Exact tier: every term must score. Scores are kept split as (all terms
+    // but the last, the last) so that the next, longer query can reuse them.
+    using Match = Narrowing::Match;
+    std::vector<Match> matches;
+    auto scoreFrom = [&](uint32_t e, size_t from, int lead) {
+        const std::wstring_view name = Folded(e);
+        int last = 0;
+        for (size_t t = from; t < termCount; ++t) {
+            const int s = ScoreTerm(name, terms[t]);
+            if (s < 0) return;
+            if (t + 1 < termCount) lead += s;
+            else                   last = s;
+        }
+        matches.push_back({ e, lead, last });
+    };
+    std::vector<uint32_t> candidates, next;
+    if (narrowExact) {
+        // Terms before the previous last one are unchanged; rescore from
+        // there (or from the first new term), starting from the kept sums.
+        const size_t k    = narrowing->termCount;
+        const size_t from = lastChanged ? k - 1 : k;
+        const bool   cut  = from < termCount && narrowing->exact.size() > kMaxDirectRescore;
+        if (cut) {
+            TermCandidates(terms[from], candidates);
+            for (size_t t = from + 1; t < termCount && !candidates.empty(); ++t) {
+                TermCandidates(terms[t], next);
+                auto end = std::set_intersection(candidates.begin(), candidates.end(),
+                                                 next.begin(), next.end(), candidates.begin());
+                candidates.erase(end, candidates.end());
+            }
+        }
+        auto narrow = [&](const Match& m) {
+            if (from < termCount) scoreFrom(m.entry, from, lastChanged ? m.lead : m.lead + m.last);
+            else                  matches.push_back(m);
+        };
+        const std::vector<Match>& previous = narrowing->exact;
+        if (cut) {
+            // Both lists ascend: step through the shorter side, binary
+            // searching the previous matches when there are far more of them.
+            matches.reserve(candidates.size());
+            const bool search = candidates.size() * 16 < previous.size();
+            auto m = previous.cbegin();
+            for (uint32_t e : candidates) {
+                if (search)
+                    m = std::lower_bound(m, previous.cend(), e,
+                                         [](const Match& a, uint32_t b) { return a.entry < b; });
+                else
+                    while (m != previous.cend() && m->entry < e) ++m;
+                if (m == previous.cend()) break;
+                if (m->entry == e) narrow(*m);
+            }
+        } else {
+            matches.reserve(previous.size());
+            for (const Match& m : previous) narrow(m);
+        }
+    } else {
+        // Longest term first: its candidate list is usually the shortest. The
+        // rest intersect in query order.
+        const size_t longest = static_cast<size_t>(
+            std::max_element(terms, terms + termCount, [](std::wstring_view a, std::wstring_view b) {
+                return a.size() < b.size();
+            }) - terms);
+        TermCandidates(terms[longest], candidates);
+        for (size_t t = 0; t < termCount && !candidates.empty(); ++t) {
+            if (t == longest) continue;
+            TermCandidates(terms[t], next);
+            auto end = std::set_intersection(candidates.begin(), candidates.end(),
+                                             next.begin(), next.end(), candidates.begin());
+            candidates.erase(end, candidates.end());
+        }
+        matches.reserve(candidates.size());
+        for (uint32_t e : candidates) scoreFrom(e, 0, 0);
+    }
+
+    struct Scored { int score; uint32_t entry; };
+    auto finalScore = [this](uint32_t e, int matchScore) {
+        return matchScore + SourceBonus(m_source[e]) + m_boost[e] -
+               static_cast<int>((std::min)(static_cast<size_t>(m_length[e]),
+                                           static_cast<size_t>(kMaxLengthCost)));
+    };
+    std::vector<Scored> scored;
+    scored.reserve(matches.size());
+    for (const Match& m : matches)
+        scored.push_back({ finalScore(m.entry, m.lead + m.last), m.entry });
+
+    if (narrowing) {
+        narrowing->folded      = folded;
+        narrowing->termCount   = termCount;
+        narrowing->lastTermLen = terms[termCount - 1].size();
+        narrowing->exact.swap(matches);
+        narrowing->build       = m_buildId;
+    }
+
+    auto better = [this](const Scored& a, const Scored& b) {
+        if (a.score != b.score) return a.score > b.score;
+        const int c = Folded(a.entry).compare(Folded(b.entry));
+        return c != 0 ? c < 0 : a.entry < b.entry;
+    };
+    std::vector<uint32_t> taken;
+    auto emit = [&](std::vector<Scored>& list) {
+        // Only the head is shown: rank a few times |limit| (slack for
+        // duplicate names), and the rest only if duplicates ate that slack.
+        size_t head = (std::min)(list.size(), limit * 4);
+        std::partial_sort(list.begin(), list.begin() + head, list.end(), better);
+        for (size_t i = 0; i < list.size() && out.size() < limit; ++i) {
+            if (i == head) {
+                std::sort(list.begin() + head, list.end(), better);
+                head = list.size();
+            }
+            const std::wstring_view name = Folded(list[i].entry);
+            bool duplicate = false;
+            for (uint32_t t : taken)
+                if (Folded(t) == name) { duplicate = true; break; }
+            if (duplicate) continue;
+            taken.push_back(list[i].entry);
+            out.push_back({ m_source[list[i].entry], m_ref[list[i].entry], list[i].score });
+        }
+    };
+    emit(scored);
+
+    // Fuzzy tier, only to fill the list: the query minus spaces as a
+    // subsequence ("vsc" -> "Visual Studio Code"). Ranked after every
+    // exact hit, so its scores are only compared among themselves. A longer
+    // pattern is a subsequence only where the shorter one was, so its
+    // previous matches can stand in for the prefilter.
+    if (narrowing) narrowing->fuzzyValid = false;
+    if (out.size() >= limit) return;
+    std::wstring pattern;
+    for (size_t t = 0; t < folded.size(); ++t)
+        if (!iswspace(folded[t])) pattern.push_back(folded[t]);
+    if (pattern.size() < 2 || pattern.size() > kFuzzyMaxPattern) return;
+
+    if (narrowFuzzy) {
+        candidates.swap(narrowing->fuzzy);
+    } else {
+        candidates.clear();
+        FuzzyPrefilter(m_masks.data(), m_masks.size(), FuzzyCharMask(pattern), candidates);
+    }
+    scored.clear();
+    next.clear();
+    for (uint32_t e : candidates) {
+        const int score = FuzzyScore(Folded(e), m_bounds.data() + m_offset[e], pattern);
+        if (score < 0) continue;
+        scored.push_back({ finalScore(e, score), e });
+        next.push_back(e);
+    }
+    if (narrowing) {
+        narrowing->fuzzy.swap(next);
+        narrowing->fuzzyValid = true;
+    }
+    emit(scored);
+}
+
+} // namespace GlassBar
@@ -0,0 +1,134 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace GlassBar {
+
+/// Where a search entry comes from; SearchHit::ref indexes that list.
+enum class SearchSource : uint8_t {
+    Program,   // m_programTree node (shortcut or folder)
+    Pinned,    // m_dynamicPinnedItems
+    Recent,    // m_recentItems
+};
+
+/// One ranked search result.
+struct SearchHit {
+    SearchSource source = SearchSource::Program;
+    uint32_t     ref    = 0;
+    int          score  = 0;
+};
+
+/// <summary>
+/// Type-to-search index over the Start Menu catalog: every All Programs node
+/// name plus the pinned and recent lists.
+///
+/// Names are case-folded (FoldNameChar) into one pool. Two posting tables
+/// find candidates without touching every entry:
+///   • trigrams of each name, for query terms of three or more characters;
+///   • the first two characters of the name and of each word, for one- and
+///     two-character terms.
+/// A query is split on spaces and every term must match an entry, as a word
+/// prefix or (three characters and up) anywhere in the name. Candidates are
+/// the intersection of the terms' posting lists and are then verified and
+/// scored: whole name &gt; name prefix &gt; word prefix &gt; substring, pinned and
+/// recent entries ahead of equal tree entries, plus each entry's boost (its
+/// frecency), shorter names first.
+///
+/// When that leaves room, a fuzzy tier follows (FuzzyMatch.h): the query
+/// without spaces as a subsequence, prefiltered by character-set masks.
+///
+/// Build once per catalog change with Add() ... Build(); Query() is const and
+/// allocation-light, meant to run on every keystroke. Typing mostly extends
+/// the previous query, and an extended query can only lose matches, so a
+/// caller-kept Narrowing lets the next Query() rescore just the previous
+/// matches instead of starting from the posting tables.
+/// </summary>
+class ProgramSearchIndex {
+public:
+    void Clear();
+
+    /// <summary>
+    /// Queue one entry; |boost| is added to every score it gets (see
+    /// FrecencyStore::SearchBoost). Call Build() after the last Add().
+    /// </summary>
+    void Add(std::wstring_view name, SearchSource source, uint32_t ref, int boost = 0);
+
+    /// Sort the posting tables. Entries added after this need another Build().
+    void Build();
+
+    /// <summary>
+    /// Matches of the last query, kept by the caller between Query() calls.
+    /// When the next query extends that one (another character or another
+    /// word) only these entries are rescored, and only for the terms that
+    /// changed; Backspace, an edit or a rebuilt index start over. Results are
+    /// the same either way.
+    /// </summary>
+    struct Narrowing {
+        struct Match {
+            uint32_t entry;
+            int      lead;   // ScoreTerm sum of every term but the last
+            int      last;   // ScoreTerm of the last term
+        };
+        std::wstring          folded;               // the query, folded
+        size_t                termCount   = 0;
+        size_t                lastTermLen = 0;
+        std::vector<Match>    exact;                // ascending by entry
+        std::vector<uint32_t> fuzzy;                // ascending; fuzzy tier matches
+        bool                  fuzzyValid  = false;  // the fuzzy tier ran
+        uint64_t              build       = 0;      // Build() it belongs to; 0 = none
+    };
+
+    /// <summary>
+    /// Up to |limit| matches for |query|, best first. Entries whose folded
+    /// names are equal are reported once (the best-ranked one). With
+    /// |narrowing|, narrows from the previous query when it can and records
+    /// this one's matches for the next call.
+    /// </summary>
+    void Query(std::wstring_view query, size_t limit, std::vector<SearchHit>& out,
+               Narrowing* narrowing = nullptr) const;
+
+    size_t EntryCount() const { return m_source.size(); }
+
+    /// Heap bytes owned by the index (capacity, not size).
+    size_t MemoryBytes() const;
+
+private:
+    /// Sorted keys with their posting lists laid out back to back
+    /// (postings of m_keys[i] are m_postings[m_offsets[i] .. m_offsets[i+1])).
+    struct PostingTable {
+        std::vector<uint64_t> keys;
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> postings;
+
+        void Build(std::vector<std::pair<uint64_t, uint32_t>>& pairs);
+        /// Appends the postings of every key in [lo, hi] to |out|.
+        void Collect(uint64_t lo, uint64_t hi, std::vector<uint32_t>& out) const;
+        size_t MemoryBytes() const;
+    };
+
+    std::wstring_view Folded(uint32_t entry) const {
+        return std::wstring_view(m_chars.data() + m_offset[entry], m_length[entry]);
+    }
+    void TermCandidates(std::wstring_view term, std::vector<uint32_t>& out) const;
+    static int ScoreTerm(std::wstring_view name, std::wstring_view term);
+
+    // ── Entries (struct of arrays) ────────────────────────────────────────────
+    std::vector<wchar_t>      m_chars;    // folded names, back to back
+    std::vector<uint8_t>      m_bounds;   // per m_chars unit: word / camel-case start
+    std::vector<uint32_t>     m_offset;
+    std::vector<uint16_t>     m_length;
+    std::vector<SearchSource> m_source;
+    std::vector<uint32_t>     m_ref;
+    std::vector<int16_t>      m_boost;
+    std::vector<uint64_t>     m_masks;    // FuzzyCharMask of each folded name
+
+    PostingTable m_trigrams;   // key: three folded units, 16 bits each
+    PostingTable m_prefixes;   // key: first two folded units of a word or the name (second may be 0)
+    bool         m_built   = false;
+    uint64_t     m_buildId = 0;   // bumped by Build(); see Narrowing::build
+};
+
+} // namespace GlassBar
@@ -0,0 +1,833 @@
+#include "ProgramTree.h"
+#include "Diagnostics.h"
+#include "ShellLinkParser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+namespace GlassBar {
+
+// ── Name collation ────────────────────────────────────────────────────────────
+
+std::uint64_t MakeNameSortKey(std::wstring_view name) {
+    std::uint64_t key = 0;
+    for (size_t i = 0; i < kSortKeyChars; ++i) {
+        const wchar_t c = i < name.size() ? FoldNameChar(name[i]) : L'\0';
+        key = (key << 16) | static_cast<std::uint16_t>(c);
+    }
+    return key;
+}
+
+/// Folded comparison of |a| and |b| starting at unit |from|.
+static int CompareFoldedFrom(std::wstring_view a, std::wstring_view b, size_t from) {
+    const size_t n = (std::min)(a.size(), b.size());
+    for (size_t i = from; i < n; ++i) {
+        const wchar_t ca = FoldNameChar(a[i]), cb = FoldNameChar(b[i]);
+        if (ca != cb) return ca < cb ? -1 : 1;
+    }
+    return a.size() == b.size() ? 0 : (a.size() < b.size() ? -1 : 1);
+}
+
+int CompareNodeNames(std::wstring_view a, std::wstring_view b) {
+    return CompareFoldedFrom(a, b, 0);
+}
+
+bool NodeLess(const MenuNode& a, const MenuNode& b) {
+    if (a.isFolder != b.isFolder) return a.isFolder > b.isFolder;   // folders first
+    if (a.sortKey != b.sortKey)   return a.sortKey < b.sortKey;
+    // Equal keys: the first kSortKeyChars folded units already match (or both
+    // names are shorter and identical), so only the tails need comparing.
+    return CompareFoldedFrom(a.name, b.name, kSortKeyChars) < 0;
+}
+
+bool SameNodeKey(const MenuNode& a, const MenuNode& b) {
+    return a.isFolder == b.isFolder && a.sortKey == b.sortKey &&
+           CompareFoldedFrom(a.name, b.name, kSortKeyChars) == 0;
+}
+
+/// True when |fileName| ends in |ext| (lower-case, with the dot), folded.
+static bool HasExtension(std::wstring_view fileName, std::wstring_view ext) {
+    return fileName.size() > ext.size() &&
+           CompareNodeNames(fileName.substr(fileName.size() - ext.size()), ext) == 0;
+}
+
+std::wstring_view ShortcutDisplayName(std::wstring_view fileName) {
+    if (!HasExtension(fileName, L".lnk") && !HasExtension(fileName, L".url")) return {};
+    return fileName.substr(0, fileName.size() - 4);
+}
+
+// ── MergeTree ─────────────────────────────────────────────────────────────────
+
+void MergeTree(std::vector<MenuNode>& base, std::vector<MenuNode>&& overlay) {
+    if (overlay.empty()) return;
+    if (!std::is_sorted(base.begin(), base.end(), NodeLess))
+        std::sort(base.begin(), base.end(), NodeLess);
+    if (!std::is_sorted(overlay.begin(), overlay.end(), NodeLess))
+        std::sort(overlay.begin(), overlay.end(), NodeLess);
+
+    std::vector<MenuNode> merged;
+    merged.reserve(base.size() + overlay.size());
+
+    // Fold one overlay node into the group head |into|.
+    // A folder still pending in either root stays pending: its expansion
+    // rescans both roots anyway.
+    auto fold = [](MenuNode& into, MenuNode&& oNode) {
+        if (oNode.isFolder && into.isFolder) {
+            into.childrenPending = into.childrenPending || oNode.childrenPending;
+            MergeTree(into.children, std::move(oNode.children));
+        } else
+            into = std::move(oNode);  // user shortcut wins
+    };
+
+    size_t b = 0, o = 0;
+    while (b < base.size() || o < overlay.size()) {
+        if (o == overlay.size() ||
+            (b < base.size() && NodeLess(base[b], overlay[o]))) {
+            merged.push_back(std::move(base[b++]));
+            continue;
+        }
+        if (b == base.size() || NodeLess(overlay[o], base[b])) {
+            // Key only in overlay: later same-key overlay nodes fold into it.
+            merged.push_back(std::move(overlay[o++]));
+            while (o < overlay.size() && SameNodeKey(merged.back(), overlay[o]))
+                fold(merged.back(), std::move(overlay[o++]));
+            continue;
+        }
+
+        // Key in both: the first base node absorbs every overlay node of the
+        // key; any further base nodes of the key follow unchanged.
+        const MenuNode& key = base[b];
+        size_t oEnd = o;
+        while (oEnd < overlay.size() && SameNodeKey(key, overlay[oEnd])) ++oEnd;
+        merged.push_back(std::move(base[b++]));
+        for (; o < oEnd; ++o) fold(merged.back(), std::move(overlay[o]));
+        while (b < base.size() && SameNodeKey(merged.back(), base[b]))
+            merged.push_back(std::move(base[b++]));
+    }
+
+    base = std::move(merged);
+}
+
+// ── ParallelScanner ───────────────────────────────────────────────────────────
+
+namespace {
+
+std::uint64_t MicrosecondsSince(std::chrono::steady_clock::time_point t0) {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - t0).count());
+}
+
+/// Parallel folder scanner with a small work-stealing pool.
+///
+/// Two kinds of task share the pool:
+///   • Enumerate — lists one folder (ScanBackend::listFolder); queues one
+///                 Enumerate task per subfolder and splits the folder's
+///                 shortcuts into Resolve batches.
+///   • Resolve   — runs ScanBackend::resolve over a contiguous slice of one
+///                 folder's shortcut slots.
+///
+/// Every worker owns a deque: it pushes/pops at the back (LIFO, cache-warm)
+/// and idle workers steal from the front of a victim's deque (FIFO, which
+/// hands out the largest remaining subtrees first).  The calling thread acts
+/// as worker 0, so a one-thread scan never spawns anything.
+///
+/// Results land in per-folder slots that each task writes exclusively; the
+/// tree is assembled and sorted on the calling thread once the pool drains,
+/// giving exactly the same output as a sequential depth-first scan.
+///
+/// A shallow scanner enumerates only the roots themselves: subfolders are
+/// recorded but not entered, and come back childrenPending (lazy mode).
+class ParallelScanner {
+public:
+    ParallelScanner(const ScanBackend& backend, unsigned threadCount, bool shallow)
+        : m_backend(backend), m_queues(threadCount ? threadCount : 1), m_shallow(shallow) {}
+
+    /// Scan every root recursively; returns one folder node per root (name unset).
+    std::vector<MenuNode> Scan(const std::vector<std::wstring>& roots) {
+        std::vector<size_t> rootIds;
+        for (const auto& r : roots) rootIds.push_back(AddFolder(r));
+        for (size_t id : rootIds) Push(0, { Task::Enumerate, id, 0, 0 });
+
+        std::vector<std::thread> workers;
+        for (size_t w = 1; w < m_queues.size(); ++w)
+            workers.emplace_back(&ParallelScanner::WorkerMain, this, w);
+        RunWorker(0);   // the caller has set up its own thread
+        for (auto& t : workers) t.join();
+
+        const auto t0 = std::chrono::steady_clock::now();
+        std::vector<MenuNode> out;
+        out.reserve(rootIds.size());
+        for (size_t id : rootIds) out.push_back(Assemble(id));
+        m_assembleUs = MicrosecondsSince(t0);
+        return out;
+    }
+
+    size_t ShortcutCount() const { return m_shortcuts.load(std::memory_order_relaxed); }
+
+    void AddStageTimes(ScanStageTimes& times) const {
+        times.enumerateUs += m_enumerateUs.load(std::memory_order_relaxed);
+        times.resolveUs   += m_resolveUs.load(std::memory_order_relaxed);
+        times.assembleUs  += m_assembleUs;
+    }
+
+private:
+    static constexpr size_t kResolveBatch = 16;   // shortcuts per Resolve task
+
+    struct Task {
+        enum Kind { Enumerate, Resolve } kind;
+        size_t folder;
+        size_t begin;
+        size_t end;
+    };
+
+    struct FolderResult {
+        std::wstring                                   path;
+        std::vector<MenuNode>                          items;       // one slot per shortcut
+        std::vector<std::pair<std::wstring, size_t>>   subfolders;  // display name → folder id
+    };
+
+    struct WorkQueue {
+        std::mutex       mutex;
+        std::deque<Task> tasks;
+    };
+
+    const ScanBackend&       m_backend;
+
+    // std::deque keeps element addresses stable across push_back, so a task
+    // can hold a FolderResult& while other workers append new folders.
+    std::deque<FolderResult> m_folders;
+    std::mutex               m_foldersMutex;
+
+    std::vector<WorkQueue>   m_queues;
+    const bool               m_shallow;
+    std::atomic<size_t>      m_pending{0};     // queued + running tasks
+    std::atomic<size_t>      m_shortcuts{0};
+    std::atomic<std::uint64_t> m_enumerateUs{0};
+    std::atomic<std::uint64_t> m_resolveUs{0};
+    std::uint64_t            m_assembleUs = 0;
+
+    // Idle workers sleep on m_idleCv until m_wakeups moves (a task was pushed
+    // or the pool drained). m_sleepers lets Push skip the mutex when nobody
+    // sleeps; both are seq_cst so a pusher either sees the sleeper or the
+    // sleeper's predicate sees the new m_wakeups.
+    std::mutex               m_idleMutex;
+    std::condition_variable  m_idleCv;
+    std::atomic<size_t>      m_wakeups{0};
+    std::atomic<size_t>      m_sleepers{0};
+
+    size_t AddFolder(const std::wstring& path) {
+        std::lock_guard<std::mutex> lk(m_foldersMutex);
+        m_folders.push_back({ path, {}, {} });
+        return m_folders.size() - 1;
+    }
+
+    FolderResult& Folder(size_t id) {
+        std::lock_guard<std::mutex> lk(m_foldersMutex);
+        return m_folders[id];
+    }
+
+    void Push(size_t worker, const Task& task) {
+        m_pending.fetch_add(1, std::memory_order_acq_rel);
+        {
+            std::lock_guard<std::mutex> lk(m_queues[worker].mutex);
+            m_queues[worker].tasks.push_back(task);
+        }
+        Wake(false);
+    }
+
+    void Wake(bool all) {
+        m_wakeups.fetch_add(1);
+        if (m_sleepers.load() == 0) return;
+        { std::lock_guard<std::mutex> lk(m_idleMutex); }   // order against a sleeper's check
+        if (all) m_idleCv.notify_all();
+        else     m_idleCv.notify_one();
+    }
+
+    bool PopLocal(size_t worker, Task& out) {
+        std::lock_guard<std::mutex> lk(m_queues[worker].mutex);
+        if (m_queues[worker].tasks.empty()) return false;
+        out = m_queues[worker].tasks.back();
+        m_queues[worker].tasks.pop_back();
+        return true;
+    }
+
+    bool Steal(size_t thief, Task& out) {
+        const size_t n = m_queues.size();
+        for (size_t i = 1; i < n; ++i) {
+            WorkQueue& victim = m_queues[(thief + i) % n];
+            std::lock_guard<std::mutex> lk(victim.mutex);
+            if (victim.tasks.empty()) continue;
+            out = victim.tasks.front();
+            victim.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    void WorkerMain(size_t worker) {
+        if (m_backend.threadStart) m_backend.threadStart();
+        RunWorker(worker);
+        if (m_backend.threadStop) m_backend.threadStop();
+    }
+
+    void RunWorker(size_t worker) {
+        Task task{};
+        while (true) {
+            // Read before looking for work: any push after this bumps it.
+            const size_t seen = m_wakeups.load();
+            if (PopLocal(worker, task) || Steal(worker, task)) {
+                Execute(worker, task);
+                if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    Wake(true);   // last task finished — wake everyone to exit
+                continue;
+            }
+            if (m_pending.load(std::memory_order_acquire) == 0) return;
+            // Nothing to steal yet but work is still running elsewhere: sleep
+            // until a new task is pushed or the pool drains.
+            std::unique_lock<std::mutex> lk(m_idleMutex);
+            m_sleepers.fetch_add(1);
+            m_idleCv.wait(lk, [&] {
+                return m_wakeups.load() != seen || m_pending.load(std::memory_order_acquire) == 0;
+            });
+            m_sleepers.fetch_sub(1);
+        }
+    }
+
+    void Execute(size_t worker, const Task& task) {
+        const auto t0 = std::chrono::steady_clock::now();
+        if (task.kind == Task::Enumerate) {
+            Enumerate(worker, task.folder);
+            m_enumerateUs.fetch_add(MicrosecondsSince(t0), std::memory_order_relaxed);
+        } else {
+            Resolve(task);
+            m_resolveUs.fetch_add(MicrosecondsSince(t0), std::memory_order_relaxed);
+        }
+    }
+
+    void Enumerate(size_t worker, size_t id) {
+        FolderResult& folder = Folder(id);
+
+        thread_local std::vector<ScanBackend::Entry> entries;
+        entries.clear();
+        m_backend.listFolder(folder.path, entries);
+
+        for (ScanBackend::Entry& entry : entries) {
+            std::wstring fullPath = folder.path;
+            fullPath += m_backend.separator;
+            fullPath += entry.name;
+
+            if (entry.isFolder) {
+                size_t childId = AddFolder(fullPath);
+                folder.subfolders.emplace_back(std::move(entry.name), childId);
+                if (!m_shallow) Push(worker, { Task::Enumerate, childId, 0, 0 });
+            } else {
+                const std::wstring_view display = ShortcutDisplayName(entry.name);
+                if (display.empty()) continue;  // skip unrecognised files
+
+                MenuNode item;
+                item.isFolder = false;
+                item.lnkPath  = std::move(fullPath);  // S6.5: kept for icon extraction
+                SetNodeName(item, std::wstring(display));
+                folder.items.push_back(std::move(item));
+            }
+        }
+
+        // items is final now — hand out disjoint slices for resolution.
+        const size_t n = folder.items.size();
+        m_shortcuts.fetch_add(n, std::memory_order_relaxed);
+        for (size_t b = 0; b < n; b += kResolveBatch)
+            Push(worker, { Task::Resolve, id, b, (std::min)(n, b + kResolveBatch) });
+    }
+
+    void Resolve(const Task& task) {
+        FolderResult& folder = Folder(task.folder);
+        for (size_t i = task.begin; i < task.end; ++i) {
+            MenuNode& item = folder.items[i];
+            if (!m_backend.resolve(item.lnkPath, item.target, item.args))
+                CF_LOG(Warning, "ScanFolder: could not resolve shortcut, skipping entry");
+            // Unresolved slots keep an empty target and are dropped in Assemble().
+        }
+    }
+
+    /// Build the MenuNode for folder |id| and its subtree (single-threaded).
+    MenuNode Assemble(size_t id) {
+        FolderResult& src = m_folders[id];
+        MenuNode folder;
+        folder.isFolder   = true;
+        folder.folderPath = src.path;
+        folder.children.reserve(src.items.size() + src.subfolders.size());
+
+        for (auto& sub : src.subfolders) {
+            MenuNode child = Assemble(sub.second);
+            SetNodeName(child, std::move(sub.first));
+            child.childrenPending = m_shallow;
+            folder.children.push_back(std::move(child));
+        }
+        for (auto& item : src.items) {
+            if (item.target.empty()) continue;  // omit unresolvable shortcuts — no dead UI
+            folder.children.push_back(std::move(item));
+        }
+
+        // Stable: same-name shortcuts ("App.lnk" beside "App.url") keep the
+        // listing order, which PatchProgramTree reproduces.
+        std::stable_sort(folder.children.begin(), folder.children.end(), NodeLess);
+        return folder;
+    }
+};
+
+} // namespace
+
+std::vector<MenuNode> ScanAndMerge(const ScanBackend& backend, const std::wstring dirs[2],
+                                   unsigned threads, size_t& outShortcuts, bool& outFound,
+                                   bool shallow, ScanStageTimes* times) {
+    std::vector<std::wstring> scanRoots;
+    for (int i = 0; i < 2; ++i)
+        if (!dirs[i].empty()) scanRoots.push_back(dirs[i]);
+    outFound = !scanRoots.empty();
+
+    ParallelScanner scanner(backend, threads, shallow);
+    std::vector<MenuNode> scanned = scanner.Scan(scanRoots);
+    outShortcuts = scanner.ShortcutCount();
+
+    // 1. Common programs (%ProgramData%\Microsoft\Windows\Start Menu\Programs)
+    // 2. User programs (%AppData%\Microsoft\Windows\Start Menu\Programs) — overlaid on top
+    std::vector<MenuNode> tree;
+    size_t next = 0;
+    const auto t0 = std::chrono::steady_clock::now();
+    if (!dirs[0].empty()) tree = std::move(scanned[next++].children);
+    if (!dirs[1].empty()) MergeTree(tree, std::move(scanned[next++].children));
+    if (times) {
+        scanner.AddStageTimes(*times);
+        times->mergeUs += MicrosecondsSince(t0);
+    }
+    return tree;
+}
+
+// ── PatchProgramTree ──────────────────────────────────────────────────────────
+
+namespace {
+
+/// Incremental counterpart of a full scan: every operation looks at what is
+/// on disk now under both roots, never at what the record claimed.
+class TreePatcher {
+public:
+    TreePatcher(const ScanBackend& backend, std::vector<MenuNode>& tree,
+                const std::wstring roots[2], bool lazy)
+        : m_backend(backend), m_tree(tree), m_roots{ roots[0], roots[1] }, m_lazy(lazy) {}
+
+    /// Rescan |rel| as a folder in both roots and splice the result in.
+    void RebuildFolder(const std::wstring& rel) {
+        const std::wstring parentRel = ParentOf(rel);
+        std::vector<MenuNode>* parent = FindFolderChildren(parentRel);
+        if (!parent) {
+            // The chain above is not in the tree yet (new nested folders):
+            // rebuilding the nearest missing ancestor covers this one too.
+            if (!parentRel.empty()) RebuildFolder(parentRel);
+            return;
+        }
+
+        std::wstring dirs[2];
+        LevelDirs(rel, dirs);
+
+        const std::wstring leaf = LeafOf(rel);
+        auto it = FindChild(*parent, leaf, /*folder=*/true);
+
+        size_t shortcuts = 0;
+        bool   found     = false;
+        // One thread: an app install adds a handful of shortcuts, not a menu.
+        // A lazy tree gets the folder's own level, like any first opening.
+        std::vector<MenuNode> children = ScanAndMerge(m_backend, dirs, 1, shortcuts, found, m_lazy);
+        m_stats.shortcuts += shortcuts;
+        ++m_stats.folders;
+
+        if (!found) {
+            if (it != parent->end()) parent->erase(it);
+            return;
+        }
+
+        if (it != parent->end()) {
+            it->children        = std::move(children);
+            it->childrenPending = false;
+            it->folderPath      = !dirs[0].empty() ? dirs[0] : dirs[1];
+            it->hIcon           = nullptr;
+            return;
+        }
+
+        MenuNode node;
+        SetNodeName(node, leaf);
+        node.isFolder   = true;
+        node.folderPath = !dirs[0].empty() ? dirs[0] : dirs[1];
+        node.children   = std::move(children);
+        auto pos = std::lower_bound(parent->begin(), parent->end(), node, NodeLess);
+        parent->insert(pos, std::move(node));
+    }
+
+    /// Re-resolve the shortcuts shown under the display name of the file at
+    /// |rel|. A full scan merges every file of that name in the folder — both
+    /// roots, .lnk and .url — into one group, so the whole group is rebuilt
+    /// the same way: each root's matches in listing order, then MergeTree.
+    void SyncShortcut(const std::wstring& rel) {
+        const std::wstring parentRel = ParentOf(rel);
+        std::vector<MenuNode>* parent = FindFolderChildren(parentRel);
+        if (!parent) {
+            if (!parentRel.empty()) RebuildFolder(parentRel);
+            return;
+        }
+        const std::wstring leaf = LeafOf(rel);
+        const std::wstring_view display = ShortcutDisplayName(leaf);
+        if (display.empty()) return;   // not a file the tree shows
+
+        std::wstring dirs[2];
+        LevelDirs(parentRel, dirs);
+        std::vector<MenuNode> group[2];
+        std::vector<ScanBackend::Entry> entries;
+        for (int i = 0; i < 2; ++i) {
+            if (dirs[i].empty()) continue;
+            entries.clear();
+            m_backend.listFolder(dirs[i], entries);
+            for (ScanBackend::Entry& entry : entries) {
+                if (entry.isFolder || CompareNodeNames(ShortcutDisplayName(entry.name), display) != 0)
+                    continue;
+                MenuNode item;
+                item.isFolder = false;
+                item.lnkPath  = dirs[i] + m_backend.separator + entry.name;
+                SetNodeName(item, std::wstring(ShortcutDisplayName(entry.name)));
+                ++m_stats.shortcuts;
+                if (m_backend.resolve(item.lnkPath, item.target, item.args))
+                    group[i].push_back(std::move(item));
+            }
+        }
+        MergeTree(group[0], std::move(group[1]));
+
+        // Swap the old group for the new one in the same sorted position.
+        MenuNode probe;
+        probe.isFolder = false;
+        SetNodeName(probe, std::wstring(display));
+        auto range = std::equal_range(parent->begin(), parent->end(), probe, NodeLess);
+        auto pos   = parent->erase(range.first, range.second);
+        parent->insert(pos, std::make_move_iterator(group[0].begin()),
+                       std::make_move_iterator(group[0].end()));
+    }
+
+    bool HasFolder(const std::wstring& rel) {
+        std::vector<MenuNode>* parent = FindFolderChildren(ParentOf(rel));
+        return parent && FindChild(*parent, LeafOf(rel), /*folder=*/true) != parent->end();
+    }
+
+    /// True when some folder above |rel| is still childrenPending: nothing
+    /// below it is in the tree, and it is scanned fresh when first opened.
+    bool IsInsidePendingFolder(const std::wstring& rel) {
+        std::vector<MenuNode>* level = &m_tree;
+        size_t pos = 0;
+        for (;;) {
+            const size_t slash = rel.find(L'\\', pos);
+            if (slash == std::wstring::npos) return false;
+            auto it = FindChild(*level, rel.substr(pos, slash - pos), /*folder=*/true);
+            if (it == level->end()) return false;
+            if (it->childrenPending) return true;
+            level = &it->children;
+            pos = slash + 1;
+        }
+    }
+
+    bool IsDirectoryOnDisk(const std::wstring& rel) const {
+        for (int i = 0; i < 2; ++i)
+            if (!m_roots[i].empty() && m_backend.isFolder(OnDisk(i, rel))) return true;
+        return false;
+    }
+
+    ProgramTreePatchStats m_stats;
+
+private:
+    const ScanBackend&     m_backend;
+    std::vector<MenuNode>& m_tree;
+    std::wstring           m_roots[2];
+    bool                   m_lazy;
+
+    static std::wstring ParentOf(const std::wstring& rel) {
+        auto slash = rel.rfind(L'\\');
+        return slash == std::wstring::npos ? std::wstring() : rel.substr(0, slash);
+    }
+
+    static std::wstring LeafOf(const std::wstring& rel) {
+        auto slash = rel.rfind(L'\\');
+        return slash == std::wstring::npos ? rel : rel.substr(slash + 1);
+    }
+
+    /// |rel| under root |i|, with the backend's separator.
+    std::wstring OnDisk(int i, const std::wstring& rel) const {
+        std::wstring path = m_roots[i];
+        if (rel.empty()) return path;
+        path += m_backend.separator;
+        for (wchar_t c : rel) path += c == L'\\' ? m_backend.separator : c;
+        return path;
+    }
+
+    /// The folder |rel| under each root, or empty where that root lacks it.
+    /// A record names the path in the letter case of the root it came from;
+    /// the other root's copy may differ, which only a case-sensitive file
+    /// system notices, so there a miss looks each component up folded.
+    void LevelDirs(const std::wstring& rel, std::wstring dirs[2]) const {
+        for (int i = 0; i < 2; ++i) {
+            dirs[i].clear();
+            if (m_roots[i].empty()) continue;
+            std::wstring full = OnDisk(i, rel);
+            if (m_backend.isFolder(full)) dirs[i] = std::move(full);
+#if !defined(_WIN32)
+            else dirs[i] = FindFolderFolded(m_roots[i], rel);
+#endif
+        }
+    }
+
+#if !defined(_WIN32)
+    std::wstring FindFolderFolded(std::wstring dir, const std::wstring& rel) const {
+        if (!m_backend.isFolder(dir)) return {};
+        std::vector<ScanBackend::Entry> entries;
+        size_t pos = 0;
+        while (pos < rel.size()) {
+            size_t slash = rel.find(L'\\', pos);
+            if (slash == std::wstring::npos) slash = rel.size();
+            const std::wstring_view part(rel.data() + pos, slash - pos);
+            entries.clear();
+            m_backend.listFolder(dir, entries);
+            auto it = std::find_if(entries.begin(), entries.end(), [&](const ScanBackend::Entry& e) {
+                return e.isFolder && CompareNodeNames(e.name, part) == 0;
+            });
+            if (it == entries.end()) return {};
+            dir += m_backend.separator;
+            dir += it->name;
+            pos = slash + 1;
+        }
+        return dir;
+    }
+#endif
+
+    static std::vector<MenuNode>::iterator FindChild(std::vector<MenuNode>& nodes,
+                                                     const std::wstring& name, bool folder) {
+        MenuNode probe;
+        probe.isFolder = folder;
+        SetNodeName(probe, name);
+        return std::find_if(nodes.begin(), nodes.end(), [&](const MenuNode& n) {
+            return SameNodeKey(n, probe);
+        });
+    }
+
+    /// Children of the merged folder at |rel| ("" = top level), or nullptr.
+    std::vector<MenuNode>* FindFolderChildren(const std::wstring& rel) {
+        std::vector<MenuNode>* level = &m_tree;
+        size_t pos = 0;
+        while (pos < rel.size()) {
+            size_t slash = rel.find(L'\\', pos);
+            if (slash == std::wstring::npos) slash = rel.size();
+            auto it = FindChild(*level, rel.substr(pos, slash - pos), /*folder=*/true);
+            if (it == level->end()) return nullptr;
+            level = &it->children;
+            pos = slash + 1;
+        }
+        return level;
+    }
+};
+
+/// |path| lies strictly below |folder| (both root-relative), folded.
+bool IsUnderFolder(const std::wstring& path, const std::wstring& folder) {
+    return path.size() > folder.size() && path[folder.size()] == L'\\' &&
+           CompareNodeNames(std::wstring_view(path).substr(0, folder.size()), folder) == 0;
+}
+
+} // namespace
+
+void PatchProgramTree(const ScanBackend& backend, const std::wstring roots[2],
+                      std::vector<MenuNode>& tree, const std::vector<ProgramTreeChange>& changes,
+                      bool lazy, ProgramTreePatchStats* stats) {
+    TreePatcher patcher(backend, tree, roots, lazy);
+
+    // Collapse duplicate records (an install touches the same file several
+    // times) — the final disk state is all that matters.
+    std::vector<ProgramTreeChange> unique(changes);
+    std::sort(unique.begin(), unique.end(), [](const ProgramTreeChange& a, const ProgramTreeChange& b) {
+        return CompareNodeNames(a.relativePath, b.relativePath) < 0;
+    });
+
+    // Pass 1: folders to rescan. A Modified record on a folder only echoes
+    // changes to its children, which have their own records.
+    std::vector<std::wstring> folders;
+    std::vector<std::wstring> files;
+    for (const ProgramTreeChange& c : unique) {
+        if (c.relativePath.empty()) continue;
+        if (patcher.IsInsidePendingFolder(c.relativePath)) { ++patcher.m_stats.deferred; continue; }
+        const bool dirNow = patcher.IsDirectoryOnDisk(c.relativePath);
+        if (dirNow && c.kind == ProgramTreeChange::Modified) continue;
+        std::vector<std::wstring>& into = dirNow || patcher.HasFolder(c.relativePath) ? folders : files;
+        if (into.empty() || CompareNodeNames(into.back(), c.relativePath) != 0)
+            into.push_back(c.relativePath);
+    }
+
+    // Sorted order puts an ancestor before its descendants, so a folder inside
+    // an already rescanned subtree can be skipped.
+    std::vector<std::wstring> rescanned;
+    auto covered = [&](const std::wstring& path) {
+        return std::any_of(rescanned.begin(), rescanned.end(),
+                           [&](const std::wstring& r) { return IsUnderFolder(path, r); });
+    };
+    for (const auto& f : folders) {
+        if (covered(f)) continue;
+        patcher.RebuildFolder(f);
+        rescanned.push_back(f);
+    }
+
+    // Pass 2: individual shortcuts outside the rescanned subtrees.
+    for (const auto& f : files) {
+        if (!covered(f)) patcher.SyncShortcut(f);
+    }
+    if (stats) *stats = patcher.m_stats;
+}
+
+// ── FileSystemScanBackend ─────────────────────────────────────────────────────
+
+#if defined(_WIN32)
+std::filesystem::path ToFsPath(std::wstring_view path) { return std::filesystem::path(path); }
+std::wstring FromFsPath(const std::filesystem::path& path) { return path.wstring(); }
+#else
+std::filesystem::path ToFsPath(std::wstring_view path) {
+    std::string utf8;
+    utf8.reserve(path.size());
+    for (size_t i = 0; i < path.size(); ++i) {
+        std::uint32_t c = static_cast<std::uint32_t>(path[i]);
+        if constexpr (sizeof(wchar_t) == 2) {
+            if (c >= 0xD800 && c < 0xDC00 && i + 1 < path.size() &&
+                path[i + 1] >= 0xDC00 && path[i + 1] < 0xE000)
+                c = 0x10000 + ((c - 0xD800) << 10) + (static_cast<std::uint32_t>(path[++i]) - 0xDC00);
+        }
+        if ((c >= 0xD800 && c < 0xE000) || c > 0x10FFFF) c = 0xFFFD;
+        if (c < 0x80) {
+            utf8 += static_cast<char>(c);
+        } else if (c < 0x800) {
+            utf8 += static_cast<char>(0xC0 | (c >> 6));
+            utf8 += static_cast<char>(0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            utf8 += static_cast<char>(0xE0 | (c >> 12));
+            utf8 += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            utf8 += static_cast<char>(0x80 | (c & 0x3F));
+        } else {
+            utf8 += static_cast<char>(0xF0 | (c >> 18));
+            utf8 += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+            utf8 += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            utf8 += static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+    return std::filesystem::path(std::move(utf8));
+}
+
+std::wstring FromFsPath(const std::filesystem::path& path) {
+    const std::string& utf8 = path.native();
+    std::wstring out;
+    out.reserve(utf8.size());
+    auto append = [&out](std::uint32_t c) {
+        if (sizeof(wchar_t) == 2 && c >= 0x10000) {
+            c -= 0x10000;
+            out += static_cast<wchar_t>(0xD800 + (c >> 10));
+            out += static_cast<wchar_t>(0xDC00 + (c & 0x3FF));
+        } else {
+            out += static_cast<wchar_t>(c);
+        }
+    };
+    for (size_t i = 0; i < utf8.size();) {
+        const auto lead = static_cast<std::uint8_t>(utf8[i]);
+        const size_t len = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3
+                                           : (lead >> 3) == 0x1E ? 4 : 0;
+        std::uint32_t c = len == 1 ? lead : len == 2 ? (lead & 0x1F) : len == 3 ? (lead & 0x0F) : (lead & 0x07);
+        bool ok = len != 0 && i + len <= utf8.size();
+        for (size_t k = 1; ok && k < len; ++k) {
+            const auto cont = static_cast<std::uint8_t>(utf8[i + k]);
+            ok = (cont & 0xC0) == 0x80;
+            c  = (c << 6) | (cont & 0x3F);
+        }
+        static constexpr std::uint32_t kMin[5] = { 0, 0, 0x80, 0x800, 0x10000 };
+        if (!ok || c < kMin[len] || c > 0x10FFFF || (c >= 0xD800 && c < 0xE000)) {
+            append(0xFFFD);
+            ++i;
+            continue;
+        }
+        append(c);
+        i += len;
+    }
+    return out;
+}
+#endif
+
+namespace {
+
+/// Same cap as the Win32 backend: real shortcuts are a few KB.
+constexpr std::uintmax_t kMaxShortcutFileSize = 64 * 1024;
+
+bool ReadShortcutFile(const std::wstring& path, std::vector<std::uint8_t>& buffer) {
+    std::error_code ec;
+    const std::uintmax_t size = std::filesystem::file_size(ToFsPath(path), ec);
+    if (ec || size == 0 || size > kMaxShortcutFileSize) return false;
+    std::ifstream f(ToFsPath(path), std::ios::binary);
+    buffer.resize(static_cast<size_t>(size));
+    return f.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(size)) &&
+           f.gcount() == static_cast<std::streamsize>(size);
+}
+
+void ListFolderStd(const std::wstring& dir, std::vector<ScanBackend::Entry>& out) {
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(ToFsPath(dir), ec), end;
+         !ec && it != end; it.increment(ec)) {
+        std::wstring name = FromFsPath(it->path().filename());
+        if (name.empty() || name[0] == L'.') continue;
+        std::error_code typeEc;
+        const bool isFolder = it->is_directory(typeEc);
+        if (typeEc) continue;
+        out.push_back({ std::move(name), isFolder });
+    }
+}
+
+bool IsFolderStd(const std::wstring& path) {
+    const std::filesystem::path p = ToFsPath(path);
+    const std::wstring name = FromFsPath(p.filename());
+    if (!name.empty() && name[0] == L'.') return false;   // hidden, as in ListFolderStd
+    std::error_code ec;
+    return std::filesystem::is_directory(p, ec);
+}
+
+bool ResolveShortcutStd(const std::wstring& path, std::wstring& target, std::wstring& args) {
+    target.clear();
+    args.clear();
+    thread_local std::vector<std::uint8_t> fileBytes;
+    if (!ReadShortcutFile(path, fileBytes)) return false;
+    if (HasExtension(path, L".lnk")) {
+        thread_local ShellLinkInfo link;
+        if (!ParseShellLink(fileBytes.data(), fileBytes.size(), link)) return false;
+        target = link.target;
+        args   = link.arguments;
+        return true;
+    }
+    thread_local InternetShortcutInfo shortcut;
+    if (!ParseInternetShortcut(fileBytes.data(), fileBytes.size(), shortcut)) return false;
+    target = shortcut.url;
+    return true;
+}
+
+} // namespace
+
+const ScanBackend& FileSystemScanBackend() {
+    static const ScanBackend backend = [] {
+        ScanBackend b;
+        b.listFolder = ListFolderStd;
+        b.resolve    = ResolveShortcutStd;
+        b.isFolder   = IsFolderStd;
+        b.separator  = static_cast<wchar_t>(std::filesystem::path::preferred_separator);
+        return b;
+    }();
+    return backend;
+}
+
+} // namespace GlassBar
@@ -0,0 +1,224 @@
+#pragma once
+#include "NameFold.h"        // FoldNameChar
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(_WIN32)
+#include <Windows.h>         // HICON
+#else
+struct HICON__;
+typedef HICON__* HICON;      // opaque off Windows; always null there
+#endif
+
+namespace GlassBar {
+
+// ── Program tree ──────────────────────────────────────────────────────────────
+// The builder form of the All Programs tree and everything that shapes it
+// without touching Win32: node collation, the common/user merge, the
+// parallel scan and watcher patches, which reach the file system only through
+// a ScanBackend.
+// AllProgramsEnumerator supplies the Win32 backend (FindFirstFileExW, COM
+// fallback); FileSystemScanBackend() runs the same pipeline anywhere, which
+// is what the tests and benchmarks use.
+
+/// <summary>
+/// One node in the All Programs tree.
+/// Leaf nodes (isFolder == false) hold a resolved launch target.
+/// Folder nodes have their children populated after BuildAllProgramsTree().
+/// </summary>
+struct MenuNode {
+    std::wstring          name;        // Display name (no file extension)
+    bool                  isFolder;    // true  → children populated; target/args unused
+    std::wstring          target;      // Resolved exe / URL (empty for folders)
+    std::wstring          args;        // Command-line arguments from .lnk (may be empty)
+    std::wstring          folderPath;  // Absolute filesystem path (folders only)
+    std::wstring          lnkPath;     // S6.5: original .lnk/.url file path (shortcuts only)
+    HICON                 hIcon = nullptr; // S6.5: loaded by StartMenuWindow::Initialize();
+                                           // never set during BuildAllProgramsTree() so
+                                           // MergeTree/sort operate safely on null handles.
+    std::uint64_t         sortKey = 0; // MakeNameSortKey(name) — set via SetNodeName()
+    bool                  childrenPending = false; // lazy scan: folder not enumerated yet
+                                                   // (children empty until expanded)
+    std::vector<MenuNode> children;    // Sub-items (folders first, then shortcuts, alpha)
+};
+
+// ── Name collation ────────────────────────────────────────────────────────────
+
+/// Number of leading UTF-16 units packed into a sort key.
+constexpr size_t kSortKeyChars = 4;
+
+/// <summary>
+/// Collation prefix for |name|: the first kSortKeyChars folded UTF-16 units,
+/// 16 bits each, most significant first and zero-padded. Unsigned integer
+/// order of two keys is the folded order of those prefixes, so sorting
+/// compares integers and only falls back to CompareNodeNames() on a tie.
+/// The top 16 bits are the folded initial, which is what jump tables use.
+/// </summary>
+std::uint64_t MakeNameSortKey(std::wstring_view name);
+
+/// Folded three-way comparison (&lt;0, 0, &gt;0) of two whole names.
+int CompareNodeNames(std::wstring_view a, std::wstring_view b);
+
+/// Assign |name| and its sort key together. Every place that creates or
+/// renames a MenuNode goes through this so the key never goes stale.
+inline void SetNodeName(MenuNode& node, std::wstring name) {
+    node.sortKey = MakeNameSortKey(name);
+    node.name    = std::move(name);
+}
+
+/// <summary>
+/// All Programs ordering: folders first, then by sort key, then (only when
+/// the keys tie) by the rest of the folded name.
+/// </summary>
+bool NodeLess(const MenuNode& a, const MenuNode& b);
+
+/// Same name and kind under NodeLess — the merge / dedup identity.
+bool SameNodeKey(const MenuNode& a, const MenuNode& b);
+
+/// <summary>
+/// Display name of a shortcut file the tree shows (|fileName| minus a .lnk or
+/// .url extension, any case), or empty for any other file.
+/// </summary>
+std::wstring_view ShortcutDisplayName(std::wstring_view fileName);
+
+// ── Merge ─────────────────────────────────────────────────────────────────────
+
+/// <summary>
+/// Merge overlay tree INTO base (user-profile overlays common programs).
+/// Same-name folder → recursive merge; same-name shortcut → overlay wins.
+///
+/// Both levels arrive sorted by NodeLess (every scanned folder is sorted), so
+/// this is a linear merge of two sorted lists: O(n + m) per level and no
+/// re-sort afterwards. Unsorted input is sorted once up front.
+///
+/// Within one key group the result matches the old find_if-based merge:
+/// every overlay node folds into the FIRST base node of that key (later base
+/// duplicates, e.g. "App.lnk" + "App.url" in the common root, are kept), and
+/// with no base match the overlay group collapses to its last entry.
+/// </summary>
+void MergeTree(std::vector<MenuNode>& base, std::vector<MenuNode>&& overlay);
+
+// ── Scan ──────────────────────────────────────────────────────────────────────
+
+/// <summary>
+/// Platform side of a scan. The scanner calls these from its workers, several
+/// at a time, so they must be thread-safe.
+/// </summary>
+struct ScanBackend {
+    struct Entry {
+        std::wstring name;               // file or folder name, no path
+        bool         isFolder = false;
+    };
+
+    /// Append the visible entries of |dir| to |out| (hidden and system
+    /// entries and . / .. left out). A folder that cannot be listed adds
+    /// nothing. Files other than shortcuts are fine; the scanner skips them.
+    std::function<void(const std::wstring& dir, std::vector<Entry>& out)> listFolder;
+
+    /// Resolve the shortcut at |path|; false drops it from the tree.
+    std::function<bool(const std::wstring& path, std::wstring& target, std::wstring& args)> resolve;
+
+    /// Whether |path| is a folder listFolder would report. Patching checks
+    /// single paths with it rather than listing their parent.
+    std::function<bool(const std::wstring& path)> isFolder;
+
+    /// Run on each extra worker thread before its first task and after its
+    /// last (COM setup on Windows). The calling thread is not included.
+    std::function<void()> threadStart;
+    std::function<void()> threadStop;
+
+    wchar_t separator = L'\\';           // joins a folder path and an entry name
+};
+
+/// <summary>
+/// std::filesystem listing and the native .lnk / .url parsers, without
+/// fallbacks: shortcuts ParseShellLink or ParseInternetShortcut decline are
+/// dropped. Names starting with '.' count as hidden. Uses the platform's
+/// preferred separator.
+/// </summary>
+const ScanBackend& FileSystemScanBackend();
+
+/// |path| as a std::filesystem path. Off Windows, file names are taken to be
+/// UTF-8 rather than converted through the C locale, which would throw on
+/// any non-ASCII name. Unpaired surrogates and invalid bytes become U+FFFD.
+std::filesystem::path ToFsPath(std::wstring_view path);
+std::wstring          FromFsPath(const std::filesystem::path& path);
+
+/// Time spent in each stage of one scan, for the build log. Worker stages
+/// are summed over all pool threads, so they can exceed the wall time.
+struct ScanStageTimes {
+    std::uint64_t enumerateUs = 0;   // listFolder walks
+    std::uint64_t resolveUs   = 0;   // resolve calls
+    std::uint64_t assembleUs  = 0;   // building + sorting MenuNode levels
+    std::uint64_t mergeUs     = 0;   // common/user MergeTree
+};
+
+/// <summary>
+/// Scan the same relative location under both roots and merge the results:
+/// common (|dirs|[0]) first, user (|dirs|[1]) overlaid on top. Empty entries
+/// in |dirs| are skipped; |outFound| is false when neither was scanned.
+///
+/// Both are walked by one work-stealing pool of |threads| workers (at least
+/// one; the calling thread is worker 0). Folder enumeration and shortcut
+/// resolution are separate tasks, so a single huge folder is still resolved
+/// in parallel, and the result is identical to a sequential scan.
+///
+/// |shallow| limits the scan to |dirs| themselves: subfolders come back with
+/// childrenPending set and no children. Stage times are added to |times|
+/// when given.
+/// </summary>
+std::vector<MenuNode> ScanAndMerge(const ScanBackend& backend, const std::wstring dirs[2],
+                                   unsigned threads, size_t& outShortcuts, bool& outFound,
+                                   bool shallow = false, ScanStageTimes* times = nullptr);
+
+// ── Patch ─────────────────────────────────────────────────────────────────────
+
+/// <summary>
+/// One record from a change notification on either Programs root
+/// (ReadDirectoryChangesW on Windows). Renames arrive as a Removed (old name)
+/// + Added (new name) pair.
+/// </summary>
+struct ProgramTreeChange {
+    enum Kind { Added, Removed, Modified } kind;
+    std::wstring relativePath;   // root-relative, '\\'-separated, e.g. L"Vendor\\App.lnk"
+};
+
+/// What one patch did, for the log.
+struct ProgramTreePatchStats {
+    size_t folders   = 0;   // folders rescanned
+    size_t shortcuts = 0;   // shortcuts (re)resolved
+    size_t deferred  = 0;   // records inside folders still childrenPending
+};
+
+/// <summary>
+/// Patch |tree|, as ScanAndMerge() built it from |roots| (common, user), in
+/// place so it reflects |changes|, touching only the affected nodes. The
+/// result is what a full scan of both roots would give now.
+///
+/// Each changed path is re-synchronised against the current disk state of
+/// BOTH roots, so records may be duplicated, reordered or stale:
+///   • a path that is (or was) a folder → that folder's subtree is rescanned
+///     in both roots and merged as in a full build, or removed if gone;
+///   • a .lnk/.url path → every shortcut with that display name in its
+///     folder is re-resolved, in both roots and both extensions, and merged
+///     as in a full build (so a surviving same-name shortcut takes the place
+///     of a removed one);
+///   • Modified records on folders are ignored (they follow child changes).
+/// Paths under a rescanned folder, or inside a folder that is still
+/// childrenPending (it is scanned fresh when first opened), are skipped.
+/// New/changed nodes come back with hIcon == nullptr; untouched nodes keep
+/// their icons. With |lazy| a rescanned folder gets one level, its
+/// subfolders childrenPending, as a shallow scan does.
+///
+/// Runs on the calling thread; |backend| needs isFolder.
+/// </summary>
+void PatchProgramTree(const ScanBackend& backend, const std::wstring roots[2],
+                      std::vector<MenuNode>& tree, const std::vector<ProgramTreeChange>& changes,
+                      bool lazy = false, ProgramTreePatchStats* stats = nullptr);
+
+} // namespace GlassBar
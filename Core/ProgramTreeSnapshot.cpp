@@ -0,0 +1,343 @@
+#include "ProgramTreeSnapshot.h"
+#include "Diagnostics.h"
+
+#include <shlobj.h>       // SHGetKnownFolderPath, FOLDERID_*
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <mutex>
+
+namespace GlassBar {
+
+// ── On-disk layout ────────────────────────────────────────────────────────────
+
+namespace {
+
+constexpr std::uint32_t kSnapshotMagic   = 0x54504247;  // 'GBPT'
+constexpr std::uint32_t kSnapshotVersion = 2;   // 2: NodeLess collation-key order
+
+enum SnapshotString : std::uint32_t {
+    StrName, StrTarget, StrArgs, StrFolderPath, StrLnkPath, StrCount
+};
+
+struct SnapshotHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t pathHash;
+    std::uint64_t commonStamp;
+    std::uint64_t userStamp;
+    std::uint32_t nodeCount;
+    std::uint32_t rootCount;
+    std::uint32_t charCount;
+    std::uint32_t reserved;
+};
+static_assert(sizeof(SnapshotHeader) == 48, "snapshot header layout changed");
+
+struct SnapshotNode {
+    std::uint32_t strOffset[StrCount];   // in wchar_t units into the pool
+    std::uint32_t strLength[StrCount];
+    std::uint32_t firstChild;
+    std::uint32_t childCount;
+    std::uint32_t isFolder;              // kNode* flags
+};
+static_assert(sizeof(SnapshotNode) == 52, "snapshot node layout changed");
+
+static_assert(sizeof(wchar_t) == 2, "snapshot string pool assumes UTF-16 wchar_t");
+
+constexpr std::uint32_t kNodeFolder  = 0x1;
+constexpr std::uint32_t kNodePending = 0x2;   // lazy tree: folder not expanded yet
+
+std::uint64_t FileTimeToU64(const FILETIME& ft) {
+    return (static_cast<std::uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+}
+
+/// FNV-1a over the UTF-16 code units.
+std::uint64_t HashPath(const std::wstring& s, std::uint64_t h) {
+    for (wchar_t c : s) {
+        h ^= static_cast<std::uint16_t>(c);
+        h *= 0x100000001B3ull;
+    }
+    h ^= 0xFFFF;   // separator, so ("ab","c") != ("a","bc")
+    h *= 0x100000001B3ull;
+    return h;
+}
+
+std::wstring ResolveKnownFolder(REFKNOWNFOLDERID id) {
+    PWSTR p = nullptr;
+    std::wstring result;
+    if (SUCCEEDED(SHGetKnownFolderPath(id, KF_FLAG_DEFAULT, nullptr, &p)) && p)
+        result = p;
+    if (p) CoTaskMemFree(p);
+    return result;
+}
+
+std::uint64_t ReadDirStamp(const std::wstring& dir) {
+    WIN32_FILE_ATTRIBUTE_DATA fad = {};
+    if (dir.empty() || !GetFileAttributesExW(dir.c_str(), GetFileExInfoStandard, &fad))
+        return 0;
+    return FileTimeToU64(fad.ftLastWriteTime);
+}
+
+// ── Serialisation ─────────────────────────────────────────────────────────────
+
+class SnapshotWriter {
+public:
+    void Write(const std::vector<MenuNode>& tree) {
+        // Breadth-first: each node's children are appended as one contiguous
+        // run, so a child index is always greater than its parent's.
+        std::deque<const std::vector<MenuNode>*> pendingChildren;
+
+        AppendLevel(tree);
+        pendingChildren.push_back(&tree);
+        std::uint32_t next = 0;
+        while (!pendingChildren.empty()) {
+            const std::vector<MenuNode>& level = *pendingChildren.front();
+            pendingChildren.pop_front();
+            for (const MenuNode& n : level) {
+                SnapshotNode& rec = m_nodes[next++];
+                rec.firstChild = static_cast<std::uint32_t>(m_nodes.size());
+                rec.childCount = static_cast<std::uint32_t>(n.children.size());
+                if (!n.children.empty()) {
+                    AppendLevel(n.children);
+                    pendingChildren.push_back(&n.children);
+                }
+            }
+        }
+    }
+
+    std::vector<SnapshotNode> m_nodes;
+    std::wstring              m_pool;
+
+private:
+    void AppendLevel(const std::vector<MenuNode>& level) {
+        for (const MenuNode& n : level) {
+            SnapshotNode rec = {};
+            AddString(rec, StrName,       n.name);
+            AddString(rec, StrTarget,     n.target);
+            AddString(rec, StrArgs,       n.args);
+            AddString(rec, StrFolderPath, n.folderPath);
+            AddString(rec, StrLnkPath,    n.lnkPath);
+            rec.isFolder = (n.isFolder ? kNodeFolder : 0) |
+                           (n.childrenPending ? kNodePending : 0);
+            m_nodes.push_back(rec);
+        }
+    }
+
+    void AddString(SnapshotNode& rec, SnapshotString which, const std::wstring& s) {
+        rec.strOffset[which] = static_cast<std::uint32_t>(m_pool.size());
+        rec.strLength[which] = static_cast<std::uint32_t>(s.size());
+        m_pool += s;
+    }
+};
+
+// ── Deserialisation ───────────────────────────────────────────────────────────
+
+class SnapshotReader {
+public:
+    SnapshotReader(const SnapshotNode* nodes, std::uint32_t nodeCount,
+                   const wchar_t* pool, std::uint32_t charCount)
+        : m_nodes(nodes), m_nodeCount(nodeCount), m_pool(pool), m_charCount(charCount) {}
+
+    /// Check every string range, then view each record's strings in place
+    /// (no copy) for MenuTree::AssignRecords(), which checks the child runs.
+    bool Read(std::vector<MenuTreeRecord>& out) const {
+        out.resize(m_nodeCount);
+        for (std::uint32_t i = 0; i < m_nodeCount; ++i) {
+            const SnapshotNode& n = m_nodes[i];
+            for (int s = 0; s < StrCount; ++s) {
+                if (n.strOffset[s] > m_charCount ||
+                    n.strLength[s] > m_charCount - n.strOffset[s])
+                    return false;
+            }
+            MenuTreeRecord& r = out[i];
+            r.name            = String(n, StrName);
+            r.target          = String(n, StrTarget);
+            r.args            = String(n, StrArgs);
+            r.folderPath      = String(n, StrFolderPath);
+            r.lnkPath         = String(n, StrLnkPath);
+            r.firstChild      = n.firstChild;
+            r.childCount      = n.childCount;
+            r.isFolder        = (n.isFolder & kNodeFolder) != 0;
+            r.childrenPending = (n.isFolder & kNodePending) != 0;
+        }
+        return true;
+    }
+
+private:
+    std::wstring_view String(const SnapshotNode& rec, SnapshotString which) const {
+        return std::wstring_view(m_pool + rec.strOffset[which], rec.strLength[which]);
+    }
+
+    const SnapshotNode* m_nodes;
+    std::uint32_t       m_nodeCount;
+    const wchar_t*      m_pool;
+    std::uint32_t       m_charCount;
+};
+
+bool NodesEqual(const MenuNode& a, const MenuNode& b) {
+    return a.isFolder   == b.isFolder   &&
+           a.childrenPending == b.childrenPending &&
+           a.name       == b.name       &&
+           a.target     == b.target     &&
+           a.args       == b.args       &&
+           a.folderPath == b.folderPath &&
+           a.lnkPath    == b.lnkPath    &&
+           ProgramTreesEqual(a.children, b.children);
+}
+
+std::mutex g_snapshotWriteMutex;
+
+} // namespace
+
+// ── Public API ────────────────────────────────────────────────────────────────
+
+bool ReadProgramTreeKey(ProgramTreeKey& outKey) {
+    std::wstring roots[2];
+    ResolveProgramsRoots(roots);
+    const std::wstring& common = roots[0];
+    const std::wstring& user   = roots[1];
+    if (common.empty() && user.empty()) return false;
+
+    outKey.pathHash    = HashPath(user, HashPath(common, 0xCBF29CE484222325ull));
+    outKey.commonStamp = ReadDirStamp(common);
+    outKey.userStamp   = ReadDirStamp(user);
+    return true;
+}
+
+std::wstring GetProgramTreeSnapshotPath() {
+    const std::wstring lap = ResolveKnownFolder(FOLDERID_LocalAppData);
+    if (lap.empty()) return {};
+    return lap + L"\\GlassBar\\programs_tree.bin";
+}
+
+bool LoadProgramTreeSnapshot(const std::wstring& path, const ProgramTreeKey& key,
+                             MenuTree& outTree) {
+    outTree.Clear();
+    if (path.empty()) return false;
+
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size = {};
+    if (!GetFileSizeEx(file, &size) ||
+        size.QuadPart < static_cast<LONGLONG>(sizeof(SnapshotHeader)) ||
+        size.QuadPart > 0x7FFFFFFF) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) return false;
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view) return false;
+
+    const auto* bytes = static_cast<const std::uint8_t*>(view);
+    const auto* hdr   = reinterpret_cast<const SnapshotHeader*>(bytes);
+    const std::uint64_t expected =
+        sizeof(SnapshotHeader) +
+        static_cast<std::uint64_t>(hdr->nodeCount) * sizeof(SnapshotNode) +
+        static_cast<std::uint64_t>(hdr->charCount) * sizeof(wchar_t);
+
+    bool ok = hdr->magic       == kSnapshotMagic   &&
+              hdr->version     == kSnapshotVersion &&
+              hdr->pathHash    == key.pathHash     &&
+              hdr->commonStamp == key.commonStamp  &&
+              hdr->userStamp   == key.userStamp    &&
+              expected == static_cast<std::uint64_t>(size.QuadPart);
+
+    if (ok) {
+        const auto* nodes = reinterpret_cast<const SnapshotNode*>(bytes + sizeof(SnapshotHeader));
+        const auto* pool  = reinterpret_cast<const wchar_t*>(nodes + hdr->nodeCount);
+        SnapshotReader reader(nodes, hdr->nodeCount, pool, hdr->charCount);
+        // The file's node table already is the arena's breadth-first layout:
+        // records go straight into |outTree| while the view is still mapped.
+        std::vector<MenuTreeRecord> records;
+        ok = reader.Read(records) && MenuTree::RecordsValid(records, hdr->rootCount);
+        if (ok)
+            outTree.AssignRecords(records, hdr->rootCount);
+        else
+            CF_LOG(Warning, "LoadProgramTreeSnapshot: corrupt node table, ignoring snapshot");
+    }
+
+    UnmapViewOfFile(view);
+    return ok;
+}
+
+bool SaveProgramTreeSnapshot(const std::wstring& path, const ProgramTreeKey& key,
+                             const std::vector<MenuNode>& tree) {
+    if (path.empty()) return false;
+
+    SnapshotWriter writer;
+    writer.Write(tree);
+
+    SnapshotHeader hdr = {};
+    hdr.magic       = kSnapshotMagic;
+    hdr.version     = kSnapshotVersion;
+    hdr.pathHash    = key.pathHash;
+    hdr.commonStamp = key.commonStamp;
+    hdr.userStamp   = key.userStamp;
+    hdr.nodeCount   = static_cast<std::uint32_t>(writer.m_nodes.size());
+    hdr.rootCount   = static_cast<std::uint32_t>(tree.size());
+    hdr.charCount   = static_cast<std::uint32_t>(writer.m_pool.size());
+
+    std::lock_guard<std::mutex> lk(g_snapshotWriteMutex);
+
+    const std::wstring dir = path.substr(0, path.find_last_of(L'\\'));
+    CreateDirectoryW(dir.c_str(), NULL);
+
+    const std::wstring tmp = path + L".tmp";
+    HANDLE file = CreateFileW(tmp.c_str(), GENERIC_WRITE, 0, nullptr,
+                              CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        CF_LOG(Warning, "SaveProgramTreeSnapshot: cannot create temp file, error=" << GetLastError());
+        return false;
+    }
+
+    auto writeAll = [file](const void* data, size_t len) {
+        DWORD written = 0;
+        return WriteFile(file, data, static_cast<DWORD>(len), &written, nullptr) &&
+               written == len;
+    };
+    bool ok = writeAll(&hdr, sizeof(hdr)) &&
+              writeAll(writer.m_nodes.data(), writer.m_nodes.size() * sizeof(SnapshotNode)) &&
+              writeAll(writer.m_pool.data(), writer.m_pool.size() * sizeof(wchar_t));
+    CloseHandle(file);
+
+    if (ok)
+        ok = MoveFileExW(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != FALSE;
+    if (!ok) {
+        CF_LOG(Warning, "SaveProgramTreeSnapshot: write failed, error=" << GetLastError());
+        DeleteFileW(tmp.c_str());
+    }
+    return ok;
+}
+
+std::vector<MenuNode> BuildProgramTreeWithSnapshot(bool lazy, const std::vector<MenuNode>& expandLike) {
+    ProgramTreeKey key;
+    const bool haveKey = ReadProgramTreeKey(key);
+
+    std::vector<MenuNode> tree = lazy ? BuildLazyProgramsTree(expandLike) : BuildAllProgramsTree();
+
+    if (haveKey) {
+        auto t0 = std::chrono::steady_clock::now();
+        if (SaveProgramTreeSnapshot(GetProgramTreeSnapshotPath(), key, tree)) {
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - t0).count();
+            CF_LOG(Info, "BuildProgramTreeWithSnapshot: snapshot saved in " << ms << " ms");
+        }
+    }
+    return tree;
+}
+
+bool ProgramTreesEqual(const std::vector<MenuNode>& a, const std::vector<MenuNode>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (!NodesEqual(a[i], b[i])) return false;
+    }
+    return true;
+}
+
+} // namespace GlassBar
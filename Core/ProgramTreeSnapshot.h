@@ -0,0 +1,82 @@
+#pragma once
+#include "AllProgramsEnumerator.h"   // MenuNode
+#include "MenuTree.h"                // MenuTree
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace GlassBar {
+
+/// <summary>
+/// Identity of the two Start Menu Programs roots at a point in time:
+/// a hash of both resolved paths plus each root's LastWriteTime.
+///
+/// A root's LastWriteTime only moves when one of its direct children is
+/// added, removed or renamed, so a matching key means "probably unchanged",
+/// never "certainly unchanged" — a loaded snapshot must still be revalidated.
+/// </summary>
+struct ProgramTreeKey {
+    std::uint64_t pathHash    = 0;
+    std::uint64_t commonStamp = 0;   // FOLDERID_CommonPrograms LastWriteTime
+    std::uint64_t userStamp   = 0;   // FOLDERID_Programs LastWriteTime
+};
+
+/// <summary>
+/// Read the current key for both Programs roots. A missing root contributes
+/// a zero stamp. Returns false only if neither root could be resolved.
+/// </summary>
+bool ReadProgramTreeKey(ProgramTreeKey& outKey);
+
+/// <summary>
+/// %LOCALAPPDATA%\GlassBar\programs_tree.bin, or empty if LocalAppData
+/// cannot be resolved.
+/// </summary>
+std::wstring GetProgramTreeSnapshotPath();
+
+/// <summary>
+/// Map the snapshot at |path| and freeze it into |outTree|.
+///
+/// File layout (little-endian, versioned, no pointers — valid at any address):
+///   Header  { magic 'GBPT', version, key, nodeCount, rootCount, charCount }
+///   Node[nodeCount]  fixed-size records in breadth-first order; each holds
+///                    (offset, length) pairs into the string pool plus the
+///                    index range of its children, which is always > its own,
+///                    and kNode* flags (folder, lazy folder not expanded yet).
+///   wchar_t[charCount]  string pool
+///
+/// The node table is MenuTree's own breadth-first layout, so the records go
+/// into the arena (MenuTree::AssignRecords) without a std::vector<MenuNode>
+/// in between; only the strings are copied, into its interned pool, before
+/// the view is unmapped.
+///
+/// Returns false (and leaves |outTree| empty) when the file is missing,
+/// truncated, from another version, malformed, or its key differs from |key|.
+/// Every icon is nullptr in the result.
+/// </summary>
+bool LoadProgramTreeSnapshot(const std::wstring& path, const ProgramTreeKey& key,
+                             MenuTree& outTree);
+
+/// <summary>
+/// Serialise |tree| under |key| to |path|. Writes to a temporary file and
+/// renames it over the old snapshot, so readers never see a partial file.
+/// Safe to call from several threads; writes are serialised internally.
+/// </summary>
+bool SaveProgramTreeSnapshot(const std::wstring& path, const ProgramTreeKey& key,
+                             const std::vector<MenuNode>& tree);
+
+/// <summary>
+/// BuildAllProgramsTree() — or BuildLazyProgramsTree(|expandLike|) when |lazy|
+/// — followed by SaveProgramTreeSnapshot(). The key is read before the scan
+/// starts, so a change made mid-scan leaves the saved snapshot stale-keyed and
+/// it is rebuilt on the next start.
+/// </summary>
+std::vector<MenuNode> BuildProgramTreeWithSnapshot(bool lazy = false,
+                                                   const std::vector<MenuNode>& expandLike = {});
+
+/// <summary>
+/// Structural equality over name / isFolder / childrenPending / target / args /
+/// folderPath / lnkPath / children. hIcon is ignored.
+/// </summary>
+bool ProgramTreesEqual(const std::vector<MenuNode>& a, const std::vector<MenuNode>& b);
+
+} // namespace GlassBar
@@ -0,0 +1,335 @@
+#include "RasterSurface.h"
+#include "IconAtlas.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#if !defined(GLASSBAR_NO_SIMD) && \
+    (defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define GLASSBAR_RASTER_X86 1
+#include <emmintrin.h>
+#endif
+
+namespace GlassBar {
+
+// ── Pixel loops ───────────────────────────────────────────────────────────────
+// Source-over as in BlendPremultiplied(): out = src + dst * (255 - srcAlpha)
+// / 255 per channel, with the same rounded division, so the SSE2 and scalar
+// loops agree bit for bit.
+
+namespace {
+
+inline std::uint32_t Div255(std::uint32_t x) {
+    const std::uint32_t t = x + 128u;
+    return (t + (t >> 8)) >> 8;
+}
+
+inline std::uint32_t BlendPixel(std::uint32_t s, std::uint32_t d) {
+    const std::uint32_t inv = 255u - (s >> 24);
+    std::uint32_t out = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        const std::uint32_t t = Div255(((d >> shift) & 0xFFu) * inv);
+        out |= (std::min)(((s >> shift) & 0xFFu) + t, 255u) << shift;
+    }
+    return out;
+}
+
+// |color| with every channel scaled by |coverage| / 255 (still premultiplied).
+inline std::uint32_t ScaleColor(std::uint32_t color, std::uint32_t coverage) {
+    std::uint32_t out = 0;
+    for (int shift = 0; shift < 32; shift += 8)
+        out |= Div255(((color >> shift) & 0xFFu) * coverage) << shift;
+    return out;
+}
+
+inline void PutPixel(std::uint32_t& d, std::uint32_t s) {
+    const std::uint32_t alpha = s >> 24;
+    if (alpha == 255)    d = s;
+    else if (alpha != 0) d = BlendPixel(s, d);
+}
+
+#if GLASSBAR_RASTER_X86
+// Store |color| over n pixels, four at a time; returns how many were done.
+int FillRowSse2(std::uint32_t* dst, int n, std::uint32_t color) {
+    const __m128i c = _mm_set1_epi32(static_cast<int>(color));
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), c);
+    return i;
+}
+
+// Blend the translucent |color| over n pixels, four at a time; returns how
+// many were done. The color's 16-bit lanes and inverse alpha are hoisted.
+int BlendRowSse2(std::uint32_t* dst, int n, std::uint32_t color) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c128 = _mm_set1_epi16(128);
+    const __m128i s16  = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(color)), zero);
+    const __m128i inv  = _mm_set1_epi16(static_cast<short>(255u - (color >> 24)));
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inv), c128);
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inv), c128);
+        lo = _mm_add_epi16(s16, _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8));
+        hi = _mm_add_epi16(s16, _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    return i;
+}
+#endif
+
+// ── Coverage ──────────────────────────────────────────────────────────────────
+// A rounded box by its centre, half extents and corner radius; coverage of a
+// pixel is 0.5 minus the signed distance from its centre to the outline,
+// clamped, which is exact where the outline is straight and axis-aligned.
+
+struct Box {
+    float cx, cy, hx, hy, r;
+};
+
+Box MakeBox(const RasterRect& rc, int radius) {
+    const float hx = (rc.right - rc.left) * 0.5f, hy = (rc.bottom - rc.top) * 0.5f;
+    return { rc.left + hx, rc.top + hy, hx, hy, static_cast<float>(radius) };
+}
+
+float BoxCoverage(const Box& b, int x, int y) {
+    const float qx = std::fabs(x + 0.5f - b.cx) - (b.hx - b.r);
+    const float qy = std::fabs(y + 0.5f - b.cy) - (b.hy - b.r);
+    const float ox = (std::max)(qx, 0.0f), oy = (std::max)(qy, 0.0f);
+    const float d  = std::sqrt(ox * ox + oy * oy) + (std::min)((std::max)(qx, qy), 0.0f) - b.r;
+    return (std::min)((std::max)(0.5f - d, 0.0f), 1.0f);
+}
+
+int ClampRadius(const RasterRect& rc, int radius) {
+    const int most = (std::min)(rc.right - rc.left, rc.bottom - rc.top) / 2;
+    return (std::max)((std::min)(radius, most), 0);
+}
+
+} // namespace
+
+// ── Surface ───────────────────────────────────────────────────────────────────
+
+RasterSurface::RasterSurface(std::uint32_t* pixels, int width, int height, int stride)
+    : m_pixels(pixels), m_width(width), m_height(height), m_stride(stride) {
+    SetClip({ 0, 0, width, height });
+}
+
+void RasterSurface::SetClip(const RasterRect& clip) {
+    m_clip.left   = (std::max)(clip.left, 0);
+    m_clip.top    = (std::max)(clip.top, 0);
+    m_clip.right  = (std::min)(clip.right, m_width);
+    m_clip.bottom = (std::min)(clip.bottom, m_height);
+}
+
+void RasterSurface::Span(int y, int x0, int x1, std::uint32_t color) {
+    if (y < m_clip.top || y >= m_clip.bottom) return;
+    x0 = (std::max)(x0, m_clip.left);
+    x1 = (std::min)(x1, m_clip.right);
+    if (x0 >= x1 || (color >> 24) == 0) return;
+
+    std::uint32_t* d = Row(y) + x0;
+    const int n = x1 - x0;
+    int i = 0;
+    if ((color >> 24) == 255) {
+#if GLASSBAR_RASTER_X86
+        i = FillRowSse2(d, n, color);
+#endif
+        for (; i < n; ++i) d[i] = color;
+    } else {
+#if GLASSBAR_RASTER_X86
+        i = BlendRowSse2(d, n, color);
+#endif
+        for (; i < n; ++i) d[i] = BlendPixel(color, d[i]);
+    }
+}
+
+void RasterSurface::Plot(int x, int y, std::uint32_t color, float coverage) {
+    if (x < m_clip.left || x >= m_clip.right || y < m_clip.top || y >= m_clip.bottom) return;
+    const std::uint32_t c = static_cast<std::uint32_t>(coverage * 255.0f + 0.5f);
+    if (c == 0) return;
+    PutPixel(Row(y)[x], c >= 255 ? color : ScaleColor(color, c));
+}
+
+void RasterSurface::FillRect(const RasterRect& r, std::uint32_t color) {
+    if (!m_pixels) return;
+    const int y0 = (std::max)(r.top, m_clip.top), y1 = (std::min)(r.bottom, m_clip.bottom);
+    for (int y = y0; y < y1; ++y) Span(y, r.left, r.right, color);
+}
+
+void RasterSurface::Clear(const RasterRect& r) {
+    if (!m_pixels) return;
+    const int x0 = (std::max)(r.left, m_clip.left), x1 = (std::min)(r.right, m_clip.right);
+    const int y0 = (std::max)(r.top, m_clip.top),   y1 = (std::min)(r.bottom, m_clip.bottom);
+    for (int y = y0; y < y1 && x0 < x1; ++y) std::fill(Row(y) + x0, Row(y) + x1, 0u);
+}
+
+void RasterSurface::MakeOpaque(const RasterRect& r) {
+    if (!m_pixels) return;
+    const int x0 = (std::max)(r.left, m_clip.left), x1 = (std::min)(r.right, m_clip.right);
+    const int y0 = (std::max)(r.top, m_clip.top),   y1 = (std::min)(r.bottom, m_clip.bottom);
+    for (int y = y0; y < y1; ++y) {
+        std::uint32_t* d = Row(y);
+        for (int x = x0; x < x1; ++x) d[x] |= 0xFF000000u;
+    }
+}
+
+void RasterSurface::FillRoundRect(const RasterRect& r, int radius, std::uint32_t color) {
+    if (!m_pixels || r.Empty()) return;
+    const int rad = ClampRadius(r, radius);
+    if (rad == 0) { FillRect(r, color); return; }
+
+    const Box box = MakeBox(r, rad);
+    const int y0 = (std::max)(r.top, m_clip.top), y1 = (std::min)(r.bottom, m_clip.bottom);
+    for (int y = y0; y < y1; ++y) {
+        // Rows clear of the corners are one span; corner rows shade the
+        // corner columns and fill between them.
+        if (y >= r.top + rad && y < r.bottom - rad) {
+            Span(y, r.left, r.right, color);
+            continue;
+        }
+        for (int x = r.left; x < r.left + rad; ++x)   Plot(x, y, color, BoxCoverage(box, x, y));
+        Span(y, r.left + rad, r.right - rad, color);
+        for (int x = r.right - rad; x < r.right; ++x) Plot(x, y, color, BoxCoverage(box, x, y));
+    }
+}
+
+void RasterSurface::StrokeRoundRect(const RasterRect& r, int radius, int width,
+                                    std::uint32_t color) {
+    if (!m_pixels || r.Empty() || width < 1) return;
+    const int rad = ClampRadius(r, radius);
+    if (2 * width >= (std::min)(r.right - r.left, r.bottom - r.top)) {
+        FillRoundRect(r, rad, color);
+        return;
+    }
+
+    // The border is the outer shape minus the inner one, inset by |width|.
+    const RasterRect in{ r.left + width, r.top + width, r.right - width, r.bottom - width };
+    const Box outer = MakeBox(r, rad);
+    const Box inner = MakeBox(in, (std::max)(rad - width, 0));
+    const int edge  = (std::max)(rad, width);
+
+    const int y0 = (std::max)(r.top, m_clip.top), y1 = (std::min)(r.bottom, m_clip.bottom);
+    for (int y = y0; y < y1; ++y) {
+        if (y >= r.top + edge && y < r.bottom - edge) {
+            Span(y, r.left, in.left, color);
+            Span(y, in.right, r.right, color);
+            continue;
+        }
+        for (int x = r.left; x < r.left + edge; ++x)
+            Plot(x, y, color, BoxCoverage(outer, x, y) - BoxCoverage(inner, x, y));
+        if (y < in.top || y >= in.bottom)
+            Span(y, r.left + edge, r.right - edge, color);
+        for (int x = r.right - edge; x < r.right; ++x)
+            Plot(x, y, color, BoxCoverage(outer, x, y) - BoxCoverage(inner, x, y));
+    }
+}
+
+void RasterSurface::DrawLine(int x0, int y0, int x1, int y1, int width, std::uint32_t color) {
+    if (!m_pixels || width < 1 || (x0 == x1 && y0 == y1)) return;
+    if (width == 1 && y0 == y1) {
+        if (x0 < x1) Span(y0, x0, x1, color);
+        else         Span(y0, x1 + 1, x0 + 1, color);
+        return;
+    }
+    if (width == 1 && x0 == x1) {
+        if (y0 < y1) FillRect({ x0, y0, x0 + 1, y1 }, color);
+        else         FillRect({ x0, y1 + 1, x0 + 1, y0 + 1 }, color);
+        return;
+    }
+
+    // Segment between the centres of the first and last pixels drawn (one
+    // step short of the end along the major axis), round-capped.
+    const int   dx = x1 - x0, dy = y1 - y0;
+    const float major = static_cast<float>((std::max)(std::abs(dx), std::abs(dy)));
+    const float ax = x0 + 0.5f, ay = y0 + 0.5f;
+    const float vx = dx - dx / major, vy = dy - dy / major;
+    const float len2 = vx * vx + vy * vy;
+    const float half = width * 0.5f;
+
+    const int left   = (std::max)(static_cast<int>(std::floor((std::min)(ax, ax + vx) - half)), m_clip.left);
+    const int right  = (std::min)(static_cast<int>(std::ceil((std::max)(ax, ax + vx) + half)), m_clip.right);
+    const int top    = (std::max)(static_cast<int>(std::floor((std::min)(ay, ay + vy) - half)), m_clip.top);
+    const int bottom = (std::min)(static_cast<int>(std::ceil((std::max)(ay, ay + vy) + half)), m_clip.bottom);
+    for (int y = top; y < bottom; ++y) {
+        for (int x = left; x < right; ++x) {
+            const float px = x + 0.5f - ax, py = y + 0.5f - ay;
+            float t = len2 > 0.0f ? (px * vx + py * vy) / len2 : 0.0f;
+            t = (std::min)((std::max)(t, 0.0f), 1.0f);
+            const float ex = px - t * vx, ey = py - t * vy;
+            const float d  = std::sqrt(ex * ex + ey * ey);
+            Plot(x, y, color, (std::min)((std::max)(half + 0.5f - d, 0.0f), 1.0f));
+        }
+    }
+}
+
+int RasterSurface::DrawGlyphRun(const RasterGlyph* glyphs, size_t count, int x, int baseline,
+                                std::uint32_t color) {
+    const bool opaque = (color >> 24) == 255;
+    for (size_t g = 0; g < count; ++g) {
+        const RasterGlyph& glyph = glyphs[g];
+        const int gx = x + glyph.offsetX, gy = baseline + glyph.offsetY;
+        x += glyph.advance;
+        if (!m_pixels || !glyph.coverage || (color >> 24) == 0) continue;
+
+        const int cx0 = (std::max)(gx, m_clip.left), cx1 = (std::min)(gx + glyph.width, m_clip.right);
+        const int cy0 = (std::max)(gy, m_clip.top),  cy1 = (std::min)(gy + glyph.height, m_clip.bottom);
+        for (int y = cy0; y < cy1; ++y) {
+            const std::uint8_t* mask = glyph.coverage + static_cast<size_t>(y - gy) * glyph.pitch - gx;
+            std::uint32_t* d = Row(y);
+            for (int px = cx0; px < cx1; ++px) {
+                const std::uint32_t c = mask[px];
+                if (c == 0) continue;
+                if (c == 255 && opaque) d[px] = color;
+                else                    PutPixel(d[px], c == 255 ? color : ScaleColor(color, c));
+            }
+        }
+    }
+    return x;
+}
+
+void RasterSurface::BlendImage(int x, int y, const std::uint32_t* src, int srcStride, int w, int h) {
+    if (!m_pixels || m_clip.Empty()) return;
+    BlendPremultiplied(Row(m_clip.top) + m_clip.left, m_stride,
+                       m_clip.right - m_clip.left, m_clip.bottom - m_clip.top,
+                       x - m_clip.left, y - m_clip.top, src, srcStride, w, h);
+}
+
+// ── Text layout ───────────────────────────────────────────────────────────────
+
+namespace {
+
+int RunWidth(const RasterGlyph* glyphs, size_t count) {
+    int width = 0;
+    for (size_t i = 0; i < count; ++i) width += glyphs[i].advance;
+    return width;
+}
+
+} // namespace
+
+GlyphLine LayoutGlyphLine(const RasterGlyph* glyphs, size_t count, const RasterRect& box,
+                          int ascent, int descent, GlyphAlign align,
+                          const RasterGlyph* ellipsis, size_t ellipsisCount) {
+    const int boxWidth = box.right - box.left;
+    GlyphLine line;
+    line.count = count;
+    int width = RunWidth(glyphs, count);
+    if (ellipsis && width > boxWidth) {
+        const int dots = RunWidth(ellipsis, ellipsisCount);
+        line.count    = 0;
+        line.ellipsis = true;
+        width         = 0;
+        while (line.count < count && width + glyphs[line.count].advance + dots <= boxWidth)
+            width += glyphs[line.count++].advance;
+        width += dots;
+    }
+    switch (align) {
+        case GlyphAlign::Left:   line.x = box.left;                         break;
+        case GlyphAlign::Center: line.x = box.left + (boxWidth - width) / 2; break;
+        case GlyphAlign::Right:  line.x = box.right - width;                break;
+    }
+    line.baseline = box.top + (box.bottom - box.top - (ascent + descent)) / 2 + ascent;
+    return line;
+}
+
+} // namespace GlassBar
@@ -0,0 +1,146 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace GlassBar {
+
+// ── Software rasterizer ───────────────────────────────────────────────────────
+// The menu's drawing primitives over a premultiplied 32-bit image (top-down
+// 0xAARRGGBB rows, the layout of a BI_RGB DIB section): filled and outlined
+// rounded rectangles with anti-aliased edges, lines, glyph runs from 8-bit
+// coverage masks and premultiplied image blits. Plain C++ with no platform
+// headers: the menu points one at its back buffer, and anything else (a
+// std::vector) renders the same frame headlessly.
+
+/// Pixel rectangle, right and bottom edges exclusive (as a Win32 RECT).
+struct RasterRect {
+    int left   = 0;
+    int top    = 0;
+    int right  = 0;
+    int bottom = 0;
+
+    bool Empty() const { return left >= right || top >= bottom; }
+};
+
+/// <summary>
+/// One glyph of a run: an 8-bit coverage mask (|pitch| bytes per row; null
+/// for a blank glyph such as a space), placed with its top-left corner at
+/// (|offsetX|, |offsetY|) from the pen position on the baseline, which then
+/// moves |advance| pixels right. Whatever rasterizes the font fills these in.
+/// </summary>
+struct RasterGlyph {
+    const std::uint8_t* coverage = nullptr;
+    int width   = 0;
+    int height  = 0;
+    int pitch   = 0;
+    int offsetX = 0;
+    int offsetY = 0;   // negative: above the baseline
+    int advance = 0;
+};
+
+/// Horizontal placement of a line in its box (DT_LEFT, DT_CENTER, DT_RIGHT).
+enum class GlyphAlign { Left, Center, Right };
+
+/// Where LayoutGlyphLine() puts a run: the pen start on the baseline, how
+/// many of its glyphs to draw, and whether the ellipsis run follows them.
+struct GlyphLine {
+    int    x        = 0;
+    int    baseline = 0;
+    size_t count    = 0;
+    bool   ellipsis = false;
+};
+
+/// <summary>
+/// Place |count| glyphs on one line in |box| as DrawTextW() does with
+/// DT_SINGLELINE | DT_VCENTER: centred vertically for a font of |ascent| +
+/// |descent| px, aligned by |align|. Given an |ellipsis| run (DT_END_ELLIPSIS),
+/// a line wider than the box keeps the glyphs that leave room for it; without
+/// one it overflows the box on the side |align| leaves open.
+/// </summary>
+GlyphLine LayoutGlyphLine(const RasterGlyph* glyphs, size_t count, const RasterRect& box,
+                          int ascent, int descent, GlyphAlign align,
+                          const RasterGlyph* ellipsis = nullptr, size_t ellipsisCount = 0);
+
+/// <summary>
+/// A non-owning view of a premultiplied 32-bit image plus a clip rectangle;
+/// every primitive draws source-over and only inside the clip. Fully opaque
+/// spans are stored rather than blended. Fill and blend loops use SSE2 on
+/// x86/x64 (GLASSBAR_NO_SIMD forces the scalar loops, which give identical
+/// results); anti-aliased edges are computed per pixel, as coverage of the
+/// shape over the pixel's centre, and are exact on axis-aligned edges.
+/// </summary>
+class RasterSurface {
+public:
+    RasterSurface() = default;
+    RasterSurface(std::uint32_t* pixels, int width, int height, int stride);
+
+    /// Premultiplied pixel of an sRGB color with |a| opacity.
+    static constexpr std::uint32_t Color(std::uint8_t r, std::uint8_t g, std::uint8_t b,
+                                         std::uint8_t a = 255) {
+        return (static_cast<std::uint32_t>(a) << 24) |
+               (Scale8(r, a) << 16) | (Scale8(g, a) << 8) | Scale8(b, a);
+    }
+
+    /// Limit drawing to |clip| (intersected with the image); the whole image
+    /// by default.
+    void SetClip(const RasterRect& clip);
+    const RasterRect& Clip() const { return m_clip; }
+
+    std::uint32_t* Pixels() const { return m_pixels; }
+    int            Width()  const { return m_width; }
+    int            Height() const { return m_height; }
+    int            Stride() const { return m_stride; }   // in pixels
+
+    void FillRect(const RasterRect& r, std::uint32_t color);
+
+    /// Store transparent black over |r|: what is left clear shows through a
+    /// window presented with per-pixel alpha.
+    void Clear(const RasterRect& r);
+
+    /// Set the alpha of every pixel in |r| to opaque, for pixels another
+    /// renderer wrote with alpha 0 (GDI does) over an opaque background.
+    void MakeOpaque(const RasterRect& r);
+
+    /// |r| with circular corners of |radius| px (0: square; half the smaller
+    /// side: a circle or a pill).
+    void FillRoundRect(const RasterRect& r, int radius, std::uint32_t color);
+
+    /// The |width| px border just inside |r|, corners as FillRoundRect().
+    void StrokeRoundRect(const RasterRect& r, int radius, int width, std::uint32_t color);
+
+    /// <summary>
+    /// A |width| px line from the centre of pixel (|x0|, |y0|) towards pixel
+    /// (|x1|, |y1|), which is not drawn (GDI's MoveToEx/LineTo). Horizontal and
+    /// vertical 1 px lines are exact spans; others are anti-aliased.
+    /// </summary>
+    void DrawLine(int x0, int y0, int x1, int y1, int width, std::uint32_t color);
+
+    /// Draw |count| glyphs in |color| with the pen starting at (|x|,
+    /// |baseline|); returns the pen's x after the last one.
+    int DrawGlyphRun(const RasterGlyph* glyphs, size_t count, int x, int baseline,
+                     std::uint32_t color);
+
+    /// Blend the premultiplied |w|×|h| image at |src| (pitch |srcStride|
+    /// pixels) with its top-left corner at (|x|, |y|).
+    void BlendImage(int x, int y, const std::uint32_t* src, int srcStride, int w, int h);
+
+private:
+    static constexpr std::uint32_t Scale8(std::uint32_t c, std::uint32_t a) {
+        const std::uint32_t t = c * a + 128u;
+        return (t + (t >> 8)) >> 8;
+    }
+
+    std::uint32_t* Row(int y) const { return m_pixels + static_cast<size_t>(y) * m_stride; }
+    // Draw |color| over [x0, x1) of row |y|, clipped.
+    void Span(int y, int x0, int x1, std::uint32_t color);
+    // Draw |color| at |coverage| (0..1) over one pixel, clipped.
+    void Plot(int x, int y, std::uint32_t color, float coverage);
+
+    std::uint32_t* m_pixels = nullptr;
+    int            m_width  = 0;
+    int            m_height = 0;
+    int            m_stride = 0;
+    RasterRect     m_clip;
+};
+
+} // namespace GlassBar
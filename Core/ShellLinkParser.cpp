@@ -0,0 +1,383 @@
+#include "ShellLinkParser.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace GlassBar {
+
+// ── Format constants (MS-SHLLINK) ─────────────────────────────────────────────
+
+namespace {
+
+constexpr std::uint32_t kHeaderSize = 0x4C;
+
+// {00021401-0000-0000-C000-000000000046} as laid out on disk.
+constexpr std::uint8_t kLinkClsid[16] = {
+    0x01, 0x14, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x46,
+};
+
+// LinkFlags
+constexpr std::uint32_t HasLinkTargetIDList = 0x00000001;
+constexpr std::uint32_t HasLinkInfo         = 0x00000002;
+constexpr std::uint32_t HasName             = 0x00000004;
+constexpr std::uint32_t HasRelativePath     = 0x00000008;
+constexpr std::uint32_t HasWorkingDir       = 0x00000010;
+constexpr std::uint32_t HasArguments        = 0x00000020;
+constexpr std::uint32_t HasIconLocation     = 0x00000040;
+constexpr std::uint32_t IsUnicode           = 0x00000080;
+constexpr std::uint32_t ForceNoLinkInfo     = 0x00000100;
+constexpr std::uint32_t HasExpString        = 0x00000200;
+constexpr std::uint32_t HasDarwinID         = 0x00001000;
+constexpr std::uint32_t HasExpIcon          = 0x00004000;
+
+// LinkInfoFlags
+constexpr std::uint32_t VolumeIDAndLocalBasePath               = 0x1;
+constexpr std::uint32_t CommonNetworkRelativeLinkAndPathSuffix = 0x2;
+
+// ExtraData block signatures
+constexpr std::uint32_t kEnvironmentVariableBlock = 0xA0000001;
+constexpr std::uint32_t kIconEnvironmentBlock     = 0xA0000007;
+constexpr std::uint32_t kEnvBlockSize             = 0x314;  // 8 + 260 + 520
+
+constexpr std::size_t kMaxPathChars = 260;
+
+// ── Little-endian readers ─────────────────────────────────────────────────────
+
+std::uint16_t ReadU16(const std::uint8_t* p) {
+    return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+}
+
+std::uint32_t ReadU32(const std::uint8_t* p) {
+    return  static_cast<std::uint32_t>(p[0])        |
+           (static_cast<std::uint32_t>(p[1]) << 8)  |
+           (static_cast<std::uint32_t>(p[2]) << 16) |
+           (static_cast<std::uint32_t>(p[3]) << 24);
+}
+
+/// NUL-terminated UTF-16LE string starting at |off|, bounded by |end|.
+bool ReadUnicodeZ(const std::uint8_t* data, std::size_t off, std::size_t end,
+                  std::wstring& out) {
+    out.clear();
+    for (std::size_t i = off; i + 1 < end; i += 2) {
+        wchar_t c = static_cast<wchar_t>(ReadU16(data + i));
+        if (c == L'\0') return true;
+        out.push_back(c);
+    }
+    return false;  // unterminated
+}
+
+/// NUL-terminated ANSI string. Only 7-bit ASCII is accepted because the
+/// system code page the link was written with is not known here.
+bool ReadAsciiZ(const std::uint8_t* data, std::size_t off, std::size_t end,
+                std::wstring& out) {
+    out.clear();
+    for (std::size_t i = off; i < end; ++i) {
+        std::uint8_t c = data[i];
+        if (c == 0) return true;
+        if (c >= 0x80) return false;
+        out.push_back(static_cast<wchar_t>(c));
+    }
+    return false;
+}
+
+/// Fixed-size NUL-padded UTF-16LE field (env / icon-env data blocks).
+void ReadUnicodeFixed(const std::uint8_t* p, std::size_t chars, std::wstring& out) {
+    out.clear();
+    for (std::size_t i = 0; i < chars; ++i) {
+        wchar_t c = static_cast<wchar_t>(ReadU16(p + i * 2));
+        if (c == L'\0') break;
+        out.push_back(c);
+    }
+}
+
+/// Join a base path and a suffix the way the shell does for LinkInfo.
+std::wstring JoinLinkInfoPath(const std::wstring& base, const std::wstring& suffix) {
+    if (suffix.empty()) return base;
+    if (base.empty()) return suffix;
+    if (base.back() == L'\\') return base + suffix;
+    return base + L'\\' + suffix;
+}
+
+/// Decode the LinkInfo structure at |off| into a file-system target path.
+/// Returns false if the structure is malformed or only has ANSI strings that
+/// cannot be decoded safely. An empty |out| with true means "no usable path".
+bool ParseLinkInfo(const std::uint8_t* data, std::size_t off, std::size_t linkInfoSize,
+                   std::wstring& out) {
+    out.clear();
+    const std::size_t end = off + linkInfoSize;
+    if (linkInfoSize < 0x1C) return false;
+
+    const std::uint8_t* li  = data + off;
+    const std::uint32_t hdrSize     = ReadU32(li + 4);
+    const std::uint32_t liFlags     = ReadU32(li + 8);
+    const std::uint32_t localOff    = ReadU32(li + 16);
+    const std::uint32_t netOff      = ReadU32(li + 20);
+    const std::uint32_t suffixOff   = ReadU32(li + 24);
+    if (hdrSize < 0x1C || hdrSize > linkInfoSize) return false;
+
+    std::uint32_t localOffW = 0, suffixOffW = 0;
+    if (hdrSize >= 0x24) {
+        localOffW  = ReadU32(li + 28);
+        suffixOffW = ReadU32(li + 32);
+    }
+
+    auto inRange = [&](std::uint32_t rel) { return rel != 0 && rel < linkInfoSize; };
+
+    std::wstring suffix;
+    if (inRange(suffixOffW)) {
+        if (!ReadUnicodeZ(data, off + suffixOffW, end, suffix)) return false;
+    } else if (inRange(suffixOff)) {
+        if (!ReadAsciiZ(data, off + suffixOff, end, suffix)) return false;
+    }
+
+    if (liFlags & VolumeIDAndLocalBasePath) {
+        std::wstring base;
+        if (inRange(localOffW)) {
+            if (!ReadUnicodeZ(data, off + localOffW, end, base)) return false;
+        } else if (inRange(localOff)) {
+            if (!ReadAsciiZ(data, off + localOff, end, base)) return false;
+        }
+        if (!base.empty()) {
+            out = JoinLinkInfoPath(base, suffix);
+            return true;
+        }
+    }
+
+    if ((liFlags & CommonNetworkRelativeLinkAndPathSuffix) && inRange(netOff)) {
+        const std::size_t cnrl = off + netOff;
+        if (cnrl + 0x14 > end) return false;
+        const std::uint32_t cnrlSize    = ReadU32(data + cnrl);
+        const std::uint32_t netNameOff  = ReadU32(data + cnrl + 8);
+        if (cnrlSize < 0x14 || cnrl + cnrlSize > end) return false;
+        const std::size_t cnrlEnd = cnrl + cnrlSize;
+
+        std::wstring netName;
+        if (netNameOff > 0x14 && cnrl + 0x18 <= cnrlEnd) {
+            const std::uint32_t netNameOffW = ReadU32(data + cnrl + 0x14);
+            if (netNameOffW == 0 || netNameOffW >= cnrlSize ||
+                !ReadUnicodeZ(data, cnrl + netNameOffW, cnrlEnd, netName))
+                return false;
+        } else if (netNameOff != 0 && netNameOff < cnrlSize) {
+            if (!ReadAsciiZ(data, cnrl + netNameOff, cnrlEnd, netName)) return false;
+        }
+        if (!netName.empty())
+            out = JoinLinkInfoPath(netName, suffix);
+    }
+    return true;
+}
+
+} // namespace
+
+// ── ParseShellLink ────────────────────────────────────────────────────────────
+
+bool ParseShellLink(const std::uint8_t* data, std::size_t size, ShellLinkInfo& out) {
+    out = ShellLinkInfo{};
+    if (!data || size < kHeaderSize) return false;
+
+    // ── ShellLinkHeader ──────────────────────────────────────────────────────
+    if (ReadU32(data) != kHeaderSize) return false;
+    if (std::memcmp(data + 4, kLinkClsid, sizeof(kLinkClsid)) != 0) return false;
+
+    const std::uint32_t flags = ReadU32(data + 0x14);
+    out.iconIndex = static_cast<int>(ReadU32(data + 0x38));
+
+    // Advertised (MSI) shortcuts need msi.dll to find the real target.
+    if (flags & HasDarwinID) return false;
+
+    std::size_t pos = kHeaderSize;
+
+    // ── LinkTargetIDList — skipped, it needs the shell namespace ─────────────
+    if (flags & HasLinkTargetIDList) {
+        if (pos + 2 > size) return false;
+        pos += 2 + ReadU16(data + pos);
+        if (pos > size) return false;
+    }
+
+    // ── LinkInfo ─────────────────────────────────────────────────────────────
+    std::wstring linkInfoPath;
+    if (flags & HasLinkInfo) {
+        if (pos + 4 > size) return false;
+        const std::uint32_t linkInfoSize = ReadU32(data + pos);
+        if (linkInfoSize < 4 || linkInfoSize > size - pos) return false;
+        if (!(flags & ForceNoLinkInfo) &&
+            !ParseLinkInfo(data, pos, linkInfoSize, linkInfoPath))
+            return false;
+        pos += linkInfoSize;
+    }
+
+    // ── StringData ───────────────────────────────────────────────────────────
+    const bool unicode = (flags & IsUnicode) != 0;
+    auto readCounted = [&](std::wstring* dest) -> bool {
+        if (pos + 2 > size) return false;
+        const std::size_t count = ReadU16(data + pos);
+        pos += 2;
+        const std::size_t bytes = unicode ? count * 2 : count;
+        if (bytes > size - pos) return false;
+        if (dest) {
+            dest->clear();
+            dest->reserve(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                if (unicode) {
+                    dest->push_back(static_cast<wchar_t>(ReadU16(data + pos + i * 2)));
+                } else {
+                    if (data[pos + i] >= 0x80) return false;
+                    dest->push_back(static_cast<wchar_t>(data[pos + i]));
+                }
+            }
+        }
+        pos += bytes;
+        return true;
+    };
+
+    if ((flags & HasName)         && !readCounted(nullptr))           return false;
+    if ((flags & HasRelativePath) && !readCounted(nullptr))           return false;
+    if ((flags & HasWorkingDir)   && !readCounted(&out.workingDir))   return false;
+    if ((flags & HasArguments)    && !readCounted(&out.arguments))    return false;
+    if ((flags & HasIconLocation) && !readCounted(&out.iconLocation)) return false;
+
+    // ── ExtraData ────────────────────────────────────────────────────────────
+    std::wstring envTarget, envIcon;
+    while (pos + 4 <= size) {
+        const std::uint32_t blockSize = ReadU32(data + pos);
+        if (blockSize < 4) break;                        // TerminalBlock
+        if (blockSize < 8 || blockSize > size - pos) break;
+        const std::uint32_t sig = ReadU32(data + pos + 4);
+        if (blockSize >= kEnvBlockSize) {
+            const std::uint8_t* wide = data + pos + 8 + kMaxPathChars;
+            if (sig == kEnvironmentVariableBlock && (flags & HasExpString))
+                ReadUnicodeFixed(wide, kMaxPathChars, envTarget);
+            else if (sig == kIconEnvironmentBlock && (flags & HasExpIcon))
+                ReadUnicodeFixed(wide, kMaxPathChars, envIcon);
+        }
+        pos += blockSize;
+    }
+
+    if (!envIcon.empty()) out.iconLocation = std::move(envIcon);
+
+    out.target = !envTarget.empty() ? std::move(envTarget) : std::move(linkInfoPath);
+    return !out.target.empty();
+}
+
+// ── ParseInternetShortcut ─────────────────────────────────────────────────────
+
+namespace {
+
+/// Code-unit view over a .url file: bytes for ANSI / UTF-8 files, UTF-16LE
+/// pairs for Unicode ones. Reads are unaligned-safe.
+struct IniUnits {
+    const std::uint8_t* data;
+    std::size_t         count;
+    bool                wide;
+
+    unsigned operator[](std::size_t i) const {
+        return wide ? ReadU16(data + i * 2) : data[i];
+    }
+};
+
+bool IsIniSpace(unsigned c) { return c == ' ' || c == '\t'; }
+
+/// Case-insensitive match of units [b, e) against an ASCII literal.
+bool IniNameIs(const IniUnits& u, std::size_t b, std::size_t e, const char* name) {
+    for (; b < e && *name; ++b, ++name) {
+        unsigned c = u[b];
+        if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+        unsigned n = static_cast<unsigned char>(*name);
+        if (n >= 'A' && n <= 'Z') n += 'a' - 'A';
+        if (c != n) return false;
+    }
+    return b == e && *name == '\0';
+}
+
+/// Copy units [b, e) into |out|. 8-bit files must be pure ASCII here.
+bool ReadIniValue(const IniUnits& u, std::size_t b, std::size_t e, std::wstring& out) {
+    out.clear();
+    out.reserve(e - b);
+    for (; b < e; ++b) {
+        const unsigned c = u[b];
+        if (!u.wide && c >= 0x80) return false;
+        out.push_back(static_cast<wchar_t>(c));
+    }
+    return true;
+}
+
+/// Leading signed decimal, like GetPrivateProfileIntW.
+int ParseIniInt(const IniUnits& u, std::size_t b, std::size_t e) {
+    bool negative = false;
+    if (b < e && (u[b] == '-' || u[b] == '+')) negative = u[b++] == '-';
+    long long value = 0;
+    for (; b < e && u[b] >= '0' && u[b] <= '9'; ++b)
+        value = (std::min)(value * 10 + (u[b] - '0'), 0x7FFFFFFFll);
+    return static_cast<int>(negative ? -value : value);
+}
+
+} // namespace
+
+bool ParseInternetShortcut(const std::uint8_t* data, std::size_t size, InternetShortcutInfo& out) {
+    out.url.clear();
+    out.iconFile.clear();
+    out.iconIndex = 0;
+    if (!data) return false;
+
+    IniUnits u{data, size, false};
+    std::size_t pos = 0;
+    if (size >= 2 && data[0] == 0xFF && data[1] == 0xFE) {
+        u.wide  = true;
+        u.count = size / 2;
+        pos     = 1;
+    } else if (size >= 3 && data[0] == 0xEF && data[1] == 0xBB && data[2] == 0xBF) {
+        pos = 3;
+    }
+
+    bool inSection = false, sectionSeen = false;
+    bool haveUrl = false, haveIconFile = false, haveIconIndex = false;
+
+    while (pos < u.count) {
+        std::size_t eol = pos;
+        while (eol < u.count && u[eol] != '\n' && u[eol] != '\r') ++eol;
+        std::size_t b = pos, e = eol;
+        pos = eol + 1;
+
+        while (b < e && IsIniSpace(u[b])) ++b;
+        while (e > b && IsIniSpace(u[e - 1])) --e;
+        if (b == e || u[b] == ';') continue;
+
+        if (u[b] == '[') {
+            if (sectionSeen) break;  // only the first [InternetShortcut] counts
+            std::size_t close = b + 1;
+            while (close < e && u[close] != ']') ++close;
+            inSection   = close < e && IniNameIs(u, b + 1, close, "InternetShortcut");
+            sectionSeen = inSection;
+            continue;
+        }
+        if (!inSection) continue;
+
+        std::size_t eq = b;
+        while (eq < e && u[eq] != '=') ++eq;
+        if (eq == e) continue;
+        std::size_t keyEnd = eq;
+        while (keyEnd > b && IsIniSpace(u[keyEnd - 1])) --keyEnd;
+        std::size_t vb = eq + 1, ve = e;
+        while (vb < ve && IsIniSpace(u[vb])) ++vb;
+        if (ve - vb >= 2 && (u[vb] == '"' || u[vb] == '\'') && u[ve - 1] == u[vb]) {
+            ++vb;
+            --ve;
+        }
+
+        if (!haveUrl && IniNameIs(u, b, keyEnd, "URL")) {
+            if (!ReadIniValue(u, vb, ve, out.url)) return false;
+            haveUrl = true;
+        } else if (!haveIconFile && IniNameIs(u, b, keyEnd, "IconFile")) {
+            if (!ReadIniValue(u, vb, ve, out.iconFile)) return false;
+            haveIconFile = true;
+        } else if (!haveIconIndex && IniNameIs(u, b, keyEnd, "IconIndex")) {
+            out.iconIndex = ParseIniInt(u, vb, ve);
+            haveIconIndex = true;
+        }
+        if (haveUrl && haveIconFile && haveIconIndex) break;
+    }
+
+    return !out.url.empty();
+}
+
+} // namespace GlassBar
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace GlassBar {
+
+/// <summary>
+/// Fields of a Windows shell link (.lnk) that the Start Menu needs.
+/// Strings are UTF-16 code units widened into std::wstring, exactly as they
+/// appear in the file (environment variables are NOT expanded).
+/// </summary>
+struct ShellLinkInfo {
+    std::wstring target;        // Raw target path (env-var form when the link carries one)
+    std::wstring arguments;     // COMMAND_LINE_ARGUMENTS string (may be empty)
+    std::wstring workingDir;    // WORKING_DIR string (may be empty)
+    std::wstring iconLocation;  // ICON_LOCATION string, env-var form preferred (may be empty)
+    int          iconIndex = 0; // ShellLinkHeader.IconIndex
+};
+
+/// <summary>
+/// Decode a shell link straight from its file bytes (MS-SHLLINK), without COM.
+///
+/// Pure C++ with no Windows dependency, so it can be exercised on any platform.
+/// Target precedence mirrors IShellLinkW::GetPath(SLGP_RAWPATH):
+///   1. EnvironmentVariableDataBlock target (when HasExpString is set)
+///   2. LinkInfo LocalBasePath + CommonPathSuffix (Unicode fields preferred)
+///   3. LinkInfo CommonNetworkRelativeLink NetName + CommonPathSuffix
+///
+/// Returns false — and the caller should fall back to IShellLinkW — when:
+///   • the buffer is truncated or is not a shell link (bad size / CLSID);
+///   • the link is an MSI advertised shortcut (HasDarwinID);
+///   • the target exists only as an ItemID list (no LinkInfo / env block);
+///   • a required ANSI string contains non-ASCII bytes (code page unknown here).
+/// |out| is cleared first; on false its contents are unspecified.
+/// </summary>
+bool ParseShellLink(const std::uint8_t* data, std::size_t size, ShellLinkInfo& out);
+
+/// <summary>
+/// Fields of an Internet shortcut (.url) that the Start Menu needs, taken
+/// from its [InternetShortcut] section.
+/// </summary>
+struct InternetShortcutInfo {
+    std::wstring url;           // URL= (quotes stripped)
+    std::wstring iconFile;      // IconFile= (may be empty)
+    int          iconIndex = 0; // IconIndex=
+};
+
+/// <summary>
+/// Decode a .url file straight from its bytes in one pass, without the
+/// legacy INI API (GetPrivateProfileStringW reopens and rescans the file for
+/// every key it is asked for).
+///
+/// Pure C++ with no Windows dependency. Follows the profile API's rules:
+/// section and key names are case-insensitive, whitespace around keys and
+/// values is trimmed, one pair of matching surrounding quotes is stripped, and
+/// the first [InternetShortcut] section and first occurrence of a key win.
+/// Accepts UTF-16LE (with BOM), UTF-8 with BOM, and plain ANSI files.
+///
+/// Returns false — and the caller should fall back to the profile API — when:
+///   • there is no non-empty URL= in [InternetShortcut];
+///   • a wanted value in an 8-bit file holds non-ASCII bytes (code page unknown here).
+/// |out| is cleared first; on false its contents are unspecified.
+/// </summary>
+bool ParseInternetShortcut(const std::uint8_t* data, std::size_t size, InternetShortcutInfo& out);
+
+} // namespace GlassBar
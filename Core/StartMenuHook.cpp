@@ -80,6 +80,10 @@ void StartMenuHook::SetForwardKeyCallback(ForwardKeyCallback callback) {
     m_forwardKeyCallback = callback;
 }
 
+void StartMenuHook::SetForwardCharCallback(ForwardCharCallback callback) {
+    m_forwardCharCallback = callback;
+}
+
 // EnumChildWindows callback — finds the widest centered child of Shell_TrayWnd
 // (the WinUI 3 XAML island that hosts the taskbar icon group on Win11 22H2+).
 struct XamlIslandSearch {
@@ -232,6 +236,25 @@ void StartMenuHook::ShowStartMenu(int x, int y) {
     }
 }
 
+// Character a key-down types in the foreground keyboard layout, or 0 for
+// non-character keys, dead keys and Ctrl / Alt chords.
+static wchar_t TranslateTypedChar(const KBDLLHOOKSTRUCT* kbd) {
+    if ((GetAsyncKeyState(VK_CONTROL) & 0x8000) || (GetAsyncKeyState(VK_MENU) & 0x8000))
+        return 0;
+
+    BYTE state[256] = {};
+    if (GetAsyncKeyState(VK_SHIFT) & 0x8000) state[VK_SHIFT]   = 0x80;
+    if (GetKeyState(VK_CAPITAL) & 0x0001)    state[VK_CAPITAL] = 0x01;
+
+    HWND fg = GetForegroundWindow();
+    HKL layout = GetKeyboardLayout(fg ? GetWindowThreadProcessId(fg, nullptr) : 0);
+
+    // wFlags bit 2: leave the kernel keyboard state (pending dead keys) untouched.
+    wchar_t buf[4] = {};
+    int n = ToUnicodeEx(kbd->vkCode, kbd->scanCode, state, buf, 4, 0x4, layout);
+    return (n == 1 && buf[0] >= L' ') ? buf[0] : 0;
+}
+
 LRESULT CALLBACK StartMenuHook::KeyboardHookProc(int nCode, WPARAM wParam, LPARAM lParam) {
     if (nCode == HC_ACTION && s_instance && s_instance->m_enabled) {
         KBDLLHOOKSTRUCT* kbd = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
@@ -286,7 +309,8 @@ LRESULT CALLBACK StartMenuHook::KeyboardHookProc(int nCode, WPARAM wParam, LPARA
             if (kbd->vkCode == VK_ESCAPE ||
                 kbd->vkCode == VK_UP     ||
                 kbd->vkCode == VK_DOWN   ||
-                kbd->vkCode == VK_RETURN) {
+                kbd->vkCode == VK_RETURN ||
+                kbd->vkCode == VK_BACK) {
                 if (s_instance->m_isMenuVisibleCallback && s_instance->m_isMenuVisibleCallback()) {
                     CF_LOG(Debug, "Nav key 0x" << std::hex << kbd->vkCode << std::dec
                                   << " forwarded to Start Menu");
@@ -296,6 +320,16 @@ LRESULT CALLBACK StartMenuHook::KeyboardHookProc(int nCode, WPARAM wParam, LPARA
                     return 1; // Suppress — handled by the menu window
                 }
             }
+
+            // Typed characters — type-to-search / initial-letter jump.  Translated
+            // here for the same reason: the menu window never has keyboard focus.
+            if (s_instance->m_forwardCharCallback && !s_instance->m_winDown &&
+                s_instance->m_isMenuVisibleCallback && s_instance->m_isMenuVisibleCallback()) {
+                if (wchar_t ch = TranslateTypedChar(kbd)) {
+                    s_instance->m_forwardCharCallback(ch);
+                    return 1; // Suppress — typed into the menu
+                }
+            }
         }
     }
 
@@ -56,12 +56,21 @@ public:
 
     /// <summary>
     /// Callback to forward a virtual key to the Start Menu window.
-    /// Called for VK_UP, VK_DOWN, VK_RETURN, and VK_ESCAPE when the menu is visible.
+    /// Called for VK_UP, VK_DOWN, VK_RETURN, VK_ESCAPE and VK_BACK when the menu is visible.
     /// Implementation should PostMessage(menuHwnd, WM_KEYDOWN, vk, 0).
     /// </summary>
     using ForwardKeyCallback = std::function<void(UINT vk)>;
     void SetForwardKeyCallback(ForwardKeyCallback callback);
 
+    /// <summary>
+    /// Callback to forward a typed character (type-to-search) to the Start Menu window.
+    /// Called with the key translated through the foreground keyboard layout when the
+    /// menu is visible; Ctrl / Alt / Win chords and dead keys are not forwarded.
+    /// Implementation should PostMessage(menuHwnd, WM_CHAR, ch, 0).
+    /// </summary>
+    using ForwardCharCallback = std::function<void(wchar_t ch)>;
+    void SetForwardCharCallback(ForwardCharCallback callback);
+
 private:
     bool m_enabled = false;
     HHOOK m_keyboardHook = nullptr;
@@ -71,6 +80,7 @@ private:
     IsMenuVisibleCallback m_isMenuVisibleCallback;
     GetMenuBoundsCallback m_getMenuBoundsCallback;
     ForwardKeyCallback m_forwardKeyCallback;
+    ForwardCharCallback m_forwardCharCallback;
     HWND m_startButtonHwnd = nullptr;
     RECT m_startButtonFallbackRect = {};  // Used when Win32 HWND is unavailable (Win11 22H2+ WinUI 3 taskbar)
 
@@ -1,14 +1,21 @@
 #include "StartMenuWindow.h"
 #include "Diagnostics.h"
+#include "ProgramTreeSnapshot.h"
+#include "FuzzyMatch.h"
+#include "UserAssist.h"
+#include "IconDiskCache.h"   // RasterizeIcon
 #include "Renderer.h" // For ACCENT_POLICY / WINDOWCOMPOSITIONATTRIBDATA
 #include <dwmapi.h>
 #include <windowsx.h>
 #include <shellapi.h>
 #include <shlobj.h>
 #include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <powrprof.h>
@@ -48,31 +55,38 @@ static std::string WStringToString(const std::wstring& wstr) {
     return strTo;
 }
 
-static void DrawShadowText(HDC hdc, const wchar_t* text, int len,
-                           RECT* rect, UINT fmt, COLORREF fg) {
-    RECT sr = { rect->left + 1, rect->top + 1, rect->right + 1, rect->bottom + 1 };
-    ::SetTextColor(hdc, ShadowColorFor(fg));
-    DrawTextW(hdc, text, len, &sr, fmt | DT_NOCLIP);
-    ::SetTextColor(hdc, fg);
-    DrawTextW(hdc, text, len, rect, fmt);
-}
-
 /// S6.2: Search the All-Programs tree (case-insensitive) for a shortcut node
 /// whose display name matches |name|. Returns its lnkPath, or empty string.
 /// Used to find a .lnk file for pinned UWP apps (ms-settings:, calc.exe, etc.)
 /// whose command string is not a filesystem path that SHGetFileInfoW can resolve.
-static std::wstring FindLnkPathByName(const std::vector<MenuNode>& nodes,
-                                       const std::wstring& name) {
-    for (const auto& node : nodes) {
-        if (!node.isFolder) {
-            if (_wcsicmp(node.name.c_str(), name.c_str()) == 0 && !node.lnkPath.empty())
-                return node.lnkPath;
-        } else {
-            auto found = FindLnkPathByName(node.children, name);
-            if (!found.empty()) return found;
-        }
-    }
-    return {};
+static std::wstring FindLnkPathByName(const MenuTree& tree, const std::wstring& name) {
+    uint32_t idx = tree.FindShortcutByName(name);
+    if (idx == MenuTree::kNone) return {};
+    return std::wstring(tree.Node(idx).lnkPath());
+}
+
+/// Current time in FILETIME units (100 ns since 1601), for FrecencyStore.
+static std::uint64_t CurrentFileTimeTicks() {
+    FILETIME now = {};
+    GetSystemTimeAsFileTime(&now);
+    return (static_cast<std::uint64_t>(now.dwHighDateTime) << 32) | now.dwLowDateTime;
+}
+
+/// Icon pool workers: CoInitializeEx succeeded and needs its CoUninitialize
+/// (S_FALSE included; RPC_E_CHANGED_MODE does not, and calls still work).
+static thread_local bool t_iconWorkerCom = false;
+
+/// S7: the two UserAssist GUIDs the recent list reads — executables and
+/// shortcut links.
+static const wchar_t* const kUserAssistGuids[] = {
+    L"{CEBFF5CD-ACE2-4F4F-9178-9926F41749EA}",  // Applications (.exe)
+    L"{F4E57C4B-2036-45F0-A9AB-443BCFE33D9F}",  // Shortcut links (.lnk)
+};
+
+/// HKCU-relative path of a UserAssist GUID's Count key.
+static std::wstring UserAssistCountKey(const wchar_t* guid) {
+    return std::wstring(L"Software\\Microsoft\\Windows\\CurrentVersion\\"
+                        L"Explorer\\UserAssist\\") + guid + L"\\Count";
 }
 
 /// Enables SE_SHUTDOWN_NAME in the current process token so that
@@ -153,6 +167,7 @@ StartMenuWindow::StartMenuWindow() {
 
     LoadCustomNames();
     LoadRecentExcluded();
+    LoadFrecency();
     LoadCustomAvatarPath();
 }
 
@@ -176,6 +191,8 @@ void StartMenuWindow::CreateCachedFonts() {
     m_fontNormal12 = MakeFont(12, FW_NORMAL,  L"Segoe UI");
     m_fontSmall10  = MakeFont(10, FW_NORMAL,  L"Marlett");
     m_fontBold16   = MakeFont(16, FW_BOLD,    L"Segoe UI");
+    m_fontBold11   = MakeFont(11, FW_BOLD,    L"Segoe UI");
+    m_fontSemibold11 = MakeFont(11, FW_SEMIBOLD, L"Segoe UI");
 }
 
 void StartMenuWindow::DestroyCachedFonts() {
@@ -184,7 +201,118 @@ void StartMenuWindow::DestroyCachedFonts() {
     Del(m_fontNormal15);  Del(m_fontBold15);
     Del(m_fontNormal13);  Del(m_fontBold12);
     Del(m_fontNormal12);  Del(m_fontSmall10);
-    Del(m_fontBold16);
+    Del(m_fontBold16);    Del(m_fontBold11);
+    Del(m_fontSemibold11);
+    m_glyphs.Clear();   // keyed by the handles just deleted
+}
+
+// ── Back buffer and paint objects ─────────────────────────────────────────────
+bool StartMenuWindow::EnsureBackBuffer(HDC screenDC, int w, int h) {
+    if (m_backDC && m_backW == w && m_backH == h) return false;
+    ReleaseBackBuffer();
+
+    // A top-down 32 bpp DIB section, so DrawAtlasIcon() can blend into its
+    // pixels.
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize        = sizeof(bmi.bmiHeader);
+    bmi.bmiHeader.biWidth       = w;
+    bmi.bmiHeader.biHeight      = -h;
+    bmi.bmiHeader.biPlanes      = 1;
+    bmi.bmiHeader.biBitCount    = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+    void* bits = nullptr;
+    m_backDC  = CreateCompatibleDC(screenDC);
+    m_backBmp = CreateDIBSection(screenDC, &bmi, DIB_RGB_COLORS, &bits, nullptr, 0);
+    if (!m_backBmp) {
+        bits      = nullptr;
+        m_backBmp = CreateCompatibleBitmap(screenDC, w, h);
+    }
+    m_backOldBmp = SelectObject(m_backDC, m_backBmp);
+    m_backPixels = static_cast<std::uint32_t*>(bits);
+    m_backW      = w;
+    m_backH      = h;
+    m_scratchDC  = CreateCompatibleDC(screenDC);
+    CF_LOG(Info, "Back buffer " << w << "x" << h
+           << (m_backPixels ? " (DIB section)" : " (compatible bitmap)"));
+    return true;
+}
+
+void StartMenuWindow::ReleaseBackBuffer() {
+    if (m_backDC) {
+        SelectObject(m_backDC, m_backOldBmp);
+        DeleteDC(m_backDC);
+    }
+    if (m_backBmp)   DeleteObject(m_backBmp);
+    if (m_scratchDC) DeleteDC(m_scratchDC);
+    m_backDC     = nullptr;
+    m_backBmp    = nullptr;
+    m_backOldBmp = nullptr;
+    m_backPixels = nullptr;
+    m_backW      = 0;
+    m_backH      = 0;
+    m_scratchDC  = nullptr;
+}
+
+// ── Presentation ──────────────────────────────────────────────────────────────
+// The back buffer is a premultiplied DIB, the format UpdateLayeredWindow
+// takes, so every pixel carries its own alpha; a compatible bitmap has none
+// and goes out opaque.  InvalidateRect() still brings WM_PAINT to a window
+// presented this way; the system just never asks for one itself, as it
+// keeps the last frame.
+void StartMenuWindow::PresentFrame(const RECT* dirty) {
+    if (!m_backDC) return;
+    m_presentAlphaFormat = m_backPixels ? AC_SRC_ALPHA : 0;
+    BLENDFUNCTION blend = { AC_SRC_OVER, 0, m_fadeAlpha, m_presentAlphaFormat };
+    SIZE  size = { m_backW, m_backH };
+    POINT src  = { 0, 0 };
+    UPDATELAYEREDWINDOWINFO info = {};
+    info.cbSize   = sizeof(info);
+    info.psize    = &size;
+    info.hdcSrc   = m_backDC;
+    info.pptSrc   = &src;
+    info.pblend   = &blend;
+    info.dwFlags  = ULW_ALPHA;
+    info.prcDirty = dirty;
+    if (UpdateLayeredWindowIndirect(m_hwnd, &info))
+        m_framePresented = true;
+    else
+        CF_LOG(Warning, "UpdateLayeredWindowIndirect failed: " << GetLastError());
+}
+
+void StartMenuWindow::SetFadeAlpha(BYTE alpha) {
+    m_fadeAlpha = alpha;
+    if (!m_framePresented) return;   // the first frame goes out with it
+    BLENDFUNCTION blend = { AC_SRC_OVER, 0, alpha, m_presentAlphaFormat };
+    UpdateLayeredWindow(m_hwnd, nullptr, nullptr, nullptr, nullptr, nullptr, 0,
+                        &blend, ULW_ALPHA);
+}
+
+// Keys: kind in the top byte, then size / position, then the COLORREF.
+HBRUSH StartMenuWindow::SolidBrush(COLORREF color) {
+    HGDIOBJ& obj = m_paintObjects[(1ull << 56) | color];
+    if (!obj) { obj = CreateSolidBrush(color); ++m_paintCost.objects; }
+    return static_cast<HBRUSH>(obj);
+}
+
+HPEN StartMenuWindow::SolidPen(COLORREF color, int width) {
+    HGDIOBJ& obj = m_paintObjects[(2ull << 56) | (static_cast<std::uint64_t>(width & 0xFF) << 32) | color];
+    if (!obj) { obj = CreatePen(PS_SOLID, width, color); ++m_paintCost.objects; }
+    return static_cast<HPEN>(obj);
+}
+
+HRGN StartMenuWindow::EllipseRegion(int cx, int cy, int r) {
+    HGDIOBJ& obj = m_paintObjects[(3ull << 56) |
+                                  (static_cast<std::uint64_t>(cx & 0xFFFF) << 32) |
+                                  (static_cast<std::uint64_t>(cy & 0xFFFF) << 16) |
+                                  static_cast<std::uint64_t>(r & 0xFFFF)];
+    if (!obj) { obj = CreateEllipticRgn(cx - r, cy - r, cx + r, cy + r); ++m_paintCost.objects; }
+    return static_cast<HRGN>(obj);
+}
+
+void StartMenuWindow::ReleasePaintObjects() {
+    for (auto& entry : m_paintObjects)
+        if (entry.second) DeleteObject(entry.second);
+    m_paintObjects.clear();
 }
 
 // ── Initialization ───────────────────────────────────────────────────────────
@@ -226,13 +354,38 @@ bool StartMenuWindow::Initialize() {
     }
 
     // Phase S2 foundation: pre-cache All Programs tree synchronously.
-    // BuildAllProgramsTree() self-manages COM and must complete before the menu
-    // can be shown (navigation data is required). Icon loading is deferred to a
-    // background thread so Initialize() returns promptly and the hook thread is
-    // not blocked (a blocked hook thread causes Windows to time out WH_MOUSE_LL /
-    // WH_KEYBOARD_LL and stutter the mouse cursor for the entire init period).
-    m_programTree = BuildAllProgramsTree();
-    CF_LOG(Info, "All Programs tree cached: " << m_programTree.size() << " top-level nodes");
+    // The tree must exist before the menu can be shown (navigation data is
+    // required). Icon loading is deferred to a background thread so Initialize()
+    // returns promptly and the hook thread is not blocked (a blocked hook thread
+    // causes Windows to time out WH_MOUSE_LL / WH_KEYBOARD_LL and stutter the
+    // mouse cursor for the entire init period).
+    //
+    // Fast path: map the snapshot saved by the previous run when both Programs
+    // roots still carry the same timestamps, and rescan in the background.
+    // Otherwise scan now (self-manages COM) and save — in lazy mode only the
+    // top level, so this does not grow with the size of the Start Menu.
+    bool fromSnapshot = false;
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        ProgramTreeKey key;
+        if (ReadProgramTreeKey(key)) {
+            // Straight into the arena: no builder form in between.
+            std::lock_guard<std::mutex> lk(m_treeMutex);
+            fromSnapshot = LoadProgramTreeSnapshot(GetProgramTreeSnapshotPath(), key, m_programTree);
+        }
+        if (fromSnapshot) {
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - t0).count();
+            CF_LOG(Info, "All Programs tree loaded from snapshot in " << us << " us ("
+                   << m_programTree.NodeCount() << " nodes, arena "
+                   << m_programTree.MemoryBytes() / 1024 << " KB)");
+        } else {
+            std::vector<MenuNode> nodes = BuildProgramTreeWithSnapshot(m_lazyProgramTree);
+            std::lock_guard<std::mutex> lk(m_treeMutex);
+            InstallProgramTree(nodes);
+        }
+    }
+    CF_LOG(Info, "All Programs tree cached: " << m_programTree.Roots().size() << " top-level nodes");
 
     // Load dynamic pinned list from JSON (falls back to built-in defaults).
     LoadPinnedItems();
@@ -251,14 +404,31 @@ bool StartMenuWindow::Initialize() {
     // Cache taskbar/Start-button position so Show() is a single SetWindowPos call.
     CacheMenuPosition();
 
+    // Icons the disk cache still holds paint from the first Show(); the
+    // background pass below asks the shell only about the rest.
+    m_iconDiskCache.Open(IconDiskCache::DefaultPath());
+    m_iconCache.SetDiskCache(&m_iconDiskCache);
+    SeedIconsFromDisk();
+
     // Launch background thread for all SHGetFileInfoW / SHGetStockIconInfo calls.
-    // Icons paint as colored-square fallbacks until m_iconsLoaded becomes true.
-    m_iconThread = std::thread(&StartMenuWindow::LoadIconsAsync, this);
+    // Icons not seeded paint as colored-square fallbacks until the pass sets them.
+    m_iconPool.Start(IconLoadPool::DefaultWorkers(),
+                     [] { t_iconWorkerCom = SUCCEEDED(CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED)); },
+                     [] { if (t_iconWorkerCom) CoUninitialize(); });
+    QueueAllIcons();
+    StartIconPass();
 
     // Task 5 — start file-system watcher for Start Menu folders.
     // Fires WM_APP_REFRESH_TREE when shortcuts are installed/removed.
     StartFolderWatcher();
 
+    // S7 — build the recent list in the background and keep it current.
+    StartRecentWatcher();
+
+    // The snapshot may miss changes below the roots — confirm it off-thread.
+    if (fromSnapshot)
+        StartTreeRevalidation();
+
     // S-G: also kick off avatar loading in background (detached — result arrives via WM_AVATAR_LOADED)
     LoadAvatarAsync();
 
@@ -267,18 +437,31 @@ bool StartMenuWindow::Initialize() {
 }
 
 void StartMenuWindow::Shutdown() {
-    // Stop the file-system watcher first so it does not post new messages.
+    // Stop the watchers first so they do not post new messages.
     StopFolderWatcher();
-
-    // Wait for background icon thread to finish before releasing any resources
-    // it may still be writing to (m_pinnedIcons, m_rightIcons, m_recentItems, tree).
-    if (m_iconThread.joinable())
-        m_iconThread.join();
+    StopRecentWatcher();
+
+    // The revalidation scan, a folder prefetch and the search catalog scan
+    // post to m_hwnd; let them finish before teardown.
+    if (m_treeRevalidateThread.joinable())
+        m_treeRevalidateThread.join();
+    if (m_prefetchThread.joinable())
+        m_prefetchThread.join();
+    if (m_searchScanThread.joinable())
+        m_searchScanThread.join();
+
+    // Abandon the icon pass and stop its workers before releasing anything
+    // they may still be writing to (pinned items, m_rightIcons, tree).
+    CancelIconPass();
+    m_iconPool.Stop();
 
     // S6 / Task 7 — release all icon handles via IconCache (deduplication means
     // a single ReleaseAll() covers every HICON, including tree nodes, pinned items,
     // and right-column entries that were loaded through the cache).
     m_iconCache.ReleaseAll();
+    m_iconCache.SetDiskCache(nullptr);
+    m_iconDiskCache.Close();
+    m_iconAtlas.Clear();
 
     // Null out all dangling hIcon references so FreeNodeIcons / the loops below
     // are no-ops (icons already destroyed by the cache).
@@ -289,19 +472,26 @@ void StartMenuWindow::Shutdown() {
     }
     for (int i = 0; i < RIGHT_ITEM_COUNT; ++i)
         m_rightIcons[i] = nullptr;
-    FreeNodeIcons(m_programTree);   // safe: hIcon already nullptr after cache clear
+    FreeNodeIcons();   // safe: hIcon already nullptr after cache clear
 
-    // S7 — release recently used program icons (not in cache — each loaded once)
-    for (auto& ri : m_recentItems) {
-        if (ri.hIcon) { DestroyIcon(ri.hIcon); ri.hIcon = nullptr; }
+    // S7 — release recently used program icons (not in cache — each loaded
+    // once), including a list the watcher built that was never swapped in.
+    for (auto* list : { &m_recentItems, &m_pendingRecentItems }) {
+        for (auto& ri : *list) {
+            if (ri.hIcon) { DestroyIcon(ri.hIcon); ri.hIcon = nullptr; }
+        }
+        list->clear();
     }
-    m_recentItems.clear();
+    m_hasPendingRecentItems = false;
 
     // S-G — release avatar bitmap
     if (m_avatarBitmap) { DeleteObject(m_avatarBitmap); m_avatarBitmap = nullptr; }
 
-    // Release cached GDI fonts
+    // Release cached GDI fonts, paint objects and the back buffer
     DestroyCachedFonts();
+    ReleasePaintObjects();
+    ReleaseBackBuffer();
+    if (m_updateRgn) { DeleteObject(m_updateRgn); m_updateRgn = nullptr; }
 
     if (m_hwnd) {
         DestroyWindow(m_hwnd);
@@ -310,85 +500,376 @@ void StartMenuWindow::Shutdown() {
     m_visible = false;
 }
 
-// ── Background icon loading ───────────────────────────────────────────────────
-// Runs on m_iconThread. Loads all HICON handles that Initialize() used to do
-// synchronously. When done, signals m_iconsLoaded and requests a repaint.
-//
-// Thread-safety contract:
-//   • m_programTree is fully built (by BuildAllProgramsTree) before this thread
-//     starts, and the main thread never modifies it during icon loading (navigation
-//     only reads children pointers; Hide() only resets the nav stack).
-//   • m_dynamicPinnedItems is fully built (LoadPinnedItems) before this thread
-//     starts and is never resized during loading; hIcon writes are pointer-sized
-//     and safe on x86-64 (same guarantee as the former m_pinnedIcons[] array).
-//   • m_recentItems is empty until this thread assigns the final vector; paint
-//     code only iterates it after m_iconsLoaded == true (acquire).
-void StartMenuWindow::LoadIconsAsync() {
-    CF_LOG(Info, "LoadIconsAsync: start");
-
-    // Initialize COM on this thread so SHGetKnownFolderPath, SHGetFileInfoW,
-    // and any shell namespace calls work correctly.
-    HRESULT hrCom = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
-    // S_OK and S_FALSE both require a balancing CoUninitialize(); RPC_E_CHANGED_MODE
-    // means another thread already set the model — no balance needed, calls still work.
-    bool comInited = SUCCEEDED(hrCom);
-
-    // S6.1 — Pinned app icons (32×32). Use IconCache to avoid duplicate handles
-    // when a pinned item's command matches a path already loaded for the tree.
-    for (auto& item : m_dynamicPinnedItems) {
-        HICON icon = m_iconCache.GetIcon(item.command, /*small=*/false);
-        if (icon) { item.hIcon = icon; continue; }
-        // S6.2 — UWP fallback via .lnk in All Programs tree
-        std::wstring lnkPath = FindLnkPathByName(m_programTree, item.name);
-        if (!lnkPath.empty()) {
-            icon = m_iconCache.GetIcon(lnkPath, /*small=*/false);
-            if (icon) item.hIcon = icon;
-        }
-    }
+// ── Icon assignment ───────────────────────────────────────────────────────────
+// Fill in the pinned, All Programs and right-column icons through m_iconCache.
+// With |diskOnly| only the disk cache is consulted (see IconCache::GetIcon),
+// which is cheap enough for the UI thread; entries it lacks stay nullptr.
+void StartMenuWindow::AssignIcons(bool diskOnly) {
+    for (size_t i = 0; i < m_dynamicPinnedItems.size(); ++i)
+        LoadPinnedIcon(i, diskOnly);
 
     // S6.5 — All Programs tree icons (recursive). Locked so RefreshProgramTree
     // on the UI thread cannot swap the tree while we're writing into it.
     {
         std::lock_guard<std::mutex> lk(m_treeMutex);
-        LoadNodeIcons(m_programTree);
+        LoadNodeIcons(diskOnly);
     }
 
-    // S6.4 — Right-column icons (16×16). Use IconCache for dedup.
-    for (int i = 0; i < RIGHT_ITEM_COUNT; ++i) {
-        const Win7RightItem& ri = s_rightItems[i];
-        if (ri.isSeparator) continue;
-
-        std::wstring iconPath;
-        if (ri.folderId) {
-            PWSTR p = nullptr;
-            if (SUCCEEDED(SHGetKnownFolderPath(*ri.folderId, KF_FLAG_DEFAULT, nullptr, &p)) && p) {
-                iconPath = p;
-                CoTaskMemFree(p);
-            }
-        } else if (ri.target) {
-            iconPath = ri.target;
+    for (int i = 0; i < RIGHT_ITEM_COUNT; ++i)
+        LoadRightIcon(i, diskOnly);
+}
+
+// S6.1 — Pinned app icons (32×32). Use IconCache to avoid duplicate handles
+// when a pinned item's command matches a path already loaded for the tree.
+void StartMenuWindow::LoadPinnedIcon(size_t index, bool diskOnly) {
+    auto& item = m_dynamicPinnedItems[index];
+    HICON icon = m_iconCache.GetIcon(item.command, /*small=*/false, diskOnly);
+    if (icon) { StoreCachedIcon(item.hIcon, icon); return; }
+    // S6.2 — UWP fallback via .lnk in All Programs tree (which a folder
+    // expansion may be growing meanwhile).
+    std::wstring lnkPath;
+    std::vector<std::wstring> pending;
+    {
+        std::lock_guard<std::mutex> lk(m_treeMutex);
+        lnkPath = FindLnkPathByName(m_programTree, item.name);
+        if (lnkPath.empty() && !diskOnly) pending = PendingFolderPaths();
+    }
+    // A lazy tree holds nothing yet for the folders nobody has opened: the
+    // shortcut may be in one of them on disk.
+    if (lnkPath.empty() && !pending.empty())
+        lnkPath = PinnedShortcutOnDisk(index, pending);
+    if (!lnkPath.empty()) {
+        icon = m_iconCache.GetIcon(lnkPath, /*small=*/false, diskOnly);
+        if (icon) StoreCachedIcon(item.hIcon, icon);
+    }
+}
+
+// Every pinned item the tree lacks would otherwise walk the pending folders on
+// its own; the first one walks for all of them.  The pinned list is not
+// resized during a pass, so |index| stays valid.
+std::wstring StartMenuWindow::PinnedShortcutOnDisk(size_t index,
+                                                   const std::vector<std::wstring>& pending) {
+    std::lock_guard<std::mutex> lk(m_pinnedLookupMutex);
+    if (!m_pinnedLookupDone) {
+        std::vector<std::wstring> names;
+        names.reserve(m_dynamicPinnedItems.size());
+        for (const auto& item : m_dynamicPinnedItems) names.push_back(item.name);
+        auto t0 = std::chrono::steady_clock::now();
+        FindProgramShortcuts(pending, names, m_pinnedLookupPaths);
+        m_pinnedLookupDone = true;
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - t0).count();
+        CF_LOG(Debug, "Pinned shortcuts looked up on disk: " << names.size() << " names under "
+               << pending.size() << " pending folders in " << us << " us");
+    }
+    return index < m_pinnedLookupPaths.size() ? m_pinnedLookupPaths[index] : std::wstring();
+}
+
+// S6.4 — Right-column icons (16×16). Use IconCache for dedup.
+void StartMenuWindow::LoadRightIcon(int index, bool diskOnly) {
+    const Win7RightItem& ri = s_rightItems[index];
+    if (ri.isSeparator) return;
+
+    std::wstring iconPath;
+    if (ri.folderId) {
+        PWSTR p = nullptr;
+        if (SUCCEEDED(SHGetKnownFolderPath(*ri.folderId, KF_FLAG_DEFAULT, nullptr, &p)) && p) {
+            iconPath = p;
+            CoTaskMemFree(p);
+        }
+    } else if (ri.target) {
+        iconPath = ri.target;
+    }
+
+    if (!iconPath.empty())
+        StoreCachedIcon(m_rightIcons[index], m_iconCache.GetIcon(iconPath, /*small=*/true, diskOnly));
+}
+
+// A handle m_iconCache just gave out goes into |slot| unless TrimIconCache()
+// evicted it meanwhile; the slot then keeps what it had.  Workers publish
+// under m_treeMutex so that check and the trim's slot sweep cannot interleave.
+void StartMenuWindow::StoreCachedIcon(HICON& slot, HICON icon) {
+    std::lock_guard<std::mutex> lk(m_treeMutex);
+    if (m_iconCache.Owns(icon)) slot = icon;
+}
+
+// UI thread (paint): a pass may be storing into these slots right now.
+HICON StartMenuWindow::LoadedIcon(const HICON& slot) const {
+    std::lock_guard<std::mutex> lk(m_treeMutex);
+    return slot;
+}
+
+HICON StartMenuWindow::LoadedNodeIcon(uint32_t index, bool& evicted) const {
+    std::lock_guard<std::mutex> lk(m_treeMutex);
+    evicted = m_programTree.IconEvicted(index);
+    return m_programTree.Icon(index);
+}
+
+// Called on the UI thread while no icon pass runs, right before one starts.
+void StartMenuWindow::SeedIconsFromDisk() {
+    auto t0 = std::chrono::steady_clock::now();
+    AssignIcons(/*diskOnly=*/true);
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+    CF_LOG(Info, "Icons seeded from disk cache in " << us << " us");
+}
+
+// ── Icon load queue ───────────────────────────────────────────────────────────
+// An icon pass loads one slot at a time from m_iconQueue, so what is on screen
+// is never stuck behind thousands of tree icons nobody can see yet: pinned,
+// then the right column, then the All Programs level being shown, then the
+// hovered folder, then the rest of the tree.  (Recent items get their icons
+// on the recent watcher thread, alongside.)  Ids carry the slot kind in
+// their top two bits.
+
+static constexpr uint32_t kIconIdPinned = 0u << 30;
+static constexpr uint32_t kIconIdRight  = 1u << 30;
+static constexpr uint32_t kIconIdNode   = 2u << 30;
+static constexpr uint32_t kIconIdKind   = 3u << 30;
+
+IconTier StartMenuWindow::NodeIconTier(uint32_t index) const {
+    const uint32_t parent = m_programTree.Parent(index);
+    if (parent == (m_apNavStack.empty() ? MenuTree::kNone : m_apNavStack.back()))
+        return IconTier::CurrentLevel;
+    if (parent != MenuTree::kNone && parent == m_iconHoverFolder)
+        return IconTier::HoveredFolder;
+    return IconTier::Background;
+}
+
+// Called on the UI thread right before a full pass starts (no pass running);
+// slots the disk cache already filled are not queued.
+void StartMenuWindow::QueueAllIcons() {
+    std::lock_guard<std::mutex> qlk(m_iconQueueMutex);
+    m_iconQueue.Clear();
+    m_iconQueue.BeginBatch();
+    for (size_t i = 0; i < m_dynamicPinnedItems.size(); ++i)
+        if (!m_dynamicPinnedItems[i].hIcon)
+            m_iconQueue.Push(kIconIdPinned | static_cast<uint32_t>(i), IconTier::Pinned);
+    for (int i = 0; i < RIGHT_ITEM_COUNT; ++i)
+        if (!s_rightItems[i].isSeparator && !m_rightIcons[i])
+            m_iconQueue.Push(kIconIdRight | static_cast<uint32_t>(i), IconTier::RightColumn);
+    const uint32_t n = static_cast<uint32_t>(m_programTree.NodeCount());
+    for (uint32_t i = 0; i < n; ++i)
+        if (!m_programTree.Icon(i))
+            m_iconQueue.Push(kIconIdNode | i, NodeIconTier(i));
+    m_iconQueueOpen = true;
+}
+
+// Nodes added or replaced since the last pass (plus any whose load failed,
+// or still queued).  Nodes whose icon was evicted wait until Paint() shows
+// them again (m_iconReloads).  Holds both mutexes, queue → tree (nothing nests
+// them the other way round): the caller holds m_iconQueueMutex, and the scan
+// takes m_treeMutex for its whole length, since a pass still taking work has
+// workers calling SetIcon() meanwhile.
+void StartMenuWindow::QueueMissingNodeIcons() {
+    m_iconQueue.BeginBatch();
+    std::lock_guard<std::mutex> lk(m_treeMutex);
+    const uint32_t n = static_cast<uint32_t>(m_programTree.NodeCount());
+    for (uint32_t i = 0; i < n; ++i)
+        if (!m_programTree.Icon(i) && !m_programTree.IconEvicted(i))
+            m_iconQueue.Push(kIconIdNode | i, NodeIconTier(i));
+    for (uint32_t i : m_iconReloads) {
+        if (i >= n || !m_programTree.IconEvicted(i)) continue;
+        // Missing from here on: a load that fails is not asked for again
+        // by every frame.
+        m_programTree.SetIcon(i, nullptr);
+        m_iconQueue.Push(kIconIdNode | i, IconTier::CurrentLevel);
+    }
+    m_iconReloads.clear();
+}
+
+void StartMenuWindow::PrioritizeVisibleIcons(uint32_t hoveredFolder) {
+    m_iconHoverFolder = hoveredFolder;
+    std::lock_guard<std::mutex> qlk(m_iconQueueMutex);
+    if (!m_iconQueueOpen || m_iconQueue.Pending() == 0) return;
+    m_iconQueue.BeginBatch();
+    for (const MenuNodeView& node : CurrentApNodes())
+        m_iconQueue.Raise(kIconIdNode | node.index(), IconTier::CurrentLevel);
+    if (hoveredFolder != MenuTree::kNone)
+        for (const MenuNodeView& node : m_programTree.Children(hoveredFolder))
+            m_iconQueue.Raise(kIconIdNode | node.index(), IconTier::HoveredFolder);
+}
+
+// Icon workers: the next slot to load, most visible first.  The worker that
+// finds the queue empty closes it, so later expansions start a pass of their
+// own (LoadMissingIconsAsync).
+bool StartMenuWindow::NextQueuedIcon(uint32_t& id) {
+    std::lock_guard<std::mutex> qlk(m_iconQueueMutex);
+    if (m_iconQueue.Pop(id)) return true;
+    m_iconQueueOpen = false;
+    return false;
+}
+
+// Icon workers, after each load: paint picks icons up as they land, with a
+// repaint requested at most every ICON_REPAINT_MS across all workers.
+void StartMenuWindow::OnIconLanded() {
+    if (!m_hwnd) return;
+    const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t last = m_iconRepaintAt.load(std::memory_order_relaxed);
+    if (now - last < ICON_REPAINT_MS ||
+        !m_iconRepaintAt.compare_exchange_strong(last, now, std::memory_order_relaxed))
+        return;
+    if (!m_iconRepaintPosted.exchange(true, std::memory_order_acq_rel))
+        PostMessage(m_hwnd, WM_ICONS_LANDED, 0, 0);
+}
+
+void StartMenuWindow::LoadQueuedIcon(uint32_t id) {
+    const uint32_t index = id & ~kIconIdKind;
+    switch (id & kIconIdKind) {
+    case kIconIdPinned:
+        LoadPinnedIcon(index, /*diskOnly=*/false);
+        return;
+    case kIconIdRight:
+        LoadRightIcon(static_cast<int>(index), /*diskOnly=*/false);
+        return;
+    default:
+        break;
+    }
+
+    std::wstring lnkPath;
+    {
+        std::lock_guard<std::mutex> lk(m_treeMutex);
+        MenuNodeView node = m_programTree.Node(index);
+        if (node.hIcon()) return;
+        if (node.isFolder()) {
+            // Use IconCache: all folders share one SIID_FOLDER handle (no dup).
+            m_programTree.SetIcon(index, m_iconCache.GetStockIcon(SIID_FOLDER, /*small=*/true));
+            return;
         }
+        lnkPath = node.lnkPath();
+    }
+    if (lnkPath.empty()) return;
+    // Use IconCache: same .lnk loaded by pinned list AND tree → one handle.
+    HICON icon = m_iconCache.GetIcon(lnkPath, /*small=*/false);
+    std::lock_guard<std::mutex> lk(m_treeMutex);
+    if (m_iconCache.Owns(icon))   // see StoreCachedIcon()
+        m_programTree.SetIcon(index, icon);
+}
 
-        if (!iconPath.empty())
-            m_rightIcons[i] = m_iconCache.GetIcon(iconPath, /*small=*/true);
+// ── Background icon loading ───────────────────────────────────────────────────
+// A pass runs on m_iconPool's workers (each COM-initialized, apartment
+// threaded), several slots at a time, until m_iconQueue is empty.  The worker
+// finishing the last load saves the disk cache, runs |afterPass|, signals
+// m_iconsLoaded and requests a repaint.  The caller fills and opens the queue.
+//
+// Thread-safety contract:
+//   • m_programTree is fully built (InstallProgramTree) before a pass starts,
+//     and the UI thread only replaces it after CancelIconPass(); meanwhile it
+//     may ExpandFolder() under m_treeMutex, which keeps indices valid.  The
+//     shell is called without m_treeMutex held.
+//   • m_dynamicPinnedItems is fully built (LoadPinnedItems) before a pass
+//     starts and is never resized during loading: pin and unpin cancel the
+//     pass first and resume it after (ResumeIconPass).  Workers write
+//     distinct slots, under m_treeMutex (StoreCachedIcon) so TrimIconCache()
+//     never misses one.
+//   • m_iconCache and m_iconDiskCache lock internally; the shell and GDI work
+//     runs outside their locks.
+//   • m_recentItems is not touched here: the recent watcher thread builds it
+//     with its own icons (StartRecentWatcher).
+//   • Slots seeded from the disk cache are not queued; they keep their handle.
+void StartMenuWindow::StartIconPass(std::function<void()> afterPass) {
+    m_iconAfterPass = std::move(afterPass);
+    {
+        // The tree may have grown or the pinned list changed since the last pass.
+        std::lock_guard<std::mutex> lk(m_pinnedLookupMutex);
+        m_pinnedLookupDone = false;
+        m_pinnedLookupPaths.clear();
     }
+    m_iconPassBusy.store(true, std::memory_order_relaxed);
+    m_iconPool.Begin(
+        [this](uint32_t& id) { return NextQueuedIcon(id); },
+        [this](uint32_t id) {
+            LoadQueuedIcon(id);
+            OnIconLanded();
+        },
+        [this](const IconLoadPool::PassStats& stats) {
+            // Release ordering: every slot written above is visible to a
+            // thread that reads m_iconsLoaded with acquire ordering.
+            m_iconsLoaded.store(true, std::memory_order_release);
+            const double perSecond = stats.seconds > 0 ? stats.loads / stats.seconds : 0.0;
+            CF_LOG(Info, "Icon pass: " << stats.loads << " slots on " << stats.workers
+                   << " workers in " << static_cast<int64_t>(stats.seconds * 1000) << " ms ("
+                   << static_cast<int64_t>(perSecond) << "/s)");
+            const IconCache::Stats cache = m_iconCache.GetStats();
+            CF_LOG(Info, "Icon cache: " << cache.icons << " icons, " << cache.bytes / 1024
+                   << " KB (peak " << cache.peakIcons << " icons); " << cache.hits << " hits, "
+                   << cache.fromDisk << " from rasters, " << cache.fromShell << " from the shell, "
+                   << cache.evictions << " evicted");
+            CF_LOG(Info, "Icon dedup: " << cache.paths << " paths on " << cache.icons
+                   << " handles (" << (cache.icons ? static_cast<double>(cache.paths) / cache.icons : 0.0)
+                   << "x); " << cache.locationShares << " shared by icon location, "
+                   << cache.pixelShares << " by pixels");
+
+            // Persist what the shell just loaded for the next start.
+            m_iconDiskCache.Save();
+            if (m_iconAfterPass) {
+                std::function<void()> afterPass = std::move(m_iconAfterPass);
+                m_iconAfterPass = nullptr;
+                afterPass();
+            }
+            m_iconPassBusy.store(false, std::memory_order_release);
 
-    // S7 — recently used programs (builds a local vector, then moves it in).
-    // LoadRecentPrograms() writes directly to m_recentItems; it is safe here
-    // because the main thread only reads m_recentItems after m_iconsLoaded==true.
-    LoadRecentPrograms();
+            // Repaint so real icons replace the colored-square fallbacks.
+            if (m_hwnd)
+                PostMessage(m_hwnd, WM_ICONS_LOADED, 0, 0);
+        });
+}
 
-    // Signal completion with release ordering so all preceding writes are
-    // visible to any thread that subsequently reads with acquire ordering.
-    m_iconsLoaded.store(true, std::memory_order_release);
-    CF_LOG(Info, "LoadIconsAsync: done — requesting repaint");
+// UI thread.  Returns once no worker is inside a load of the abandoned pass;
+// whatever it had not started stays nullptr and is queued by the next pass.
+void StartMenuWindow::CancelIconPass() {
+    auto t0 = std::chrono::steady_clock::now();
+    m_iconPool.Cancel();
+    {
+        std::lock_guard<std::mutex> qlk(m_iconQueueMutex);
+        const size_t dropped = m_iconQueue.Pending();
+        m_iconQueue.Clear();
+        m_iconQueueOpen = false;
+        if (dropped) {
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - t0).count();
+            CF_LOG(Info, "Icon pass cancelled: " << dropped << " slots dropped, waited "
+                   << us << " us for loads in flight");
+        }
+    }
+    m_iconPassBusy.store(false, std::memory_order_release);
+}
 
-    if (comInited) CoUninitialize();
+// UI thread, after CancelIconPass(): start over on every slot still without
+// an icon, keeping the abandoned pass's |afterPass| (if it had not run yet).
+void StartMenuWindow::ResumeIconPass() {
+    QueueAllIcons();
+    StartIconPass(std::move(m_iconAfterPass));
+}
 
-    // If the Start Menu window already exists, request a repaint so real icons
-    // replace the colored-square fallbacks immediately.
-    if (m_hwnd)
-        PostMessage(m_hwnd, WM_ICONS_LOADED, 0, 0);
+// UI thread: hold m_iconCache to its budget while passes add to it.  Each
+// evicted handle leaves every tree slot and m_iconAtlas before it is
+// destroyed; a node that lost its icon is reloaded, from the disk cache's
+// raster, once Paint() shows it again.
+void StartMenuWindow::TrimIconCache() {
+    if (!m_iconCache.OverBudget()) return;
+    std::vector<HICON> evicted;
+    {
+        std::lock_guard<std::mutex> lk(m_treeMutex);
+        // Pinned and right-column icons are never given up: they are on
+        // screen whenever the Programs view is.
+        for (const auto& item : m_dynamicPinnedItems)
+            m_iconCache.MarkVisible(item.hIcon);
+        for (HICON icon : m_rightIcons)
+            m_iconCache.MarkVisible(icon);
+        if (!m_iconCache.Trim(evicted)) return;
+
+        std::unordered_set<HICON> gone(evicted.begin(), evicted.end());
+        const uint32_t n = static_cast<uint32_t>(m_programTree.NodeCount());
+        for (uint32_t i = 0; i < n; ++i)
+            if (m_programTree.Icon(i) && gone.count(m_programTree.Icon(i)))
+                m_programTree.EvictIcon(i);
+    }
+    for (HICON icon : evicted) {
+        m_iconAtlas.Remove(reinterpret_cast<std::uintptr_t>(icon));
+        DestroyIcon(icon);
+    }
 }
 
 // ── S-G: LoadAvatarAsync + DrawAvatarCircle ───────────────────────────────────
@@ -579,38 +1060,28 @@ void StartMenuWindow::LoadAvatarAsync() {
 // Draw a circular avatar at (cx, cy) with radius r.
 // Uses real account picture bitmap if loaded; otherwise draws blue circle + initial.
 void StartMenuWindow::DrawAvatarCircle(HDC hdc, int cx, int cy, int r) {
-    if (m_avatarBitmap) {
+    if (m_avatarBitmap && m_scratchDC) {
         // Clip drawing to ellipse, then StretchBlt the 96×96 bitmap into the circle.
-        HRGN clipRgn = CreateEllipticRgn(cx - r, cy - r, cx + r, cy + r);
-        int savedDC  = SaveDC(hdc);
-        SelectClipRgn(hdc, clipRgn);
+        int savedDC = SaveDC(hdc);
+        SelectClipRgn(hdc, EllipseRegion(cx, cy, r));
 
-        HDC memDC = CreateCompatibleDC(hdc);
-        HBITMAP oldBmp = (HBITMAP)SelectObject(memDC, m_avatarBitmap);
+        HBITMAP oldBmp = (HBITMAP)SelectObject(m_scratchDC, m_avatarBitmap);
         StretchBlt(hdc, cx - r, cy - r, r * 2, r * 2,
-                   memDC, 0, 0, 96, 96, SRCCOPY);
-        SelectObject(memDC, oldBmp);
-        DeleteDC(memDC);
+                   m_scratchDC, 0, 0, 96, 96, SRCCOPY);
+        SelectObject(m_scratchDC, oldBmp);
 
         RestoreDC(hdc, savedDC);
-        DeleteObject(clipRgn);
+        if (m_frame.Pixels()) {   // the blit copied the bitmap's alpha, not ours
+            GdiFlush();
+            m_frame.MakeOpaque({ cx - r, cy - r, cx + r, cy + r });
+        }
     } else {
         // Fallback: solid blue circle with initial letter
-        HBRUSH avBr  = CreateSolidBrush(RGB(0, 103, 192));
-        HPEN   noPen = (HPEN)GetStockObject(NULL_PEN);
-        HBRUSH ob    = (HBRUSH)SelectObject(hdc, avBr);
-        HPEN   op    = (HPEN)SelectObject(hdc, noPen);
-        Ellipse(hdc, cx - r, cy - r, cx + r, cy + r);
-        SelectObject(hdc, ob);
-        SelectObject(hdc, op);
-        DeleteObject(avBr);
-
-        // Initial letter
-        int fontSize = max(10, r - 2);
-        HFONT f = CreateFontW(fontSize, 0, 0, 0, FW_BOLD, FALSE, FALSE, FALSE,
-            DEFAULT_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS,
-            CLEARTYPE_QUALITY, DEFAULT_PITCH | FF_DONTCARE, L"Segoe UI");
-        HFONT oldF = (HFONT)SelectObject(hdc, f);
+        FillRounded(hdc, { cx - r, cy - r, cx + r, cy + r }, r, RGB(0, 103, 192));
+
+        // Initial letter, r - 2 px high: the right-column (r = 18) and
+        // bottom-bar (r = 13) avatars
+        HFONT oldF = (HFONT)SelectObject(hdc, r >= 18 ? m_fontBold16 : m_fontBold11);
         ::SetTextColor(hdc, RGB(255, 255, 255));
         SetBkMode(hdc, TRANSPARENT);
         wchar_t init[2] = { 
@@ -618,9 +1089,8 @@ void StartMenuWindow::DrawAvatarCircle(HDC hdc, int cx, int cy, int r) {
         0 
     };
         RECT tr = { cx - r, cy - r, cx + r, cy + r };
-        DrawTextW(hdc, init, 1, &tr, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
+        DrawLabel(hdc, init, 1, &tr, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
         SelectObject(hdc, oldF);
-        DeleteObject(f);
     }
 }
 
@@ -778,7 +1248,9 @@ bool StartMenuWindow::CreateMenuWindow() {
         return false;
     }
 
-    SetLayeredWindowAttributes(m_hwnd, 0, 255, LWA_ALPHA);
+    // Nothing shows until the first PresentFrame(): the window's pixels and
+    // alpha come from UpdateLayeredWindowIndirect, never from
+    // SetLayeredWindowAttributes (one call of that would make it fail).
 
     // Windows 11 rounded corners via DWM
     DWM_WINDOW_CORNER_PREFERENCE corner = DWMWCP_ROUND;
@@ -800,8 +1272,9 @@ void StartMenuWindow::Show(int /*x*/, int /*y*/) {
     // Refresh cached position in case the taskbar moved since last open.
     CacheMenuPosition();
 
-    // Refresh recent programs so newly-launched apps appear immediately.
-    { std::lock_guard<std::mutex> lk(m_treeMutex); LoadRecentPrograms(); }
+    // Take the recent list the watcher rebuilt since the last open, if any
+    // (a swap — the registry was read in the background).
+    ApplyPendingRecentItems();
 
     // Apply transparency once if not yet done (lazy: skip on every Show()).
     if (!m_transparencyApplied) {
@@ -810,13 +1283,17 @@ void StartMenuWindow::Show(int /*x*/, int /*y*/) {
     }
 
     // Start fade-in: set window alpha to 0, show, then ramp to 255 over ~80ms.
-    SetLayeredWindowAttributes(m_hwnd, 0, 0, LWA_ALPHA);
+    // Paint now what changed while hidden (everything, the first time), so
+    // the fade starts from the current frame.
+    SetFadeAlpha(0);
     SetWindowPos(m_hwnd, HWND_TOPMOST, m_cachedMenuX, m_cachedMenuY, 0, 0,
                  SWP_NOSIZE | SWP_SHOWWINDOW | SWP_NOACTIVATE);
     ShowWindow(m_hwnd, SW_SHOWNOACTIVATE);
     m_visible = true;
+    if (!m_framePresented)
+        InvalidateRect(m_hwnd, nullptr, FALSE);
+    UpdateWindow(m_hwnd);
 
-    m_fadeAlpha = 0;
     if (!m_fadeTimer)
         m_fadeTimer = SetTimer(m_hwnd, FADE_TIMER_ID, 16, NULL);
 
@@ -830,9 +1307,8 @@ void StartMenuWindow::Hide() {
 
     if (m_hwnd && m_visible) {
         if (m_fadeTimer) { KillTimer(m_hwnd, FADE_TIMER_ID); m_fadeTimer = 0; }
-        m_fadeAlpha = 255;
-        SetLayeredWindowAttributes(m_hwnd, 0, 255, LWA_ALPHA);
         ShowWindow(m_hwnd, SW_HIDE);
+        SetFadeAlpha(255);
         m_visible          = false;
         // Reset to Programs view on every hide
         m_viewMode         = LeftViewMode::Programs;
@@ -847,6 +1323,8 @@ void StartMenuWindow::Hide() {
         m_keySelApRow       = false;
         m_keySelApIndex     = -1;
         m_apScrollOffset    = 0;
+        m_searchQuery.clear();
+        m_searchResults.clear();
         if (m_hoverTimer) { KillTimer(m_hwnd, HOVER_TIMER_ID); m_hoverTimer = 0; }
         if (m_hoverAnimTimer) { KillTimer(m_hwnd, HOVER_ANIM_TIMER_ID); m_hoverAnimTimer = 0; }
         m_hoverAnimAlpha    = 255;
@@ -854,6 +1332,15 @@ void StartMenuWindow::Hide() {
         m_subMenuOpen       = false;
         m_subMenuNodeIdx    = -1;
         m_subMenuHoveredIdx = -1;
+        if (m_paintCost.paints > 0) {
+            const double fullPixels = static_cast<double>(m_paintCost.paints) * WIDTH * HEIGHT;
+            CF_LOG(Info, "Paint cost: " << m_paintCost.paints << " paints ("
+                   << m_paintCost.fullPaints << " full), " << m_paintCost.rows << " rows, "
+                   << static_cast<int>(100.0 * m_paintCost.pixels / fullPixels + 0.5)
+                   << "% of full-window pixels, " << m_paintCost.objects
+                   << " GDI objects created, " << m_paintCost.ms << " ms");
+        }
+        m_paintCost = {};
         CF_LOG(Info, "StartMenuWindow::Hide");
     }
 }
@@ -874,6 +1361,7 @@ void StartMenuWindow::SetOpacity(int opacity) {
 
 void StartMenuWindow::SetBackgroundColor(COLORREF color) {
     m_bgColor = color;
+    ReleasePaintObjects();
     m_transparencyApplied = false;
     if (m_visible) {
         ApplyTransparency();
@@ -884,6 +1372,7 @@ void StartMenuWindow::SetBackgroundColor(COLORREF color) {
 
 void StartMenuWindow::SetTextColor(COLORREF color) {
     m_textColor = color;
+    ReleasePaintObjects();
     if (m_visible) InvalidateRect(m_hwnd, NULL, FALSE);
 }
 
@@ -1014,9 +1503,34 @@ void StartMenuWindow::ForceHide() {
 void StartMenuWindow::SetBorderColor(COLORREF color) {
     m_borderColor         = color;
     m_borderColorOverride = true;
+    ReleasePaintObjects();
     if (m_visible) InvalidateRect(m_hwnd, NULL, FALSE);
 }
 
+// ── DrawAtlasIcon ─────────────────────────────────────────────────────────────
+void StartMenuWindow::DrawAtlasIcon(HDC hdc, HICON icon, int x, int y, int size) {
+    m_iconCache.MarkVisible(icon);   // kept while on screen
+    const auto id = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(icon));
+    const IconAtlas::Slot* slot = m_frame.Pixels() ? m_iconAtlas.Find(id, size) : nullptr;
+    if (m_frame.Pixels() && !slot) {
+        m_iconRaster.resize(static_cast<size_t>(size) * size);
+        if (RasterizeIcon(icon, size, m_iconRaster.data()))
+            slot = m_iconAtlas.Insert(id, size, m_iconRaster.data());
+    }
+    if (!slot) {
+        DrawIconEx(hdc, x, y, icon, size, size, 0, nullptr, DI_NORMAL);
+        if (m_frame.Pixels()) {   // GDI leaves alpha 0 behind
+            GdiFlush();
+            m_frame.MakeOpaque({ x, y, x + size, y + size });
+        }
+        return;
+    }
+    GdiFlush();   // GDI may still be drawing into the back buffer
+    m_frame.BlendImage(x, y,
+                       m_iconAtlas.Pixels() + static_cast<size_t>(slot->y) * IconAtlas::kWidth + slot->x,
+                       IconAtlas::kWidth, size, size);
+}
+
 // ── DrawIconSquare ────────────────────────────────────────────────────────────
 void StartMenuWindow::DrawIconSquare(HDC hdc, int cx, int cy, int sz,
                                      COLORREF bgColor, const wchar_t* label,
@@ -1025,115 +1539,207 @@ void StartMenuWindow::DrawIconSquare(HDC hdc, int cx, int cy, int sz,
     int x1 = cx - half, y1 = cy - half;
     int x2 = cx + half, y2 = cy + half;
 
-    HBRUSH icoBr  = CreateSolidBrush(bgColor);
-    HPEN   noPen  = (HPEN)GetStockObject(NULL_PEN);
-    HBRUSH oldBr  = (HBRUSH)SelectObject(hdc, icoBr);
-    HPEN   oldPen = (HPEN)SelectObject(hdc, noPen);
-    RoundRect(hdc, x1, y1, x2, y2, 6, 6);
-    SelectObject(hdc, oldBr);
-    SelectObject(hdc, oldPen);
-    DeleteObject(icoBr);
+    FillRounded(hdc, { x1, y1, x2, y2 }, 3, bgColor);
 
     if (label && label[0]) {
-        HFONT font = CreateFontW(
-            11, 0, 0, 0, FW_SEMIBOLD, FALSE, FALSE, FALSE,
-            DEFAULT_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS,
-            CLEARTYPE_QUALITY, DEFAULT_PITCH | FF_DONTCARE, L"Segoe UI");
-        HFONT oldFont = (HFONT)SelectObject(hdc, font);
+        HFONT oldFont = (HFONT)SelectObject(hdc, m_fontSemibold11);
         ::SetTextColor(hdc, textColor);
         SetBkMode(hdc, TRANSPARENT);
         RECT tr = { x1, y1, x2, y2 };
-        DrawTextW(hdc, label, -1, &tr, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
+        DrawLabel(hdc, label, -1, &tr, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
         SelectObject(hdc, oldFont);
-        DeleteObject(font);
     }
 }
 
 // ── DrawSeparator ─────────────────────────────────────────────────────────────
 void StartMenuWindow::DrawSeparator(HDC hdc, int y, int x1, int x2) {
-    HPEN pen    = CreatePen(PS_SOLID, 1, CalculateBorderColor());
-    HPEN oldPen = (HPEN)SelectObject(hdc, pen);
-    MoveToEx(hdc, x1, y, NULL);
-    LineTo(hdc, x2, y);
+    DrawLine(hdc, x1, y, x2, y, CalculateBorderColor());
+}
+
+// ── Shapes ────────────────────────────────────────────────────────────────────
+// m_frame writes the back buffer directly, so GDI's queued calls are flushed
+// first to keep the drawing order.
+static std::uint32_t FramePixel(COLORREF c) {
+    return RasterSurface::Color(GetRValue(c), GetGValue(c), GetBValue(c));
+}
+
+static RasterRect FrameRect(const RECT& r) {
+    return { r.left, r.top, r.right, r.bottom };
+}
+
+void StartMenuWindow::FillSolid(HDC hdc, const RECT& r, COLORREF color) {
+    if (m_frame.Pixels()) {
+        GdiFlush();
+        m_frame.FillRect(FrameRect(r), FramePixel(color));
+        return;
+    }
+    FillRect(hdc, &r, SolidBrush(color));
+}
+
+void StartMenuWindow::FillRounded(HDC hdc, const RECT& r, int radius, COLORREF color) {
+    if (m_frame.Pixels()) {
+        GdiFlush();
+        m_frame.FillRoundRect(FrameRect(r), radius, FramePixel(color));
+        return;
+    }
+    // Without a pen GDI leaves out the right and bottom edges; widen by one.
+    HBRUSH oldBr  = (HBRUSH)SelectObject(hdc, SolidBrush(color));
+    HPEN   oldPen = (HPEN)SelectObject(hdc, GetStockObject(NULL_PEN));
+    RoundRect(hdc, r.left, r.top, r.right + 1, r.bottom + 1, radius * 2, radius * 2);
+    SelectObject(hdc, oldBr);
     SelectObject(hdc, oldPen);
-    DeleteObject(pen);
+}
+
+void StartMenuWindow::StrokeRounded(HDC hdc, const RECT& r, int radius, int width,
+                                    COLORREF color) {
+    if (m_frame.Pixels()) {
+        GdiFlush();
+        m_frame.StrokeRoundRect(FrameRect(r), radius, width, FramePixel(color));
+        return;
+    }
+    // GDI centres a wider pen on the outline rather than inside it.
+    HPEN   oldPen = (HPEN)SelectObject(hdc, SolidPen(color, width));
+    HBRUSH oldBr  = (HBRUSH)SelectObject(hdc, GetStockObject(NULL_BRUSH));
+    if (radius > 0)
+        RoundRect(hdc, r.left, r.top, r.right, r.bottom, radius * 2, radius * 2);
+    else
+        Rectangle(hdc, r.left, r.top, r.right, r.bottom);
+    SelectObject(hdc, oldPen);
+    SelectObject(hdc, oldBr);
+}
+
+void StartMenuWindow::DrawLine(HDC hdc, int x0, int y0, int x1, int y1,
+                               COLORREF color, int width) {
+    if (m_frame.Pixels()) {
+        GdiFlush();
+        m_frame.DrawLine(x0, y0, x1, y1, width, FramePixel(color));
+        return;
+    }
+    HPEN oldPen = (HPEN)SelectObject(hdc, SolidPen(color, width));
+    MoveToEx(hdc, x0, y0, NULL);
+    LineTo(hdc, x1, y1);
+    SelectObject(hdc, oldPen);
+}
+
+// ── Labels ────────────────────────────────────────────────────────────────────
+// DrawTextW writes alpha 0, which the presented frame would show as holes;
+// m_frame's glyph runs carry alpha like its other primitives.  Text with an
+// '&' prefix to interpret, or a character the font itself lacks, is left to
+// DrawTextW (prefixes, font linking) and its box patched opaque.
+void StartMenuWindow::DrawLabel(HDC hdc, const wchar_t* text, int len, RECT* rect, UINT fmt) {
+    const size_t n    = len < 0 ? wcslen(text) : static_cast<size_t>(len);
+    HFONT        font = static_cast<HFONT>(GetCurrentObject(hdc, OBJ_FONT));
+    const bool shaped = m_frame.Pixels() && (fmt & DT_SINGLELINE) &&
+                        ((fmt & DT_NOPREFIX) || !wmemchr(text, L'&', n)) &&
+                        m_glyphs.Shape(hdc, font, text, n, m_glyphRun);
+    if (!shaped) {
+        DrawTextW(hdc, text, len, rect, fmt);
+        if (m_frame.Pixels()) {
+            GdiFlush();
+            m_frame.MakeOpaque(FrameRect(*rect));
+        }
+        return;
+    }
+
+    const GlyphCache::Metrics m = m_glyphs.FontMetrics(hdc, font);
+    const std::vector<RasterGlyph>& dots = m_glyphs.Ellipsis(hdc, font);
+    const RasterRect bounds = FrameRect(*rect);
+    RasterRect       box    = bounds;
+    if (!(fmt & DT_VCENTER))
+        box.bottom = box.top + m.ascent + m.descent;   // top-aligned line
+    const GlyphAlign align = (fmt & DT_CENTER) ? GlyphAlign::Center
+                           : (fmt & DT_RIGHT)  ? GlyphAlign::Right : GlyphAlign::Left;
+    const bool      cut  = (fmt & DT_END_ELLIPSIS) != 0;
+    const GlyphLine line = LayoutGlyphLine(m_glyphRun.data(), m_glyphRun.size(), box,
+                                           m.ascent, m.descent, align,
+                                           cut ? dots.data() : nullptr, cut ? dots.size() : 0);
+
+    const RasterRect    clip  = m_frame.Clip();
+    const std::uint32_t color = FramePixel(GetTextColor(hdc));
+    if (!(fmt & DT_NOCLIP))
+        m_frame.SetClip({ (std::max)(clip.left, bounds.left),   (std::max)(clip.top, bounds.top),
+                          (std::min)(clip.right, bounds.right), (std::min)(clip.bottom, bounds.bottom) });
+    GdiFlush();
+    const int x = m_frame.DrawGlyphRun(m_glyphRun.data(), line.count, line.x, line.baseline, color);
+    if (line.ellipsis)
+        m_frame.DrawGlyphRun(dots.data(), dots.size(), x, line.baseline, color);
+    m_frame.SetClip(clip);
+}
+
+void StartMenuWindow::DrawShadowText(HDC hdc, const wchar_t* text, int len,
+                                     RECT* rect, UINT fmt, COLORREF fg) {
+    RECT sr = { rect->left + 1, rect->top + 1, rect->right + 1, rect->bottom + 1 };
+    ::SetTextColor(hdc, ShadowColorFor(fg));
+    DrawLabel(hdc, text, len, &sr, fmt | DT_NOCLIP);
+    ::SetTextColor(hdc, fg);
+    DrawLabel(hdc, text, len, rect, fmt);
 }
 
 // ── S6 icon helpers ───────────────────────────────────────────────────────────
-// Walk the All-Programs tree and load a shell icon for every node.
+// Load a shell icon for every node of the All-Programs tree.
 // Folders get the standard SIID_FOLDER stock icon; shortcuts get the icon
 // embedded in (or pointed to by) their .lnk / .url file.
-// Called once from Initialize(), after BuildAllProgramsTree() has returned
-// the final, sorted, merged tree — so MergeTree/std::sort never see live HICONs.
-void StartMenuWindow::LoadNodeIcons(std::vector<MenuNode>& nodes) {
-    for (auto& node : nodes) {
-        if (node.isFolder) {
+// The tree is frozen, so this is one flat pass over the arena's records.
+// |diskOnly|: see IconCache::GetIcon.
+void StartMenuWindow::LoadNodeIcons(bool diskOnly) {
+    auto t0 = std::chrono::steady_clock::now();
+    const uint32_t n = static_cast<uint32_t>(m_programTree.NodeCount());
+    for (uint32_t i = 0; i < n; ++i) {
+        // Seeding stops at the cache budget, the top levels first (the tree
+        // is breadth-first); the icon pass loads the rest, trimming as it goes.
+        if (diskOnly && m_iconCache.OverBudget()) break;
+        MenuNodeView node = m_programTree.Node(i);
+        if (node.isFolder()) {
             // Use IconCache: all folders share one SIID_FOLDER handle (no dup).
-            node.hIcon = m_iconCache.GetStockIcon(SIID_FOLDER, /*small=*/true);
-            LoadNodeIcons(node.children);   // recurse
-        } else if (!node.lnkPath.empty()) {
+            m_programTree.SetIcon(i, m_iconCache.GetStockIcon(SIID_FOLDER, /*small=*/true));
+        } else if (!node.lnkPath().empty()) {
             // Use IconCache: same .lnk loaded by pinned list AND tree → one handle.
-            node.hIcon = m_iconCache.GetIcon(node.lnkPath, /*small=*/false);
+            m_programTree.SetIcon(i, m_iconCache.GetIcon(std::wstring(node.lnkPath()), /*small=*/false,
+                                                         diskOnly));
         }
     }
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+    CF_LOG(Info, "LoadNodeIcons" << (diskOnly ? " (disk cache)" : "") << ": " << n
+           << " nodes in " << ms << " ms");
 }
 
-// Walk the tree and clear every hIcon pointer to nullptr.
+// Clear every hIcon pointer in the tree to nullptr.
 // NOTE: tree icons are always loaded through m_iconCache (LoadNodeIcons uses
 // m_iconCache.GetIcon / GetStockIcon), so DestroyIcon must NOT be called here —
 // m_iconCache.ReleaseAll() is the sole owner and will call DestroyIcon once.
 // This function exists only to null out dangling pointers after the cache is cleared.
-void StartMenuWindow::FreeNodeIcons(std::vector<MenuNode>& nodes) {
-    for (auto& node : nodes) {
-        node.hIcon = nullptr;
-        if (node.isFolder) FreeNodeIcons(node.children);
-    }
+void StartMenuWindow::FreeNodeIcons() {
+    m_programTree.ClearIcons();
+}
+
+// Freeze a freshly built / loaded / patched tree into the arena.
+void StartMenuWindow::InstallProgramTree(const std::vector<MenuNode>& nodes) {
+    auto t0 = std::chrono::steady_clock::now();
+    m_programTree.Assign(nodes);
+    auto t1 = std::chrono::steady_clock::now();
+    CF_LOG(Info, "InstallProgramTree: " << m_programTree.NodeCount() << " nodes, "
+           << m_programTree.MemoryBytes() / 1024 << " KB, frozen in "
+           << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us");
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
 // S7 — LoadRecentPrograms
 // Reads Windows UserAssist registry to find the most recently used programs.
-// UserAssist stores ROT13-encoded paths with run count + FILETIME last run.
-// We load both the Applications GUID and the Shortcut Links GUID, decode,
-// filter to .exe/.lnk, sort by last-run time, deduplicate against pinned list,
-// and keep the top RECENT_COUNT entries.
-//
-// Data format (Windows Vista+ — 24+ bytes per value):
-//   offset 0  : DWORD — unknown / session count
-//   offset 4  : DWORD — run count (0 = never counted)
-//   offset 8  : DWORD — focus count
-//   offset 12 : DWORD — focus time (ms)
-//   offset 16 : FILETIME (8 bytes) — last execution time
+// We load both the Applications GUID and the Shortcut Links GUID, decode the
+// values (UserAssist.h), add the launches recorded in m_frecency, and take
+// the best-ranked candidates until RECENT_COUNT survive the shell lookup,
+// the exclusions and the pinned / duplicate name checks.
+// Called on the recent watcher thread only; UI-thread state comes in |in|.
 // ─────────────────────────────────────────────────────────────────────────────
-void StartMenuWindow::LoadRecentPrograms() {
-    m_recentItems.clear();
-
-    // ROT13 decode: shift alphabetic chars by 13 positions.
-    auto rot13 = [](std::wstring s) -> std::wstring {
-        for (wchar_t& c : s) {
-            if      (c >= L'a' && c <= L'z') c = static_cast<wchar_t>(L'a' + (c - L'a' + 13) % 26);
-            else if (c >= L'A' && c <= L'Z') c = static_cast<wchar_t>(L'A' + (c - L'A' + 13) % 26);
-        }
-        return s;
-    };
-
-    struct UAEntry {
-        std::wstring path;
-        DWORD        count;
-        FILETIME     lastRun;
-    };
-    std::vector<UAEntry> entries;
-
-    // Two UserAssist GUIDs: executables + shortcut links
-    static const wchar_t* kGuids[] = {
-        L"{CEBFF5CD-ACE2-4F4F-9178-9926F41749EA}",  // Applications (.exe)
-        L"{F4E57C4B-2036-45F0-A9AB-443BCFE33D9F}",  // Shortcut links (.lnk)
-    };
+std::vector<RecentItem> StartMenuWindow::LoadRecentPrograms(
+        const RecentInputs& in, const std::set<std::wstring>& iconsHeld) const {
+    std::vector<RecentItem> items;
+    RecentCandidates candidates;
+    UserAssistRecord record;
 
-    for (const auto* guid : kGuids) {
-        std::wstring keyPath =
-            std::wstring(L"Software\\Microsoft\\Windows\\CurrentVersion\\"
-                         L"Explorer\\UserAssist\\") + guid + L"\\Count";
+    for (const auto* guid : kUserAssistGuids) {
+        const std::wstring keyPath = UserAssistCountKey(guid);
 
         HKEY hKey = nullptr;
         if (RegOpenKeyExW(HKEY_CURRENT_USER, keyPath.c_str(), 0,
@@ -1145,6 +1751,7 @@ void StartMenuWindow::LoadRecentPrograms() {
                          nullptr, &valueCount, &maxNameLen, &maxDataLen,
                          nullptr, nullptr);
         ++maxNameLen; // include null terminator
+        candidates.Reserve(valueCount);
 
         std::vector<wchar_t> nameBuf(maxNameLen + 1);
         const DWORD kMinDataBuf = 72u;
@@ -1158,112 +1765,70 @@ void StartMenuWindow::LoadRecentPrograms() {
             if (RegEnumValueW(hKey, idx, nameBuf.data(), &nameLen, nullptr,
                               &type, dataBuf.data(), &dataLen) != ERROR_SUCCESS)
                 continue;
-            if (type != REG_BINARY || dataLen < 20) continue;
-
-            // Decode ROT13 — UserAssist encodes value names to deter peeking
-            std::wstring decoded = rot13(std::wstring(nameBuf.data(), nameLen));
-
-            // Truncate at embedded NUL (some entries append window title after \0)
-            auto nul = decoded.find(L'\0');
-            if (nul != std::wstring::npos) decoded.resize(nul);
-            if (decoded.empty()) continue;
-
-            // Skip UserAssist metadata entries (UEME_*)
-            if (decoded.size() >= 5 && decoded.substr(0, 5) == L"UEME_") continue;
-
-            // Extract run count (offset 4) and last-run FILETIME (offset 16)
-            DWORD    count   = 0;
-            FILETIME lastRun = {};
-            memcpy(&count,   dataBuf.data() + 4,  sizeof(DWORD));
-            memcpy(&lastRun, dataBuf.data() + 16, sizeof(FILETIME));
-            if (count == 0) continue;
-
-            // Accept only .exe and .lnk paths
-            auto lower = decoded;
-            for (auto& c : lower) c = static_cast<wchar_t>(towlower(c));
-            bool isExe = lower.size() > 4 && lower.compare(lower.size() - 4, 4, L".exe") == 0;
-            bool isLnk = lower.size() > 4 && lower.compare(lower.size() - 4, 4, L".lnk") == 0;
-            if (!isExe && !isLnk) continue;
+            if (type != REG_BINARY) continue;
+            if (!DecodeUserAssistValue(std::wstring_view(nameBuf.data(), nameLen),
+                                       dataBuf.data(), dataLen, record))
+                continue;
 
             // Expand environment variables (%windir%, %appdata%, etc.)
             wchar_t expanded[MAX_PATH] = {};
-            DWORD expLen = ExpandEnvironmentStringsW(decoded.c_str(), expanded,
+            DWORD expLen = ExpandEnvironmentStringsW(record.path.c_str(), expanded,
                                                      static_cast<DWORD>(MAX_PATH));
-            std::wstring path = (expLen > 1 && expLen <= MAX_PATH) ? expanded : decoded;
-
-            entries.push_back({path, count, lastRun});
+            if (expLen > 1 && expLen <= MAX_PATH) record.path = expanded;
+            candidates.Add(record);
         }
 
         RegCloseKey(hKey);
     }
 
-    // Sort descending by last-run FILETIME (most recent first)
-    std::sort(entries.begin(), entries.end(), [](const UAEntry& a, const UAEntry& b) {
-        if (a.lastRun.dwHighDateTime != b.lastRun.dwHighDateTime)
-            return a.lastRun.dwHighDateTime > b.lastRun.dwHighDateTime;
-        return a.lastRun.dwLowDateTime > b.lastRun.dwLowDateTime;
-    });
+    // The menu's own launches: a target UserAssist also knows gets both
+    // histories combined; the rest join as menu-only candidates.
+    for (const auto& launch : m_frecency.Snapshot())
+        candidates.AddLaunches(launch);
+
+    RecentNameFilter names(in.pinnedNames);
+    std::wstring lowerPath;
+    while (static_cast<int>(items.size()) < RECENT_COUNT) {
+        const RecentCandidates::Candidate* c = candidates.Next();
+        if (!c) break;
+        const std::wstring path(c->path);
 
-    // Collect up to RECENT_COUNT unique entries not already in the pinned list
-    for (const auto& e : entries) {
-        if (static_cast<int>(m_recentItems.size()) >= RECENT_COUNT) break;
+        // Skip if user removed this from the recent list
+        lowerPath.resize(path.size());
+        for (size_t i = 0; i < path.size(); ++i)
+            lowerPath[i] = static_cast<wchar_t>(towlower(path[i]));
+        if (in.excluded.count(lowerPath)) continue;
 
         // Get display name via shell (handles .lnk resolution + UWP app names)
         SHFILEINFOW sfi = {};
-        if (!SHGetFileInfoW(e.path.c_str(), 0, &sfi, sizeof(sfi),
+        if (!SHGetFileInfoW(path.c_str(), 0, &sfi, sizeof(sfi),
                             SHGFI_DISPLAYNAME))
             continue;                      // path doesn't exist / not accessible
         std::wstring displayName = sfi.szDisplayName;
+        TrimProgramExtension(displayName);
         if (displayName.empty()) continue;
 
-        // Remove trailing ".lnk" / ".exe" that some shells leave in display name
-        auto lowerName = displayName;
-        for (auto& c : lowerName) c = static_cast<wchar_t>(towlower(c));
-        if (lowerName.size() > 4) {
-            auto ext = lowerName.substr(lowerName.size() - 4);
-            if (ext == L".lnk" || ext == L".exe")
-                displayName.resize(displayName.size() - 4);
-        }
-
-        // Skip if user removed this from the recent list
-        {
-            std::wstring lowerPath = e.path;
-            for (auto& c : lowerPath) c = static_cast<wchar_t>(towlower(c));
-            if (m_recentExcluded.count(lowerPath)) continue;
-        }
-
-        // Skip if already in pinned list (case-insensitive name match)
-        bool alreadyPinned = false;
-        for (const auto& pin : m_dynamicPinnedItems) {
-            auto pn = pin.name;
-            auto dn = displayName;
-            for (auto& c : pn) c = static_cast<wchar_t>(towlower(c));
-            for (auto& c : dn) c = static_cast<wchar_t>(towlower(c));
-            if (pn == dn) { alreadyPinned = true; break; }
-        }
-        if (alreadyPinned) continue;
+        // Skip pinned names and names already on the recent list
+        if (!names.Admit(displayName)) continue;
 
-        // Skip duplicate display names already added to recent list
-        bool dupName = false;
-        for (const auto& ri : m_recentItems) {
-            auto a = ri.name, b = displayName;
-            for (auto& c : a) c = static_cast<wchar_t>(towlower(c));
-            for (auto& c : b) c = static_cast<wchar_t>(towlower(c));
-            if (a == b) { dupName = true; break; }
-        }
-        if (dupName) continue;
-
-        // Load icon (reuse the SHGetFileInfoW call with SHGFI_ICON this time)
+        // Load icon (reuse the SHGetFileInfoW call with SHGFI_ICON this time),
+        // unless the list being replaced already holds one for this path.
         HICON hIcon = nullptr;
         SHFILEINFOW sfiIcon = {};
-        if (SHGetFileInfoW(e.path.c_str(), 0, &sfiIcon, sizeof(sfiIcon),
+        if (!iconsHeld.count(path) &&
+            SHGetFileInfoW(path.c_str(), 0, &sfiIcon, sizeof(sfiIcon),
                            SHGFI_ICON | SHGFI_LARGEICON) && sfiIcon.hIcon)
             hIcon = sfiIcon.hIcon;
 
-        m_recentItems.push_back({e.path, displayName, hIcon, e.lastRun, e.count});
+        FILETIME lastRun = {};
+        lastRun.dwLowDateTime  = static_cast<DWORD>(c->lastRunTicks);
+        lastRun.dwHighDateTime = static_cast<DWORD>(c->lastRunTicks >> 32);
+        items.push_back({path, displayName, hIcon, lastRun, c->runCount, c->rank});
     }
 
-    CF_LOG(Info, "LoadRecentPrograms: " << m_recentItems.size() << " entries loaded");
+    CF_LOG(Info, "LoadRecentPrograms: " << items.size() << " of "
+           << candidates.Size() << " candidates loaded");
+    return items;
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
@@ -1272,10 +1837,9 @@ void StartMenuWindow::LoadRecentPrograms() {
 // ─────────────────────────────────────────────────────────────────────────────
 void StartMenuWindow::PaintProgramsList(HDC hdc, const RECT& cr) {
     (void)cr;
-    // All-or-nothing gate: use real icons only after the background thread has
-    // finished ALL writes. Prevents flickering caused by partially-loaded icon
-    // arrays being visible on intermediate hover repaints.
-    const bool iconsReady = m_iconsLoaded.load(std::memory_order_acquire);
+    // Icons show up progressively: each row draws whatever its slot holds now
+    // (copied under m_treeMutex, LoadedIcon) and the fallback square until the
+    // pass gets to it; OnIconLanded() throttles the repaints that pick them up.
     SetBkMode(hdc, TRANSPARENT);
 
     HFONT oldF = (HFONT)SelectObject(hdc, m_fontNormal14);
@@ -1284,31 +1848,26 @@ void StartMenuWindow::PaintProgramsList(HDC hdc, const RECT& cr) {
     for (int i = 0; i < pinnedCount; ++i) {
         const DynamicPinnedItem& item = m_dynamicPinnedItems[static_cast<size_t>(i)];
         int itemY = PROG_Y + i * PROG_ITEM_H;
+        if (!NeedsPaint(ProgRowRect(i))) continue;
+        ++m_paintCost.rows;
 
         // Hover / keyboard-selection highlight — S-C uses AnimatedHoverColor()
         bool isKeySel = (i == m_keySelProgIndex);
         bool isHover  = (i == m_hoveredProgIndex) && !isKeySel;
         if (isKeySel || isHover) {
             COLORREF hlColor = isKeySel ? CalculateSelectionColor() : AnimatedHoverColor();
-            HBRUSH hBr  = CreateSolidBrush(hlColor);
-            HPEN   noPn = (HPEN)GetStockObject(NULL_PEN);
-            HBRUSH ob   = (HBRUSH)SelectObject(hdc, hBr);
-            HPEN   op   = (HPEN)SelectObject(hdc, noPn);
-            RoundRect(hdc, MARGIN, itemY + 2,
-                      DIVIDER_X - MARGIN, itemY + PROG_ITEM_H - 2, 6, 6);
-            SelectObject(hdc, ob);
-            SelectObject(hdc, op);
-            DeleteObject(hBr);
+            FillRounded(hdc, { MARGIN, itemY + 2,
+                               DIVIDER_X - MARGIN, itemY + PROG_ITEM_H - 2 }, 3, hlColor);
         }
 
         // Icon — custom icon > system icon > colored square fallback
         int iconCX = MARGIN + PROG_ICON_SZ / 2 + 4;
         int iconCY = itemY + PROG_ITEM_H / 2;
         HICON effectiveIcon = item.hCustomIcon ? item.hCustomIcon
-                            : (iconsReady ? item.hIcon : nullptr);
+                            : LoadedIcon(item.hIcon);
         if (effectiveIcon) {
-            DrawIconEx(hdc, iconCX - PROG_ICON_SZ / 2, iconCY - PROG_ICON_SZ / 2,
-                       effectiveIcon, PROG_ICON_SZ, PROG_ICON_SZ, 0, nullptr, DI_NORMAL);
+            DrawAtlasIcon(hdc, effectiveIcon, iconCX - PROG_ICON_SZ / 2,
+                          iconCY - PROG_ICON_SZ / 2, PROG_ICON_SZ);
         } else {
             DrawIconSquare(hdc, iconCX, iconCY, PROG_ICON_SZ,
                            item.iconColor, item.shortName.c_str());
@@ -1323,7 +1882,7 @@ void StartMenuWindow::PaintProgramsList(HDC hdc, const RECT& cr) {
 
     // ── S7: Recently used programs — below pinned items ──────────────────────
     // Only read m_recentItems after m_iconsLoaded (acquire) so the vector
-    // contents are fully visible (happens-before the release store in LoadIconsAsync).
+    // contents are fully visible (happens-before the release store ending an icon pass).
     int recentCount  = m_iconsLoaded.load(std::memory_order_acquire)
                        ? static_cast<int>(m_recentItems.size()) : 0;
     int recentStartY = PROG_Y + pinnedCount * PROG_ITEM_H + 12; // 12px gap (4 sep + 8 pad)
@@ -1331,30 +1890,24 @@ void StartMenuWindow::PaintProgramsList(HDC hdc, const RECT& cr) {
     for (int i = 0; i < recentCount; ++i) {
         int itemIdx = pinnedCount + i;
         int itemY   = recentStartY + i * PROG_ITEM_H;
+        if (!NeedsPaint(ProgRowRect(itemIdx))) continue;
+        ++m_paintCost.rows;
 
         // Hover / keyboard-selection highlight
         bool isKeySel = (itemIdx == m_keySelProgIndex);
         bool isHover  = (itemIdx == m_hoveredProgIndex) && !isKeySel;
         if (isKeySel || isHover) {
             COLORREF hlColor = isKeySel ? CalculateSelectionColor() : AnimatedHoverColor();
-            HBRUSH hBr  = CreateSolidBrush(hlColor);
-            HPEN   noPn = (HPEN)GetStockObject(NULL_PEN);
-            HBRUSH ob   = (HBRUSH)SelectObject(hdc, hBr);
-            HPEN   op   = (HPEN)SelectObject(hdc, noPn);
-            RoundRect(hdc, MARGIN, itemY + 2,
-                      DIVIDER_X - MARGIN, itemY + PROG_ITEM_H - 2, 6, 6);
-            SelectObject(hdc, ob);
-            SelectObject(hdc, op);
-            DeleteObject(hBr);
+            FillRounded(hdc, { MARGIN, itemY + 2,
+                               DIVIDER_X - MARGIN, itemY + PROG_ITEM_H - 2 }, 3, hlColor);
         }
 
         // Icon
         int iconCX = MARGIN + PROG_ICON_SZ / 2 + 4;
         int iconCY = itemY + PROG_ITEM_H / 2;
         if (m_recentItems[i].hIcon) {
-            DrawIconEx(hdc, iconCX - PROG_ICON_SZ / 2, iconCY - PROG_ICON_SZ / 2,
-                       m_recentItems[i].hIcon, PROG_ICON_SZ, PROG_ICON_SZ,
-                       0, nullptr, DI_NORMAL);
+            DrawAtlasIcon(hdc, m_recentItems[i].hIcon, iconCX - PROG_ICON_SZ / 2,
+                          iconCY - PROG_ICON_SZ / 2, PROG_ICON_SZ);
         } else {
             // Fallback: gray square with first 3 chars of name
             std::wstring fb = m_recentItems[i].name.size() > 3
@@ -1386,7 +1939,6 @@ void StartMenuWindow::PaintProgramsList(HDC hdc, const RECT& cr) {
 // ─────────────────────────────────────────────────────────────────────────────
 void StartMenuWindow::PaintAllProgramsView(HDC hdc, const RECT& cr) {
     (void)cr;
-    const bool iconsReady = m_iconsLoaded.load(std::memory_order_acquire);
     SetBkMode(hdc, TRANSPARENT);
 
     const auto& nodes = CurrentApNodes();
@@ -1402,35 +1954,32 @@ void StartMenuWindow::PaintAllProgramsView(HDC hdc, const RECT& cr) {
     HFONT oldF = (HFONT)SelectObject(hdc, m_fontNormal14);
 
     for (int i = 0; i < count; ++i) {
-        int             nodeIdx = m_apScrollOffset + i;
-        const MenuNode& node    = nodes[static_cast<size_t>(nodeIdx)];
-        int             itemY   = PROG_Y + i * PROG_ITEM_H;
+        int          nodeIdx = m_apScrollOffset + i;
+        MenuNodeView node    = nodes[static_cast<size_t>(nodeIdx)];
+        int          itemY   = PROG_Y + i * PROG_ITEM_H;
+        if (!NeedsPaint(ApListRowRect(nodeIdx))) continue;
+        ++m_paintCost.rows;
 
         // Hover / keyboard-selection highlight — S-C animated hover
         bool isKeySel = (nodeIdx == m_keySelApIndex);
         bool isHover  = (nodeIdx == m_hoveredApIndex) && !isKeySel;
         if (isKeySel || isHover) {
             COLORREF hlColor = isKeySel ? CalculateSelectionColor() : AnimatedHoverColor();
-            HBRUSH hBr  = CreateSolidBrush(hlColor);
-            HPEN   noPn = (HPEN)GetStockObject(NULL_PEN);
-            HBRUSH ob   = (HBRUSH)SelectObject(hdc, hBr);
-            HPEN   op   = (HPEN)SelectObject(hdc, noPn);
-            RoundRect(hdc, MARGIN, itemY + 2,
-                      DIVIDER_X - MARGIN, itemY + PROG_ITEM_H - 2, 6, 6);
-            SelectObject(hdc, ob);
-            SelectObject(hdc, op);
-            DeleteObject(hBr);
+            FillRounded(hdc, { MARGIN, itemY + 2,
+                               DIVIDER_X - MARGIN, itemY + PROG_ITEM_H - 2 }, 3, hlColor);
         }
 
         int iconCX = MARGIN + PROG_ICON_SZ / 2 + 4;
         int iconCY = itemY + PROG_ITEM_H / 2;
 
-        if (iconsReady && node.hIcon) {
+        bool  evicted = false;
+        HICON icon    = LoadedNodeIcon(node.index(), evicted);
+        if (icon) {
             // Real system icon from shell
-            DrawIconEx(hdc, iconCX - PROG_ICON_SZ / 2, iconCY - PROG_ICON_SZ / 2,
-                       node.hIcon, PROG_ICON_SZ, PROG_ICON_SZ, 0, nullptr, DI_NORMAL);
+            DrawAtlasIcon(hdc, icon, iconCX - PROG_ICON_SZ / 2,
+                          iconCY - PROG_ICON_SZ / 2, PROG_ICON_SZ);
             SelectObject(hdc, m_fontNormal14);
-        } else if (node.isFolder) {
+        } else if (node.isFolder()) {
             // Folder fallback: amber square with "›" glyph
             DrawIconSquare(hdc, iconCX, iconCY, PROG_ICON_SZ,
                            RGB(210, 150, 20), L"\u203a");
@@ -1440,11 +1989,13 @@ void StartMenuWindow::PaintAllProgramsView(HDC hdc, const RECT& cr) {
             DrawIconSquare(hdc, iconCX, iconCY, PROG_ICON_SZ,
                            RGB(30, 140, 130), L"\u00bb");
             SelectObject(hdc, m_fontNormal14);
+            if (evicted)
+                m_iconReloads.push_back(node.index());
         }
 
         RECT nr = { MARGIN + PROG_ICON_SZ + 12, itemY,
                     DIVIDER_X - MARGIN,          itemY + PROG_ITEM_H };
-        DrawShadowText(hdc, node.name.c_str(), -1, &nr,
+        DrawShadowText(hdc, node.name().data(), -1, &nr,
                        DT_LEFT | DT_VCENTER | DT_SINGLELINE | DT_END_ELLIPSIS, m_textColor);
     }
 
@@ -1453,8 +2004,8 @@ void StartMenuWindow::PaintAllProgramsView(HDC hdc, const RECT& cr) {
         SelectObject(hdc, m_fontNormal14);
         ::SetTextColor(hdc, CalculateBorderColor());
         RECT tr = { MARGIN, PROG_Y, DIVIDER_X - MARGIN, PROG_Y + PROG_ITEM_H / 2 };
-        DrawTextW(hdc, L"\u25b2  scroll\u2026", -1, &tr,
-                  DT_LEFT | DT_VCENTER | DT_SINGLELINE);
+        DrawLabel(hdc, L"\u25b2  scroll\u2026", -1, &tr,
+                   DT_LEFT | DT_VCENTER | DT_SINGLELINE);
     }
 
     // "▼ more…" hint when items remain below the visible window.
@@ -1463,8 +2014,87 @@ void StartMenuWindow::PaintAllProgramsView(HDC hdc, const RECT& cr) {
         SelectObject(hdc, m_fontNormal14);
         ::SetTextColor(hdc, CalculateBorderColor());
         RECT mr = { MARGIN, lastY, DIVIDER_X - MARGIN, AP_ROW_Y };
-        DrawTextW(hdc, L"\u25bc  more\u2026", -1, &mr,
-                  DT_LEFT | DT_VCENTER | DT_SINGLELINE);
+        DrawLabel(hdc, L"\u25bc  more\u2026", -1, &mr,
+                   DT_LEFT | DT_VCENTER | DT_SINGLELINE);
+    }
+
+    SelectObject(hdc, oldF);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// PaintSearchResults — ranked type-to-search hits (left column, Search view).
+// Same row layout as the All Programs list; m_keySelApIndex / m_hoveredApIndex
+// index m_searchResults.
+// ─────────────────────────────────────────────────────────────────────────────
+void StartMenuWindow::PaintSearchResults(HDC hdc, const RECT& cr) {
+    (void)cr;
+    SetBkMode(hdc, TRANSPARENT);
+    HFONT oldF = (HFONT)SelectObject(hdc, m_fontNormal14);
+
+    if (m_searchResults.empty()) {
+        ::SetTextColor(hdc, CalculateBorderColor());
+        RECT tr = { MARGIN + 6, PROG_Y, DIVIDER_X - MARGIN, PROG_Y + PROG_ITEM_H };
+        DrawLabel(hdc, L"No items match your search.", -1, &tr,
+                   DT_LEFT | DT_VCENTER | DT_SINGLELINE | DT_END_ELLIPSIS);
+        SelectObject(hdc, oldF);
+        return;
+    }
+
+    const int count = min(static_cast<int>(m_searchResults.size()), SEARCH_MAX_VISIBLE);
+    for (int i = 0; i < count; ++i) {
+        const SearchHit& hit = m_searchResults[static_cast<size_t>(i)];
+        int itemY = PROG_Y + i * PROG_ITEM_H;
+        if (!NeedsPaint(ApListRowRect(i))) continue;
+        ++m_paintCost.rows;
+
+        bool isKeySel = (i == m_keySelApIndex);
+        bool isHover  = (i == m_hoveredApIndex) && !isKeySel;
+        if (isKeySel || isHover) {
+            COLORREF hlColor = isKeySel ? CalculateSelectionColor() : AnimatedHoverColor();
+            FillRounded(hdc, { MARGIN, itemY + 2,
+                               DIVIDER_X - MARGIN, itemY + PROG_ITEM_H - 2 }, 3, hlColor);
+        }
+
+        // Name, icon and fallback square of whichever list the hit came from.
+        const wchar_t* name     = L"";
+        HICON          icon     = nullptr;
+        COLORREF       fbColor  = RGB(30, 140, 130);
+        std::wstring   fbLabel  = L"\u00bb";
+        if (hit.source == SearchSource::Pinned) {
+            const DynamicPinnedItem& item = m_dynamicPinnedItems[hit.ref];
+            name    = item.name.c_str();
+            icon    = item.hCustomIcon ? item.hCustomIcon : LoadedIcon(item.hIcon);
+            fbColor = item.iconColor;
+            fbLabel = item.shortName;
+        } else if (hit.source == SearchSource::Recent) {
+            const RecentItem& item = m_recentItems[hit.ref];
+            name    = item.name.c_str();
+            icon    = item.hIcon;
+            fbColor = RGB(90, 90, 90);
+            fbLabel = item.name.substr(0, 3);
+        } else {
+            MenuNodeView node = m_programTree.Node(hit.ref);
+            name = node.name().data();
+            bool evicted = false;
+            icon = LoadedNodeIcon(hit.ref, evicted);
+            if (node.isFolder()) { fbColor = RGB(210, 150, 20); fbLabel = L"\u203a"; }
+            if (evicted) m_iconReloads.push_back(hit.ref);
+        }
+
+        int iconCX = MARGIN + PROG_ICON_SZ / 2 + 4;
+        int iconCY = itemY + PROG_ITEM_H / 2;
+        if (icon) {
+            DrawAtlasIcon(hdc, icon, iconCX - PROG_ICON_SZ / 2,
+                          iconCY - PROG_ICON_SZ / 2, PROG_ICON_SZ);
+        } else {
+            DrawIconSquare(hdc, iconCX, iconCY, PROG_ICON_SZ, fbColor, fbLabel.c_str());
+        }
+        SelectObject(hdc, m_fontNormal14);
+
+        RECT nr = { MARGIN + PROG_ICON_SZ + 12, itemY,
+                    DIVIDER_X - MARGIN,          itemY + PROG_ITEM_H };
+        DrawShadowText(hdc, name, -1, &nr,
+                       DT_LEFT | DT_VCENTER | DT_SINGLELINE | DT_END_ELLIPSIS, m_textColor);
     }
 
     SelectObject(hdc, oldF);
@@ -1487,15 +2117,8 @@ void StartMenuWindow::PaintApRow(HDC hdc, const RECT& cr) {
         bool isHover  = m_hoveredApRow && !isKeySel;
         if (isKeySel || isHover) {
             COLORREF hlColor = isKeySel ? CalculateSelectionColor() : AnimatedHoverColor();
-            HBRUSH hBr  = CreateSolidBrush(hlColor);
-            HPEN   noPn = (HPEN)GetStockObject(NULL_PEN);
-            HBRUSH ob   = (HBRUSH)SelectObject(hdc, hBr);
-            HPEN   op   = (HPEN)SelectObject(hdc, noPn);
-            RoundRect(hdc, MARGIN, AP_ROW_Y + 1,
-                      DIVIDER_X - MARGIN, AP_ROW_Y + AP_ROW_H - 1, 4, 4);
-            SelectObject(hdc, ob);
-            SelectObject(hdc, op);
-            DeleteObject(hBr);
+            FillRounded(hdc, { MARGIN, AP_ROW_Y + 1,
+                               DIVIDER_X - MARGIN, AP_ROW_Y + AP_ROW_H - 1 }, 2, hlColor);
         }
     }
 
@@ -1516,6 +2139,7 @@ void StartMenuWindow::PaintApRow(HDC hdc, const RECT& cr) {
 // ─────────────────────────────────────────────────────────────────────────────
 // PaintWin7SearchBox — Win7 style: sits at the bottom of the left column,
 // just above the bottom bar.  (Moved from top to bottom per Win7 design.)
+// Painted in the Search view only, in place of the "All Programs" row.
 // ─────────────────────────────────────────────────────────────────────────────
 void StartMenuWindow::PaintWin7SearchBox(HDC hdc, const RECT& cr) {
     (void)cr;
@@ -1523,100 +2147,97 @@ void StartMenuWindow::PaintWin7SearchBox(HDC hdc, const RECT& cr) {
     int bx1 = MARGIN,             by1 = SEARCH_Y;
     int bx2 = DIVIDER_X - MARGIN, by2 = SEARCH_Y + SEARCH_H;
 
-    HBRUSH srBr  = CreateSolidBrush(CalculateSubtleColor());
-    HPEN   srPen = CreatePen(PS_SOLID, 1, CalculateBorderColor());
-    HBRUSH oldBr = (HBRUSH)SelectObject(hdc, srBr);
-    HPEN   oldPn = (HPEN)SelectObject(hdc, srPen);
-    RoundRect(hdc, bx1, by1, bx2, by2, 6, 6);
-    SelectObject(hdc, oldBr);
-    SelectObject(hdc, oldPn);
-    DeleteObject(srBr);
-    DeleteObject(srPen);
+    FillRounded(hdc, { bx1, by1, bx2, by2 }, 3, CalculateSubtleColor());
+    StrokeRounded(hdc, { bx1, by1, bx2, by2 }, 3, 1, CalculateBorderColor());
 
     // Magnifier icon
     int icoX = bx1 + 18, icoY = (by1 + by2) / 2, icoR = 6;
-    HPEN mgPen = CreatePen(PS_SOLID, 2, RGB(155, 155, 165));
-    HPEN oldP2 = (HPEN)SelectObject(hdc, mgPen);
-    HBRUSH nb  = (HBRUSH)SelectObject(hdc, GetStockObject(NULL_BRUSH));
-    Ellipse(hdc, icoX - icoR, icoY - icoR, icoX + icoR, icoY + icoR);
-    MoveToEx(hdc, icoX + icoR - 2, icoY + icoR - 2, NULL);
-    LineTo(hdc, icoX + icoR + 4, icoY + icoR + 4);
-    SelectObject(hdc, oldP2);
-    SelectObject(hdc, nb);
-    DeleteObject(mgPen);
-
-    // Placeholder text
+    const COLORREF mgColor = RGB(155, 155, 165);
+    // 2 px ring centred on the icoR circle, as GDI's pen would draw it
+    StrokeRounded(hdc, { icoX - icoR - 1, icoY - icoR - 1, icoX + icoR + 1, icoY + icoR + 1 },
+                  icoR + 1, 2, mgColor);
+    DrawLine(hdc, icoX + icoR - 2, icoY + icoR - 2, icoX + icoR + 4, icoY + icoR + 4, mgColor, 2);
+
+    // Query text with a caret after it, or the placeholder
     HFONT oldF = (HFONT)SelectObject(hdc, m_fontNormal13);
-    ::SetTextColor(hdc, RGB(135, 135, 145));
     SetBkMode(hdc, TRANSPARENT);
     RECT tr = { bx1 + 34, by1, bx2 - 8, by2 };
-    DrawTextW(hdc, L"Search programs and files",
-              -1, &tr, DT_LEFT | DT_VCENTER | DT_SINGLELINE | DT_END_ELLIPSIS);
+    if (m_searchQuery.empty()) {
+        ::SetTextColor(hdc, RGB(135, 135, 145));
+        DrawLabel(hdc, L"Search programs and files",
+                   -1, &tr, DT_LEFT | DT_VCENTER | DT_SINGLELINE | DT_END_ELLIPSIS);
+    } else {
+        // A query wider than the box is right-aligned so its end (what is
+        // being typed) stays in view.
+        ::SetTextColor(hdc, m_textColor);
+        const int len = static_cast<int>(m_searchQuery.size());
+        SIZE ext = {};
+        GetTextExtentPoint32W(hdc, m_searchQuery.c_str(), len, &ext);
+        const bool fits = ext.cx <= tr.right - tr.left;
+        DrawLabel(hdc, m_searchQuery.c_str(), len, &tr,
+                   (fits ? DT_LEFT : DT_RIGHT) | DT_VCENTER | DT_SINGLELINE | DT_NOPREFIX);
+        const int caretX = (fits ? tr.left + ext.cx : tr.right) + 1;
+        DrawLine(hdc, caretX, by1 + 9, caretX, by2 - 9, m_textColor);
+    }
     SelectObject(hdc, oldF);
 }
 
+// Map s_rightItems index → m_menuItems index (-1 = always visible)
+static int RightItemMenuIndex(int ri) {
+    switch (ri) {
+        case 0: return 3;  // Documents → m_menuItems[3]
+        case 1: return 4;  // Pictures  → m_menuItems[4]
+        case 6: return 0;  // Control Panel → m_menuItems[0]
+        case 7: return 1;  // Devices & Printers → m_menuItems[1]
+        case 8: return 2;  // Default Programs → m_menuItems[2]
+        default: return -1;
+    }
+}
+
 // ── PaintWin7RightColumn ──────────────────────────────────────────────────────
 // Paints the right-column panel: background, username header, shell links.
 // Every non-separator entry in s_rightItems is drawn and is clickable.
 void StartMenuWindow::PaintWin7RightColumn(HDC hdc, const RECT& cr) {
-    const bool iconsReady = m_iconsLoaded.load(std::memory_order_acquire);
     // ── Background ───────────────────────────────────────────────────────────
     COLORREF rcBgColor = CalculateSubtleColor();
-    HBRUSH   rcBg      = CreateSolidBrush(rcBgColor);
-    RECT     rcArea    = { DIVIDER_X, 0, cr.right, BOTTOM_BAR_Y };
-    FillRect(hdc, &rcArea, rcBg);
-    DeleteObject(rcBg);
+    FillSolid(hdc, { DIVIDER_X, 0, cr.right, BOTTOM_BAR_Y }, rcBgColor);
 
     // ── Vertical divider ─────────────────────────────────────────────────────
-    HPEN divPen = CreatePen(PS_SOLID, 1, CalculateBorderColor());
-    HPEN oldPen = (HPEN)SelectObject(hdc, divPen);
-    MoveToEx(hdc, DIVIDER_X, 0, NULL);
-    LineTo(hdc, DIVIDER_X, BOTTOM_BAR_Y);
-    SelectObject(hdc, oldPen);
-    DeleteObject(divPen);
+    DrawLine(hdc, DIVIDER_X, 0, DIVIDER_X, BOTTOM_BAR_Y, CalculateBorderColor());
 
     SetBkMode(hdc, TRANSPARENT);
 
-    // ── Username header ──────────────────────────────────────────────────────
-    int avR  = 18;
-    int avCX = RC_X + avR + 4;
-    int avCY = RC_HDR_H / 2;
-
-    // S-G: real avatar if loaded, otherwise initials fallback
-    DrawAvatarCircle(hdc, avCX, avCY, avR);
-
     HFONT oldF = (HFONT)SelectObject(hdc, m_fontBold16);
 
-    // Username text (S15: shadow text)
-    SelectObject(hdc, m_fontBold15);
-    RECT nmR = { avCX + avR + 8, 0, cr.right - 8, RC_HDR_H };
-    DrawShadowText(hdc, m_username, -1, &nmR,
-                   DT_LEFT | DT_VCENTER | DT_SINGLELINE | DT_END_ELLIPSIS, m_textColor);
+    // ── Username header ──────────────────────────────────────────────────────
+    const RECT hdrR = { DIVIDER_X, 0, cr.right, RC_HDR_H + 1 };
+    if (NeedsPaint(hdrR)) {
+        int avR  = 18;
+        int avCX = RC_X + avR + 4;
+        int avCY = RC_HDR_H / 2;
+
+        // S-G: real avatar if loaded, otherwise initials fallback
+        DrawAvatarCircle(hdc, avCX, avCY, avR);
+
+        // Username text (S15: shadow text)
+        SelectObject(hdc, m_fontBold15);
+        RECT nmR = { avCX + avR + 8, 0, cr.right - 8, RC_HDR_H };
+        DrawShadowText(hdc, m_username, -1, &nmR,
+                       DT_LEFT | DT_VCENTER | DT_SINGLELINE | DT_END_ELLIPSIS, m_textColor);
 
-    // Thin separator below header
-    DrawSeparator(hdc, RC_HDR_H, DIVIDER_X + 8, cr.right - 8);
+        // Thin separator below header
+        DrawSeparator(hdc, RC_HDR_H, DIVIDER_X + 8, cr.right - 8);
+    }
 
     // ── Shell link items ─────────────────────────────────────────────────────
     SelectObject(hdc, m_fontNormal15);
 
-    // Map s_rightItems index → m_menuItems index (-1 = always visible)
-    auto GetRightItemMenuIndex = [](int ri) -> int {
-        switch (ri) {
-            case 0: return 3;  // Documents → m_menuItems[3]
-            case 1: return 4;  // Pictures  → m_menuItems[4]
-            case 6: return 0;  // Control Panel → m_menuItems[0]
-            case 7: return 1;  // Devices & Printers → m_menuItems[1]
-            case 8: return 2;  // Default Programs → m_menuItems[2]
-            default: return -1;
-        }
-    };
-
     int y = RC_HDR_H + 2;
     for (int i = 0; i < RIGHT_ITEM_COUNT; ++i) {
         const Win7RightItem& item = s_rightItems[i];
 
         if (!item.isSeparator) {
-            int mi = GetRightItemMenuIndex(i);
+            int mi = RightItemMenuIndex(i);
             if (mi >= 0 && !m_menuItems[mi].visible) continue;
         }
 
@@ -1624,38 +2245,29 @@ void StartMenuWindow::PaintWin7RightColumn(HDC hdc, const RECT& cr) {
             // Draw a subtle horizontal line centred in the separator row
             DrawSeparator(hdc, y + RC_SEP_H / 2, RC_X + 4, cr.right - 8);
             y += RC_SEP_H;
+        } else if (!NeedsPaint(RightItemRect(i))) {
+            y += RC_ITEM_H;
         } else {
+            ++m_paintCost.rows;
             // Hover highlight — S-C animated, S-D inner top glow
             if (i == m_hoveredRightIndex) {
                 COLORREF hc = AnimatedHoverColor();
-                HBRUSH hBr  = CreateSolidBrush(hc);
-                HPEN   noPn = (HPEN)GetStockObject(NULL_PEN);
-                HBRUSH hOb  = (HBRUSH)SelectObject(hdc, hBr);
-                HPEN   hOp  = (HPEN)SelectObject(hdc, noPn);
-                RoundRect(hdc, RC_X, y + 1, cr.right - 4, y + RC_ITEM_H - 1, 6, 6);
-                SelectObject(hdc, hOb);
-                SelectObject(hdc, hOp);
-                DeleteObject(hBr);
+                FillRounded(hdc, { RC_X, y + 1, cr.right - 4, y + RC_ITEM_H - 1 }, 3, hc);
                 // S-D glow: 1px lighter line at top of hover rect (Win7 glass effect)
                 if (m_hoverAnimAlpha > 60) {
                     COLORREF glowC = RGB(
                         min(255, GetRValue(hc) + 60),
                         min(255, GetGValue(hc) + 60),
                         min(255, GetBValue(hc) + 60));
-                    HPEN glowPen = CreatePen(PS_SOLID, 1, glowC);
-                    HPEN ogp = (HPEN)SelectObject(hdc, glowPen);
-                    MoveToEx(hdc, RC_X + 4, y + 2, NULL);
-                    LineTo(hdc, cr.right - 8, y + 2);
-                    SelectObject(hdc, ogp);
-                    DeleteObject(glowPen);
+                    DrawLine(hdc, RC_X + 4, y + 2, cr.right - 8, y + 2, glowC);
                 }
             }
 
             // Item icon (16×16) — drawn at left edge of item row
-            if (iconsReady && m_rightIcons[i]) {
+            if (HICON icon = LoadedIcon(m_rightIcons[i])) {
                 int iconX = RC_X + 4;
                 int iconY = y + (RC_ITEM_H - 16) / 2;
-                DrawIconEx(hdc, iconX, iconY, m_rightIcons[i], 16, 16, 0, nullptr, DI_NORMAL);
+                DrawAtlasIcon(hdc, icon, iconX, iconY, 16);
             }
 
             // Item label — S15 shadow text
@@ -1674,10 +2286,7 @@ void StartMenuWindow::PaintWin7RightColumn(HDC hdc, const RECT& cr) {
 void StartMenuWindow::PaintBottomBar(HDC hdc, const RECT& cr) {
     SetBkMode(hdc, TRANSPARENT);
 
-    HBRUSH bbBr = CreateSolidBrush(CalculateSubtleColor());
-    RECT   bbR  = { 0, BOTTOM_BAR_Y, cr.right, cr.bottom };
-    FillRect(hdc, &bbR, bbBr);
-    DeleteObject(bbBr);
+    FillSolid(hdc, { 0, BOTTOM_BAR_Y, cr.right, cr.bottom }, CalculateSubtleColor());
 
     // Thin rule at top of bottom bar
     DrawSeparator(hdc, BOTTOM_BAR_Y, MARGIN, WIDTH - MARGIN);
@@ -1713,53 +2322,136 @@ void StartMenuWindow::PaintBottomBar(HDC hdc, const RECT& cr) {
 
     // Draw "Shut down" text button
     {
-        HBRUSH br = CreateSolidBrush(btnFill(m_hoveredShutdown));
-        RECT   rc = { sdL, btnTop, sdR, btnBot };
-        FillRect(hdc, &rc, br);
-        DeleteObject(br);
+        RECT rc = { sdL, btnTop, sdR, btnBot };
+        FillSolid(hdc, rc, btnFill(m_hoveredShutdown));
         // Border
-        HPEN  pe = CreatePen(PS_SOLID, 1, RGB(100, 140, 190));
-        HPEN  op = (HPEN)SelectObject(hdc, pe);
-        HBRUSH nb3 = (HBRUSH)SelectObject(hdc, GetStockObject(NULL_BRUSH));
-        Rectangle(hdc, sdL, btnTop, sdR, btnBot);
-        SelectObject(hdc, op);
-        SelectObject(hdc, nb3);
-        DeleteObject(pe);
+        StrokeRounded(hdc, rc, 0, 1, RGB(100, 140, 190));
         // Text
         HFONT  oldSdF = (HFONT)SelectObject(hdc, m_fontNormal12);
         ::SetTextColor(hdc, RGB(10, 10, 10));
         RECT  tr = { sdL, btnTop, sdR, btnBot };
-        DrawTextW(hdc, L"Shut down", -1, &tr, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
+        DrawLabel(hdc, L"Shut down", -1, &tr, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
         SelectObject(hdc, oldSdF);
     }
 
     // Draw arrow dropdown button
     {
-        HBRUSH br = CreateSolidBrush(btnFill(m_hoveredArrow));
-        RECT   rc = { arrL, btnTop, arrR, btnBot };
-        FillRect(hdc, &rc, br);
-        DeleteObject(br);
+        RECT rc = { arrL, btnTop, arrR, btnBot };
+        FillSolid(hdc, rc, btnFill(m_hoveredArrow));
         // Border (share left border with shut-down button)
-        HPEN  pe = CreatePen(PS_SOLID, 1, RGB(100, 140, 190));
-        HPEN  op = (HPEN)SelectObject(hdc, pe);
-        HBRUSH nb4 = (HBRUSH)SelectObject(hdc, GetStockObject(NULL_BRUSH));
-        Rectangle(hdc, arrL, btnTop, arrR, btnBot);
-        SelectObject(hdc, op);
-        SelectObject(hdc, nb4);
-        DeleteObject(pe);
+        StrokeRounded(hdc, rc, 0, 1, RGB(100, 140, 190));
         // Arrow glyph (▼) centred
         HFONT  oldArF = (HFONT)SelectObject(hdc, m_fontSmall10);
         ::SetTextColor(hdc, RGB(10, 10, 10));
         RECT  tr = { arrL, btnTop, arrR, btnBot };
-        DrawTextW(hdc, L"6", -1, &tr, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
+        DrawLabel(hdc, L"6", -1, &tr, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
         SelectObject(hdc, oldArF);
     }
 
     SelectObject(hdc, oldF);
 }
 
+// ── Damage tracking ───────────────────────────────────────────────────────────
+// Row rects cover what a row's painter draws there: highlight, icon and the
+// 1 px text shadow.  Empty rects are never invalidated and never painted.
+
+void StartMenuWindow::InvalidateArea(const RECT& r) {
+    if (m_hwnd && !IsRectEmpty(&r))
+        InvalidateRect(m_hwnd, &r, FALSE);
+}
+
+void StartMenuWindow::InvalidateHighlights() {
+    InvalidateArea(ProgRowRect(m_hoveredProgIndex));
+    InvalidateArea(ProgRowRect(m_keySelProgIndex));
+    InvalidateArea(ApListRowRect(m_hoveredApIndex));
+    InvalidateArea(ApListRowRect(m_keySelApIndex));
+    if (m_hoveredApRow || m_keySelApRow)
+        InvalidateArea(ApRowRect());
+    InvalidateArea(RightItemRect(m_hoveredRightIndex));
+    if (m_subMenuOpen)
+        InvalidateArea(SubMenuRowRect(m_subMenuHoveredIdx));
+    if (m_hoveredShutdown) InvalidateArea(ShutdownButtonRect());
+    if (m_hoveredArrow)    InvalidateArea(ArrowButtonRect());
+}
+
+bool StartMenuWindow::NeedsPaint(const RECT& r) const {
+    return !m_paintRgn || RectInRegion(m_paintRgn, &r) != FALSE;
+}
+
+RECT StartMenuWindow::ProgRowRect(int index) const {
+    if (m_viewMode != LeftViewMode::Programs || index < 0) return {};
+    const int pinnedCount = static_cast<int>(m_dynamicPinnedItems.size());
+    int y = PROG_Y + index * PROG_ITEM_H;
+    if (index >= pinnedCount) y += 12;   // gap above the recent list
+    return { MARGIN, y, DIVIDER_X - MARGIN + 1, y + PROG_ITEM_H };
+}
+
+RECT StartMenuWindow::ApListRowRect(int index) const {
+    int visual = index;
+    if (m_viewMode == LeftViewMode::AllPrograms) {
+        visual -= m_apScrollOffset;
+        if (visual >= AP_MAX_VISIBLE) return {};
+    } else if (m_viewMode != LeftViewMode::Search || visual >= SEARCH_MAX_VISIBLE) {
+        return {};
+    }
+    if (index < 0 || visual < 0) return {};
+    int y = PROG_Y + visual * PROG_ITEM_H;
+    return { MARGIN, y, DIVIDER_X - MARGIN + 1, y + PROG_ITEM_H };
+}
+
+RECT StartMenuWindow::ApRowRect() const {
+    return { MARGIN, AP_ROW_Y - 1, DIVIDER_X - MARGIN + 1, AP_ROW_Y + AP_ROW_H };
+}
+
+RECT StartMenuWindow::RightItemRect(int index) const {
+    if (index < 0 || index >= RIGHT_ITEM_COUNT || s_rightItems[index].isSeparator) return {};
+    // Must match PaintWin7RightColumn's layout
+    int y = RC_HDR_H + 2;
+    for (int i = 0; i <= index; ++i) {
+        const Win7RightItem& item = s_rightItems[i];
+        if (!item.isSeparator) {
+            int mi = RightItemMenuIndex(i);
+            if (mi >= 0 && !m_menuItems[mi].visible) {
+                if (i == index) return {};
+                continue;
+            }
+        }
+        if (i == index) break;
+        y += item.isSeparator ? RC_SEP_H : RC_ITEM_H;
+    }
+    return { RC_X, y, WIDTH, y + RC_ITEM_H };
+}
+
+RECT StartMenuWindow::SubMenuRowRect(int visualIdx) const {
+    if (visualIdx < 0) return {};
+    int y = SM_TITLE_H + visualIdx * SM_ITEM_H;
+    return { SM_X, y, WIDTH, y + SM_ITEM_H };
+}
+
+// Layout (right-aligned): [Shut down SHUT_BTN_W][1px gap][arrow SHUT_ARROW_W][MARGIN]
+RECT StartMenuWindow::ShutdownButtonRect() const {
+    RECT a = ArrowButtonRect();
+    return { a.left - 1 - SHUT_BTN_W, a.top, a.left - 1, a.bottom };
+}
+
+RECT StartMenuWindow::ArrowButtonRect() const {
+    RECT cr; GetClientRect(m_hwnd, &cr);
+    int btnBot = BOTTOM_BAR_Y + (BOTTOM_BAR_H + SHUT_BTN_H) / 2;
+    int btnR   = cr.right - MARGIN;
+    return { btnR - SHUT_ARROW_W, btnBot - SHUT_BTN_H, btnR, btnBot };
+}
+
 // ── Paint (master) ───────────────────────────────────────────────────────────
 void StartMenuWindow::Paint() {
+    const auto t0 = std::chrono::steady_clock::now();
+
+    // The update region, read before BeginPaint() validates it.  Sections
+    // and rows outside it are skipped; the rest of the frame is clipped.
+    if (!m_updateRgn)
+        m_updateRgn = CreateRectRgn(0, 0, 0, 0);
+    HRGN dirty     = m_updateRgn;
+    int  dirtyKind = GetUpdateRgn(m_hwnd, dirty, FALSE);
+
     PAINTSTRUCT ps;
     HDC screenDC = BeginPaint(m_hwnd, &ps);
 
@@ -1768,51 +2460,98 @@ void StartMenuWindow::Paint() {
     int w = cr.right;
     int h = cr.bottom;
 
-    // Off-screen buffer — all drawing goes here, then BitBlt in one shot
-    // to eliminate the background-erase flash (double buffering).
-    HDC     memDC  = CreateCompatibleDC(screenDC);
-    HBITMAP memBmp = CreateCompatibleBitmap(screenDC, w, h);
-    HBITMAP oldBmp = (HBITMAP)SelectObject(memDC, memBmp);
-    HDC hdc = memDC;
-
-    // Background (whole window)
-    HBRUSH bg = CreateSolidBrush(m_bgColor);
-    FillRect(hdc, &cr, bg);
-    DeleteObject(bg);
-
-    // Outer border
-    HPEN  bdrPen = CreatePen(PS_SOLID, 1, CalculateBorderColor());
-    HPEN  oldPn  = (HPEN)SelectObject(hdc, bdrPen);
-    HBRUSH nb    = (HBRUSH)SelectObject(hdc, GetStockObject(NULL_BRUSH));
-    RoundRect(hdc, 0, 0, cr.right, cr.bottom, 12, 12);
-    SelectObject(hdc, oldPn);
-    SelectObject(hdc, nb);
-    DeleteObject(bdrPen);
-
-    // Left column — programs or All Programs tree
-    if (m_viewMode == LeftViewMode::Programs)
-        PaintProgramsList(hdc, cr);
-    else
-        PaintAllProgramsView(hdc, cr);
-
-    // Left column — "All Programs" / "Back" row + search box (always visible)
-    PaintApRow(hdc, cr);
-    // PaintWin7SearchBox intentionally omitted — search box removed from UI.
-
-    // Right column: draw normal links, or overlay with submenu when open
-    PaintWin7RightColumn(hdc, cr);
-    if (m_subMenuOpen)
-        PaintSubMenu(hdc, cr);
-    PaintBottomBar(hdc, cr);
+    // Off-screen buffer — all drawing goes here, then PresentFrame() hands it
+    // over in one shot (double buffering).  It keeps the last frame, so only
+    // the update region is redrawn; a new one holds nothing yet and is drawn
+    // whole.
+    const bool fresh = EnsureBackBuffer(screenDC, w, h);
+    if (dirtyKind == ERROR || fresh) {
+        SetRectRgn(dirty, 0, 0, w, h);
+        dirtyKind = SIMPLEREGION;
+        ps.rcPaint = cr;
+    }
+    const RECT& pr   = ps.rcPaint;
+    const bool  full = dirtyKind == SIMPLEREGION && pr.left <= 0 && pr.top <= 0 &&
+                       pr.right >= w && pr.bottom >= h;
+
+    HDC hdc = m_backDC;
+    SelectClipRgn(hdc, dirty);
+    m_paintRgn = dirty;
+    if (m_backPixels) {
+        m_frame = RasterSurface(m_backPixels, w, h, w);
+        m_frame.SetClip({ pr.left, pr.top, pr.right, pr.bottom });
+    }
+    // Only a full frame starts a new visible set: a partial one redraws rows
+    // already on screen, and the rest of the last frame is still showing.
+    if (full)
+        m_iconCache.BeginFrame();
+    m_iconReloads.clear();
+
+    // Background (update region) and outer border.  Outside the border's
+    // rounded corners the frame is left clear: per-pixel alpha shapes the
+    // window.
+    if (m_frame.Pixels()) {
+        GdiFlush();
+        m_frame.Clear(FrameRect(pr));
+        FillRounded(hdc, cr, 6, m_bgColor);
+    } else {
+        FillSolid(hdc, pr, m_bgColor);
+    }
+    StrokeRounded(hdc, cr, 6, 1, CalculateBorderColor());
+
+    const RECT listArea   = { 0, 0, DIVIDER_X, AP_ROW_Y };
+    const RECT footArea   = { 0, SEARCH_Y, DIVIDER_X, BOTTOM_BAR_Y };
+    const RECT rightArea  = { DIVIDER_X, 0, cr.right, BOTTOM_BAR_Y };
+    const RECT bottomArea = { 0, BOTTOM_BAR_Y, cr.right, cr.bottom };
+
+    // Left column — programs, All Programs tree or search results
+    if (NeedsPaint(listArea)) {
+        if (m_viewMode == LeftViewMode::Programs)
+            PaintProgramsList(hdc, cr);
+        else if (m_viewMode == LeftViewMode::Search)
+            PaintSearchResults(hdc, cr);
+        else
+            PaintAllProgramsView(hdc, cr);
+    }
 
-    // Flip the completed frame to screen in one atomic operation
-    BitBlt(screenDC, 0, 0, w, h, memDC, 0, 0, SRCCOPY);
+    // Left column — "All Programs" / "Back" row, or the search box while typing
+    if (NeedsPaint(footArea)) {
+        if (m_viewMode == LeftViewMode::Search)
+            PaintWin7SearchBox(hdc, cr);
+        else
+            PaintApRow(hdc, cr);
+    }
 
-    SelectObject(memDC, oldBmp);
-    DeleteObject(memBmp);
-    DeleteDC(memDC);
+    // Right column: draw normal links, or the submenu that covers them
+    if (NeedsPaint(rightArea)) {
+        if (m_subMenuOpen)
+            PaintSubMenu(hdc, cr);
+        else
+            PaintWin7RightColumn(hdc, cr);
+    }
+    if (NeedsPaint(bottomArea))
+        PaintBottomBar(hdc, cr);
+
+    // Hand the update region's bounds to DWM in one operation.  Nothing is
+    // drawn through screenDC: BeginPaint()/EndPaint() only validate.
+    m_frame    = RasterSurface();
+    m_paintRgn = nullptr;
+    GdiFlush();
+    PresentFrame(full ? nullptr : &pr);
+    SelectClipRgn(hdc, nullptr);
+
+    ++m_paintCost.paints;
+    if (full) ++m_paintCost.fullPaints;
+    m_paintCost.pixels += static_cast<uint64_t>(max(0L, pr.right - pr.left)) *
+                          static_cast<uint64_t>(max(0L, pr.bottom - pr.top));
 
     EndPaint(m_hwnd, &ps);
+    m_paintCost.ms += std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - t0).count();
+
+    // Evicted icons this frame drew as fallbacks.
+    if (!m_iconReloads.empty())
+        LoadMissingIconsAsync();
 }
 
 // ── Hit testing ───────────────────────────────────────────────────────────────
@@ -1845,6 +2584,7 @@ int StartMenuWindow::GetProgItemAtPoint(POINT pt) {
 // Returns true if pt is over the "All Programs" / "Back" row.
 bool StartMenuWindow::IsOverApRow(POINT pt) {
     if (pt.x >= DIVIDER_X) return false;
+    if (m_viewMode == LeftViewMode::Search) return false;   // search box there instead
     return pt.y >= AP_ROW_Y && pt.y < AP_ROW_Y + AP_ROW_H;
 }
 
@@ -1855,31 +2595,24 @@ int StartMenuWindow::GetApItemAtPoint(POINT pt) {
     if (pt.x < MARGIN || pt.x >= DIVIDER_X - MARGIN) return -1;
     if (pt.y < PROG_Y || pt.y >= AP_ROW_Y) return -1;
     int visualIdx = (pt.y - PROG_Y) / PROG_ITEM_H;
+    if (m_viewMode == LeftViewMode::Search) {
+        // Search view: index into m_searchResults (never scrolled).
+        int shown = min(static_cast<int>(m_searchResults.size()), SEARCH_MAX_VISIBLE);
+        return (pt.y < SEARCH_Y && visualIdx < shown) ? visualIdx : -1;
+    }
     int total = static_cast<int>(CurrentApNodes().size());
     int count = max(0, min(AP_MAX_VISIBLE, total - m_apScrollOffset));
     if (visualIdx >= 0 && visualIdx < count) return m_apScrollOffset + visualIdx;
     return -1;
 }
 
-bool StartMenuWindow::IsOverShutdownButton(POINT pt) {
-    RECT cr; GetClientRect(m_hwnd, &cr);
-    int btnBot = BOTTOM_BAR_Y + (BOTTOM_BAR_H + SHUT_BTN_H) / 2;
-    int btnTop = btnBot - SHUT_BTN_H;
-    int btnR   = cr.right - MARGIN;
-    int arrL   = btnR - SHUT_ARROW_W;
-    int sdR    = arrL - 1;
-    int sdL    = sdR  - SHUT_BTN_W;
-    RECT r = { sdL, btnTop, sdR, btnBot };
+bool StartMenuWindow::IsOverShutdownButton(POINT pt) {
+    RECT r = ShutdownButtonRect();
     return PtInRect(&r, pt) != FALSE;
 }
 
 bool StartMenuWindow::IsOverArrowButton(POINT pt) {
-    RECT cr; GetClientRect(m_hwnd, &cr);
-    int btnBot = BOTTOM_BAR_Y + (BOTTOM_BAR_H + SHUT_BTN_H) / 2;
-    int btnTop = btnBot - SHUT_BTN_H;
-    int btnR   = cr.right - MARGIN;
-    int arrL   = btnR - SHUT_ARROW_W;
-    RECT r = { arrL, btnTop, btnR, btnBot };
+    RECT r = ArrowButtonRect();
     return PtInRect(&r, pt) != FALSE;
 }
 
@@ -1892,23 +2625,12 @@ int StartMenuWindow::GetRightItemAtPoint(POINT pt) {
     if (pt.y >= BOTTOM_BAR_Y) return -1;   // bottom bar handled separately
 
     // Must match PaintWin7RightColumn's visibility logic
-    auto GetRightItemMenuIndex = [](int ri) -> int {
-        switch (ri) {
-            case 0: return 3;
-            case 1: return 4;
-            case 6: return 0;
-            case 7: return 1;
-            case 8: return 2;
-            default: return -1;
-        }
-    };
-
     int y = RC_HDR_H + 2;
     for (int i = 0; i < RIGHT_ITEM_COUNT; ++i) {
         const Win7RightItem& item = s_rightItems[i];
 
         if (!item.isSeparator) {
-            int mi = GetRightItemMenuIndex(i);
+            int mi = RightItemMenuIndex(i);
             if (mi >= 0 && !m_menuItems[mi].visible) continue;
         }
 
@@ -1931,8 +2653,9 @@ void StartMenuWindow::ExecutePinnedItem(int index) {
     if (index < pinnedCount) {
         // Pinned item
         CF_LOG(Info, "ExecutePinnedItem: " << index);
-        ShellExecuteW(NULL, L"open", m_dynamicPinnedItems[static_cast<size_t>(index)].command.c_str(),
-                      NULL, NULL, SW_SHOW);
+        const std::wstring& command = m_dynamicPinnedItems[static_cast<size_t>(index)].command;
+        ShellExecuteW(NULL, L"open", command.c_str(), NULL, NULL, SW_SHOW);
+        RecordLaunch(command);
     } else {
         // S7 — Recently used item (index == pinnedCount + recentIdx)
         int ri = index - pinnedCount;
@@ -1940,6 +2663,7 @@ void StartMenuWindow::ExecutePinnedItem(int index) {
         CF_LOG(Info, "ExecuteRecentItem index=" << ri);
         ShellExecuteW(NULL, L"open", m_recentItems[ri].exePath.c_str(),
                       NULL, NULL, SW_SHOW);
+        RecordLaunch(m_recentItems[ri].exePath);
     }
     Hide();
 }
@@ -2007,57 +2731,78 @@ void StartMenuWindow::ExecuteRightItem(int index) {
 // Launches the shortcut at index in CurrentApNodes().
 // If the node is a folder, navigates into it instead of launching.
 void StartMenuWindow::LaunchApItem(int index) {
-    const auto& nodes = CurrentApNodes();
+    MenuNodeRange nodes = CurrentApNodes();
     if (index < 0 || index >= static_cast<int>(nodes.size())) return;
 
-    const MenuNode& node = nodes[static_cast<size_t>(index)];
+    MenuNodeView node = nodes[static_cast<size_t>(index)];
 
-    if (node.isFolder) {
+    if (node.isFolder()) {
         CF_LOG(Info, "AP navigate into folder: " << index);
-        NavigateIntoFolder(node.children);
+        NavigateIntoFolder(node);
         return;
     }
 
     CF_LOG(Info, "AP launch: index=" << index);
+    LaunchProgramNode(node);
+}
+
+void StartMenuWindow::LaunchProgramNode(const MenuNodeView& node) {
     Hide();
 
-    if (!node.target.empty()) {
+    // Hide() does not touch the tree, so |node| is still valid here.
+    if (!node.target().empty()) {
         HINSTANCE hi = ShellExecuteW(
             NULL, L"open",
-            node.target.c_str(),
-            node.args.empty() ? nullptr : node.args.c_str(),
+            node.target().data(),
+            node.args().empty() ? nullptr : node.args().data(),
             nullptr, SW_SHOW);
         if (reinterpret_cast<INT_PTR>(hi) <= 32) {
             CF_LOG(Warning, "ShellExecuteW(AP item) returned "
                    << reinterpret_cast<INT_PTR>(hi)
-                   << " target=" << node.target.size() << " chars");
+                   << " target=" << node.target().size() << " chars");
+        } else {
+            RecordLaunch(LaunchKeyPath(node));
         }
     } else {
-        CF_LOG(Warning, "AP item has no target: index=" << index);
+        CF_LOG(Warning, "AP item has no target: node=" << node.index());
     }
 }
 
+// A shortcut is keyed by its .lnk path, as UserAssist records shortcut launches
+// from the shell; targets without one by the target itself.
+std::wstring_view StartMenuWindow::LaunchKeyPath(const MenuNodeView& node) {
+    return node.lnkPath().empty() ? node.target() : node.lnkPath();
+}
+
+void StartMenuWindow::RecordLaunch(std::wstring_view target) {
+    m_frecency.RecordLaunch(target, CurrentFileTimeTicks());
+    m_searchIndexDirty = true;
+    RequestRecentRefresh();   // re-rank the recent list before the next open
+}
+
 // ── All Programs navigation ───────────────────────────────────────────────────
 
-const std::vector<MenuNode>& StartMenuWindow::CurrentApNodes() const {
-    if (m_apNavStack.empty()) return m_programTree;
-    return *m_apNavStack.back();
+MenuNodeRange StartMenuWindow::CurrentApNodes() const {
+    if (m_apNavStack.empty()) return m_programTree.Roots();
+    return m_programTree.Children(m_apNavStack.back());
 }
 
-void StartMenuWindow::NavigateIntoFolder(const std::vector<MenuNode>& children) {
+void StartMenuWindow::NavigateIntoFolder(const MenuNodeView& folder) {
+    EnsureFolderExpanded(folder.index());
     if (m_hoverTimer) { KillTimer(m_hwnd, HOVER_TIMER_ID); m_hoverTimer = 0; }
     m_hoverCandidate    = -1;
     m_subMenuOpen       = false;
     m_subMenuNodeIdx    = -1;
     m_subMenuHoveredIdx = -1;
-    m_apNavStack.push_back(&children);
+    m_apNavStack.push_back(folder.index());
     m_hoveredApIndex    = -1;
     m_keySelApIndex     = -1;
     m_keySelApRow       = false;
     m_apScrollOffset    = 0;
+    PrioritizeVisibleIcons();
     if (m_hwnd) InvalidateRect(m_hwnd, NULL, FALSE);
     CF_LOG(Info, "AP drill-down: depth=" << m_apNavStack.size()
-           << " nodes=" << children.size());
+           << " nodes=" << folder.children().size());
 }
 
 void StartMenuWindow::NavigateBack() {
@@ -2082,20 +2827,298 @@ void StartMenuWindow::NavigateBack() {
         m_keySelApRow      = false;
         CF_LOG(Info, "AP navigate back to Programs view");
     }
+    PrioritizeVisibleIcons();
+    if (m_hwnd) InvalidateRect(m_hwnd, NULL, FALSE);
+}
+
+// ── Lazy folder expansion ─────────────────────────────────────────────────────
+// Folders of a lazily built tree arrive childrenPending.  They are scanned on
+// the UI thread the first time NavigateIntoFolder / OpenSubMenu needs them —
+// one folder level, typically a few milliseconds — unless the hover prefetch
+// already did it.  MenuTree::ExpandFolder appends, so indices held in
+// m_apNavStack and m_subMenuNodeIdx stay valid.
+
+std::wstring StartMenuWindow::FolderRelativePath(uint32_t folder) const {
+    std::vector<std::wstring_view> parts;
+    for (uint32_t i = folder; i != MenuTree::kNone; i = m_programTree.Parent(i))
+        parts.push_back(m_programTree.Node(i).name());
+    std::wstring rel;
+    for (auto it = parts.rbegin(); it != parts.rend(); ++it) {
+        if (!rel.empty()) rel += L'\\';
+        rel.append(it->data(), it->size());
+    }
+    return rel;
+}
+
+// Caller holds m_treeMutex (or is the UI thread).
+std::vector<std::wstring> StartMenuWindow::PendingFolderPaths() const {
+    std::vector<std::wstring> paths;
+    const uint32_t n = static_cast<uint32_t>(m_programTree.NodeCount());
+    for (uint32_t i = 0; i < n; ++i)
+        if (m_programTree.Node(i).childrenPending())
+            paths.push_back(FolderRelativePath(i));
+    return paths;
+}
+
+void StartMenuWindow::EnsureFolderExpanded(uint32_t folder) {
+    if (!m_programTree.Node(folder).childrenPending()) return;
+
+    // A prefetch may be reading this very folder; waiting for it is cheaper
+    // than scanning twice.
+    if (m_prefetchThread.joinable()) {
+        FinishFolderPrefetch();
+        if (!m_programTree.Node(folder).childrenPending()) return;
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<MenuNode> children;
+    if (!ScanProgramFolderLevel(FolderRelativePath(folder), children))
+        CF_LOG(Warning, "EnsureFolderExpanded: folder no longer on disk");
+    {
+        std::lock_guard<std::mutex> lk(m_treeMutex);
+        m_programTree.ExpandFolder(folder, children);
+        ++m_treeGeneration;
+    }
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+    CF_LOG(Info, "Lazy folder expanded on demand: " << children.size()
+           << " nodes in " << us << " us");
+    LoadMissingIconsAsync();
+}
+
+void StartMenuWindow::PrefetchFolder(uint32_t folder) {
+    if (!m_programTree.Node(folder).isFolder() ||
+        !m_programTree.Node(folder).childrenPending())
+        return;
+    if (m_prefetchThread.joinable()) return;   // one at a time; the timer catches up
+
+    m_prefetchFolder = folder;
+    {
+        std::lock_guard<std::mutex> lk(m_treeMutex);
+        m_prefetchGeneration = m_treeGeneration;
+    }
+    m_prefetchThread = std::thread([this, rel = FolderRelativePath(folder)]() {
+        std::vector<MenuNode> children;
+        ScanProgramFolderLevel(rel, children);   // manages COM itself
+        m_prefetchChildren = std::move(children);
+        if (m_hwnd)
+            PostMessageW(m_hwnd, WM_APP_FOLDER_SCANNED, 0, 0);
+    });
+}
+
+void StartMenuWindow::FinishFolderPrefetch() {
+    if (!m_prefetchThread.joinable()) return;
+    m_prefetchThread.join();
+
+    const uint32_t folder = m_prefetchFolder;
+    m_prefetchFolder = MenuTree::kNone;
+    std::vector<MenuNode> children = std::move(m_prefetchChildren);
+    m_prefetchChildren.clear();
+    {
+        std::lock_guard<std::mutex> lk(m_treeMutex);
+        // The tree was swapped or patched while scanning: |folder| may now
+        // be a different node.  Drop the result; an open will rescan.
+        if (m_prefetchGeneration != m_treeGeneration ||
+            folder >= m_programTree.NodeCount() ||
+            !m_programTree.Node(folder).childrenPending())
+            return;
+        m_programTree.ExpandFolder(folder, children);
+        ++m_treeGeneration;
+    }
+    CF_LOG(Info, "Lazy folder prefetched: " << children.size() << " nodes");
+    LoadMissingIconsAsync();
+    if (m_hwnd) InvalidateRect(m_hwnd, nullptr, FALSE);
+}
+
+void StartMenuWindow::LoadMissingIconsAsync() {
+    // Passes never overlap: one still taking work just gets the new nodes,
+    // one winding down is followed up from WM_ICONS_LOADED.
+    {
+        std::lock_guard<std::mutex> qlk(m_iconQueueMutex);
+        if (m_iconQueueOpen) {
+            QueueMissingNodeIcons();
+            return;
+        }
+    }
+    if (m_iconPassBusy.load(std::memory_order_acquire)) {
+        m_missingIconsQueued = true;
+        return;
+    }
+    m_missingIconsQueued = false;
+    {
+        std::lock_guard<std::mutex> qlk(m_iconQueueMutex);
+        QueueMissingNodeIcons();
+        m_iconQueueOpen = true;
+    }
+    StartIconPass();
+}
+
+// ── Type-to-search ────────────────────────────────────────────────────────────
+// Typed characters arrive as WM_CHAR from the keyboard hook.  Each keystroke
+// reruns the query against m_searchIndex (a few hundred microseconds at most
+// for a 10k-entry catalog); one that extends the previous query only narrows
+// its matches (m_searchNarrowing).  The index itself is rebuilt only when the
+// tree, pinned or recent lists changed.  Everything here runs on the UI thread,
+// which is also the only thread that changes the tree's structure, so names
+// are read without m_treeMutex (the icon thread only writes icons).
+
+void StartMenuWindow::RebuildSearchIndex() {
+    const bool recentReady = m_iconsLoaded.load(std::memory_order_acquire);
+    if (!m_searchIndexDirty && m_searchIndexGeneration == m_treeGeneration &&
+        m_searchIndexHasRecent == recentReady)
+        return;
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    // Frecency boosts: recent items carry their combined rank; everything
+    // else is looked up among the menu's own launches.
+    const std::uint64_t now = CurrentFileTimeTicks();
+    std::unordered_map<std::uint64_t, double> launchRank;
+    for (const auto& launch : m_frecency.Snapshot())
+        launchRank.emplace(launch.key, launch.rank);
+    auto boostOf = [&](std::wstring_view path) {
+        if (launchRank.empty() || path.empty()) return 0;
+        auto it = launchRank.find(FrecencyStore::KeyOf(path));
+        return it == launchRank.end() ? 0 : FrecencyStore::SearchBoost(it->second, now);
+    };
+
+    m_searchIndex.Clear();
+    for (size_t i = 0; i < m_dynamicPinnedItems.size(); ++i)
+        m_searchIndex.Add(m_dynamicPinnedItems[i].name, SearchSource::Pinned,
+                          static_cast<uint32_t>(i), boostOf(m_dynamicPinnedItems[i].command));
+    if (recentReady) {
+        for (size_t i = 0; i < m_recentItems.size(); ++i)
+            m_searchIndex.Add(m_recentItems[i].name, SearchSource::Recent, static_cast<uint32_t>(i),
+                              FrecencyStore::SearchBoost(m_recentItems[i].rank, now));
+    }
+    const uint32_t n = static_cast<uint32_t>(m_programTree.NodeCount());
+    for (uint32_t i = 0; i < n; ++i) {
+        MenuNodeView node = m_programTree.Node(i);
+        m_searchIndex.Add(node.name(), SearchSource::Program, i,
+                          node.isFolder() ? 0 : boostOf(LaunchKeyPath(node)));
+    }
+    m_searchIndex.Build();
+
+    m_searchIndexDirty      = false;
+    m_searchIndexGeneration = m_treeGeneration;
+    m_searchIndexHasRecent  = recentReady;
+
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+    CF_LOG(Info, "Search index: " << m_searchIndex.EntryCount() << " entries, "
+           << m_searchIndex.MemoryBytes() / 1024 << " KB, built in " << us << " us (fuzzy: "
+           << FuzzySimdLevel() << ")");
+}
+
+void StartMenuWindow::UpdateSearch(std::wstring query) {
+    m_searchQuery = std::move(query);
+    m_hoveredApIndex = -1;
+
+    if (m_searchQuery.empty()) {
+        if (m_viewMode == LeftViewMode::Search) {
+            m_viewMode        = LeftViewMode::Programs;
+            m_keySelApIndex   = -1;
+            m_keySelProgIndex = -1;
+            m_searchResults.clear();
+            CF_LOG(Info, "Search cleared, back to Programs view");
+        }
+        if (m_hwnd) InvalidateRect(m_hwnd, NULL, FALSE);
+        return;
+    }
+
+    if (m_viewMode != LeftViewMode::Search) {
+        CloseSubMenu();
+        m_viewMode        = LeftViewMode::Search;
+        m_apNavStack.clear();
+        m_apScrollOffset  = 0;
+        m_keySelProgIndex = -1;
+        m_keySelApRow     = false;
+        StartSearchCatalogScan();
+    }
+
+    RebuildSearchIndex();
+    auto t0 = std::chrono::steady_clock::now();
+    m_searchIndex.Query(m_searchQuery, SEARCH_MAX_VISIBLE, m_searchResults, &m_searchNarrowing);
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+    CF_LOG(Debug, "Search: " << m_searchQuery.size() << "-char query, "
+           << m_searchResults.size() << " hits in " << us << " us");
+
+    // The top hit is preselected so Enter launches it.
+    m_keySelApIndex = m_searchResults.empty() ? -1 : 0;
     if (m_hwnd) InvalidateRect(m_hwnd, NULL, FALSE);
 }
 
+void StartMenuWindow::ActivateSearchResult(int index) {
+    if (index < 0 || index >= static_cast<int>(m_searchResults.size())) return;
+    const SearchHit hit = m_searchResults[static_cast<size_t>(index)];
+    CF_LOG(Info, "Search: activate result " << index);
+
+    if (hit.source == SearchSource::Pinned) {
+        ExecutePinnedItem(static_cast<int>(hit.ref));
+        return;
+    }
+    if (hit.source == SearchSource::Recent) {
+        ExecutePinnedItem(static_cast<int>(m_dynamicPinnedItems.size() + hit.ref));
+        return;
+    }
+
+    MenuNodeView node = m_programTree.Node(hit.ref);
+    if (!node.isFolder()) {
+        LaunchProgramNode(node);
+        return;
+    }
+
+    // Folder: open it in All Programs with its ancestors on the nav stack,
+    // so Back walks up from there.
+    m_searchQuery.clear();
+    m_searchResults.clear();
+    m_viewMode = LeftViewMode::AllPrograms;
+    m_apNavStack.clear();
+    for (uint32_t p = m_programTree.Parent(hit.ref); p != MenuTree::kNone;
+         p = m_programTree.Parent(p))
+        m_apNavStack.insert(m_apNavStack.begin(), p);
+    NavigateIntoFolder(node);
+}
+
+void StartMenuWindow::StartSearchCatalogScan() {
+    if (!m_lazyProgramTree || m_searchScanStarted) return;
+    m_searchScanStarted = true;
+
+    const uint32_t n = static_cast<uint32_t>(m_programTree.NodeCount());
+    bool anyPending = false;
+    for (uint32_t i = 0; i < n && !anyPending; ++i)
+        anyPending = m_programTree.Node(i).childrenPending();
+    if (!anyPending) return;
+
+    // A full (non-lazy) scan, handed over like a revalidation result; later
+    // lazy rescans keep its shape, so the catalog stays complete.
+    CF_LOG(Info, "Search: scanning pending folders in the background");
+    m_searchScanThread = std::thread([this]() {
+        std::vector<MenuNode> full = BuildProgramTreeWithSnapshot(/*lazy=*/false);
+        {
+            std::lock_guard<std::mutex> lk(m_treeMutex);
+            m_pendingProgramTree    = std::move(full);
+            m_hasPendingProgramTree = true;
+        }
+        if (m_hwnd)
+            PostMessageW(m_hwnd, WM_APP_REFRESH_TREE, 0, 0);
+    });
+}
+
 // ── Hover-to-open lateral submenu (S3.3) ─────────────────────────────────────
 void StartMenuWindow::OpenSubMenu(int apNodeIdx) {
-    const auto& nodes = CurrentApNodes();
+    MenuNodeRange nodes = CurrentApNodes();
     if (apNodeIdx < 0 || apNodeIdx >= static_cast<int>(nodes.size())) return;
-    if (!nodes[static_cast<size_t>(apNodeIdx)].isFolder) return;
+    if (!nodes[static_cast<size_t>(apNodeIdx)].isFolder()) return;
+    EnsureFolderExpanded(nodes[static_cast<size_t>(apNodeIdx)].index());
 
     if (m_hoverTimer) { KillTimer(m_hwnd, HOVER_TIMER_ID); m_hoverTimer = 0; }
     m_hoverCandidate    = -1;
     m_subMenuOpen       = true;
     m_subMenuNodeIdx    = apNodeIdx;
     m_subMenuHoveredIdx = -1;
+    PrioritizeVisibleIcons(nodes[static_cast<size_t>(apNodeIdx)].index());
     CF_LOG(Info, "SubMenu opened for AP node " << apNodeIdx);
     if (m_hwnd) InvalidateRect(m_hwnd, NULL, FALSE);
 }
@@ -2106,6 +3129,7 @@ void StartMenuWindow::CloseSubMenu() {
     m_subMenuOpen       = false;
     m_subMenuNodeIdx    = -1;
     m_subMenuHoveredIdx = -1;
+    m_iconHoverFolder   = MenuTree::kNone;
     if (m_hwnd) InvalidateRect(m_hwnd, NULL, FALSE);
 }
 
@@ -2121,80 +3145,72 @@ int StartMenuWindow::GetSubMenuItemAtPoint(POINT pt) {
     if (relY < 0) return -1;
     int vis = relY / SM_ITEM_H;
 
-    const auto& nodes   = CurrentApNodes();
-    const auto& folder  = nodes[static_cast<size_t>(m_subMenuNodeIdx)];
-    int count = min(SM_MAX_VIS, static_cast<int>(folder.children.size()));
+    MenuNodeView folder = CurrentApNodes()[static_cast<size_t>(m_subMenuNodeIdx)];
+    int count = min(SM_MAX_VIS, static_cast<int>(folder.children().size()));
     if (vis >= 0 && vis < count) return vis;
     return -1;
 }
 
 void StartMenuWindow::PaintSubMenu(HDC hdc, const RECT& cr) {
     if (!m_subMenuOpen) return;
-    const bool iconsReady = m_iconsLoaded.load(std::memory_order_acquire);
-    const auto& nodes  = CurrentApNodes();
-    const auto& folder = nodes[static_cast<size_t>(m_subMenuNodeIdx)];
-    int count = min(SM_MAX_VIS, static_cast<int>(folder.children.size()));
+    MenuNodeView  folder   = CurrentApNodes()[static_cast<size_t>(m_subMenuNodeIdx)];
+    MenuNodeRange children = folder.children();
+    int count = min(SM_MAX_VIS, static_cast<int>(children.size()));
 
     // Background panel
     COLORREF panelColor = CalculateSubtleColor();
-    HBRUSH   panelBr    = CreateSolidBrush(panelColor);
-    RECT     panelR     = { DIVIDER_X, 0, cr.right, BOTTOM_BAR_Y };
-    FillRect(hdc, &panelR, panelBr);
-    DeleteObject(panelBr);
+    FillSolid(hdc, { DIVIDER_X, 0, cr.right, BOTTOM_BAR_Y }, panelColor);
 
     // Left border of panel
-    HPEN bdrPen = CreatePen(PS_SOLID, 1, CalculateBorderColor());
-    HPEN oldPen = (HPEN)SelectObject(hdc, bdrPen);
-    MoveToEx(hdc, DIVIDER_X, 0, NULL);
-    LineTo(hdc, DIVIDER_X, BOTTOM_BAR_Y);
-    SelectObject(hdc, oldPen);
-    DeleteObject(bdrPen);
+    DrawLine(hdc, DIVIDER_X, 0, DIVIDER_X, BOTTOM_BAR_Y, CalculateBorderColor());
 
     SetBkMode(hdc, TRANSPARENT);
 
     // Title — folder name
     HFONT oldF = (HFONT)SelectObject(hdc, m_fontBold14);
-    ::SetTextColor(hdc, m_textColor);
-    RECT tr = { SM_X, 0, cr.right - 4, SM_TITLE_H };
-    DrawTextW(hdc, folder.name.c_str(), -1, &tr,
-              DT_LEFT | DT_VCENTER | DT_SINGLELINE | DT_END_ELLIPSIS);
-    DrawSeparator(hdc, SM_TITLE_H, SM_X, cr.right - 4);
+    if (NeedsPaint({ SM_X, 0, cr.right, SM_TITLE_H + 1 })) {
+        ::SetTextColor(hdc, m_textColor);
+        RECT tr = { SM_X, 0, cr.right - 4, SM_TITLE_H };
+        DrawLabel(hdc, folder.name().data(), -1, &tr,
+                   DT_LEFT | DT_VCENTER | DT_SINGLELINE | DT_END_ELLIPSIS);
+        DrawSeparator(hdc, SM_TITLE_H, SM_X, cr.right - 4);
+    }
 
     // Items
 
     for (int i = 0; i < count; ++i) {
-        const MenuNode& child = folder.children[static_cast<size_t>(i)];
+        MenuNodeView child = children[static_cast<size_t>(i)];
         int itemY = SM_TITLE_H + i * SM_ITEM_H;
+        if (!NeedsPaint(SubMenuRowRect(i))) continue;
+        ++m_paintCost.rows;
 
         if (i == m_subMenuHoveredIdx) {
-            HBRUSH hBr  = CreateSolidBrush(AnimatedHoverColor());
-            HPEN   noPn = (HPEN)GetStockObject(NULL_PEN);
-            HBRUSH ob   = (HBRUSH)SelectObject(hdc, hBr);
-            HPEN   op   = (HPEN)SelectObject(hdc, noPn);
-            RoundRect(hdc, SM_X, itemY + 2, cr.right - 4, itemY + SM_ITEM_H - 2, 6, 6);
-            SelectObject(hdc, ob);
-            SelectObject(hdc, op);
-            DeleteObject(hBr);
+            FillRounded(hdc, { SM_X, itemY + 2,
+                               cr.right - 4, itemY + SM_ITEM_H - 2 }, 3, AnimatedHoverColor());
         }
 
         // Small icon (20×20 slot)
         static constexpr int SM_ICON_SZ = 20;
         int iconCX = SM_X + 14;
         int iconCY = itemY + SM_ITEM_H / 2;
-        if (iconsReady && child.hIcon) {
-            DrawIconEx(hdc, iconCX - SM_ICON_SZ / 2, iconCY - SM_ICON_SZ / 2,
-                       child.hIcon, SM_ICON_SZ, SM_ICON_SZ, 0, nullptr, DI_NORMAL);
+        bool  evicted = false;
+        HICON icon    = LoadedNodeIcon(child.index(), evicted);
+        if (icon) {
+            DrawAtlasIcon(hdc, icon, iconCX - SM_ICON_SZ / 2,
+                          iconCY - SM_ICON_SZ / 2, SM_ICON_SZ);
             SelectObject(hdc, m_fontNormal14);
-        } else if (child.isFolder) {
+        } else if (child.isFolder()) {
             DrawIconSquare(hdc, iconCX, iconCY, SM_ICON_SZ, RGB(210, 150, 20), L"\u203a");
             SelectObject(hdc, m_fontNormal14);
         } else {
             DrawIconSquare(hdc, iconCX, iconCY, SM_ICON_SZ, RGB(30, 140, 130), L"\u00bb");
             SelectObject(hdc, m_fontNormal14);
+            if (evicted)
+                m_iconReloads.push_back(child.index());
         }
 
         RECT nr = { SM_X + 32, itemY, cr.right - 4, itemY + SM_ITEM_H };
-        DrawShadowText(hdc, child.name.c_str(), -1, &nr,
+        DrawShadowText(hdc, child.name().data(), -1, &nr,
                        DT_LEFT | DT_VCENTER | DT_SINGLELINE | DT_END_ELLIPSIS, m_textColor);
     }
 
@@ -2202,38 +3218,38 @@ void StartMenuWindow::PaintSubMenu(HDC hdc, const RECT& cr) {
         SelectObject(hdc, m_fontNormal14);
         ::SetTextColor(hdc, CalculateBorderColor());
         RECT er = { SM_X, SM_TITLE_H + 8, cr.right - 4, SM_TITLE_H + SM_ITEM_H };
-        DrawTextW(hdc, L"(empty)", -1, &er, DT_LEFT | DT_VCENTER | DT_SINGLELINE);
+        DrawLabel(hdc, L"(empty)", -1, &er, DT_LEFT | DT_VCENTER | DT_SINGLELINE);
     }
 
-    if (static_cast<int>(folder.children.size()) > SM_MAX_VIS) {
+    if (static_cast<int>(children.size()) > SM_MAX_VIS) {
         int lastY = SM_TITLE_H + count * SM_ITEM_H;
         SelectObject(hdc, m_fontNormal14);
         ::SetTextColor(hdc, CalculateBorderColor());
         RECT mr = { SM_X, lastY, cr.right - 4, lastY + SM_ITEM_H };
-        DrawTextW(hdc, L"\u25bc  more\u2026", -1, &mr, DT_LEFT | DT_VCENTER | DT_SINGLELINE);
+        DrawLabel(hdc, L"\u25bc  more\u2026", -1, &mr, DT_LEFT | DT_VCENTER | DT_SINGLELINE);
     }
 
     SelectObject(hdc, oldF);
 }
 
 void StartMenuWindow::ExecuteSubMenuItem(int visualIdx) {
-    const auto& nodes  = CurrentApNodes();
-    const auto& folder = nodes[static_cast<size_t>(m_subMenuNodeIdx)];
-    if (visualIdx < 0 || visualIdx >= static_cast<int>(folder.children.size())) return;
+    MenuNodeView  folder   = CurrentApNodes()[static_cast<size_t>(m_subMenuNodeIdx)];
+    MenuNodeRange children = folder.children();
+    if (visualIdx < 0 || visualIdx >= static_cast<int>(children.size())) return;
 
-    const MenuNode& child = folder.children[static_cast<size_t>(visualIdx)];
-    if (child.isFolder) {
+    MenuNodeView child = children[static_cast<size_t>(visualIdx)];
+    if (child.isFolder()) {
         // Drill into sub-folder: close submenu, navigate main AP list into folder
         CloseSubMenu();
-        NavigateIntoFolder(child.children);
+        NavigateIntoFolder(child);
     } else {
-        CF_LOG(Info, "SubMenu launch: " << child.target.size() << " char target");
+        CF_LOG(Info, "SubMenu launch: " << child.target().size() << " char target");
         CloseSubMenu();
         Hide();
-        if (!child.target.empty()) {
+        if (!child.target().empty()) {
             HINSTANCE hi = ShellExecuteW(NULL, L"open",
-                child.target.c_str(),
-                child.args.empty() ? nullptr : child.args.c_str(),
+                child.target().data(),
+                child.args().empty() ? nullptr : child.args().data(),
                 nullptr, SW_SHOW);
             if (reinterpret_cast<INT_PTR>(hi) <= 32)
                 CF_LOG(Warning, "SubMenu ShellExecuteW returned " << reinterpret_cast<INT_PTR>(hi));
@@ -2323,15 +3339,42 @@ LRESULT StartMenuWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
         return 0;
 
     case WM_ICONS_LOADED:
-        // Posted by LoadIconsAsync() when all background icon loading is done.
+        // Posted by the icon pool when a pass has loaded everything queued.
         // Repaint so real icons replace the colored-square fallbacks.
+        TrimIconCache();
+        if (m_missingIconsQueued)
+            LoadMissingIconsAsync();   // folders expanded during that pass
+        // Every tree build or expansion ends here: index it now rather than
+        // on the first keystroke.  Recent items are readable from here on.
+        RebuildSearchIndex();
+        if (m_viewMode == LeftViewMode::Search)
+            UpdateSearch(m_searchQuery);
+        InvalidateRect(m_hwnd, nullptr, FALSE);
+        return 0;
+
+    case WM_ICONS_LANDED:
+        // Posted by the icon thread while a pass runs: paint what landed.
+        m_iconRepaintPosted.store(false, std::memory_order_release);
+        TrimIconCache();
         InvalidateRect(m_hwnd, nullptr, FALSE);
         return 0;
 
+    case WM_APP_FOLDER_SCANNED:
+        // Posted by the lazy-folder prefetch thread.
+        FinishFolderPrefetch();
+        return 0;
+
+    case WM_APP_RECENT_CHANGED:
+        // Posted by the recent watcher.  While the menu is open the list stays
+        // put (rows must not move under the pointer); Show() takes it then.
+        if (!m_visible)
+            ApplyPendingRecentItems();
+        return 0;
+
     case WM_APP_REFRESH_TREE:
         // Posted by the file-system watcher thread when a Start Menu folder
-        // change is detected.  Rebuild the programs tree on the UI thread.
-        RefreshProgramTree();
+        // change is detected.  Patch (or rebuild) the tree on the UI thread.
+        ApplyFolderChanges();
         return 0;
 
     case WM_AVATAR_LOADED:
@@ -2353,7 +3396,7 @@ LRESULT StartMenuWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
         int  nProg  = (m_viewMode == LeftViewMode::Programs)
                       ? GetProgItemAtPoint(pt) : -1;
         bool nApRow = IsOverApRow(pt);
-        int  nAp    = (m_viewMode == LeftViewMode::AllPrograms)
+        int  nAp    = (m_viewMode != LeftViewMode::Programs)
                       ? GetApItemAtPoint(pt) : -1;
         int  nrc    = GetRightItemAtPoint(pt);
         bool nshut  = IsOverShutdownButton(pt);
@@ -2363,16 +3406,16 @@ LRESULT StartMenuWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
         if (m_viewMode == LeftViewMode::AllPrograms) {
             bool overFolder = false;
             if (nAp >= 0) {
-                const auto& nodes = CurrentApNodes();
-                overFolder = nodes[static_cast<size_t>(nAp)].isFolder;
+                overFolder = CurrentApNodes()[static_cast<size_t>(nAp)].isFolder();
             }
             if (overFolder) {
                 if (m_subMenuOpen && m_subMenuNodeIdx == nAp) {
                     // Same folder as open submenu — just update submenu hover
                     int smHov = GetSubMenuItemAtPoint(pt);
                     if (smHov != m_subMenuHoveredIdx) {
+                        InvalidateArea(SubMenuRowRect(m_subMenuHoveredIdx));
                         m_subMenuHoveredIdx = smHov;
-                        InvalidateRect(m_hwnd, NULL, FALSE);
+                        InvalidateArea(SubMenuRowRect(smHov));
                     }
                 } else if (nAp != m_hoverCandidate) {
                     // Different folder — start a new switch timer but do NOT close
@@ -2384,6 +3427,11 @@ LRESULT StartMenuWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
                     if (m_hoverTimer) KillTimer(m_hwnd, HOVER_TIMER_ID);
                     m_hoverCandidate = nAp;
                     m_hoverTimer     = SetTimer(m_hwnd, HOVER_TIMER_ID, HOVER_DELAY_MS, NULL);
+                    // Lazy tree: start reading the folder now so the submenu
+                    // usually finds it expanded when the timer fires.
+                    const uint32_t hovered = CurrentApNodes()[static_cast<size_t>(nAp)].index();
+                    PrefetchFolder(hovered);
+                    PrioritizeVisibleIcons(hovered);
                 }
             } else if (m_subMenuOpen && IsOverSubMenu(pt)) {
                 // Mouse is in the submenu panel — cancel any pending switch timer so
@@ -2392,8 +3440,9 @@ LRESULT StartMenuWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
                 // Update submenu item hover
                 int smHov = GetSubMenuItemAtPoint(pt);
                 if (smHov != m_subMenuHoveredIdx) {
+                    InvalidateArea(SubMenuRowRect(m_subMenuHoveredIdx));
                     m_subMenuHoveredIdx = smHov;
-                    InvalidateRect(m_hwnd, NULL, FALSE);
+                    InvalidateArea(SubMenuRowRect(smHov));
                 }
             } else {
                 // Not over a folder and not in submenu.
@@ -2413,8 +3462,8 @@ LRESULT StartMenuWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
                     CloseSubMenu();
                 }
             }
-        } else if (m_viewMode == LeftViewMode::Programs) {
-            // Programs view — ensure any lingering submenu/timer is cleared
+        } else {
+            // Programs / Search view — ensure any lingering submenu/timer is cleared
             if (m_hoverTimer) { KillTimer(m_hwnd, HOVER_TIMER_ID); m_hoverTimer = 0; m_hoverCandidate = -1; }
             if (m_subMenuOpen) CloseSubMenu();
         }
@@ -2449,6 +3498,8 @@ LRESULT StartMenuWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
                 m_hoverAnimAlpha = 255;
             }
 
+            // Rows losing their highlight repaint now, whatever the timer does
+            InvalidateHighlights();
             m_hoveredProgIndex  = nProg;
             m_hoveredApRow      = nApRow;
             m_hoveredApIndex    = nAp;
@@ -2462,7 +3513,7 @@ LRESULT StartMenuWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
             }
             // Skip immediate repaint if anim timer is already running — it repaints at 16ms
             if (!m_hoverAnimTimer)
-                InvalidateRect(m_hwnd, NULL, FALSE);
+                InvalidateHighlights();
         }
         return 0;
     }
@@ -2472,6 +3523,7 @@ LRESULT StartMenuWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
         if (m_hoverAnimTimer) { KillTimer(m_hwnd, HOVER_ANIM_TIMER_ID); m_hoverAnimTimer = 0; }
         m_hoverAnimAlpha    = 255;
         m_trackingMouse     = false;
+        InvalidateHighlights();
         m_hoveredProgIndex  = -1;
         m_hoveredApRow      = false;
         m_hoveredApIndex    = -1;
@@ -2480,7 +3532,6 @@ LRESULT StartMenuWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
         m_hoveredArrow      = false;
         if (m_hoverTimer) { KillTimer(m_hwnd, HOVER_TIMER_ID); m_hoverTimer = 0; m_hoverCandidate = -1; }
         if (m_subMenuOpen)  CloseSubMenu();
-        else InvalidateRect(m_hwnd, NULL, FALSE);
         return 0;
 
     case WM_LBUTTONDOWN: {
@@ -2504,6 +3555,7 @@ LRESULT StartMenuWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
                 m_viewMode       = LeftViewMode::AllPrograms;
                 m_hoveredApIndex = -1;
                 m_apNavStack.clear();
+                PrioritizeVisibleIcons();
                 CF_LOG(Info, "Switching to All Programs view");
             } else {
                 NavigateBack();
@@ -2524,6 +3576,12 @@ LRESULT StartMenuWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
             if (ap >= 0) { LaunchApItem(ap); return 0; }
         }
 
+        // Left column — Search view: result activation
+        if (m_viewMode == LeftViewMode::Search) {
+            int hit = GetApItemAtPoint(pt);
+            if (hit >= 0) { ActivateSearchResult(hit); return 0; }
+        }
+
         // Bottom bar — Shut down button (direct action) and arrow (dropdown)
         if (IsOverShutdownButton(pt)) {
             Hide();
@@ -2534,7 +3592,6 @@ LRESULT StartMenuWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
         }
         if (IsOverArrowButton(pt)) { ShowPowerMenu(); return 0; }
 
-        // Search box removed — no click handler.
         return 0;
     }
 
@@ -2542,6 +3599,8 @@ LRESULT StartMenuWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
         if (wParam == VK_ESCAPE) {
             if (m_subMenuOpen)
                 CloseSubMenu();
+            else if (m_viewMode == LeftViewMode::Search)
+                UpdateSearch(std::wstring());   // clear the query, back to Programs
             else if (m_viewMode == LeftViewMode::AllPrograms)
                 NavigateBack();
             else
@@ -2549,10 +3608,24 @@ LRESULT StartMenuWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
             return 0;
         }
 
+        if (wParam == VK_BACK) {
+            if (m_viewMode == LeftViewMode::Search && !m_searchQuery.empty())
+                UpdateSearch(m_searchQuery.substr(0, m_searchQuery.size() - 1));
+            return 0;
+        }
+
         if (wParam == VK_DOWN || wParam == VK_UP) {
             bool down = (wParam == VK_DOWN);
-
-            if (m_viewMode == LeftViewMode::Programs) {
+            InvalidateHighlights();
+            const int scroll = m_apScrollOffset;
+
+            if (m_viewMode == LeftViewMode::Search) {
+                // Search view: move within the shown results, clamped at both ends.
+                int shown = min(static_cast<int>(m_searchResults.size()), SEARCH_MAX_VISIBLE);
+                if (shown > 0)
+                    m_keySelApIndex = down ? min(m_keySelApIndex + 1, shown - 1)
+                                           : max(m_keySelApIndex - 1, 0);
+            } else if (m_viewMode == LeftViewMode::Programs) {
                 // Navigation range: 0..pinnedCount-1, then AP row
                 // S7: total navigable items = pinned + recently used (only after icons loaded)
                 int totalProgItems = static_cast<int>(m_dynamicPinnedItems.size())
@@ -2616,18 +3689,25 @@ LRESULT StartMenuWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
                         m_apScrollOffset = m_keySelApIndex - AP_MAX_VISIBLE + 1;
                 }
             }
-            InvalidateRect(m_hwnd, NULL, FALSE);
+            if (m_apScrollOffset != scroll)
+                InvalidateRect(m_hwnd, NULL, FALSE);
+            else
+                InvalidateHighlights();
             return 0;
         }
 
         if (wParam == VK_RETURN) {
-            if (m_viewMode == LeftViewMode::Programs) {
+            if (m_viewMode == LeftViewMode::Search) {
+                // Enter launches the selected hit (the top one until moved).
+                ActivateSearchResult(max(m_keySelApIndex, 0));
+            } else if (m_viewMode == LeftViewMode::Programs) {
                 if (m_keySelApRow) {
                     // Enter on "All Programs" row → switch view
                     m_keySelApRow    = false;
                     m_keySelApIndex  = -1;
                     m_viewMode       = LeftViewMode::AllPrograms;
                     m_apNavStack.clear();
+                    PrioritizeVisibleIcons();
                     CF_LOG(Info, "Keyboard: switch to All Programs view");
                     InvalidateRect(m_hwnd, NULL, FALSE);
                 } else if (m_keySelProgIndex >= 0) {
@@ -2650,6 +3730,41 @@ LRESULT StartMenuWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
 
         return 0;
 
+    case WM_CHAR: {
+        // Typed characters, translated and forwarded by the keyboard hook
+        // (Backspace arrives as VK_BACK above).
+        const wchar_t ch = static_cast<wchar_t>(wParam);
+        if (ch < L' ' || ch == 0x7F) return 0;
+
+        // Letter / digit in All Programs: jump to the next item with that
+        // initial (repeated presses cycle), via the tree's sort-key jump table.
+        if (m_viewMode == LeftViewMode::AllPrograms) {
+            if (!iswalnum(ch)) return 0;
+            const int next = m_programTree.FindNextByInitial(CurrentApNodes(), ch,
+                                                             m_keySelApIndex);
+            if (next >= 0) {
+                InvalidateHighlights();
+                const int scroll = m_apScrollOffset;
+                m_keySelApRow   = false;
+                m_keySelApIndex = next;
+                if (m_keySelApIndex < m_apScrollOffset)
+                    m_apScrollOffset = m_keySelApIndex;
+                else if (m_keySelApIndex >= m_apScrollOffset + AP_MAX_VISIBLE)
+                    m_apScrollOffset = m_keySelApIndex - AP_MAX_VISIBLE + 1;
+                if (m_apScrollOffset != scroll)
+                    InvalidateRect(m_hwnd, NULL, FALSE);
+                else
+                    InvalidateHighlights();
+            }
+            return 0;
+        }
+
+        // Anywhere else typing searches; a leading space does not start one.
+        if (m_viewMode == LeftViewMode::Search || !iswspace(ch))
+            UpdateSearch(m_searchQuery + ch);
+        return 0;
+    }
+
     case WM_TIMER:
         if (wParam == HOVER_TIMER_ID) {
             KillTimer(m_hwnd, HOVER_TIMER_ID);
@@ -2665,11 +3780,10 @@ LRESULT StartMenuWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
                 KillTimer(m_hwnd, HOVER_ANIM_TIMER_ID);
                 m_hoverAnimTimer = 0;
             }
-            InvalidateRect(m_hwnd, NULL, FALSE);
+            InvalidateHighlights();   // only hovered rows fade
         } else if (wParam == FADE_TIMER_ID) {
-            // Show() fade-in: ramp SetLayeredWindowAttributes 0→255 over ~80ms (5 ticks × 16ms)
-            m_fadeAlpha = static_cast<BYTE>(min(255, static_cast<int>(m_fadeAlpha) + 51));
-            SetLayeredWindowAttributes(m_hwnd, 0, m_fadeAlpha, LWA_ALPHA);
+            // Show() fade-in: ramp the frame's constant alpha 0→255 over ~80ms (5 ticks × 16ms)
+            SetFadeAlpha(static_cast<BYTE>(min(255, static_cast<int>(m_fadeAlpha) + 51)));
             if (m_fadeAlpha >= 255) {
                 KillTimer(m_hwnd, FADE_TIMER_ID);
                 m_fadeTimer = 0;
@@ -2679,8 +3793,14 @@ LRESULT StartMenuWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
 
     case WM_SETTINGCHANGE:
     case WM_DISPLAYCHANGE:
+    case WM_DPICHANGED:
         // Taskbar position / DPI changed — refresh cached menu position.
         CacheMenuPosition();
+        // The back buffer was made for the old display; Paint() rebuilds it.
+        if (msg != WM_SETTINGCHANGE) {
+            ReleaseBackBuffer();
+            InvalidateRect(m_hwnd, nullptr, FALSE);
+        }
         return 0;
 
     case WM_APP_SHOW_MENU:
@@ -2717,8 +3837,7 @@ LRESULT StartMenuWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
         } else if (m_viewMode == LeftViewMode::AllPrograms) {
             int ap = GetApItemAtPoint(pt);
             if (ap >= 0) {
-                const auto& nodes = CurrentApNodes();
-                if (!nodes[static_cast<size_t>(ap)].isFolder)
+                if (!CurrentApNodes()[static_cast<size_t>(ap)].isFolder())
                     ShowAllProgramsContextMenu(ap, screenPt);
             }
         }
@@ -2736,13 +3855,15 @@ LRESULT StartMenuWindow::HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
         int total  = static_cast<int>(CurrentApNodes().size());
         int maxOff = max(0, total - AP_MAX_VISIBLE);
         int step   = 3;   // items per wheel notch
+        int scroll = m_apScrollOffset;
 
         if (delta < 0)
             m_apScrollOffset = min(m_apScrollOffset + step, maxOff);
         else
             m_apScrollOffset = max(m_apScrollOffset - step, 0);
 
-        InvalidateRect(m_hwnd, NULL, FALSE);
+        if (m_apScrollOffset != scroll)   // nothing moves at either end
+            InvalidateRect(m_hwnd, NULL, FALSE);
         return 0;
     }
 
@@ -2781,21 +3902,9 @@ void StartMenuWindow::StartFolderWatcher() {
     m_watcherRunning.store(true, std::memory_order_relaxed);
 
     m_watcherThread = std::thread([this]() {
-        // Resolve both Start Menu Programs paths.
-        auto resolvePath = [](REFKNOWNFOLDERID id) -> std::wstring {
-            PWSTR p = nullptr;
-            std::wstring result;
-            if (SUCCEEDED(SHGetKnownFolderPath(id, KF_FLAG_DEFAULT, nullptr, &p)) && p) {
-                result = p;
-                CoTaskMemFree(p);
-            }
-            return result;
-        };
-
-        std::wstring paths[2] = {
-            resolvePath(FOLDERID_CommonPrograms),
-            resolvePath(FOLDERID_Programs)
-        };
+        // Resolve both Start Menu Programs paths (same roots as the scan).
+        std::wstring paths[2];
+        ResolveProgramsRoots(paths);
 
         // Open directory handles for both folders.
         HANDLE hDirs[2]   = { INVALID_HANDLE_VALUE, INVALID_HANDLE_VALUE };
@@ -2821,11 +3930,14 @@ void StartMenuWindow::StartFolderWatcher() {
         hEvents[dirCount] = m_watcherStopEvent;
         DWORD waitCount   = static_cast<DWORD>(dirCount) + 1;
 
-        // Overlapped buffers for ReadDirectoryChangesW
-        const DWORD kBufSize = 4096;
-        alignas(DWORD) BYTE buf0[kBufSize] = {};
-        alignas(DWORD) BYTE buf1[kBufSize] = {};
-        BYTE* bufs[2] = { buf0, buf1 };
+        // Overlapped buffers for ReadDirectoryChangesW.  64 KB is the largest
+        // size honoured for every volume type and holds a typical installer's
+        // burst of records without overflowing into a full rebuild.
+        const DWORD kBufSize = 64 * 1024;
+        std::vector<DWORD> buf0(kBufSize / sizeof(DWORD));
+        std::vector<DWORD> buf1(kBufSize / sizeof(DWORD));
+        BYTE* bufs[2] = { reinterpret_cast<BYTE*>(buf0.data()),
+                          reinterpret_cast<BYTE*>(buf1.data()) };
         OVERLAPPED ov[2] = {};
 
         // Issue initial ReadDirectoryChangesW calls.
@@ -2841,6 +3953,30 @@ void StartMenuWindow::StartFolderWatcher() {
         };
         for (int i = 0; i < dirCount; ++i) issueRead(i);
 
+        // Decode one completed buffer into m_pendingTreeChanges.  Paths are
+        // relative to the watched root; ApplyProgramTreeChanges() checks them
+        // against both roots, so which root reported them does not matter.
+        auto queueRecords = [&](const BYTE* buf, DWORD bytes) {
+            std::lock_guard<std::mutex> lk(m_treeChangesMutex);
+            DWORD offset = 0;
+            while (offset + sizeof(FILE_NOTIFY_INFORMATION) <= bytes) {
+                auto* fni = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buf + offset);
+                ProgramTreeChange change;
+                switch (fni->Action) {
+                case FILE_ACTION_ADDED:
+                case FILE_ACTION_RENAMED_NEW_NAME: change.kind = ProgramTreeChange::Added;    break;
+                case FILE_ACTION_REMOVED:
+                case FILE_ACTION_RENAMED_OLD_NAME: change.kind = ProgramTreeChange::Removed;  break;
+                default:                           change.kind = ProgramTreeChange::Modified; break;
+                }
+                change.relativePath.assign(fni->FileName, fni->FileNameLength / sizeof(WCHAR));
+                m_pendingTreeChanges.push_back(std::move(change));
+
+                if (fni->NextEntryOffset == 0) break;
+                offset += fni->NextEntryOffset;
+            }
+        };
+
         bool needsRefresh = false;
         while (m_watcherRunning.load(std::memory_order_relaxed)) {
             // INFINITE when idle; 200 ms batch window when changes accumulated.
@@ -2861,10 +3997,18 @@ void StartMenuWindow::StartFolderWatcher() {
             int idx = static_cast<int>(res - WAIT_OBJECT_0);
             if (idx >= dirCount) break; // stop event fired → exit cleanly
 
-            // Drain the change buffer and re-arm.
+            // Drain the change buffer and re-arm.  A completion with zero bytes
+            // (or ERROR_NOTIFY_ENUM_DIR) means the kernel dropped records
+            // because the buffer overflowed — only a full rebuild is safe then.
             DWORD bytes = 0;
-            if (GetOverlappedResult(hDirs[idx], &ov[idx], &bytes, FALSE) && bytes > 0)
-                needsRefresh = true;
+            if (GetOverlappedResult(hDirs[idx], &ov[idx], &bytes, FALSE) && bytes > 0) {
+                queueRecords(bufs[idx], bytes);
+            } else {
+                CF_LOG(Warning, "StartFolderWatcher: change buffer overflow, full rebuild queued");
+                std::lock_guard<std::mutex> lk(m_treeChangesMutex);
+                m_treeChangesOverflow = true;
+            }
+            needsRefresh = true;
             issueRead(idx);
         }
 
@@ -2891,23 +4035,204 @@ void StartMenuWindow::StopFolderWatcher() {
     }
 }
 
+// ── S7: Recent programs watcher ───────────────────────────────────────────────
+// Keeps the recent list current off the UI thread.  The thread builds it once
+// at start, then again whenever either UserAssist Count key changes (Explorer
+// updates it on every launch) or RequestRecentRefresh() sets the wake event —
+// batched over 200 ms like the folder watcher.  A rebuild whose entries equal
+// the last published ones is dropped (UserAssist also rewrites focus times),
+// so most notifications cost one registry pass and no icon loads.
+void StartMenuWindow::StartRecentWatcher() {
+    m_recentStopEvent = CreateEventW(nullptr, /*manualReset=*/TRUE,  FALSE, nullptr);
+    m_recentWakeEvent = CreateEventW(nullptr, /*manualReset=*/FALSE, FALSE, nullptr);
+    if (!m_recentStopEvent || !m_recentWakeEvent) {
+        CF_LOG(Warning, "StartRecentWatcher: failed to create events");
+        StopRecentWatcher();
+        return;
+    }
+    RequestRecentRefresh();   // seed m_recentInputs
+
+    m_recentThread = std::thread([this]() {
+        // SHGetFileInfoW resolves .lnk display names through the shell.
+        HRESULT hrCom = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
+        bool comInited = SUCCEEDED(hrCom);
+
+        // Change notifications are one-shot: re-armed after each signal.
+        HKEY   keys[2]   = {};
+        HANDLE events[4] = {};   // [0..keyCount-1] = key changes, then wake, stop
+        DWORD  keyCount  = 0;
+        for (const auto* guid : kUserAssistGuids) {
+            HKEY h = nullptr;
+            if (RegOpenKeyExW(HKEY_CURRENT_USER, UserAssistCountKey(guid).c_str(), 0,
+                              KEY_READ | KEY_NOTIFY, &h) != ERROR_SUCCESS)
+                continue;
+            keys[keyCount]   = h;
+            events[keyCount] = CreateEventW(nullptr, /*manualReset=*/FALSE, FALSE, nullptr);
+            ++keyCount;
+        }
+        auto arm = [&](DWORD i) {
+            RegNotifyChangeKeyValue(keys[i], /*watchSubtree=*/FALSE,
+                                    REG_NOTIFY_CHANGE_LAST_SET, events[i], /*async=*/TRUE);
+        };
+        for (DWORD i = 0; i < keyCount; ++i) arm(i);
+        events[keyCount]     = m_recentWakeEvent;
+        events[keyCount + 1] = m_recentStopEvent;
+        const DWORD waitCount = keyCount + 2;
+
+        // Entries of the last list handed to the UI thread (icons not owned
+        // here: they live in m_pendingRecentItems or m_recentItems).
+        std::vector<RecentItem> published;
+        auto sameEntries = [](const std::vector<RecentItem>& a, const std::vector<RecentItem>& b) {
+            if (a.size() != b.size()) return false;
+            for (size_t i = 0; i < a.size(); ++i) {
+                if (a[i].exePath != b[i].exePath || a[i].name != b[i].name ||
+                    a[i].runCount != b[i].runCount || a[i].rank != b[i].rank)
+                    return false;
+            }
+            return true;
+        };
+
+        auto rebuild = [&]() {
+            auto t0 = std::chrono::steady_clock::now();
+            RecentInputs in;
+            {
+                std::lock_guard<std::mutex> lk(m_recentMutex);
+                in = m_recentInputs;
+            }
+            std::set<std::wstring> held;
+            for (const auto& ri : published) held.insert(ri.exePath);
+            std::vector<RecentItem> items = LoadRecentPrograms(in, held);
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - t0).count();
+            if (sameEntries(items, published)) {
+                CF_LOG(Debug, "Recent watcher: unchanged (" << us << " us)");
+                return;
+            }
+
+            published = items;
+            for (auto& ri : published) ri.hIcon = nullptr;
+            {
+                // A list the UI thread has not taken yet is replaced: hand its
+                // icons on to the new one (or free them).
+                std::lock_guard<std::mutex> lk(m_recentMutex);
+                if (m_hasPendingRecentItems) {
+                    for (auto& old : m_pendingRecentItems) {
+                        if (!old.hIcon) continue;
+                        for (auto& ri : items) {
+                            if (!ri.hIcon && ri.exePath == old.exePath) {
+                                ri.hIcon = old.hIcon;
+                                old.hIcon = nullptr;
+                                break;
+                            }
+                        }
+                        if (old.hIcon) DestroyIcon(old.hIcon);
+                    }
+                }
+                m_pendingRecentItems    = std::move(items);
+                m_hasPendingRecentItems = true;
+            }
+            CF_LOG(Info, "Recent watcher: " << published.size() << " entries rebuilt in "
+                   << us << " us");
+            if (m_hwnd) PostMessageW(m_hwnd, WM_APP_RECENT_CHANGED, 0, 0);
+        };
+
+        rebuild();
+        bool needsRebuild = false;
+        for (;;) {
+            DWORD res = WaitForMultipleObjects(waitCount, events, FALSE,
+                                               needsRebuild ? 200u : INFINITE);
+            if (res == WAIT_TIMEOUT) {
+                rebuild();
+                needsRebuild = false;
+                continue;
+            }
+            if (res == WAIT_FAILED) break;
+
+            DWORD idx = res - WAIT_OBJECT_0;
+            if (idx == keyCount + 1) break;   // stop event
+            if (idx < keyCount) arm(idx);
+            needsRebuild = true;
+        }
+
+        for (DWORD i = 0; i < keyCount; ++i) {
+            RegCloseKey(keys[i]);
+            CloseHandle(events[i]);
+        }
+        if (comInited) CoUninitialize();
+    });
+}
+
+void StartMenuWindow::StopRecentWatcher() {
+    if (m_recentStopEvent) SetEvent(m_recentStopEvent);
+    if (m_recentThread.joinable())
+        m_recentThread.join();
+    if (m_recentStopEvent) { CloseHandle(m_recentStopEvent); m_recentStopEvent = nullptr; }
+    if (m_recentWakeEvent) { CloseHandle(m_recentWakeEvent); m_recentWakeEvent = nullptr; }
+}
+
+void StartMenuWindow::RequestRecentRefresh() {
+    RecentInputs in;
+    in.excluded = m_recentExcluded;
+    in.pinnedNames.reserve(m_dynamicPinnedItems.size());
+    for (const auto& pin : m_dynamicPinnedItems) in.pinnedNames.push_back(pin.name);
+    {
+        std::lock_guard<std::mutex> lk(m_recentMutex);
+        m_recentInputs = std::move(in);
+    }
+    if (m_recentWakeEvent) SetEvent(m_recentWakeEvent);
+}
+
+void StartMenuWindow::ApplyPendingRecentItems() {
+    std::vector<RecentItem> items;
+    {
+        std::lock_guard<std::mutex> lk(m_recentMutex);
+        if (!m_hasPendingRecentItems) return;
+        items.swap(m_pendingRecentItems);
+        m_hasPendingRecentItems = false;
+    }
+
+    // Entries the watcher left without an icon keep the one they already have.
+    for (auto& old : m_recentItems) {
+        if (!old.hIcon) continue;
+        for (auto& ri : items) {
+            if (!ri.hIcon && ri.exePath == old.exePath) {
+                ri.hIcon = old.hIcon;
+                old.hIcon = nullptr;
+                break;
+            }
+        }
+        if (old.hIcon) {
+            m_iconAtlas.Remove(reinterpret_cast<std::uintptr_t>(old.hIcon));
+            DestroyIcon(old.hIcon);
+        }
+    }
+    m_recentItems.swap(items);
+
+    // Rows and search results index m_recentItems.
+    m_hoveredProgIndex = -1;
+    m_keySelProgIndex  = -1;
+    m_searchIndexDirty = true;
+    if (m_viewMode == LeftViewMode::Search)
+        UpdateSearch(m_searchQuery);
+    CF_LOG(Info, "Recent list updated: " << m_recentItems.size() << " entries");
+}
+
 // ── Task 3/5: RefreshProgramTree — rebuild on UI thread after watcher fires ───
 // Called on the UI thread from HandleMessage (WM_APP_REFRESH_TREE).
-// Joins the old icon thread, frees all icons, rebuilds the tree, and starts
+// Abandons the old icon pass, frees all icons, rebuilds the tree, and starts
 // a new icon-loading pass.
 void StartMenuWindow::RefreshProgramTree() {
     CF_LOG(Info, "RefreshProgramTree: change detected, rebuilding All Programs tree");
 
-    // Stop icon loading for the old tree.
-    if (m_iconThread.joinable())
-        m_iconThread.join();
+    // Stop icon loading for the old tree — only loads in flight are waited for.
+    CancelIconPass();
 
     m_iconsLoaded.store(false, std::memory_order_relaxed);
 
     // Fix P2: clear the All-Programs navigation stack before swapping the tree.
-    // m_apNavStack holds raw pointers into old m_programTree nodes; if we don't
-    // clear it, CurrentApNodes() will dereference dangling pointers after the
-    // swap, causing crashes / use-after-free.
+    // m_apNavStack holds node indices into the old m_programTree; if we don't
+    // clear it, CurrentApNodes() would read unrelated (or out-of-range) records
+    // after the swap.
     m_apNavStack.clear();
     m_apScrollOffset   = 0;
     m_hoveredApIndex   = -1;
@@ -2916,31 +4241,165 @@ void StartMenuWindow::RefreshProgramTree() {
 
     // Release all cached icons (dedup cache covers tree + pinned + right-col).
     m_iconCache.ReleaseAll();
+    m_iconAtlas.Clear();
     for (auto& item : m_dynamicPinnedItems) item.hIcon = nullptr;
     for (int i = 0; i < RIGHT_ITEM_COUNT; ++i) m_rightIcons[i] = nullptr;
 
-    // Fix P3: recent icons are loaded outside IconCache — destroy them explicitly
-    // before nulling, otherwise each refresh leaks one GDI handle per entry.
-    for (auto& ri : m_recentItems) {
-        if (ri.hIcon) { DestroyIcon(ri.hIcon); ri.hIcon = nullptr; }
-    }
-
-    // Rebuild the tree under the mutex so LoadIconsAsync (new thread) can
-    // safely start reading it without racing with us.
+    // Rebuild the tree under the mutex so the new pass's workers can
+    // safely start reading it without racing with us.  A tree already produced
+    // by the snapshot revalidation scan is swapped in instead of rescanning.
     {
         std::lock_guard<std::mutex> lk(m_treeMutex);
-        m_programTree = BuildAllProgramsTree();
+        if (m_hasPendingProgramTree) {
+            InstallProgramTree(m_pendingProgramTree);
+            m_pendingProgramTree.clear();
+            m_hasPendingProgramTree = false;
+        } else {
+            // Rescan with the same folders expanded as the tree being replaced.
+            InstallProgramTree(BuildProgramTreeWithSnapshot(m_lazyProgramTree,
+                                                            m_programTree.Thaw()));
+        }
+        ++m_treeGeneration;
     }
 
-    CF_LOG(Info, "RefreshProgramTree: " << m_programTree.size() << " top-level nodes");
+    CF_LOG(Info, "RefreshProgramTree: " << m_programTree.Roots().size() << " top-level nodes");
+
+    // Keep painting real icons for everything the disk cache holds.
+    SeedIconsFromDisk();
 
     // Kick off icon loading for the new tree.
-    m_iconThread = std::thread(&StartMenuWindow::LoadIconsAsync, this);
+    QueueAllIcons();
+    StartIconPass();
+
+    // Results held node indices into the old tree — rerun the query.
+    if (m_viewMode == LeftViewMode::Search)
+        UpdateSearch(m_searchQuery);
 
     // Request a repaint so the UI reflects the rebuilt tree immediately.
     if (m_hwnd) InvalidateRect(m_hwnd, nullptr, FALSE);
 }
 
+// ── Incremental tree patching ─────────────────────────────────────────────────
+// Called on the UI thread from HandleMessage (WM_APP_REFRESH_TREE).  Applies
+// the watcher's queued records to the live tree so an install or uninstall
+// costs one shortcut (or one folder) of work.  A full RefreshProgramTree() is
+// still used after a watcher overflow, or when the snapshot revalidation
+// thread has a replacement tree waiting.
+void StartMenuWindow::ApplyFolderChanges() {
+    std::vector<ProgramTreeChange> changes;
+    bool overflow;
+    {
+        std::lock_guard<std::mutex> lk(m_treeChangesMutex);
+        changes.swap(m_pendingTreeChanges);
+        overflow = m_treeChangesOverflow;
+        m_treeChangesOverflow = false;
+    }
+    bool pendingTree;
+    {
+        std::lock_guard<std::mutex> lk(m_treeMutex);
+        pendingTree = m_hasPendingProgramTree;
+    }
+
+    if (overflow || pendingTree) {
+        RefreshProgramTree();
+        return;
+    }
+    if (changes.empty()) return;
+
+    // Icon workers write hIcon into tree nodes by index; abandon the current
+    // pass rather than patch underneath it.  IconCache keeps every handle it
+    // has loaded and the new pass queues every slot still without one, so
+    // only new or changed nodes (and what the old pass had left) cost a load.
+    CancelIconPass();
+
+    // Nodes may move when siblings are inserted or erased — drop raw pointers
+    // into the tree exactly as a full refresh does.
+    m_apNavStack.clear();
+    m_apScrollOffset   = 0;
+    m_hoveredApIndex   = -1;
+    m_keySelApIndex    = -1;
+    CloseSubMenu();
+
+    // The arena is frozen: thaw it (icons included), patch the builder form
+    // outside the lock — only this thread ever replaces the tree — and
+    // refreeze.
+    std::vector<MenuNode> nodes;
+    {
+        std::lock_guard<std::mutex> lk(m_treeMutex);
+        nodes = m_programTree.Thaw();
+    }
+    if (!ApplyProgramTreeChanges(nodes, changes, m_lazyProgramTree)) {
+        RefreshProgramTree();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lk(m_treeMutex);
+        InstallProgramTree(nodes);
+        ++m_treeGeneration;
+    }
+    if (m_viewMode == LeftViewMode::Search)
+        UpdateSearch(m_searchQuery);
+
+    // Icons for every slot still without one — the patched nodes, plus what
+    // the abandoned pass had not reached — then persist the patched tree so
+    // the next start maps it directly.
+    QueueAllIcons();
+    StartIconPass([nodes = std::move(nodes)]() {
+        ProgramTreeKey key;
+        if (ReadProgramTreeKey(key))
+            SaveProgramTreeSnapshot(GetProgramTreeSnapshotPath(), key, nodes);
+    });
+
+    if (m_hwnd) InvalidateRect(m_hwnd, nullptr, FALSE);
+}
+
+// ── Snapshot revalidation ─────────────────────────────────────────────────────
+// Called once from Initialize() when the tree came from programs_tree.bin.
+// Rescans both Programs folders (which also rewrites the snapshot) and, only if
+// the result differs from what is on screen, hands it to RefreshProgramTree()
+// through m_pendingProgramTree.
+void StartMenuWindow::StartTreeRevalidation() {
+    uint64_t generation;
+    std::vector<MenuNode> shape;
+    {
+        std::lock_guard<std::mutex> lk(m_treeMutex);
+        generation = m_treeGeneration;
+        if (m_lazyProgramTree) shape = m_programTree.Thaw();
+    }
+
+    m_treeRevalidateThread = std::thread([this, generation, shape = std::move(shape)]() mutable {
+        // A watcher patch only fixes the paths it saw, so a scan overtaken by
+        // one is repeated (a couple of times at most) rather than dropped —
+        // otherwise staleness from before this session could survive it.
+        // Lazy expansions also bump the generation: the rescan then picks up
+        // the newly opened folders instead of collapsing them again.
+        constexpr int kMaxAttempts = 3;
+        bool post = false;
+        for (int attempt = 0; attempt < kMaxAttempts; ++attempt) {
+            std::vector<MenuNode> fresh = BuildProgramTreeWithSnapshot(m_lazyProgramTree, shape);
+
+            std::lock_guard<std::mutex> lk(m_treeMutex);
+            if (generation != m_treeGeneration) {
+                CF_LOG(Info, "StartTreeRevalidation: tree replaced meanwhile, rescanning");
+                generation = m_treeGeneration;
+                if (m_lazyProgramTree) shape = m_programTree.Thaw();
+                continue;
+            }
+            if (ProgramTreesEqual(fresh, m_programTree.Thaw())) {
+                CF_LOG(Info, "StartTreeRevalidation: snapshot is current");
+            } else {
+                CF_LOG(Info, "StartTreeRevalidation: snapshot was stale, scheduling swap");
+                m_pendingProgramTree    = std::move(fresh);
+                m_hasPendingProgramTree = true;
+                post = true;
+            }
+            break;
+        }
+        if (post && m_hwnd)
+            PostMessageW(m_hwnd, WM_APP_REFRESH_TREE, 0, 0);
+    });
+}
+
 // ── Position cache ────────────────────────────────────────────────────────────
 void StartMenuWindow::CacheMenuPosition() {
     int screenW = GetSystemMetrics(SM_CXSCREEN);
@@ -3065,6 +4524,8 @@ void StartMenuWindow::LoadPinnedItems() {
 }
 
 void StartMenuWindow::SavePinnedItems() {
+    m_searchIndexDirty = true;   // every pin / unpin / rename comes through here
+    RequestRecentRefresh();      // pinned names are filtered out of the recent list
     PWSTR lap = nullptr;
     if (FAILED(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, NULL, &lap))) return;
     std::wstring dir = std::wstring(lap) + L"\\GlassBar";
@@ -3109,12 +4570,20 @@ void StartMenuWindow::SavePinnedItems() {
 
 void StartMenuWindow::UnpinItem(int index) {
     if (index < 0 || index >= static_cast<int>(m_dynamicPinnedItems.size())) return;
-    if (!m_iconsLoaded.load(std::memory_order_acquire)) return; // Wait until icons done
+
+    // Icon workers index m_dynamicPinnedItems by slot: no pass may run while
+    // it is resized, whether the startup pass or one after a folder patch.
+    const bool resume = m_iconPassBusy.load(std::memory_order_acquire);
+    CancelIconPass();
 
     // Fix P1: hIcon is always cache-owned — never call DestroyIcon.
     // hCustomIcon is NOT cache-owned — always call DestroyIcon before erase.
     auto& dying = m_dynamicPinnedItems[static_cast<size_t>(index)];
-    if (dying.hCustomIcon) { DestroyIcon(dying.hCustomIcon); dying.hCustomIcon = nullptr; }
+    if (dying.hCustomIcon) {
+        m_iconAtlas.Remove(reinterpret_cast<std::uintptr_t>(dying.hCustomIcon));
+        DestroyIcon(dying.hCustomIcon);
+        dying.hCustomIcon = nullptr;
+    }
     dying.hIcon = nullptr;
     m_dynamicPinnedItems.erase(m_dynamicPinnedItems.begin() + index);
     SavePinnedItems();
@@ -3124,49 +4593,46 @@ void StartMenuWindow::UnpinItem(int index) {
     if (m_hoveredProgIndex >= newCount) m_hoveredProgIndex = -1;
     if (m_keySelProgIndex  >= newCount) m_keySelProgIndex  = -1;
 
+    if (resume) ResumeIconPass();
     InvalidateRect(m_hwnd, NULL, FALSE);
 }
 
 void StartMenuWindow::PinItemFromAllPrograms(int apIndex) {
-    if (!m_iconsLoaded.load(std::memory_order_acquire)) return;
-
-    const auto& nodes = CurrentApNodes();
+    MenuNodeRange nodes = CurrentApNodes();
     if (apIndex < 0 || apIndex >= static_cast<int>(nodes.size())) return;
-    const MenuNode& node = nodes[static_cast<size_t>(apIndex)];
-    if (node.isFolder) return;
+    MenuNodeView view = nodes[static_cast<size_t>(apIndex)];
+    if (view.isFolder()) return;
+    const std::wstring name(view.name());
+    const std::wstring lnkPath(view.lnkPath());
 
-    // Don't add duplicates (case-insensitive)
+    // Don't add duplicates (same folded name as the All Programs ordering)
     for (const auto& p : m_dynamicPinnedItems) {
-        auto pn = p.name, nn = node.name;
-        for (auto& c : pn) c = static_cast<wchar_t>(towlower(c));
-        for (auto& c : nn) c = static_cast<wchar_t>(towlower(c));
-        if (pn == nn) return;
+        if (CompareNodeNames(p.name, name) == 0) return;
     }
 
+    // See UnpinItem().
+    const bool resume = m_iconPassBusy.load(std::memory_order_acquire);
+    CancelIconPass();
+
     DynamicPinnedItem di;
-    di.name      = node.name;
-    di.shortName = node.name.size() >= 3 ? node.name.substr(0, 3) : node.name;
-    di.command   = node.lnkPath.empty() ? node.name : node.lnkPath;
+    di.name      = name;
+    di.shortName = name.size() >= 3 ? name.substr(0, 3) : name;
+    di.command   = lnkPath.empty() ? name : lnkPath;
     di.iconColor = RGB(64, 64, 68);
     // Fix P1/P2: use m_iconCache instead of CopyIcon so the handle is cache-owned.
     // This ensures UnpinItem never double-destroys it and RefreshProgramTree's
     // ReleaseAll() covers it without leaking.
-    // The .lnkPath key matches what LoadNodeIcons stored, so it's already cached.
-    if (!node.lnkPath.empty())
-        di.hIcon = m_iconCache.GetIcon(node.lnkPath, /*small=*/false);
-    else if (!di.command.empty())
-        di.hIcon = m_iconCache.GetIcon(di.command, /*small=*/false);
+    // The .lnkPath key matches what LoadQueuedIcon stored, so it is usually
+    // held already; the shell is not asked on the UI thread.
+    const std::wstring& iconPath = lnkPath.empty() ? di.command : lnkPath;
+    if (!iconPath.empty())
+        di.hIcon = m_iconCache.GetIcon(iconPath, /*small=*/false, /*diskOnly=*/true);
 
     m_dynamicPinnedItems.push_back(di);
     SavePinnedItems();
-    // No async fallback: PinItemFromAllPrograms() is only callable when
-    // m_iconsLoaded == true, which means LoadNodeIcons() has already called
-    // m_iconCache.GetIcon(node.lnkPath) for every tree node.  If the cache
-    // returned nullptr above the icon genuinely does not exist (unresolvable
-    // path); a detached thread calling SHGetFileInfoW on the same path would
-    // also fail, and — critically — IconCache is not thread-safe, so any
-    // concurrent GetIcon / ReleaseAll call would be undefined behaviour.
-    // The colored-square fallback (iconColor) is shown instead.
+    // The pass picks up where it was, plus the new item if the cache lacked
+    // its icon; the colored square (iconColor) shows until one lands.
+    if (resume || !di.hIcon) ResumeIconPass();
 
     InvalidateRect(m_hwnd, NULL, FALSE);
 }
@@ -3231,11 +4697,15 @@ void StartMenuWindow::RemoveRecentItem(int recentIndex) {
     m_recentExcluded.insert(lowerPath);
 
     // Free icon before erasing
-    if (m_recentItems[static_cast<size_t>(recentIndex)].hIcon)
-        DestroyIcon(m_recentItems[static_cast<size_t>(recentIndex)].hIcon);
+    if (HICON dyingIcon = m_recentItems[static_cast<size_t>(recentIndex)].hIcon) {
+        m_iconAtlas.Remove(reinterpret_cast<std::uintptr_t>(dyingIcon));
+        DestroyIcon(dyingIcon);
+    }
 
     m_recentItems.erase(m_recentItems.begin() + recentIndex);
+    m_searchIndexDirty = true;
     SaveRecentExcluded();
+    RequestRecentRefresh();   // the next entry moves up to fill the list
     InvalidateRect(m_hwnd, NULL, FALSE);
 }
 
@@ -3282,6 +4752,14 @@ void StartMenuWindow::SaveRecentExcluded() {
     f << L"\n]\n";
 }
 
+void StartMenuWindow::LoadFrecency() {
+    PWSTR lap = nullptr;
+    if (FAILED(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, NULL, &lap))) return;
+    std::wstring path = std::wstring(lap) + L"\\GlassBar\\frecency.bin";
+    CoTaskMemFree(lap);
+    m_frecency.Load(path);
+}
+
 void StartMenuWindow::SelectCustomIconForPinnedItem(int index) {
     if (index < 0 || index >= static_cast<int>(m_dynamicPinnedItems.size())) return;
 
@@ -3307,7 +4785,11 @@ void StartMenuWindow::SelectCustomIconForPinnedItem(int index) {
     auto& item = m_dynamicPinnedItems[static_cast<size_t>(index)];
 
     // Release previous custom icon
-    if (item.hCustomIcon) { DestroyIcon(item.hCustomIcon); item.hCustomIcon = nullptr; }
+    if (item.hCustomIcon) {
+        m_iconAtlas.Remove(reinterpret_cast<std::uintptr_t>(item.hCustomIcon));
+        DestroyIcon(item.hCustomIcon);
+        item.hCustomIcon = nullptr;
+    }
 
     item.hCustomIcon    = hLarge;
     item.customIconPath = iconPath;
@@ -3332,16 +4814,16 @@ void StartMenuWindow::ShowAllProgramsContextMenu(int apIndex, POINT screenPt) {
     if (cmd == 1) {
         PinItemFromAllPrograms(apIndex);
     } else if (cmd == 2) {
-        const auto& nodes = CurrentApNodes();
+        MenuNodeRange nodes = CurrentApNodes();
         if (apIndex >= 0 && apIndex < static_cast<int>(nodes.size())) {
-            const std::wstring& lnkPath = nodes[static_cast<size_t>(apIndex)].lnkPath;
+            std::wstring_view lnkPath = nodes[static_cast<size_t>(apIndex)].lnkPath();
             if (!lnkPath.empty()) {
                 SHELLEXECUTEINFOW sei = {};
                 sei.cbSize = sizeof(sei);
                 sei.fMask  = SEE_MASK_FLAG_NO_UI | SEE_MASK_INVOKEIDLIST;
                 sei.hwnd   = m_hwnd;
                 sei.lpVerb = L"TaskbarPin";
-                sei.lpFile = lnkPath.c_str();
+                sei.lpFile = lnkPath.data();   // pool strings are NUL-terminated
                 sei.nShow  = SW_SHOWNORMAL;
                 ShellExecuteExW(&sei);
             }
@@ -8,7 +8,16 @@
 #include <set>
 #include <thread>
 #include <vector>
-#include "AllProgramsEnumerator.h"   // MenuNode, BuildAllProgramsTree, IconCache
+#include "AllProgramsEnumerator.h"   // MenuNode, BuildAllProgramsTree
+#include "IconCache.h"               // IconCache
+#include "MenuTree.h"                // MenuTree, MenuNodeView, MenuNodeRange
+#include "ProgramSearchIndex.h"      // ProgramSearchIndex, SearchHit
+#include "FrecencyStore.h"           // FrecencyStore
+#include "GlyphCache.h"              // GlyphCache
+#include "IconAtlas.h"               // IconAtlas, BlendPremultiplied
+#include "IconLoadQueue.h"           // IconLoadQueue, IconTier
+#include "IconLoadPool.h"            // IconLoadPool
+#include "RasterSurface.h"           // RasterSurface
 
 namespace GlassBar {
 
@@ -20,8 +29,9 @@ struct RecentItem {
     std::wstring exePath;    // Full path to .exe or .lnk (for ShellExecute)
     std::wstring name;       // Display name (from SHGetFileInfoW SHGFI_DISPLAYNAME)
     HICON        hIcon;      // 32×32 icon (nullptr → DrawIconSquare fallback)
-    FILETIME     ftLastRun;  // Last execution time (for sorting; most recent first)
+    FILETIME     ftLastRun;  // Last execution time from UserAssist (zero if menu-only)
     DWORD        runCount;   // Usage count from UserAssist
+    double       rank;       // FrecencyStore rank: UserAssist + menu launches; higher first
 };
 
 /// <summary>
@@ -52,7 +62,8 @@ struct Win7RightItem {
 /// Left-column view mode:
 ///   Programs     — vertical list of pinned apps + "All Programs" entry
 ///   AllPrograms  — "All Programs" tree from AllProgramsEnumerator
-enum class LeftViewMode { Programs, AllPrograms };
+///   Search       — ranked type-to-search results + search box
+enum class LeftViewMode { Programs, AllPrograms, Search };
 
 /// Right-column recommended/shortcut menu item (visibility + display name).
 struct RecommendedMenuItem {
@@ -94,6 +105,10 @@ public:
     /// Initialize window classes (call once at startup)
     bool Initialize();
 
+    /// Scan All Programs folders only when first opened (default) rather than
+    /// all at startup. Call before Initialize().
+    void SetLazyProgramTree(bool lazy) { m_lazyProgramTree = lazy; }
+
     /// Show the menu; x/y are hint coords (actual position is calculated from taskbar)
     void Show(int x, int y);
 
@@ -149,9 +164,9 @@ private:
     LeftViewMode m_viewMode = LeftViewMode::Programs;
 
     // Navigation stack for All Programs drill-down.
-    // Each entry points to the children vector of the folder we entered.
+    // Each entry is the m_programTree index of a folder we entered.
     // Empty stack = root of m_programTree.
-    std::vector<const std::vector<MenuNode>*> m_apNavStack;
+    std::vector<uint32_t> m_apNavStack;
 
     // Hover state
     int  m_hoveredProgIndex    = -1;   // Programs list (pinned items)
@@ -177,21 +192,52 @@ private:
     int      m_subMenuNodeIdx    = -1;  // absolute AP node that opened the submenu
     int      m_subMenuHoveredIdx = -1;  // visual index in submenu list (-1 = none)
 
+    // Damage tracking: Paint()'s update region while it runs (null outside;
+    // m_updateRgn is the region object reused by every paint), and what
+    // painting cost since Show(), logged by Hide().
+    struct PaintCost {
+        uint32_t paints     = 0;
+        uint32_t fullPaints = 0;   // update region covered the whole window
+        uint64_t pixels     = 0;   // update-region bounding boxes
+        uint32_t rows       = 0;   // list / column / submenu rows drawn
+        uint32_t objects    = 0;   // brushes, pens and regions created (SolidBrush...)
+        double   ms         = 0.0;
+    };
+    HRGN      m_paintRgn  = nullptr;
+    HRGN      m_updateRgn = nullptr;
+    PaintCost m_paintCost;
+
     static constexpr UINT_PTR HOVER_TIMER_ID      = 1;
     static constexpr UINT     HOVER_DELAY_MS      = 50;   // was 400 — snappy submenu opening
     static constexpr UINT_PTR HOVER_ANIM_TIMER_ID = 2;    // S-C: hover fade-in animation
     static constexpr UINT_PTR FADE_TIMER_ID       = 3;    // Show() window fade-in
+    static constexpr UINT     ICON_REPAINT_MS     = 30;   // WM_ICONS_LANDED spacing
 
     // Cached Windows login name for the right-column header
     wchar_t m_username[64] = {};
 
-    // Phase S2: All Programs tree pre-cached at Initialize().
-    std::vector<MenuNode> m_programTree;
-
-    // S7 — recently used programs, loaded from UserAssist at Initialize().
-    // Shown below pinned items; max RECENT_COUNT entries, sorted by last-run time.
+    // Phase S2: All Programs tree pre-cached at Initialize(), frozen into one
+    // arena (see MenuTree).  Replaced only through InstallProgramTree(), or
+    // loaded straight from programs_tree.bin by Initialize(); lazy folders
+    // are filled in place by ExpandFolder().
+    MenuTree m_programTree;
+
+    // Lazy mode: cold starts scan only the top level of the Programs roots and
+    // each folder is enumerated the first time it is opened.  Rescans keep the
+    // expansion shape of the tree they replace.  Set by SetLazyProgramTree()
+    // before Initialize(); config "StartLazyProgramTree".
+    bool m_lazyProgramTree = true;
+
+    // S7 — recently used programs, from UserAssist plus the menu's launches.
+    // Shown below pinned items; max RECENT_COUNT entries, by frecency rank.
+    // Built by the recent watcher thread, swapped in on the UI thread only.
     std::vector<RecentItem> m_recentItems;
 
+    // Launches made from the menu, with time decay, persisted to
+    // %LOCALAPPDATA%\GlassBar\frecency.bin. Ranks the recent list together
+    // with UserAssist and boosts search results.
+    FrecencyStore m_frecency;
+
     // Paths explicitly removed by the user via right-click "Remove from list".
     // Persisted to %LOCALAPPDATA%\GlassBar\recent_excluded.json.
     std::set<std::wstring> m_recentExcluded;
@@ -224,7 +270,8 @@ private:
     int  m_cachedMenuX      = 0;
     int  m_cachedMenuY      = 0;
 
-    // Window fade-in state — ramps SetLayeredWindowAttributes 0→255 over ~80ms.
+    // Window fade-in state — ramps the presented frame's constant alpha
+    // 0→255 over ~80ms (SetFadeAlpha).
     BYTE     m_fadeAlpha    = 255;
     UINT_PTR m_fadeTimer    = 0;
 
@@ -235,20 +282,115 @@ private:
     // ── Thread safety ──────────────────────────────────────────────────────────
     // Protects m_programTree between the background icon/watcher threads and the
     // UI (paint) thread.  Lock held only for the duration of individual reads or
-    // the full tree-rebuild cycle so contention is negligible.
+    // the full tree-rebuild cycle so contention is negligible.  Icon workers
+    // also store pinned / right-column handles under it (StoreCachedIcon), so
+    // TrimIconCache() sees every slot a handle it evicts may be in.
     mutable std::mutex   m_treeMutex;
 
-    // Background icon loading (S6/S7): icons are loaded on a worker thread so
-    // that Initialize() returns quickly and the hook thread is not blocked.
-    // m_iconsLoaded becomes true (release) after all icon writes are complete;
-    // paint code reads it (acquire) before using any icon handle.
-    std::thread          m_iconThread;
+    // Background icon loading (S6): icons are loaded by a small pool of
+    // worker threads so that Initialize() returns quickly and the hook thread
+    // is not blocked.  Each slot's handle is stored under m_treeMutex as soon
+    // as it is loaded, and paint copies slots under it (LoadedIcon), so icons
+    // appear row by row mid-pass; m_iconsLoaded becomes true (release) once a
+    // pass completes.
+    IconLoadPool         m_iconPool;
     std::atomic<bool>    m_iconsLoaded{false};
+    // True from the moment an icon pass is started until it is about to post
+    // WM_ICONS_LOADED or is cancelled.
+    std::atomic<bool>    m_iconPassBusy{false};
+    // The running pass's |afterPass|, cleared by the worker that runs it.  A
+    // cancelled pass leaves it for ResumeIconPass().
+    std::function<void()> m_iconAfterPass;
+
+    // ── Icon load queue ───────────────────────────────────────────────────────
+    // The slots an icon pass still has to load, most visible first.  Filled
+    // by the UI thread before the pass starts and re-ranked by it as the user
+    // navigates (PrioritizeVisibleIcons); drained by m_iconPool's workers.
+    // m_iconQueueOpen: the pass still takes work — cleared by the worker that
+    // finds the queue empty, under the mutex.
+    std::mutex           m_iconQueueMutex;
+    IconLoadQueue        m_iconQueue;
+    bool                 m_iconQueueOpen = false;
+    // Folder whose children rank as IconTier::HoveredFolder (UI thread only).
+    uint32_t             m_iconHoverFolder = MenuTree::kNone;
+    // Nodes whose icon was evicted that the last Paint() showed; queued by
+    // the next LoadMissingIconsAsync() (UI thread only).
+    std::vector<uint32_t> m_iconReloads;
+    // A WM_ICONS_LANDED is in flight; the UI thread clears it on receipt.
+    // m_iconRepaintAt: steady-clock ms of the last one, shared by the workers.
+    std::atomic<bool>    m_iconRepaintPosted{false};
+    std::atomic<int64_t> m_iconRepaintAt{0};
+    // Where each pinned item's shortcut is on disk when a lazy tree does not
+    // hold it yet (parallel to m_dynamicPinnedItems): found by the first
+    // worker that needs it, for all pinned names in one walk, and kept for
+    // the rest of the pass.  StartIconPass() clears it.
+    std::mutex           m_pinnedLookupMutex;
+    bool                 m_pinnedLookupDone = false;
+    std::vector<std::wstring> m_pinnedLookupPaths;
 
     // ── Shared icon cache (Task 7) ─────────────────────────────────────────────
-    // Owned exclusively by LoadIconsAsync; ReleaseAll() is called on the UI
-    // thread inside RefreshProgramTree() after m_iconThread has been joined.
+    // Owned by the running icon pass (or the UI thread while seeding from
+    // m_iconDiskCache); ReleaseAll() is called on the UI thread inside
+    // RefreshProgramTree() after the icon pass has been cancelled.  Budgeted:
+    // the UI thread trims it (TrimIconCache) as icons land.
     IconCache            m_iconCache;
+    // Pre-rasterized icons of the previous runs (icons.bin), same owner.
+    IconDiskCache        m_iconDiskCache;
+
+    // ── Icon atlas (UI thread only) ───────────────────────────────────────────
+    // Every HICON painted so far, rasterized at the size it is drawn at and
+    // keyed by handle value; an entry must be removed (or the atlas cleared)
+    // wherever its handle is destroyed, as handle values get reused.
+    // m_frame views Paint()'s back buffer while it runs (no pixels
+    // otherwise, or when the back buffer is not a DIB section), clipped to
+    // the bounds of the update region.
+    IconAtlas                  m_iconAtlas;
+    std::vector<std::uint32_t> m_iconRaster;
+    RasterSurface              m_frame;
+    // Label glyphs for m_frame, per cached font; cleared with the fonts.
+    GlyphCache                 m_glyphs;
+    std::vector<RasterGlyph>   m_glyphRun;
+
+    // ── Back buffer (UI thread only) ──────────────────────────────────────────
+    // Paint()'s off-screen frame, kept between paints so a partial paint
+    // redraws only the update region into it: a top-down 32 bpp DIB section
+    // (m_backPixels; null if only a compatible bitmap could be made) selected
+    // into m_backDC.  Rebuilt when the client size changes; dropped on a
+    // display or DPI change.  m_scratchDC is a spare memory DC for blits
+    // from other bitmaps (the avatar).
+    HDC            m_backDC     = nullptr;
+    HBITMAP        m_backBmp    = nullptr;
+    HGDIOBJ        m_backOldBmp = nullptr;
+    std::uint32_t* m_backPixels = nullptr;
+    int            m_backW      = 0;
+    int            m_backH      = 0;
+    HDC            m_scratchDC  = nullptr;
+    // True when the back buffer was (re)built and holds no frame yet.
+    bool EnsureBackBuffer(HDC screenDC, int w, int h);
+    void ReleaseBackBuffer();
+
+    // ── Presentation (UI thread only) ─────────────────────────────────────────
+    // The window is a layered window fed by UpdateLayeredWindowIndirect:
+    // PresentFrame() hands DWM the back buffer (|dirty| only, or all of it)
+    // with its per-pixel alpha; SetFadeAlpha() changes only the constant
+    // alpha over the frame already presented.  m_presentAlphaFormat is the
+    // AlphaFormat that frame went out with.
+    bool m_framePresented     = false;
+    BYTE m_presentAlphaFormat = 0;
+    void PresentFrame(const RECT* dirty);
+    void SetFadeAlpha(BYTE alpha);
+
+    // ── Paint objects (UI thread only) ────────────────────────────────────────
+    // Solid brushes, pens and clip regions the painters use, created on first
+    // use and kept until the palette changes: SetBackgroundColor, SetTextColor
+    // and SetBorderColor call ReleasePaintObjects(), as does Shutdown().  A
+    // steady-state frame creates no GDI objects; each hover-fade step adds one
+    // brush the first time it is drawn.  Never delete what these return.
+    HBRUSH SolidBrush(COLORREF color);
+    HPEN   SolidPen(COLORREF color, int width = 1);
+    HRGN   EllipseRegion(int cx, int cy, int r);
+    void   ReleasePaintObjects();
+    std::map<std::uint64_t, HGDIOBJ> m_paintObjects;   // by kind, size and color
 
     // ── File-system watcher (Task 5) ──────────────────────────────────────────
     // Watches %ProgramData% and %AppData% Start Menu folders.  Posts
@@ -259,12 +401,91 @@ private:
     // Manual-reset event signalled by StopFolderWatcher() so the watcher can
     // wake immediately from an INFINITE WaitForMultipleObjects call.
     HANDLE               m_watcherStopEvent = nullptr;
+    // Records decoded by the watcher, consumed by ApplyFolderChanges() on the
+    // UI thread.  m_treeChangesOverflow is set when ReadDirectoryChangesW lost
+    // records (buffer overflow) and forces a full rebuild.
+    std::mutex                      m_treeChangesMutex;
+    std::vector<ProgramTreeChange>  m_pendingTreeChanges;
+    bool                            m_treeChangesOverflow = false;
+
+    // ── Tree snapshot revalidation ────────────────────────────────────────────
+    // When Initialize() starts from programs_tree.bin, this thread rescans the
+    // Programs folders and, if the result differs, parks it in
+    // m_pendingProgramTree and posts WM_APP_REFRESH_TREE.  m_treeGeneration
+    // (guarded by m_treeMutex) is bumped on every tree swap or patch so a rescan
+    // that raced with a watcher update is redone instead of reinstating older data.
+    std::thread            m_treeRevalidateThread;
+    std::vector<MenuNode>  m_pendingProgramTree;
+    bool                   m_hasPendingProgramTree = false;
+    uint64_t               m_treeGeneration        = 0;
+
+    // ── Lazy folder prefetch ──────────────────────────────────────────────────
+    // At most one background scan of a pending folder at a time.  The thread
+    // fills m_prefetchChildren and posts WM_APP_FOLDER_SCANNED; the UI thread
+    // joins it and grafts the result only if m_treeGeneration still equals
+    // m_prefetchGeneration (otherwise m_prefetchFolder may name another node).
+    std::thread            m_prefetchThread;
+    uint32_t               m_prefetchFolder     = MenuTree::kNone;
+    uint64_t               m_prefetchGeneration = 0;
+    std::vector<MenuNode>  m_prefetchChildren;
+    // Set when expanded nodes need icons while an icon pass is busy but no
+    // longer taking work (m_iconQueueOpen false); serviced from WM_ICONS_LOADED.
+    bool                   m_missingIconsQueued = false;
 
     // Posted to m_hwnd by the icon thread when loading is done → triggers repaint.
     static constexpr UINT WM_ICONS_LOADED    = WM_USER + 101;
     static constexpr UINT WM_AVATAR_LOADED   = WM_USER + 102; // S-G: avatar thread → UI
-    // Posted by the file-system watcher when a Start Menu folder change is detected.
+    // Posted by the file-system watcher when a Start Menu folder change is
+    // detected (records queued in m_pendingTreeChanges), and by the snapshot
+    // revalidation thread when a replacement tree is ready.
     static constexpr UINT WM_APP_REFRESH_TREE = WM_USER + 105;
+    // Posted by the folder prefetch thread when its scan is done.
+    static constexpr UINT WM_APP_FOLDER_SCANNED = WM_USER + 106;
+    // Posted by the recent watcher when m_pendingRecentItems is ready.
+    static constexpr UINT WM_APP_RECENT_CHANGED = WM_USER + 107;
+    // Posted by the icon thread, at most every ICON_REPAINT_MS, while icons land.
+    static constexpr UINT WM_ICONS_LANDED = WM_USER + 108;
+
+    // ── Recent programs watcher ───────────────────────────────────────────────
+    // Rebuilds the recent list in the background whenever either UserAssist
+    // key changes (RegNotifyChangeKeyValue) or m_recentWakeEvent is set, and
+    // parks it in m_pendingRecentItems; Show() and WM_APP_RECENT_CHANGED (while
+    // hidden) swap it into m_recentItems, so opening the menu never touches
+    // the registry.  Pending items whose hIcon is nullptr take the icon of
+    // the item with the same path in the list they replace.
+    // What the list is filtered against, copied from UI-thread state by
+    // RequestRecentRefresh() for the watcher thread.
+    struct RecentInputs {
+        std::set<std::wstring>    excluded;      // m_recentExcluded
+        std::vector<std::wstring> pinnedNames;   // m_dynamicPinnedItems names
+    };
+    std::thread             m_recentThread;
+    HANDLE                  m_recentStopEvent = nullptr;   // manual reset
+    HANDLE                  m_recentWakeEvent = nullptr;   // auto reset
+    std::mutex              m_recentMutex;                 // guards the three below
+    RecentInputs            m_recentInputs;
+    std::vector<RecentItem> m_pendingRecentItems;
+    bool                    m_hasPendingRecentItems = false;
+
+    // ── Type-to-search ────────────────────────────────────────────────────────
+    // Index over every tree node name plus the pinned and recent lists, owned
+    // by the UI thread.  RebuildSearchIndex() refreshes it when the tree
+    // generation moved on, or m_searchIndexDirty is set by a pinned / recent
+    // change; SearchHit::ref values are only valid against that build.
+    ProgramSearchIndex     m_searchIndex;
+    bool                   m_searchIndexDirty      = true;
+    bool                   m_searchIndexHasRecent  = false;
+    uint64_t               m_searchIndexGeneration = ~uint64_t{0};
+    std::wstring           m_searchQuery;
+    std::vector<SearchHit> m_searchResults;
+    // Matches of the last query, so a keystroke that extends it only narrows
+    // them down; tied to the index build it came from.
+    ProgramSearchIndex::Narrowing m_searchNarrowing;
+    // Lazy tree: the first search scans every pending folder in the
+    // background (through m_pendingProgramTree) so results cover the whole
+    // Start Menu, not just the folders opened so far.
+    std::thread            m_searchScanThread;
+    bool                   m_searchScanStarted = false;
 
     // S15 — blur switch
     bool m_blur = false;
@@ -290,6 +511,8 @@ private:
     HFONT m_fontNormal12  = nullptr;   // 12pt FW_NORMAL  "Segoe UI"
     HFONT m_fontSmall10   = nullptr;   // 10pt FW_NORMAL  "Marlett" (arrow glyph)
     HFONT m_fontBold16    = nullptr;   // 16pt FW_BOLD    "Segoe UI" (right-col header)
+    HFONT m_fontBold11    = nullptr;   // 11pt FW_BOLD    "Segoe UI" (bottom-bar avatar initial)
+    HFONT m_fontSemibold11 = nullptr;  // 11pt FW_SEMIBOLD "Segoe UI" (icon square labels)
 
     void CreateCachedFonts();
     void DestroyCachedFonts();
@@ -328,9 +551,8 @@ private:
     static constexpr int SHUT_BTN_H      = 26;   // height of the button
     static constexpr int SHUT_ARROW_W    = 18;   // width of the arrow dropdown button
 
-    // ── Search box — REMOVED (search box hidden per design decision; Windows
-    //    search is still accessible via Win+S; kept as constant for hit-test
-    //    legacy code that may reference it). Do NOT re-add to Paint().
+    // ── Search box — painted only in the Search view (typing starts a
+    //    search), where it takes the place of the "All Programs" row.
     static constexpr int SEARCH_H        = 34;
     static constexpr int SEARCH_Y        = BOTTOM_BAR_Y - SEARCH_H - 2;  // 624
 
@@ -348,6 +570,9 @@ private:
     // Max items visible in All Programs list (without scroll)
     static constexpr int AP_MAX_VISIBLE  = (AP_ROW_Y - PROG_Y) / PROG_ITEM_H; // ~16
 
+    // Search results shown above the search box (no scrolling: best hits only)
+    static constexpr int SEARCH_MAX_VISIBLE = (SEARCH_Y - PROG_Y) / PROG_ITEM_H;
+
     // ── Hover submenu panel layout (S3.3) ───────────────────────────────────
     static constexpr int SM_X       = DIVIDER_X + 4;
     static constexpr int SM_TITLE_H = 32;
@@ -388,31 +613,121 @@ private:
     // Left column — search box (Win7: at the bottom of the left column)
     void PaintWin7SearchBox(HDC hdc, const RECT& cr);
 
+    // Left column — Search view result rows
+    void PaintSearchResults(HDC hdc, const RECT& cr);
+
     // Right column
     void PaintWin7RightColumn(HDC hdc, const RECT& cr);
 
     // Bottom bar
     void PaintBottomBar(HDC hdc, const RECT& cr);
 
+    // ── Damage tracking ─────────────────────────────────────────────────────
+    // Hover and selection changes invalidate just the rows they touch, and
+    // Paint() skips every section and row outside the update region.  View
+    // changes (scrolling, navigation, submenu, icons landing) stay full.
+    // Rows are always invalidated whole: m_frame clips to the bounds of the
+    // update region, not to the region, so what a row blends (icons, shape
+    // edges) must land on background this paint has just filled.
+    void InvalidateArea(const RECT& r);
+    // Every row drawn highlighted now (hover, keyboard selection, buttons);
+    // called both before and after hover / selection state changes.
+    void InvalidateHighlights();
+    bool NeedsPaint(const RECT& r) const;   // always true outside Paint()
+    RECT ProgRowRect(int index) const;      // pinned / recent row
+    RECT ApListRowRect(int index) const;    // All Programs / search row; empty if not shown
+    RECT ApRowRect() const;                 // "All Programs" / "Back" row
+    RECT RightItemRect(int index) const;    // empty for separators and hidden links
+    RECT SubMenuRowRect(int visualIdx) const;
+    RECT ShutdownButtonRect() const;
+    RECT ArrowButtonRect() const;
+
+    // Draw |icon| at |size| px from m_iconAtlas (rasterized on first use);
+    // DrawIconEx when outside Paint() or the raster cannot be made.
+    void DrawAtlasIcon(HDC hdc, HICON icon, int x, int y, int size);
+
+    // One line of text in the font and text color selected into |hdc|, placed
+    // as DrawTextW(|fmt|) would place it.  Inside Paint() the glyphs come from
+    // m_glyphs and m_frame draws them; labels it cannot shape still go to
+    // DrawTextW, and their box is made opaque again.
+    void DrawLabel(HDC hdc, const wchar_t* text, int len, RECT* rect, UINT fmt);
+    // S15: |text| in |fg| over a 1px offset shadow.
+    void DrawShadowText(HDC hdc, const wchar_t* text, int len, RECT* rect, UINT fmt,
+                        COLORREF fg);
+
     // Draw a colored rounded icon square with a short label inside (S6 fallback)
     void DrawIconSquare(HDC hdc, int cx, int cy, int sz,
                         COLORREF bgColor, const wchar_t* label,
                         COLORREF textColor = RGB(255, 255, 255));
 
-    // S6 — icon lifecycle helpers (walk m_programTree recursively)
-    void LoadNodeIcons(std::vector<MenuNode>& nodes);
-    void FreeNodeIcons(std::vector<MenuNode>& nodes);
-
-    // S7 — populate m_recentItems from Windows UserAssist registry
-    void LoadRecentPrograms();
-
-    // Background thread entry point: loads all system icons (S6.1/S6.2/S6.4/S6.5/S7),
-    // sets m_iconsLoaded = true, then posts WM_ICONS_LOADED to m_hwnd if it exists.
-    void LoadIconsAsync();
+    // S6 — icon lifecycle helpers (walk every m_programTree node)
+    void LoadNodeIcons(bool diskOnly = false);
+    void FreeNodeIcons();
+
+    // Freeze |nodes| into m_programTree (caller holds m_treeMutex) and log
+    // the arena's footprint against the nested layout.
+    void InstallProgramTree(const std::vector<MenuNode>& nodes);
+
+    // S7 — rank UserAssist + m_frecency and build the recent list.  Loads an
+    // icon for every entry except those in |iconsHeld| (left nullptr: the
+    // list they come from still owns one).  Runs on the recent watcher thread.
+    std::vector<RecentItem> LoadRecentPrograms(const RecentInputs& in,
+                                               const std::set<std::wstring>& iconsHeld) const;
+
+    // Load every queued slot on m_iconPool (S6.1/S6.2/S6.4/S6.5); the last
+    // worker saves the disk cache, runs |afterPass|, sets m_iconsLoaded and
+    // posts WM_ICONS_LOADED.  CancelIconPass() abandons it and empties the queue.
+    void StartIconPass(std::function<void()> afterPass = {});
+    void CancelIconPass();
+    // Queue every slot still without an icon and start a pass that runs the
+    // cancelled one's |afterPass|.
+    void ResumeIconPass();
+
+    // Pinned / All Programs / right-column icons through m_iconCache; with
+    // |diskOnly| from the disk cache alone.  SeedIconsFromDisk() runs that on
+    // the UI thread before an icon pass starts.
+    void AssignIcons(bool diskOnly);
+    void LoadPinnedIcon(size_t index, bool diskOnly);
+    void LoadRightIcon(int index, bool diskOnly);
+    void StoreCachedIcon(HICON& slot, HICON icon);
+    // Paint's copy of a slot workers may be storing into, read under
+    // m_treeMutex; the node form also reports whether its icon was evicted.
+    HICON LoadedIcon(const HICON& slot) const;
+    HICON LoadedNodeIcon(uint32_t index, bool& evicted) const;
+    // Icon workers: |index|'s pinned shortcut under the |pending| folders of
+    // a lazy tree (m_pinnedLookupPaths), or empty.
+    std::wstring PinnedShortcutOnDisk(size_t index, const std::vector<std::wstring>& pending);
+    void SeedIconsFromDisk();
+    // Evict what m_iconCache holds beyond its budget, clearing the tree slots
+    // and atlas entries of the handles it gives up.
+    void TrimIconCache();
+
+    // ── Icon load queue (UI thread unless noted) ─────────────────────────────
+    // Queue every slot still without an icon, for a new full pass.
+    void QueueAllIcons();
+    // Queue tree nodes without an icon (caller holds m_iconQueueMutex; takes
+    // m_treeMutex inside it).
+    void QueueMissingNodeIcons();
+    IconTier NodeIconTier(uint32_t index) const;
+    // Re-rank what is on screen now: the current level and |hoveredFolder|'s
+    // children (MenuTree::kNone: none).
+    void PrioritizeVisibleIcons(uint32_t hoveredFolder = MenuTree::kNone);
+    // Icon workers: take the next queued slot / load it / maybe repaint.
+    bool NextQueuedIcon(uint32_t& id);
+    void LoadQueuedIcon(uint32_t id);
+    void OnIconLanded();
 
     // Draw a subtle horizontal separator line
     void DrawSeparator(HDC hdc, int y, int x1, int x2);
 
+    // Shapes the painters draw, rendered by m_frame during Paint() (with
+    // anti-aliased corners) and by GDI otherwise; rects exclude their right
+    // and bottom edges, lines their end point.
+    void FillSolid(HDC hdc, const RECT& r, COLORREF color);
+    void FillRounded(HDC hdc, const RECT& r, int radius, COLORREF color);
+    void StrokeRounded(HDC hdc, const RECT& r, int radius, int width, COLORREF color);
+    void DrawLine(HDC hdc, int x0, int y0, int x1, int y1, COLORREF color, int width = 1);
+
     // ── Hit testing ─────────────────────────────────────────────────────────
     int  GetProgItemAtPoint(POINT pt);      // pinned list; -1 if none
     bool IsOverApRow(POINT pt);             // "All Programs" / "Back" row
@@ -426,12 +741,40 @@ private:
     void ExecuteRecommendedItem(int index); // kept for backward compat
     void ExecuteRightItem(int index);       // Win7 right column launch
     void LaunchApItem(int index);           // launch item from current AP node list
+    void LaunchProgramNode(const MenuNodeView& node);  // hide + ShellExecute a shortcut
+    void RecordLaunch(std::wstring_view target);       // credit m_frecency
+    static std::wstring_view LaunchKeyPath(const MenuNodeView& node);  // .lnk path, else target
 
     // ── All Programs navigation ──────────────────────────────────────────────
-    const std::vector<MenuNode>& CurrentApNodes() const;
-    void NavigateIntoFolder(const std::vector<MenuNode>& children);
+    MenuNodeRange CurrentApNodes() const;
+    void NavigateIntoFolder(const MenuNodeView& folder);
     void NavigateBack();
 
+    // ── Lazy folder expansion ────────────────────────────────────────────────
+    // Scan a childrenPending folder now (waiting for a prefetch of it if one
+    // is running) and graft its children into m_programTree.
+    void EnsureFolderExpanded(uint32_t folder);
+    // Start scanning a pending folder in the background (hover timer started).
+    void PrefetchFolder(uint32_t folder);
+    // Join the prefetch thread and graft its result if the tree is unchanged.
+    void FinishFolderPrefetch();
+    // "Vendor\Tools"-style path of a folder relative to the Programs roots.
+    std::wstring FolderRelativePath(uint32_t folder) const;
+    // Relative paths of every folder still childrenPending.
+    std::vector<std::wstring> PendingFolderPaths() const;
+    // Load icons for nodes added since the last pass, after any running pass.
+    void LoadMissingIconsAsync();
+
+    // ── Type-to-search ───────────────────────────────────────────────────────
+    // Rebuild m_searchIndex if the tree, pinned or recent lists changed.
+    void RebuildSearchIndex();
+    // Set the query and rerun it; an empty query returns to the Programs view.
+    void UpdateSearch(std::wstring query);
+    // Launch (or, for a folder, open in All Programs) m_searchResults[index].
+    void ActivateSearchResult(int index);
+    // Lazy tree: scan every pending folder in the background, once.
+    void StartSearchCatalogScan();
+
     // ── Hover-to-open lateral submenu (S3.3) ─────────────────────────────────
     void OpenSubMenu(int apNodeIdx);       // show submenu for folder at apNodeIdx
     void CloseSubMenu();                   // hide submenu + reset state
@@ -454,8 +797,18 @@ private:
     void StartFolderWatcher();
     void StopFolderWatcher();
 
+    // S7 — recent programs watcher (UserAssist registry + explicit refreshes)
+    void StartRecentWatcher();
+    void StopRecentWatcher();
+    void RequestRecentRefresh();      // UI thread: snapshot filters, wake the watcher
+    void ApplyPendingRecentItems();   // UI thread: swap in the watcher's latest list
+
     // Task 3/5 — rebuild program tree on the UI thread after watcher fires
     void RefreshProgramTree();
+    // Patch the tree from the watcher's records; falls back to RefreshProgramTree()
+    void ApplyFolderChanges();
+    // Background rescan after the tree was loaded from the on-disk snapshot
+    void StartTreeRevalidation();
 
     // ── Color helpers ────────────────────────────────────────────────────────
     COLORREF CalculateHoverColor();
@@ -487,6 +840,7 @@ private:
     void SaveCustomNames();
     void LoadRecentExcluded();
     void SaveRecentExcluded();
+    void LoadFrecency();
 
     // ── Power menu (Sleep / Shut down / Restart popup) ───────────────────────
     void ShowPowerMenu();
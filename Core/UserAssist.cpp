@@ -0,0 +1,217 @@
+#include "UserAssist.h"
+#include "NameFold.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#if !defined(GLASSBAR_NO_SIMD) && \
+    (defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define GLASSBAR_USERASSIST_X86 1
+#include <emmintrin.h>
+#endif
+
+namespace GlassBar {
+
+// ── ROT13 ─────────────────────────────────────────────────────────────────────
+
+namespace {
+
+using WideUnit = std::make_unsigned_t<wchar_t>;
+
+struct Rot13Table {
+    wchar_t map[128] = {};
+    constexpr Rot13Table() {
+        for (int c = 0; c < 128; ++c) {
+            int r = c;
+            if      (c >= 'a' && c <= 'z') r = 'a' + (c - 'a' + 13) % 26;
+            else if (c >= 'A' && c <= 'Z') r = 'A' + (c - 'A' + 13) % 26;
+            map[c] = static_cast<wchar_t>(r);
+        }
+    }
+};
+constexpr Rot13Table kRot13;
+
+#if GLASSBAR_USERASSIST_X86
+// Per lane: x = (c | 0x20) - 'a' is in [0, 26) exactly for ASCII letters
+// (anything else lands outside, wrapping included); letters then move by
+// +13 below 'n' and -13 from it. Returns how many units were done.
+size_t Rot13Sse2(wchar_t* s, size_t n) {
+    size_t i = 0;
+    if constexpr (sizeof(wchar_t) == 2) {
+        const __m128i caseBit = _mm_set1_epi16(0x20);
+        const __m128i a       = _mm_set1_epi16('a');
+        const __m128i minus1  = _mm_set1_epi16(-1);
+        const __m128i v12     = _mm_set1_epi16(12);
+        const __m128i v13     = _mm_set1_epi16(13);
+        const __m128i v26     = _mm_set1_epi16(26);
+        for (; i + 8 <= n; i += 8) {
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+            const __m128i x      = _mm_sub_epi16(_mm_or_si128(c, caseBit), a);
+            const __m128i letter = _mm_and_si128(_mm_cmpgt_epi16(x, minus1), _mm_cmplt_epi16(x, v26));
+            const __m128i delta  = _mm_sub_epi16(v13, _mm_and_si128(_mm_cmpgt_epi16(x, v12), v26));
+            c = _mm_add_epi16(c, _mm_and_si128(delta, letter));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(s + i), c);
+        }
+    } else {
+        const __m128i caseBit = _mm_set1_epi32(0x20);
+        const __m128i a       = _mm_set1_epi32('a');
+        const __m128i minus1  = _mm_set1_epi32(-1);
+        const __m128i v12     = _mm_set1_epi32(12);
+        const __m128i v13     = _mm_set1_epi32(13);
+        const __m128i v26     = _mm_set1_epi32(26);
+        for (; i + 4 <= n; i += 4) {
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+            const __m128i x      = _mm_sub_epi32(_mm_or_si128(c, caseBit), a);
+            const __m128i letter = _mm_and_si128(_mm_cmpgt_epi32(x, minus1), _mm_cmplt_epi32(x, v26));
+            const __m128i delta  = _mm_sub_epi32(v13, _mm_and_si128(_mm_cmpgt_epi32(x, v12), v26));
+            c = _mm_add_epi32(c, _mm_and_si128(delta, letter));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(s + i), c);
+        }
+    }
+    return i;
+}
+#endif
+
+/// True when |s| is longer than |suffix| (lower-case ASCII) and ends in it, folded.
+bool EndsWithFolded(std::wstring_view s, std::wstring_view suffix) {
+    if (s.size() <= suffix.size()) return false;
+    const size_t at = s.size() - suffix.size();
+    for (size_t i = 0; i < suffix.size(); ++i)
+        if (FoldNameChar(s[at + i]) != suffix[i]) return false;
+    return true;
+}
+
+} // namespace
+
+void Rot13InPlace(wchar_t* s, size_t n) {
+    size_t i = 0;
+#if GLASSBAR_USERASSIST_X86
+    i = Rot13Sse2(s, n);
+#endif
+    for (; i < n; ++i) {
+        const WideUnit u = static_cast<WideUnit>(s[i]);
+        if (u < 128) s[i] = kRot13.map[u];
+    }
+}
+
+// ── Records ───────────────────────────────────────────────────────────────────
+
+bool IsProgramPath(std::wstring_view path) {
+    return EndsWithFolded(path, L".exe") || EndsWithFolded(path, L".lnk");
+}
+
+void TrimProgramExtension(std::wstring& name) {
+    if (IsProgramPath(name)) name.resize(name.size() - 4);
+}
+
+bool DecodeUserAssistValue(std::wstring_view encodedName, const std::uint8_t* data,
+                           size_t size, UserAssistRecord& out) {
+    if (!data || size < kUserAssistMinData) return false;
+    std::uint32_t runCount = 0;
+    std::memcpy(&runCount, data + 4, sizeof(runCount));
+    if (runCount == 0) return false;
+
+    // Some names carry a window title after an embedded NUL.
+    const size_t nul = encodedName.find(L'\0');
+    if (nul != std::wstring_view::npos) encodedName = encodedName.substr(0, nul);
+    if (encodedName.empty()) return false;
+
+    out.path.assign(encodedName);
+    Rot13InPlace(out.path.data(), out.path.size());
+    if (out.path.compare(0, 5, L"UEME_") == 0 || !IsProgramPath(out.path)) return false;
+
+    out.runCount = runCount;
+    std::memcpy(&out.lastRunTicks, data + 16, sizeof(out.lastRunTicks));
+    return true;
+}
+
+// ── RecentCandidates ──────────────────────────────────────────────────────────
+
+namespace {
+
+constexpr size_t kFirstBatch     = 16;
+constexpr size_t kPathChunkUnits = 16 * 1024;
+
+bool Better(const RecentCandidates::Candidate& a, const RecentCandidates::Candidate& b) {
+    if (a.rank != b.rank) return a.rank > b.rank;
+    return a.path < b.path;
+}
+
+} // namespace
+
+void RecentCandidates::Reserve(size_t n) {
+    m_items.reserve(m_items.size() + n);
+    m_byKey.reserve(m_byKey.size() + n);
+}
+
+std::wstring_view RecentCandidates::StorePath(std::wstring_view path) {
+    const size_t need = path.size() + 1;
+    if (need > m_chunkLeft) {
+        const size_t units = (std::max)(need, kPathChunkUnits);
+        m_pathChunks.push_back(std::make_unique<wchar_t[]>(units));
+        m_chunkNext = m_pathChunks.back().get();
+        m_chunkLeft = units;
+    }
+    wchar_t* stored = m_chunkNext;
+    std::copy(path.begin(), path.end(), stored);
+    stored[path.size()] = L'\0';
+    m_chunkNext += need;
+    m_chunkLeft -= need;
+    return { stored, path.size() };
+}
+
+void RecentCandidates::Merge(std::uint64_t key, std::wstring_view path, const Candidate& c) {
+    m_ordered = m_next = 0;
+    auto [it, added] = m_byKey.emplace(key, m_items.size());
+    if (added) {
+        m_items.push_back(c);
+        m_items.back().path = StorePath(path);
+        return;
+    }
+    Candidate& known = m_items[it->second];
+    known.rank         = FrecencyStore::Combine(known.rank, c.rank);
+    known.runCount    += c.runCount;
+    known.lastRunTicks = (std::max)(known.lastRunTicks, c.lastRunTicks);
+}
+
+void RecentCandidates::Add(const UserAssistRecord& record) {
+    Merge(FrecencyStore::KeyOf(record.path), record.path,
+          { {}, record.runCount, record.lastRunTicks,
+            FrecencyStore::RankFromUserAssist(record.lastRunTicks, record.runCount) });
+}
+
+void RecentCandidates::AddLaunches(const FrecencyStore::Entry& launches) {
+    if (!m_byKey.count(launches.key) && !IsProgramPath(launches.path)) return;
+    Merge(launches.key, launches.path, { {}, 0, 0, launches.rank });
+}
+
+const RecentCandidates::Candidate* RecentCandidates::Next() {
+    if (m_next == m_ordered) {
+        if (m_ordered == m_items.size()) return nullptr;
+        // Cut the next batch off the unordered tail, then order just it.
+        const size_t batch = (std::min)(m_items.size() - m_ordered,
+                                        (std::max)(kFirstBatch, m_ordered));
+        const auto first = m_items.begin() + static_cast<std::ptrdiff_t>(m_ordered);
+        const auto mid   = first + static_cast<std::ptrdiff_t>(batch);
+        std::nth_element(first, mid, m_items.end(), Better);
+        std::sort(first, mid, Better);
+        m_ordered += batch;
+    }
+    return &m_items[m_next++];
+}
+
+// ── RecentNameFilter ──────────────────────────────────────────────────────────
+
+RecentNameFilter::RecentNameFilter(const std::vector<std::wstring>& pinnedNames) {
+    m_seen.reserve(pinnedNames.size() + kFirstBatch);
+    for (const auto& name : pinnedNames) Admit(name);
+}
+
+bool RecentNameFilter::Admit(std::wstring_view displayName) {
+    m_folded.resize(displayName.size());
+    for (size_t i = 0; i < displayName.size(); ++i) m_folded[i] = FoldNameChar(displayName[i]);
+    return m_seen.insert(m_folded).second;
+}
+
+} // namespace GlassBar
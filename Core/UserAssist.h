@@ -0,0 +1,129 @@
+#pragma once
+#include "FrecencyStore.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace GlassBar {
+
+// ── UserAssist records ────────────────────────────────────────────────────────
+// Explorer's per-user launch history lives under
+//   HKCU\Software\Microsoft\Windows\CurrentVersion\Explorer\UserAssist\{GUID}\Count
+// with ROT13-encoded paths as value names and, since Windows 7, 72-byte data:
+//   offset 0  : DWORD — session / unknown
+//   offset 4  : DWORD — run count (0 = never counted)
+//   offset 8  : DWORD — focus count
+//   offset 12 : DWORD — focus time (ms)
+//   offset 16 : FILETIME — last execution time
+// Registry access and environment expansion stay with the caller; everything
+// declared here is plain C++ so it can be exercised anywhere.
+
+/// Smallest Count value that holds both the run count and the last-run time.
+constexpr size_t kUserAssistMinData = 24;
+
+/// One decoded Count value.
+struct UserAssistRecord {
+    std::wstring  path;               // decoded, cut at the first NUL
+    std::uint32_t runCount     = 0;
+    std::uint64_t lastRunTicks = 0;   // FILETIME, 100 ns since 1601
+};
+
+/// <summary>
+/// ROT13 of the ASCII letters in |s|[0, n), in place; every other unit is
+/// left alone. SSE2 on x86/x64 (GLASSBAR_NO_SIMD forces the table loop).
+/// </summary>
+void Rot13InPlace(wchar_t* s, size_t n);
+
+/// True when |path| ends in .exe or .lnk (any case).
+bool IsProgramPath(std::wstring_view path);
+
+/// Drop a trailing ".exe" / ".lnk" (any case) that some shells leave in a
+/// display name.
+void TrimProgramExtension(std::wstring& name);
+
+/// <summary>
+/// Decode one Count value into |out| (its buffer is reused). Returns false for
+/// data too short to hold a record, never-run entries, UserAssist's own
+/// UEME_* bookkeeping values and paths that are not .exe / .lnk.
+/// </summary>
+bool DecodeUserAssistValue(std::wstring_view encodedName, const std::uint8_t* data,
+                           size_t size, UserAssistRecord& out);
+
+// ── Recent list selection ─────────────────────────────────────────────────────
+
+/// <summary>
+/// Ranked candidates for the recent list: UserAssist records plus the menu's
+/// own launches, one candidate per target (FrecencyStore::KeyOf), ranked by
+/// combined frecency.
+///
+/// Next() hands them out best first but only orders what it hands out: each
+/// batch is cut from the rest with nth_element and then sorted, and batches
+/// double, so taking the few entries a short list needs costs linear time in
+/// the history size rather than a full sort. Paths are copied into chunks
+/// owned by the set, not one heap string per candidate.
+/// </summary>
+class RecentCandidates {
+public:
+    struct Candidate {
+        std::wstring_view path;                // NUL-terminated, owned by the set
+        std::uint32_t     runCount     = 0;    // UserAssist runs (0 = menu launches only)
+        std::uint64_t     lastRunTicks = 0;    // latest UserAssist run (0 = none)
+        double            rank         = 0.0;
+    };
+
+    /// Room for |n| more candidates (e.g. a Count key's value count).
+    void Reserve(size_t n);
+
+    /// Add a UserAssist record; records of the same target are combined.
+    void Add(const UserAssistRecord& record);
+
+    /// <summary>
+    /// Add the menu's launches of one target. They combine with a target
+    /// already added; an unknown target joins only if it is a program path.
+    /// Call after every Add().
+    /// </summary>
+    void AddLaunches(const FrecencyStore::Entry& launches);
+
+    /// Best remaining candidate, or nullptr when all have been handed out.
+    /// Pointers stay valid until the next Add() / AddLaunches().
+    const Candidate* Next();
+
+    size_t Size() const { return m_items.size(); }
+
+private:
+    void             Merge(std::uint64_t key, std::wstring_view path, const Candidate& c);
+    std::wstring_view StorePath(std::wstring_view path);
+
+    std::vector<Candidate>                    m_items;
+    std::unordered_map<std::uint64_t, size_t> m_byKey;   // key → m_items index
+    size_t                                    m_ordered = 0;   // [0, m_ordered) sorted
+    size_t                                    m_next    = 0;
+    std::vector<std::unique_ptr<wchar_t[]>>   m_pathChunks;
+    wchar_t*                                  m_chunkNext = nullptr;   // free tail of the last chunk
+    size_t                                    m_chunkLeft = 0;
+};
+
+/// <summary>
+/// Display-name gate of the recent list: admits a name once, and never a
+/// pinned one. Names are case-folded (FoldNameChar) once and hashed, so each
+/// check is O(1) instead of a scan over the pinned and taken names.
+/// </summary>
+class RecentNameFilter {
+public:
+    explicit RecentNameFilter(const std::vector<std::wstring>& pinnedNames);
+
+    /// True, and remembered, the first time |displayName| comes up.
+    bool Admit(std::wstring_view displayName);
+
+private:
+    std::unordered_set<std::wstring> m_seen;   // folded pinned + admitted names
+    std::wstring                     m_folded;
+};
+
+} // namespace GlassBar
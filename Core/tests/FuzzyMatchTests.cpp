@@ -0,0 +1,142 @@
+// Built twice: FuzzyMatchTests with the SIMD kernels of this machine, and
+// FuzzyMatchScalarTests against the GLASSBAR_NO_SIMD library.
+// Both must pass the same expectations.
+
+#include "FuzzyMatch.h"
+#include "FuzzyReference.h"
+#include "TestHarness.h"
+
+#include <cstring>
+#include <random>
+#include <string>
+
+using namespace GlassBar;
+using namespace GlassBar::Test;
+
+namespace {
+
+int Score(std::wstring_view name, std::wstring_view pattern) {
+    const std::vector<std::uint8_t> bounds = WordStarts(name);
+    return FuzzyScore(name, bounds.data(), pattern);
+}
+
+std::wstring RandomName(std::mt19937& rng, size_t length) {
+    // A small alphabet so patterns are often subsequences.
+    static const wchar_t kChars[] = L"abcdeoinst  x9é中";
+    std::wstring s(length, L'a');
+    for (wchar_t& c : s) c = kChars[rng() % (sizeof(kChars) / sizeof(wchar_t) - 1)];
+    return s;
+}
+
+} // namespace
+
+// ── Kernel selection ──────────────────────────────────────────────────────────
+
+GB_TEST(SimdLevelMatchesBuild) {
+    std::printf("  FuzzySimdLevel() = %s\n", FuzzySimdLevel());
+#if defined(GLASSBAR_NO_SIMD)
+    GB_CHECK(std::strcmp(FuzzySimdLevel(), "scalar") == 0);
+#endif
+}
+
+// ── Scores ────────────────────────────────────────────────────────────────────
+
+GB_TEST(KnownScores) {
+    // v@0 start (16+24+8), s@7 start gap 6 (16+24-8), c@14 start gap 6 (16+24-8).
+    GB_CHECK(Score(L"visual studio code", L"vsc") == 112);
+    // Consecutive prefix: 48, then 16+12 twice.
+    GB_CHECK(Score(L"notepad", L"not") == 104);
+    // Leading gap costs at most 10: 'z' at 12, no boundary.
+    GB_CHECK(Score(L"abcdefghijklz", L"z") == 6);
+    GB_CHECK(Score(L"abc", L"abcd") == -1);
+    GB_CHECK(Score(L"abc", L"") == -1);
+    GB_CHECK(Score(L"abc", L"ca") == -1);
+}
+
+GB_TEST(PlacementPrefersRunsThenWordStarts) {
+    // A consecutive run beats the same characters with a gap.
+    GB_CHECK(Score(L"code", L"co") > Score(L"cxode", L"co"));
+    // The first character goes to a word start even past an earlier hit.
+    GB_CHECK(Score(L"xcode control", L"co") == (16 + 24 - 6) + (16 + 12));
+    // A word start beats an earlier mid-word hit.
+    GB_CHECK(Score(L"macro code", L"c") == 16 + 24 - 6);
+    // The greedy choice never breaks a match that exists.
+    GB_CHECK(Score(L"a ab", L"ab") > 0);
+}
+
+GB_TEST(LongPatternLimit) {
+    const std::wstring name(40, L'a');
+    GB_CHECK(Score(name, std::wstring(kFuzzyMaxPattern, L'a')) > 0);
+    GB_CHECK(Score(name, std::wstring(kFuzzyMaxPattern + 1, L'a')) == -1);
+}
+
+GB_TEST(ShortAndLongPathsAgreeAroundTheMaskWidth) {
+    // 64 units is the last length scored on bitmasks; 65 takes the scan path.
+    for (size_t n : { 15u, 16u, 17u, 31u, 32u, 33u, 63u, 64u, 65u, 66u, 200u }) {
+        std::wstring name(n, L'b');
+        name[0] = L'q';
+        name[n - 1] = L'z';
+        GB_CHECK(Score(name, L"qz") == ReferenceFuzzyScore(name, WordStarts(name).data(), L"qz"));
+        GB_CHECK(Score(name, L"z") == ReferenceFuzzyScore(name, WordStarts(name).data(), L"z"));
+    }
+}
+
+GB_TEST(RandomScoresMatchReference) {
+    std::mt19937 rng(12345);
+    int matched = 0;
+    for (int iter = 0; iter < 20000; ++iter) {
+        const std::wstring name = RandomName(rng, 1 + rng() % 100);
+        std::wstring pattern;
+        if (rng() % 2) {
+            // A subsequence of the name, so most of these score.
+            for (wchar_t c : name)
+                if (pattern.size() < kFuzzyMaxPattern && rng() % 4 == 0) pattern.push_back(c);
+        } else {
+            pattern = RandomName(rng, 1 + rng() % 6);
+        }
+        const std::vector<std::uint8_t> bounds = WordStarts(name);
+        const int expected = ReferenceFuzzyScore(name, bounds.data(), pattern);
+        const int actual   = FuzzyScore(name, bounds.data(), pattern);
+        GB_CHECK(actual == expected);
+        if (actual != expected) {
+            std::printf("  name \"%s\" pattern \"%s\": %d, reference %d\n",
+                        Printable(name).c_str(), Printable(pattern).c_str(), actual, expected);
+            return;
+        }
+        matched += expected >= 0 ? 1 : 0;
+    }
+    GB_CHECK(matched > 5000);
+}
+
+// ── Prefilter ─────────────────────────────────────────────────────────────────
+
+GB_TEST(CharMaskIsSubsetForSubsequences) {
+    std::mt19937 rng(7);
+    for (int iter = 0; iter < 2000; ++iter) {
+        const std::wstring name = RandomName(rng, 1 + rng() % 40);
+        std::wstring pattern;
+        for (wchar_t c : name)
+            if (rng() % 3 == 0) pattern.push_back(c);
+        const uint64_t nm = FuzzyCharMask(name), pm = FuzzyCharMask(pattern);
+        GB_CHECK((nm & pm) == pm);
+    }
+    GB_CHECK(FuzzyCharMask(L"a") == 1);
+    GB_CHECK(FuzzyCharMask(L"0") == uint64_t{1} << 26);
+    GB_CHECK(FuzzyCharMask(L"   ") == 0);
+}
+
+GB_TEST(PrefilterMatchesReferenceAtEveryTailLength) {
+    std::mt19937_64 rng(99);
+    std::vector<uint64_t> masks(203);
+    for (uint64_t& m : masks) m = rng() & rng();   // about a quarter of the bits set
+    for (size_t count = 0; count <= masks.size(); ++count) {
+        for (uint64_t need : { uint64_t{0}, uint64_t{1}, uint64_t{0x5}, masks[count % masks.size()] & 0xFF,
+                               ~uint64_t{0} }) {
+            std::vector<uint32_t> out = { 0xDEAD };   // appended to, not replaced
+            FuzzyPrefilter(masks.data(), count, need, out);
+            std::vector<uint32_t> expected = ReferenceFuzzyPrefilter(masks.data(), count, need);
+            expected.insert(expected.begin(), 0xDEAD);
+            GB_CHECK(out == expected);
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace GlassBar::Test {
+
+// ── FuzzyMatch reference ──────────────────────────────────────────────────────
+// The rules documented in FuzzyMatch.h, written as plain character scans with
+// no bitmasks or vector code. The tests and the fuzzer hold FuzzyScore and
+// FuzzyPrefilter to these on every input, so the SIMD kernels, the 64-unit
+// bitmask path and the GLASSBAR_NO_SIMD build all have to agree with them.
+
+inline int ReferenceFuzzyScore(std::wstring_view name, const std::uint8_t* bounds,
+                               std::wstring_view pattern) {
+    const size_t n = name.size(), m = pattern.size();
+    if (m == 0 || m > n || m > 32) return -1;
+
+    // Last feasible index of each pattern character, from the right.
+    std::vector<size_t> latest(m);
+    size_t end = n;
+    for (size_t j = m; j-- > 0;) {
+        while (end > 0 && name[end - 1] != pattern[j]) --end;
+        if (end == 0) return -1;
+        latest[j] = --end;
+    }
+
+    int score = 0;
+    bool first = true;
+    size_t prev = 0;
+    for (size_t j = 0; j < m; ++j) {
+        const size_t lo = first ? 0 : prev + 1;
+        size_t at = latest[j];
+        if (!first && name[lo] == pattern[j]) {
+            at = lo;
+        } else {
+            size_t firstHit = latest[j], firstStart = static_cast<size_t>(-1);
+            for (size_t k = latest[j] + 1; k-- > lo;) {
+                if (name[k] != pattern[j]) continue;
+                firstHit = k;
+                if (bounds[k]) firstStart = k;
+            }
+            at = firstStart != static_cast<size_t>(-1) ? firstStart : firstHit;
+        }
+
+        int points = 16;
+        if (bounds[at]) points += 24 + (at == 0 ? 8 : 0);
+        if (first) {
+            points -= static_cast<int>(at < 10 ? at : 10);
+        } else if (at == prev + 1) {
+            points += 12;
+        } else {
+            const int gap  = static_cast<int>(at - prev - 1);
+            const int cost = 3 + (gap - 1);
+            points -= cost < 12 ? cost : 12;
+        }
+        score += points;
+        prev  = at;
+        first = false;
+    }
+    return score;
+}
+
+inline std::vector<std::uint32_t> ReferenceFuzzyPrefilter(const std::uint64_t* masks, size_t count,
+                                                          std::uint64_t need) {
+    std::vector<std::uint32_t> out;
+    for (size_t i = 0; i < count; ++i)
+        if ((masks[i] & need) == need) out.push_back(static_cast<std::uint32_t>(i));
+    return out;
+}
+
+/// Word starts of a folded name: index 0 and every unit after a space.
+inline std::vector<std::uint8_t> WordStarts(std::wstring_view name) {
+    std::vector<std::uint8_t> bounds(name.size(), 0);
+    for (size_t i = 0; i < name.size(); ++i)
+        bounds[i] = (name[i] != L' ' && (i == 0 || name[i - 1] == L' ')) ? 1 : 0;
+    return bounds;
+}
+
+} // namespace GlassBar::Test
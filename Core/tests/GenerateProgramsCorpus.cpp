@@ -0,0 +1,36 @@
+// Writes a synthetic Start Menu (see ProgramsCorpus.h) to disk, for timing
+// the real Win32 scan through the GLASSBAR_PROGRAMS_ROOTS override.
+//
+//   GenerateProgramsCorpus <outdir> [entries] [seed]
+
+#include "ProgramsCorpus.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace GlassBar::Test;
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <outdir> [entries] [seed]\n", argv[0]);
+        return 2;
+    }
+    const std::filesystem::path dir = argv[1];
+    std::error_code ec;
+    if (std::filesystem::exists(dir / "Common", ec) || std::filesystem::exists(dir / "User", ec)) {
+        std::fprintf(stderr, "%s already holds a corpus\n", argv[1]);
+        return 1;
+    }
+
+    CorpusSpec spec;
+    if (argc > 2) spec.entries = std::strtoul(argv[2], nullptr, 10);
+    if (argc > 3) spec.seed    = static_cast<unsigned>(std::strtoul(argv[3], nullptr, 10));
+    const CorpusInfo info = WriteProgramsCorpus(dir, spec);
+
+    std::printf("%zu .lnk, %zu .url, %zu folders, %zu shared, %zu same-stem .url, %zu ignored\n",
+                info.lnk, info.url, info.folders, info.sharedLinks, info.sameStemUrls, info.ignored);
+    std::printf("GLASSBAR_PROGRAMS_ROOTS=%s;%s\n",
+                std::filesystem::absolute(info.commonRoot).string().c_str(),
+                std::filesystem::absolute(info.userRoot).string().c_str());
+    return 0;
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace GlassBar::Test {
+
+// ── Golden images ─────────────────────────────────────────────────────────────
+// Reference frames live in tests/golden as PAM files (P7, RGB_ALPHA, 8 bits;
+// samples are the surface's premultiplied values, so translucent pixels look
+// darker in a viewer than on screen). A render matches when no channel is more
+// than |tolerance| off. With GLASSBAR_UPDATE_GOLDEN=1 in the environment a
+// mismatching or missing golden is rewritten instead; otherwise the render is
+// written beside the test as <name>.actual.pam to look at.
+
+struct Image {
+    int width  = 0;
+    int height = 0;
+    std::vector<std::uint32_t> pixels;   // 0xAARRGGBB rows, top-down
+};
+
+inline bool WritePam(const std::string& path, const Image& img) {
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    f << "P7\nWIDTH " << img.width << "\nHEIGHT " << img.height
+      << "\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n";
+    for (std::uint32_t p : img.pixels) {
+        const char rgba[4] = { static_cast<char>(p >> 16), static_cast<char>(p >> 8),
+                               static_cast<char>(p), static_cast<char>(p >> 24) };
+        f.write(rgba, 4);
+    }
+    return static_cast<bool>(f);
+}
+
+inline bool ReadPam(const std::string& path, Image& img) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+    std::string line, magic;
+    int depth = 0, maxval = 0;
+    img = {};
+    if (!std::getline(f, magic) || magic != "P7") return false;
+    while (std::getline(f, line) && line != "ENDHDR") {
+        std::istringstream fields(line);
+        std::string key;
+        fields >> key;
+        if (key == "WIDTH")       fields >> img.width;
+        else if (key == "HEIGHT") fields >> img.height;
+        else if (key == "DEPTH")  fields >> depth;
+        else if (key == "MAXVAL") fields >> maxval;
+    }
+    if (depth != 4 || maxval != 255 || img.width <= 0 || img.height <= 0) return false;
+    img.pixels.resize(static_cast<size_t>(img.width) * img.height);
+    for (std::uint32_t& p : img.pixels) {
+        unsigned char rgba[4];
+        if (!f.read(reinterpret_cast<char*>(rgba), 4)) return false;
+        p = (std::uint32_t(rgba[3]) << 24) | (std::uint32_t(rgba[0]) << 16) |
+            (std::uint32_t(rgba[1]) << 8) | rgba[2];
+    }
+    return true;
+}
+
+/// Compare |actual| with <dir>/<name>.pam; prints why on a mismatch.
+inline bool MatchesGolden(const std::string& dir, const std::string& name, const Image& actual,
+                          int tolerance = 1) {
+    const std::string path = dir + "/" + name + ".pam";
+    const char* update = std::getenv("GLASSBAR_UPDATE_GOLDEN");
+    Image golden;
+    const bool loaded = ReadPam(path, golden);
+
+    size_t off = 0;
+    int worst = 0;
+    if (loaded && golden.width == actual.width && golden.height == actual.height) {
+        for (size_t i = 0; i < actual.pixels.size(); ++i) {
+            int pixelWorst = 0;
+            for (int shift = 0; shift < 32; shift += 8) {
+                const int a = static_cast<int>((actual.pixels[i] >> shift) & 0xFF);
+                const int g = static_cast<int>((golden.pixels[i] >> shift) & 0xFF);
+                pixelWorst = (std::max)(pixelWorst, a > g ? a - g : g - a);
+            }
+            worst = (std::max)(worst, pixelWorst);
+            if (pixelWorst > tolerance) ++off;
+        }
+        if (off == 0) return true;
+    }
+
+    if (update && *update == '1') {
+        std::fprintf(stderr, "golden %s: rewritten\n", path.c_str());
+        return WritePam(path, actual);
+    }
+    if (!loaded)
+        std::fprintf(stderr, "golden %s: missing or unreadable\n", path.c_str());
+    else if (golden.width != actual.width || golden.height != actual.height)
+        std::fprintf(stderr, "golden %s: is %dx%d, render is %dx%d\n", path.c_str(),
+                     golden.width, golden.height, actual.width, actual.height);
+    else
+        std::fprintf(stderr, "golden %s: %zu pixels off by up to %d\n", path.c_str(), off, worst);
+    WritePam(name + ".actual.pam", actual);
+    return false;
+}
+
+} // namespace GlassBar::Test
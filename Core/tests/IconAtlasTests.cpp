@@ -0,0 +1,261 @@
+// Built twice, like FuzzyMatchTests: IconAtlasTests blends with SSE2 where the
+// target has it, IconAtlasScalarTests against the GLASSBAR_NO_SIMD library.
+
+#include "IconAtlas.h"
+#include "TestHarness.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+
+using namespace GlassBar;
+using namespace GlassBar::Test;
+
+namespace {
+
+/// A raster whose every pixel names its icon, size and position.
+std::vector<std::uint32_t> Raster(std::uint64_t id, int size) {
+    std::vector<std::uint32_t> px(static_cast<size_t>(size) * size);
+    for (size_t i = 0; i < px.size(); ++i)
+        px[i] = static_cast<std::uint32_t>(id * 2654435761u) ^ static_cast<std::uint32_t>(size << 20) ^
+                static_cast<std::uint32_t>(i);
+    return px;
+}
+
+bool HoldsRaster(const IconAtlas& atlas, const IconAtlas::Slot& slot, std::uint64_t id) {
+    const std::vector<std::uint32_t> px = Raster(id, slot.size);
+    for (int row = 0; row < slot.size; ++row)
+        for (int col = 0; col < slot.size; ++col)
+            if (atlas.Pixels()[static_cast<size_t>(slot.y + row) * IconAtlas::kWidth + slot.x + col] !=
+                px[static_cast<size_t>(row) * slot.size + col])
+                return false;
+    return true;
+}
+
+/// One channel of the documented blend, computed in floating point.
+std::uint32_t ReferenceChannel(std::uint32_t s, std::uint32_t d, std::uint32_t alpha) {
+    const double t = std::floor(d * (255.0 - alpha) / 255.0 + 0.5);
+    return (std::min)(s + static_cast<std::uint32_t>(t), 255u);
+}
+
+std::uint32_t ReferencePixel(std::uint32_t s, std::uint32_t d) {
+    const std::uint32_t alpha = s >> 24;
+    if (alpha == 0)   return d;
+    if (alpha == 255) return s;
+    std::uint32_t out = 0;
+    for (int shift = 0; shift < 32; shift += 8)
+        out |= ReferenceChannel((s >> shift) & 0xFF, (d >> shift) & 0xFF, alpha) << shift;
+    return out;
+}
+
+/// Random premultiplied pixel: mostly mixed alpha, with opaque and clear runs.
+std::uint32_t RandomPremultiplied(std::mt19937& rng) {
+    const unsigned kind = rng() % 4;
+    const std::uint32_t a = kind == 0 ? 0 : kind == 1 ? 255 : rng() % 256;
+    std::uint32_t px = a << 24;
+    for (int shift = 0; shift < 24; shift += 8)
+        px |= (a ? rng() % (a + 1) : 0) << shift;
+    return px;
+}
+
+} // namespace
+
+// ── Packing ───────────────────────────────────────────────────────────────────
+
+GB_TEST(InsertFindAndReplace) {
+    IconAtlas atlas;
+    GB_CHECK(atlas.Find(1, 32) == nullptr);
+    const auto px = Raster(1, 32);
+    const IconAtlas::Slot* slot = atlas.Insert(1, 32, px.data());
+    GB_CHECK(slot && slot->x == 0 && slot->y == 0 && slot->size == 32);
+    GB_CHECK(atlas.Find(1, 32) == slot);
+    GB_CHECK(atlas.Find(1, 16) == nullptr);
+    GB_CHECK(atlas.Height() == 32);
+    GB_CHECK(HoldsRaster(atlas, *slot, 1));
+
+    // Same id and size: same slot, new pixels.
+    const auto other = Raster(2, 32);
+    const IconAtlas::Slot* again = atlas.Insert(1, 32, other.data());
+    GB_CHECK(again == slot && again->x == 0 && again->y == 0);
+    GB_CHECK(HoldsRaster(atlas, *again, 2));
+    GB_CHECK(atlas.IconCount() == 1);
+}
+
+GB_TEST(SizeLimits) {
+    IconAtlas atlas;
+    const auto big = Raster(1, IconAtlas::kWidth + 1);
+    GB_CHECK(atlas.Insert(1, 0, big.data()) == nullptr);
+    GB_CHECK(atlas.Insert(1, IconAtlas::kWidth + 1, big.data()) == nullptr);
+    GB_CHECK(atlas.Insert(1, IconAtlas::kWidth, big.data()) != nullptr);
+    for (int size = 1; size < IconAtlas::kSizesPerIcon; ++size)
+        GB_CHECK(atlas.Insert(1, size, big.data()) != nullptr);
+    GB_CHECK(atlas.Insert(1, 99, big.data()) == nullptr);   // a fifth size
+    GB_CHECK(atlas.Insert(1, 1, big.data()) != nullptr);    // an existing one is fine
+}
+
+GB_TEST(ShelvesFillThenGrow) {
+    IconAtlas atlas;
+    const int perShelf = IconAtlas::kWidth / 24;   // 10, with a 16 px tail unused
+    std::vector<std::uint32_t> px(24 * 24, 0);
+    for (int i = 0; i < perShelf; ++i) {
+        const IconAtlas::Slot* s = atlas.Insert(static_cast<std::uint64_t>(i), 24, px.data());
+        GB_CHECK(s && s->x == i * 24 && s->y == 0);
+    }
+    GB_CHECK(atlas.Height() == 24);
+    const IconAtlas::Slot* next = atlas.Insert(100, 24, px.data());
+    GB_CHECK(next && next->x == 0 && next->y == 24);
+    const IconAtlas::Slot* small = atlas.Insert(200, 16, px.data());   // its own shelf
+    GB_CHECK(small && small->x == 0 && small->y == 48);
+    GB_CHECK(atlas.Height() == 64);
+}
+
+GB_TEST(RemovedSlotsAreReusedBySize) {
+    IconAtlas atlas;
+    std::vector<std::uint32_t> px(48 * 48, 0);
+    atlas.Insert(1, 16, px.data());
+    atlas.Insert(1, 48, px.data());
+    const IconAtlas::Slot s16 = *atlas.Find(1, 16);
+    const IconAtlas::Slot s48 = *atlas.Find(1, 48);
+    atlas.Insert(2, 16, px.data());
+    atlas.Remove(1);
+    GB_CHECK(atlas.Find(1, 16) == nullptr && atlas.IconCount() == 1);
+    const int height = atlas.Height();
+
+    const IconAtlas::Slot* r48 = atlas.Insert(3, 48, px.data());
+    const IconAtlas::Slot* r16 = atlas.Insert(4, 16, px.data());
+    GB_CHECK(r48 && r48->x == s48.x && r48->y == s48.y);
+    GB_CHECK(r16 && r16->x == s16.x && r16->y == s16.y);
+    GB_CHECK(atlas.Height() == height);
+    atlas.Remove(12345);   // unknown: no-op
+
+    atlas.Clear();
+    GB_CHECK(atlas.IconCount() == 0 && atlas.Height() == 0);
+    const IconAtlas::Slot* fresh = atlas.Insert(5, 16, px.data());
+    GB_CHECK(fresh && fresh->x == 0 && fresh->y == 0);
+}
+
+GB_TEST(RandomOperationsKeepSlotsDisjointAndPixelsIntact) {
+    static const int kSizes[] = { 16, 20, 24, 32, 40, 48, 64, 96 };
+    std::mt19937 rng(18);
+    IconAtlas atlas;
+    std::map<std::uint64_t, std::vector<int>> model;   // id → sizes held
+    for (int step = 0; step < 4000; ++step) {
+        const std::uint64_t id = rng() % 150;
+        if (rng() % 4 == 0) {
+            atlas.Remove(id);
+            model.erase(id);
+            continue;
+        }
+        const int size = kSizes[rng() % 8];
+        const auto px = Raster(id, size);
+        std::vector<int>& sizes = model[id];
+        const bool known = std::find(sizes.begin(), sizes.end(), size) != sizes.end();
+        const IconAtlas::Slot* slot = atlas.Insert(id, size, px.data());
+        if (!known && sizes.size() == IconAtlas::kSizesPerIcon) {
+            GB_CHECK(slot == nullptr);
+        } else {
+            GB_CHECK(slot != nullptr);
+            if (!known) sizes.push_back(size);
+        }
+        if (sizes.empty()) model.erase(id);
+    }
+
+    // Every live slot lies inside the image, overlaps no other and still
+    // holds the pixels it was given, whatever moved or grew since.
+    std::vector<std::uint8_t> owner(static_cast<size_t>(IconAtlas::kWidth) * atlas.Height(), 0);
+    size_t live = 0;
+    for (const auto& [id, sizes] : model) {
+        for (int size : sizes) {
+            const IconAtlas::Slot* s = atlas.Find(id, size);
+            GB_CHECK(s != nullptr);
+            if (!s) continue;
+            ++live;
+            GB_CHECK(s->x >= 0 && s->x + s->size <= IconAtlas::kWidth);
+            GB_CHECK(s->y >= 0 && s->y + s->size <= atlas.Height());
+            GB_CHECK(HoldsRaster(atlas, *s, id));
+            for (int row = 0; row < s->size; ++row)
+                for (int col = 0; col < s->size; ++col) {
+                    std::uint8_t& o = owner[static_cast<size_t>(s->y + row) * IconAtlas::kWidth + s->x + col];
+                    GB_CHECK(o == 0);
+                    o = 1;
+                }
+        }
+    }
+    GB_CHECK(atlas.IconCount() == model.size());
+    GB_CHECK(live > 100);
+}
+
+// ── Blending ──────────────────────────────────────────────────────────────────
+
+GB_TEST(BlendChannelMathIsExact) {
+    // Every alpha, every destination value and the extreme premultiplied
+    // source values, through a 1×8 block so the vector path runs too.
+    for (std::uint32_t alpha = 0; alpha < 256; ++alpha) {
+        for (std::uint32_t s : { 0u, alpha / 2, alpha }) {
+            for (std::uint32_t d0 = 0; d0 < 256; d0 += 8) {
+                std::uint32_t src[8], dst[8], expected[8];
+                for (int i = 0; i < 8; ++i) {
+                    const std::uint32_t d = d0 + static_cast<std::uint32_t>(i);
+                    src[i] = (alpha << 24) | (s << 16) | (s << 8) | s;
+                    dst[i] = (d << 24) | (d << 16) | ((255 - d) << 8) | d;
+                    expected[i] = ReferencePixel(src[i], dst[i]);
+                }
+                BlendPremultiplied(dst, 8, 8, 1, 0, 0, src, 8, 8, 1);
+                for (int i = 0; i < 8; ++i) {
+                    if (dst[i] != expected[i]) {
+                        GB_CHECK(dst[i] == expected[i]);
+                        std::printf("  alpha %u s %u: %08X, expected %08X\n", alpha, s, dst[i], expected[i]);
+                        return;
+                    }
+                }
+            }
+        }
+    }
+}
+
+GB_TEST(BlendClipsAndMatchesReference) {
+    std::mt19937 rng(25);
+    const int dstW = 37, dstH = 23;
+    for (int iter = 0; iter < 3000; ++iter) {
+        const int w = 1 + static_cast<int>(rng() % 20), h = 1 + static_cast<int>(rng() % 20);
+        const int x = static_cast<int>(rng() % (dstW + 2 * w)) - w;
+        const int y = static_cast<int>(rng() % (dstH + 2 * h)) - h;
+        const int srcStride = w + static_cast<int>(rng() % 5);
+
+        std::vector<std::uint32_t> src(static_cast<size_t>(srcStride) * h);
+        for (auto& p : src) p = RandomPremultiplied(rng);
+        std::vector<std::uint32_t> dst(static_cast<size_t>(dstW) * dstH);
+        for (auto& p : dst) p = static_cast<std::uint32_t>(rng());
+        std::vector<std::uint32_t> expected = dst;
+        for (int row = 0; row < h; ++row)
+            for (int col = 0; col < w; ++col) {
+                const int dx = x + col, dy = y + row;
+                if (dx < 0 || dy < 0 || dx >= dstW || dy >= dstH) continue;
+                std::uint32_t& d = expected[static_cast<size_t>(dy) * dstW + dx];
+                d = ReferencePixel(src[static_cast<size_t>(row) * srcStride + col], d);
+            }
+
+        BlendPremultiplied(dst.data(), dstW, dstW, dstH, x, y, src.data(), srcStride, w, h);
+        if (dst != expected) {
+            GB_CHECK(dst == expected);
+            std::printf("  block %dx%d at (%d,%d)\n", w, h, x, y);
+            return;
+        }
+    }
+}
+
+GB_TEST(BlendFromAtlasSlot) {
+    IconAtlas atlas;
+    std::vector<std::uint32_t> icon(16 * 16, 0x80402010u);   // half-transparent
+    const IconAtlas::Slot* slot = atlas.Insert(7, 16, icon.data());
+    GB_CHECK(slot != nullptr);
+    std::vector<std::uint32_t> frame(20 * 20, 0xFF000000u);
+    BlendPremultiplied(frame.data(), 20, 20, 20, 2, 2,
+                       atlas.Pixels() + static_cast<size_t>(slot->y) * IconAtlas::kWidth + slot->x,
+                       IconAtlas::kWidth, 16, 16);
+    GB_CHECK(frame[0] == 0xFF000000u);
+    GB_CHECK(frame[2 * 20 + 2] == ReferencePixel(0x80402010u, 0xFF000000u));
+    GB_CHECK(frame[17 * 20 + 17] == frame[2 * 20 + 2]);
+    GB_CHECK(frame[18 * 20 + 18] == 0xFF000000u);
+}
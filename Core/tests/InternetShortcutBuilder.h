@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace GlassBar::Test {
+
+/// Encodings ParseInternetShortcut accepts.
+enum class UrlFileEncoding { Ansi, Utf8Bom, Utf16Bom };
+
+/// |text| (UTF-16 code units, ASCII for the 8-bit encodings) as .url file
+/// bytes, with the encoding's byte order mark.
+inline std::vector<std::uint8_t> EncodeUrlFile(const std::wstring& text, UrlFileEncoding encoding) {
+    std::vector<std::uint8_t> bytes;
+    if (encoding == UrlFileEncoding::Utf16Bom) {
+        bytes = { 0xFF, 0xFE };
+        for (wchar_t c : text) {
+            bytes.push_back(static_cast<std::uint8_t>(c));
+            bytes.push_back(static_cast<std::uint8_t>(static_cast<unsigned>(c) >> 8));
+        }
+        return bytes;
+    }
+    if (encoding == UrlFileEncoding::Utf8Bom) bytes = { 0xEF, 0xBB, 0xBF };
+    for (wchar_t c : text) bytes.push_back(static_cast<std::uint8_t>(c));
+    return bytes;
+}
+
+} // namespace GlassBar::Test
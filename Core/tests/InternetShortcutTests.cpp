@@ -0,0 +1,144 @@
+#include "ShellLinkParser.h"
+#include "InternetShortcutBuilder.h"
+#include "TestHarness.h"
+
+using namespace GlassBar;
+using namespace GlassBar::Test;
+
+namespace {
+
+bool Parse(const std::wstring& text, InternetShortcutInfo& info,
+           UrlFileEncoding encoding = UrlFileEncoding::Ansi) {
+    const std::vector<std::uint8_t> bytes = EncodeUrlFile(text, encoding);
+    return ParseInternetShortcut(bytes.data(), bytes.size(), info);
+}
+
+} // namespace
+
+// ── Keys and values ───────────────────────────────────────────────────────────
+
+GB_TEST(AllThreeKeys) {
+    InternetShortcutInfo info;
+    GB_CHECK(Parse(L"[InternetShortcut]\r\nURL=https://example.com/\r\n"
+                   L"IconFile=C:\\icons\\site.ico\r\nIconIndex=3\r\n", info));
+    GB_CHECK_WSTR(info.url, L"https://example.com/");
+    GB_CHECK_WSTR(info.iconFile, L"C:\\icons\\site.ico");
+    GB_CHECK(info.iconIndex == 3);
+}
+
+GB_TEST(NamesAreCaseInsensitiveAndTrimmed) {
+    InternetShortcutInfo info;
+    GB_CHECK(Parse(L"  [internetSHORTCUT]\n\t url \t=  steam://run/1  \n  ICONINDEX= 2\n", info));
+    GB_CHECK_WSTR(info.url, L"steam://run/1");
+    GB_CHECK(info.iconIndex == 2);
+    GB_CHECK(info.iconFile.empty());
+}
+
+GB_TEST(MatchingQuotesStripped) {
+    InternetShortcutInfo info;
+    GB_CHECK(Parse(L"[InternetShortcut]\nURL=\"https://a/\"\nIconFile='C:\\x.ico'\n", info));
+    GB_CHECK_WSTR(info.url, L"https://a/");
+    GB_CHECK_WSTR(info.iconFile, L"C:\\x.ico");
+
+    GB_CHECK(Parse(L"[InternetShortcut]\nURL=\"https://a/'\n", info));   // mismatched: kept
+    GB_CHECK_WSTR(info.url, L"\"https://a/'");
+    GB_CHECK(Parse(L"[InternetShortcut]\nURL=\"\"x\"\"\n", info));      // one pair only
+    GB_CHECK_WSTR(info.url, L"\"x\"");
+}
+
+GB_TEST(IconIndexLikeGetPrivateProfileInt) {
+    InternetShortcutInfo info;
+    GB_CHECK(Parse(L"[InternetShortcut]\nURL=a\nIconIndex=-5\n", info));
+    GB_CHECK(info.iconIndex == -5);
+    GB_CHECK(Parse(L"[InternetShortcut]\nURL=a\nIconIndex=+7\n", info));
+    GB_CHECK(info.iconIndex == 7);
+    GB_CHECK(Parse(L"[InternetShortcut]\nURL=a\nIconIndex=12abc\n", info));
+    GB_CHECK(info.iconIndex == 12);
+    GB_CHECK(Parse(L"[InternetShortcut]\nURL=a\nIconIndex=x\n", info));
+    GB_CHECK(info.iconIndex == 0);
+    GB_CHECK(Parse(L"[InternetShortcut]\nURL=a\nIconIndex=99999999999999\n", info));
+    GB_CHECK(info.iconIndex == 0x7FFFFFFF);
+}
+
+// ── Sections, lines and precedence ────────────────────────────────────────────
+
+GB_TEST(FirstKeyAndFirstSectionWin) {
+    InternetShortcutInfo info;
+    GB_CHECK(Parse(L"[InternetShortcut]\nURL=first\nURL=second\n", info));
+    GB_CHECK_WSTR(info.url, L"first");
+    GB_CHECK(Parse(L"[InternetShortcut]\nURL=first\n[InternetShortcut]\nURL=second\n", info));
+    GB_CHECK_WSTR(info.url, L"first");
+    // A later section ends the first one.
+    GB_CHECK(!Parse(L"[InternetShortcut]\nIconIndex=1\n[Other]\nURL=other\n", info));
+}
+
+GB_TEST(OtherSectionsIgnored) {
+    InternetShortcutInfo info;
+    GB_CHECK(Parse(L"[{000214A0-0000-0000-C000-000000000046}]\nProp3=19,11\nURL=nope\n"
+                   L"[InternetShortcut]\nURL=yes\n", info));
+    GB_CHECK_WSTR(info.url, L"yes");
+    GB_CHECK(!Parse(L"URL=outside\n", info));
+}
+
+GB_TEST(CommentsBlankAndMalformedLines) {
+    InternetShortcutInfo info;
+    GB_CHECK(Parse(L"; comment\n\n[InternetShortcut]\n;URL=commented\nno equals sign\n"
+                   L"[broken\nURL=kept\n", info) == false);   // "[broken" starts a new section
+    GB_CHECK(Parse(L"; comment\n\n[InternetShortcut]\n;URL=commented\nno equals sign\nURL=kept\n", info));
+    GB_CHECK_WSTR(info.url, L"kept");
+}
+
+GB_TEST(LineEndings) {
+    InternetShortcutInfo info;
+    GB_CHECK(Parse(L"[InternetShortcut]\rURL=cr\rIconIndex=4", info));
+    GB_CHECK_WSTR(info.url, L"cr");
+    GB_CHECK(info.iconIndex == 4);
+    GB_CHECK(Parse(L"[InternetShortcut]\nURL=no-final-newline", info));
+    GB_CHECK_WSTR(info.url, L"no-final-newline");
+}
+
+// ── Encodings ─────────────────────────────────────────────────────────────────
+
+GB_TEST(Utf16WithBom) {
+    InternetShortcutInfo info;
+    GB_CHECK(Parse(L"[InternetShortcut]\r\nURL=https://b\u00FCcher.example/\u4E2D\r\n", info,
+                   UrlFileEncoding::Utf16Bom));
+    GB_CHECK_WSTR(info.url, L"https://b\u00FCcher.example/\u4E2D");
+}
+
+GB_TEST(Utf8BomAsciiAccepted) {
+    InternetShortcutInfo info;
+    GB_CHECK(Parse(L"[InternetShortcut]\nURL=https://c/\n", info, UrlFileEncoding::Utf8Bom));
+    GB_CHECK_WSTR(info.url, L"https://c/");
+}
+
+GB_TEST(NonAsciiEightBitValuesDeclined) {
+    InternetShortcutInfo info;
+    GB_CHECK(!Parse(L"[InternetShortcut]\nURL=https://caf\u00E9/\n", info));
+    GB_CHECK(!Parse(L"[InternetShortcut]\nURL=https://c/\nIconFile=C:\\\u00E9.ico\n", info));
+    // Bytes outside the wanted values do not matter.
+    GB_CHECK(Parse(L"[InternetShortcut]\nURL=https://c/\nName=caf\u00E9\n", info));
+}
+
+GB_TEST(MissingOrEmptyUrlDeclined) {
+    InternetShortcutInfo info;
+    GB_CHECK(!Parse(L"", info));
+    GB_CHECK(!Parse(L"[InternetShortcut]\nIconFile=x\n", info));
+    GB_CHECK(!Parse(L"[InternetShortcut]\nURL=\n", info));
+    GB_CHECK(!Parse(L"[InternetShortcut]\nURL=\"\"\n", info));
+    GB_CHECK(!ParseInternetShortcut(nullptr, 0, info));
+}
+
+GB_TEST(TruncatedFilesNeverReadPastTheEnd) {
+    const std::wstring text = L"[InternetShortcut]\r\nURL=\"https://example.com/x\"\r\nIconFile=C:\\a.ico\r\nIconIndex=-12\r\n";
+    for (UrlFileEncoding enc : { UrlFileEncoding::Ansi, UrlFileEncoding::Utf8Bom, UrlFileEncoding::Utf16Bom }) {
+        const std::vector<std::uint8_t> full = EncodeUrlFile(text, enc);
+        InternetShortcutInfo info;
+        for (size_t n = 0; n <= full.size(); ++n) {
+            std::vector<std::uint8_t> prefix(full.begin(), full.begin() + n);
+            ParseInternetShortcut(prefix.data(), prefix.size(), info);
+        }
+        GB_CHECK_WSTR(info.url, L"https://example.com/x");
+        GB_CHECK(info.iconIndex == -12);
+    }
+}
@@ -0,0 +1,124 @@
+// MergeTree against the merge it replaced, on random trees full of the
+// collisions the linear merge has to get right: names differing only in
+// case, names sharing the packed sort-key prefix, same-name folder/shortcut
+// pairs, and duplicate keys within one level in either tree.
+
+#include "ProgramTree.h"
+#include "TestHarness.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+
+using namespace GlassBar;
+
+namespace {
+
+/// The original merge: a find_if over |base| per overlay node, matching
+/// kind and case-insensitive name (_wcsicmp, here the same folding the
+/// collation uses), then a sort of every level it touched. stable_sort
+/// stands in for std::sort so that equal keys keep a defined order; the
+/// old code left it unspecified.
+void LegacyMergeTree(std::vector<MenuNode>& base, std::vector<MenuNode>&& overlay) {
+    for (auto& oNode : overlay) {
+        auto it = std::find_if(base.begin(), base.end(), [&](const MenuNode& b) {
+            return b.isFolder == oNode.isFolder && CompareNodeNames(b.name, oNode.name) == 0;
+        });
+        if (it == base.end()) {
+            base.push_back(std::move(oNode));
+        } else if (oNode.isFolder && it->isFolder) {
+            LegacyMergeTree(it->children, std::move(oNode.children));
+        } else {
+            *it = std::move(oNode);  // user shortcut wins
+        }
+    }
+    std::stable_sort(base.begin(), base.end(), NodeLess);
+}
+
+// Case variants, shared 4-unit prefixes and a non-ASCII fold.
+const wchar_t* const kNames[] = {
+    L"App", L"APP", L"app", L"Tools", L"TOOLS", L"Zeta", L"abcdX", L"ABCDy", L"abcd",
+    L"Caf\u00E9", L"CAF\u00C9", L"Microsoft Office", L"microsoft office 2016", L"7-Zip",
+};
+
+struct TreeGen {
+    std::mt19937 rng;
+    unsigned     nextId = 0;
+
+    std::vector<MenuNode> Level(unsigned depth, size_t maxWidth) {
+        std::vector<MenuNode> level(rng() % (maxWidth + 1));
+        for (MenuNode& n : level) {
+            n.isFolder = depth > 0 && rng() % 3 == 0;
+            SetNodeName(n, kNames[rng() % (sizeof(kNames) / sizeof(kNames[0]))]);
+            n.target = n.isFolder ? std::wstring() : L"t" + std::to_wstring(nextId);
+            n.lnkPath = L"p" + std::to_wstring(nextId++);
+            if (n.isFolder) n.children = Level(depth - 1, maxWidth);
+        }
+        // Scanned levels arrive sorted; equal keys keep scan order.
+        std::stable_sort(level.begin(), level.end(), NodeLess);
+        return level;
+    }
+};
+
+bool SameTree(const std::vector<MenuNode>& a, const std::vector<MenuNode>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].name != b[i].name || a[i].isFolder != b[i].isFolder || a[i].target != b[i].target ||
+            a[i].lnkPath != b[i].lnkPath || a[i].sortKey != b[i].sortKey ||
+            !SameTree(a[i].children, b[i].children))
+            return false;
+    }
+    return true;
+}
+
+size_t CountNodes(const std::vector<MenuNode>& level) {
+    size_t n = level.size();
+    for (const MenuNode& node : level) n += CountNodes(node.children);
+    return n;
+}
+
+void CheckAgainstLegacy(unsigned seed, unsigned depth, size_t maxWidth, int trials) {
+    TreeGen gen{ std::mt19937(seed) };
+    size_t compared = 0;
+    for (int t = 0; t < trials; ++t) {
+        std::vector<MenuNode> base    = gen.Level(depth, maxWidth);
+        std::vector<MenuNode> overlay = gen.Level(depth, maxWidth);
+        std::vector<MenuNode> legacyBase = base, legacyOverlay = overlay;
+
+        MergeTree(base, std::move(overlay));
+        LegacyMergeTree(legacyBase, std::move(legacyOverlay));
+        if (!SameTree(base, legacyBase)) {
+            std::fprintf(stderr, "seed %u trial %d: merge differs from legacy\n", seed, t);
+            GB_CHECK(false);
+            return;
+        }
+        compared += CountNodes(base);
+    }
+    GB_CHECK(compared > 0);
+}
+
+} // namespace
+
+GB_TEST(MatchesLegacyOnNarrowDeepTrees) {
+    CheckAgainstLegacy(1, 4, 4, 3000);
+}
+
+GB_TEST(MatchesLegacyOnWideShallowTrees) {
+    CheckAgainstLegacy(2, 2, 40, 500);
+}
+
+GB_TEST(MatchesLegacyWithEmptySides) {
+    TreeGen gen{ std::mt19937(3) };
+    for (int t = 0; t < 200; ++t) {
+        std::vector<MenuNode> tree = gen.Level(3, 8);
+        std::vector<MenuNode> a = tree, b = tree, empty, legacyEmpty;
+        MergeTree(a, {});
+        LegacyMergeTree(b, {});
+        GB_CHECK(SameTree(a, b));
+        std::vector<MenuNode> copy = tree;
+        MergeTree(empty, std::move(tree));
+        LegacyMergeTree(legacyEmpty, std::move(copy));
+        GB_CHECK(SameTree(empty, legacyEmpty));
+    }
+}
@@ -0,0 +1,393 @@
+#include "ProgramTree.h"
+#include "MenuTree.h"
+#include "ProgramsCorpus.h"
+#include "TestHarness.h"
+
+#include <algorithm>
+#include <random>
+
+using namespace GlassBar;
+using namespace GlassBar::Test;
+
+namespace {
+
+MenuNode Leaf(const std::wstring& name, const std::wstring& target) {
+    MenuNode n;
+    n.isFolder = false;
+    SetNodeName(n, name);
+    n.target = target;
+    return n;
+}
+
+MenuNode Folder(const std::wstring& name, std::vector<MenuNode> children, bool pending = false) {
+    MenuNode n;
+    n.isFolder = true;
+    SetNodeName(n, name);
+    std::sort(children.begin(), children.end(), NodeLess);
+    n.children        = std::move(children);
+    n.childrenPending = pending;
+    return n;
+}
+
+bool SameTree(const std::vector<MenuNode>& a, const std::vector<MenuNode>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].name != b[i].name || a[i].isFolder != b[i].isFolder || a[i].target != b[i].target ||
+            a[i].args != b[i].args || a[i].lnkPath != b[i].lnkPath || a[i].sortKey != b[i].sortKey ||
+            a[i].childrenPending != b[i].childrenPending || !SameTree(a[i].children, b[i].children))
+            return false;
+    }
+    return true;
+}
+
+bool SortedEverywhere(const std::vector<MenuNode>& level) {
+    if (!std::is_sorted(level.begin(), level.end(), NodeLess)) return false;
+    return std::all_of(level.begin(), level.end(),
+                       [](const MenuNode& n) { return SortedEverywhere(n.children); });
+}
+
+void CollectLeaves(const std::vector<MenuNode>& level, std::vector<const MenuNode*>& out) {
+    for (const MenuNode& n : level) {
+        if (n.isFolder) CollectLeaves(n.children, out);
+        else            out.push_back(&n);
+    }
+}
+
+struct ScratchCorpus {
+    std::filesystem::path dir = MakeScratchDir("tree-test");
+    ~ScratchCorpus() { std::error_code ec; std::filesystem::remove_all(dir, ec); }
+};
+
+} // namespace
+
+// ── Collation ─────────────────────────────────────────────────────────────────
+
+GB_TEST(SortKeysOrderLikeFoldedNames) {
+    GB_CHECK(MakeNameSortKey(L"abc") < MakeNameSortKey(L"abd"));
+    GB_CHECK(MakeNameSortKey(L"ab") < MakeNameSortKey(L"abc"));
+    GB_CHECK(MakeNameSortKey(L"ABC") == MakeNameSortKey(L"abc"));
+    GB_CHECK(MakeNameSortKey(L"abcdX") == MakeNameSortKey(L"abcdY"));   // only 4 units
+    GB_CHECK(CompareNodeNames(L"Zoom", L"zoom") == 0);
+    GB_CHECK(CompareNodeNames(L"abcdX", L"abcdY") < 0);
+    GB_CHECK(CompareNodeNames(L"abc", L"ab") > 0);
+
+    const MenuNode folder = Folder(L"Zeta", {});
+    const MenuNode leaf   = Leaf(L"Alpha", L"a");
+    GB_CHECK(NodeLess(folder, leaf));                                   // folders first
+    GB_CHECK(NodeLess(Leaf(L"abcdA", L""), Leaf(L"ABCDb", L"")));       // tail decides
+    GB_CHECK(SameNodeKey(Leaf(L"Git Bash", L"x"), Leaf(L"git bash", L"y")));
+    GB_CHECK(!SameNodeKey(Folder(L"Git", {}), Leaf(L"Git", L"y")));
+}
+
+GB_TEST(ShortcutDisplayNames) {
+    GB_CHECK(ShortcutDisplayName(L"Git Bash.lnk") == L"Git Bash");
+    GB_CHECK(ShortcutDisplayName(L"Site.URL") == L"Site");
+    GB_CHECK(ShortcutDisplayName(L"a.b.lnk") == L"a.b");
+    GB_CHECK(ShortcutDisplayName(L"desktop.ini").empty());
+    GB_CHECK(ShortcutDisplayName(L".lnk").empty());
+    GB_CHECK(ShortcutDisplayName(L"lnk").empty());
+}
+
+GB_TEST(FsPathRoundTripsUnicodeNames) {
+    const std::wstring names[] = { L"Caf\u00E9 Tools", L"\u65E5\u672C\u8A9E.lnk", L"plain", L"" };
+    for (const std::wstring& name : names)
+        GB_CHECK_WSTR(FromFsPath(ToFsPath(name)), name);
+#if !defined(_WIN32)
+    GB_CHECK(ToFsPath(L"Caf\u00E9").native() == "Caf\xC3\xA9");
+    GB_CHECK_WSTR(FromFsPath(std::filesystem::path("bad\xFF")), L"bad\uFFFD");
+    GB_CHECK_WSTR(FromFsPath(std::filesystem::path("\xC0\xAF")), L"\uFFFD\uFFFD");   // overlong
+#endif
+}
+
+// ── MergeTree ─────────────────────────────────────────────────────────────────
+
+GB_TEST(MergeUserShortcutWinsAndFoldersCombine) {
+    std::vector<MenuNode> common;
+    common.push_back(Folder(L"Tools", { Leaf(L"A", L"common-a"), Leaf(L"B", L"common-b") }));
+    common.push_back(Leaf(L"Shared", L"common-shared"));
+    common.push_back(Leaf(L"OnlyCommon", L"c"));
+    std::sort(common.begin(), common.end(), NodeLess);
+
+    std::vector<MenuNode> user;
+    user.push_back(Folder(L"TOOLS", { Leaf(L"b", L"user-b"), Leaf(L"C", L"user-c") }));
+    user.push_back(Leaf(L"shared", L"user-shared"));
+    user.push_back(Folder(L"Lazy", {}, /*pending=*/true));
+    std::sort(user.begin(), user.end(), NodeLess);
+
+    MergeTree(common, std::move(user));
+    GB_CHECK(common.size() == 4);
+    GB_CHECK(SortedEverywhere(common));
+    GB_CHECK(common[0].name == L"Lazy" && common[0].childrenPending);
+    GB_CHECK(common[1].name == L"Tools" && common[1].children.size() == 3);
+    GB_CHECK(common[1].children[1].target == L"user-b");
+    GB_CHECK(common[3].name == L"shared" && common[3].target == L"user-shared");
+}
+
+GB_TEST(MergeKeepsBaseDuplicates) {
+    std::vector<MenuNode> common = { Leaf(L"App", L"lnk"), Leaf(L"app", L"url"), Leaf(L"Z", L"z") };
+    std::vector<MenuNode> user   = { Leaf(L"APP", L"user"), Leaf(L"New", L"n1"), Leaf(L"new", L"n2") };
+    MergeTree(common, std::move(user));
+    GB_CHECK(SortedEverywhere(common));
+    GB_CHECK(common.size() == 4);
+    GB_CHECK(common[0].target == L"user");   // first base "App" absorbed the overlay
+    GB_CHECK(common[1].target == L"url");    // second base duplicate kept
+    GB_CHECK(common[2].target == L"n2");     // overlay-only group: last entry wins
+}
+
+// ── Scan over a generated corpus ──────────────────────────────────────────────
+
+GB_TEST(CorpusScanMergesAsDocumented) {
+    ScratchCorpus scratch;
+    CorpusSpec spec;
+    spec.entries = 1500;
+    spec.seed    = 9;
+    const CorpusInfo info = WriteProgramsCorpus(scratch.dir, spec);
+    GB_CHECK(info.url > 0 && info.sharedLinks > 0 && info.sameStemUrls > 0 && info.ignored > 0);
+
+    const std::wstring dirs[2] = { FromFsPath(info.commonRoot), FromFsPath(info.userRoot) };
+    size_t shortcuts = 0;
+    bool   found     = false;
+    ScanStageTimes times;
+    const std::vector<MenuNode> tree =
+        ScanAndMerge(FileSystemScanBackend(), dirs, 1, shortcuts, found, false, &times);
+    GB_CHECK(found);
+    GB_CHECK(shortcuts == info.lnk + info.url + info.sharedLinks + info.sameStemUrls);
+    GB_CHECK(SortedEverywhere(tree));
+
+    // Shared shortcuts collapse to the user's copy; same-stem .url files stay.
+    std::vector<const MenuNode*> leaves;
+    CollectLeaves(tree, leaves);
+    GB_CHECK(leaves.size() == info.lnk + info.url + info.sameStemUrls);
+    const std::wstring userRoot = FromFsPath(info.userRoot);
+    size_t fromUser = 0, userTargets = 0;
+    for (const MenuNode* n : leaves) {
+        GB_CHECK(!n->target.empty());
+        if (n->lnkPath.compare(0, userRoot.size(), userRoot) == 0) ++fromUser;
+        if (n->target.size() > 9 && n->target.compare(n->target.size() - 9, 9, L" User.exe") == 0) {
+            ++userTargets;
+            GB_CHECK(n->lnkPath.compare(0, userRoot.size(), userRoot) == 0);
+        }
+    }
+    GB_CHECK(userTargets == info.sharedLinks);
+    GB_CHECK(fromUser >= info.sharedLinks);
+
+    // Any thread count gives the same tree.
+    for (unsigned threads : { 2u, 4u, 7u }) {
+        size_t n = 0;
+        const std::vector<MenuNode> again = ScanAndMerge(FileSystemScanBackend(), dirs, threads, n, found);
+        GB_CHECK(n == shortcuts);
+        GB_CHECK(SameTree(again, tree));
+    }
+
+    // The arena form holds the same tree.
+    MenuTree frozen;
+    frozen.Assign(tree);
+    GB_CHECK(SameTree(frozen.Thaw(), tree));
+}
+
+GB_TEST(ShallowScanLeavesFoldersPending) {
+    ScratchCorpus scratch;
+    CorpusSpec spec;
+    spec.entries = 300;
+    const CorpusInfo info = WriteProgramsCorpus(scratch.dir, spec);
+    const std::wstring dirs[2] = { FromFsPath(info.commonRoot), std::wstring() };
+    size_t shortcuts = 0;
+    bool   found     = false;
+    const std::vector<MenuNode> top =
+        ScanAndMerge(FileSystemScanBackend(), dirs, 3, shortcuts, found, /*shallow=*/true);
+    GB_CHECK(found && !top.empty());
+    for (const MenuNode& n : top) {
+        if (n.isFolder) GB_CHECK(n.childrenPending && n.children.empty());
+    }
+    const std::wstring none[2];
+    GB_CHECK(ScanAndMerge(FileSystemScanBackend(), none, 2, shortcuts, found).empty());
+    GB_CHECK(!found && shortcuts == 0);
+}
+
+// ── Patch ─────────────────────────────────────────────────────────────────────
+// After every change on disk the patched tree must equal a full rescan.
+
+namespace {
+
+struct PatchFixture {
+    ScratchCorpus         scratch;
+    std::filesystem::path root[2] = { scratch.dir / "Common", scratch.dir / "User" };
+    std::wstring          roots[2] = { FromFsPath(root[0]), FromFsPath(root[1]) };
+    std::vector<MenuNode> tree;
+    std::mt19937          rng{ 4 };
+
+    PatchFixture() {
+        std::filesystem::create_directories(root[0]);
+        std::filesystem::create_directories(root[1]);
+    }
+
+    std::vector<MenuNode> FullScan() const {
+        size_t shortcuts = 0;
+        bool   found     = false;
+        return ScanAndMerge(FileSystemScanBackend(), roots, 1, shortcuts, found);
+    }
+
+    /// |rel| uses '\\' like a change record.
+    std::filesystem::path OnDisk(int r, const std::wstring& rel) const {
+        std::filesystem::path p = root[r];
+        size_t pos = 0;
+        for (;;) {
+            const size_t slash = rel.find(L'\\', pos);
+            p /= ToFsPath(rel.substr(pos, slash - pos));
+            if (slash == std::wstring::npos) return p;
+            pos = slash + 1;
+        }
+    }
+
+    void Write(int r, const std::wstring& rel, const std::wstring& target) {
+        const std::filesystem::path p = OnDisk(r, rel);
+        std::filesystem::create_directories(p.parent_path());
+        Corpus::WriteFile(p, rel.size() > 4 && rel.compare(rel.size() - 4, 4, L".url") == 0
+                                 ? Corpus::UrlBytes(target, rng) : Corpus::LinkBytes(target, rng));
+    }
+
+    /// Apply |changes| to the tree and check it against a full rescan.
+    bool PatchMatchesRescan(const std::vector<ProgramTreeChange>& changes) {
+        PatchProgramTree(FileSystemScanBackend(), roots, tree, changes);
+        return SameTree(tree, FullScan());
+    }
+};
+
+} // namespace
+
+GB_TEST(PatchRemovingUserShortcutRestoresCommonOne) {
+    PatchFixture f;
+    for (const std::wstring dir : { L"", L"Vendor\\" }) {
+        f.Write(0, dir + L"App.lnk", L"Common App");
+        f.Write(1, dir + L"App.url", L"User App");
+        f.Write(0, dir + L"Other.lnk", L"Other");
+    }
+    f.tree = f.FullScan();
+
+    for (const std::wstring dir : { L"", L"Vendor\\" }) {
+        // The user's App.url hid the common App.lnk; once it goes, the common
+        // one is back.
+        std::filesystem::remove(f.OnDisk(1, dir + L"App.url"));
+        GB_CHECK(f.PatchMatchesRescan({ { ProgramTreeChange::Removed, dir + L"App.url" } }));
+        f.Write(1, dir + L"app.URL", L"User App 2");
+        GB_CHECK(f.PatchMatchesRescan({ { ProgramTreeChange::Added, dir + L"app.URL" } }));
+        std::filesystem::remove(f.OnDisk(0, dir + L"App.lnk"));
+        GB_CHECK(f.PatchMatchesRescan({ { ProgramTreeChange::Removed, dir + L"App.lnk" } }));
+        f.Write(0, dir + L"App.lnk", L"Common App 2");
+        GB_CHECK(f.PatchMatchesRescan({ { ProgramTreeChange::Added, dir + L"App.lnk" } }));
+    }
+}
+
+GB_TEST(PatchSameStemPairInOneRoot) {
+    PatchFixture f;
+    for (int r = 0; r < 2; ++r) {
+        f.Write(r, L"Tools\\Pair.lnk", L"Pair lnk");
+        f.Write(r, L"Tools\\Pair.url", L"Pair url");
+        f.Write(r, L"Tools\\Solo.lnk", L"Solo");
+    }
+    f.Write(1, L"Loose.lnk", L"Loose lnk");
+    f.Write(1, L"Loose.url", L"Loose url");
+    f.tree = f.FullScan();
+
+    // User-root pair: the merge shows one of the two; removing either leaves
+    // the other in view.
+    std::filesystem::remove(f.OnDisk(1, L"Loose.url"));
+    GB_CHECK(f.PatchMatchesRescan({ { ProgramTreeChange::Removed, L"Loose.url" } }));
+    f.Write(1, L"Loose.url", L"Loose url 2");
+    GB_CHECK(f.PatchMatchesRescan({ { ProgramTreeChange::Added, L"Loose.url" } }));
+    std::filesystem::remove(f.OnDisk(1, L"Loose.lnk"));
+    GB_CHECK(f.PatchMatchesRescan({ { ProgramTreeChange::Removed, L"Loose.lnk" } }));
+
+    // Pairs in both roots, one file at a time and then a whole batch.
+    const std::wstring order[] = { L"Tools\\Pair.url", L"Tools\\Pair.lnk" };
+    for (int r = 1; r >= 0; --r) {
+        for (const std::wstring& rel : order) {
+            std::filesystem::remove(f.OnDisk(r, rel));
+            GB_CHECK(f.PatchMatchesRescan({ { ProgramTreeChange::Removed, rel } }));
+        }
+    }
+    std::vector<ProgramTreeChange> batch;
+    for (int r = 0; r < 2; ++r) {
+        for (const std::wstring& rel : order) {
+            f.Write(r, rel, L"Again " + std::to_wstring(r));
+            batch.push_back({ ProgramTreeChange::Added, rel });
+            batch.push_back({ ProgramTreeChange::Modified, rel });
+        }
+    }
+    GB_CHECK(f.PatchMatchesRescan(batch));
+}
+
+GB_TEST(PatchRandomChangesMatchRescan) {
+    ScratchCorpus scratch;
+    CorpusSpec spec;
+    spec.entries = 600;
+    spec.seed    = 21;
+    const CorpusInfo info = WriteProgramsCorpus(scratch.dir, spec);
+    const std::filesystem::path root[2] = { info.commonRoot, info.userRoot };
+    const std::wstring roots[2] = { FromFsPath(info.commonRoot), FromFsPath(info.userRoot) };
+    auto fullScan = [&] {
+        size_t shortcuts = 0;
+        bool   found     = false;
+        return ScanAndMerge(FileSystemScanBackend(), roots, 1, shortcuts, found);
+    };
+    std::vector<MenuNode> tree = fullScan();
+
+    // Root-relative, '\\'-separated record path of a file on disk.
+    auto record = [&](int r, const std::filesystem::path& p) {
+        std::wstring rel;
+        for (const auto& part : std::filesystem::relative(p, root[r])) {
+            if (!rel.empty()) rel += L'\\';
+            rel += FromFsPath(part);
+        }
+        return rel;
+    };
+
+    std::mt19937 rng(33);
+    for (int round = 0; round < 12; ++round) {
+        // Every shortcut file in both roots, in a fixed order.
+        std::vector<std::pair<int, std::filesystem::path>> files;
+        for (int r = 0; r < 2; ++r)
+            for (const auto& e : std::filesystem::recursive_directory_iterator(root[r]))
+                if (e.is_regular_file() && !ShortcutDisplayName(FromFsPath(e.path().filename())).empty())
+                    files.emplace_back(r, e.path());
+        std::sort(files.begin(), files.end());
+
+        // Delete a few, give a few a twin in the other root or the other
+        // extension, and rewrite a few in place.
+        std::vector<ProgramTreeChange> changes;
+        for (int i = 0; i < 6 && !files.empty(); ++i) {
+            const auto& [r, path] = files[rng() % files.size()];
+            std::error_code ec;
+            switch (rng() % 3) {
+            case 0:
+                if (std::filesystem::remove(path, ec))
+                    changes.push_back({ ProgramTreeChange::Removed, record(r, path) });
+                break;
+            case 1: {
+                const int other = rng() % 2 ? 1 - r : r;
+                std::filesystem::path twin = root[other] / std::filesystem::relative(path, root[r]);
+                twin.replace_extension(twin.extension() == ".lnk" ? ".url" : ".lnk");
+                if (rng() % 2) twin.replace_extension(path.extension());
+                // Only into folders that exist: a new one in another letter
+                // case is a second folder on a case-sensitive disk.
+                if (twin == path || !std::filesystem::is_directory(twin.parent_path(), ec)) break;
+                Corpus::WriteFile(twin, twin.extension() == ".url" ? Corpus::UrlBytes(L"Twin", rng)
+                                                                   : Corpus::LinkBytes(L"Twin", rng));
+                changes.push_back({ ProgramTreeChange::Added, record(other, twin) });
+                break;
+            }
+            default:
+                if (std::filesystem::exists(path, ec)) {
+                    Corpus::WriteFile(path, path.extension() == ".url" ? Corpus::UrlBytes(L"Edit", rng)
+                                                                       : Corpus::LinkBytes(L"Edit", rng));
+                    changes.push_back({ ProgramTreeChange::Modified, record(r, path) });
+                }
+                break;
+            }
+        }
+        ProgramTreePatchStats stats;
+        PatchProgramTree(FileSystemScanBackend(), roots, tree, changes, false, &stats);
+        GB_CHECK(stats.folders == 0);
+        GB_CHECK(SameTree(tree, fullScan()));
+    }
+}
@@ -0,0 +1,170 @@
+#pragma once
+#include "ProgramTree.h"      // ToFsPath / FromFsPath
+#include "ShellLinkBuilder.h"
+#include "InternetShortcutBuilder.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace GlassBar::Test {
+
+// ── Synthetic Start Menu ──────────────────────────────────────────────────────
+// Writes a common and a user Programs root the way imaged machines look:
+// vendor folders with product subfolders, a few loose top-level shortcuts,
+// mostly .lnk with some .url, and the collisions the merge has to settle —
+// folders present in both roots (in another letter case), the same shortcut
+// in both roots (user wins), "App.lnk" beside "App.url" in one folder, plus
+// files the scan must skip (desktop.ini, hidden entries, other extensions).
+// Deterministic for a given spec. GenerateProgramsCorpus writes one to disk
+// for use with GLASSBAR_PROGRAMS_ROOTS on Windows.
+
+struct CorpusSpec {
+    size_t   entries  = 1000;   // shortcut files over both roots (100 to 50k)
+    unsigned seed     = 1;
+    unsigned maxDepth = 3;      // folder levels below a root
+};
+
+struct CorpusInfo {
+    std::filesystem::path commonRoot;
+    std::filesystem::path userRoot;
+    size_t lnk          = 0;
+    size_t url          = 0;
+    size_t folders      = 0;
+    size_t sharedLinks  = 0;    // shortcuts written to both roots
+    size_t sameStemUrls = 0;    // .url beside a same-name .lnk (common root only)
+    size_t ignored      = 0;    // files the scan skips
+};
+
+namespace Corpus {
+
+inline const wchar_t* const kVendors[] = {
+    L"Microsoft Office", L"Visual Studio", L"Adobe", L"JetBrains", L"Autodesk",
+    L"Steam", L"Git", L"Python", L"Node.js", L"Oracle", L"VMware", L"NVIDIA Corporation",
+    L"Intel", L"7-Zip", L"Mozilla", L"Google", L"Zoom", L"Dell", L"HP", L"Logitech",
+    L"Windows Kits", L"SQL Server Tools", L"Wireshark", L"Caf\u00E9 Tools",
+};
+inline const wchar_t* const kProducts[] = {
+    L"Studio", L"Reader", L"Designer", L"Manager", L"Console", L"Toolkit", L"Player",
+    L"Monitor", L"Profiler", L"Assistant", L"Client", L"Server", L"Analyzer", L"Editor",
+};
+inline const wchar_t* const kSuffixes[] = {
+    L"", L" 2022", L" (x64)", L" Uninstall", L" Help", L" Release Notes", L" Command Prompt",
+    L" Settings", L" Documentation", L" Safe Mode",
+};
+
+inline void WriteFile(const std::filesystem::path& path, const std::vector<std::uint8_t>& bytes) {
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    f.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+inline std::vector<std::uint8_t> LinkBytes(const std::wstring& name, std::mt19937& rng) {
+    LinkSpec spec;
+    spec.localBasePath = L"C:\\Program Files\\" + name + L"\\" + name + L".exe";
+    spec.workingDir    = L"C:\\Program Files\\" + name;
+    if (rng() % 3 == 0) spec.arguments    = L"--profile=" + std::to_wstring(rng() % 100);
+    if (rng() % 2 == 0) spec.iconLocation = L"C:\\Program Files\\" + name + L"\\app.ico";
+    if (rng() % 8 == 0) spec.envTarget    = L"%ProgramFiles%\\" + name + L"\\" + name + L".exe";
+    if (rng() % 4 == 0) spec.idList       = std::vector<std::uint8_t>(40 + rng() % 200, 0x11);
+    return BuildShellLink(spec);
+}
+
+inline std::vector<std::uint8_t> UrlBytes(const std::wstring& name, std::mt19937& rng) {
+    std::wstring slug;
+    for (wchar_t c : name) slug += (c == L' ' || c > 0x7E) ? L'-' : c;
+    const std::wstring url = rng() % 2 ? L"steam://rungameid/" + std::to_wstring(rng() % 2000000)
+                                       : L"https://www.example.com/" + slug;
+    return EncodeUrlFile(L"[InternetShortcut]\r\nURL=" + url + L"\r\nIconIndex=0\r\n",
+                         rng() % 5 == 0 ? UrlFileEncoding::Utf16Bom : UrlFileEncoding::Ansi);
+}
+
+} // namespace Corpus
+
+/// <summary>
+/// Write the corpus under |dir| (created; must not hold an older corpus) as
+/// |dir|/Common and |dir|/User.
+/// </summary>
+inline CorpusInfo WriteProgramsCorpus(const std::filesystem::path& dir, const CorpusSpec& spec) {
+    namespace fs = std::filesystem;
+    using namespace Corpus;
+    CorpusInfo info;
+    info.commonRoot = dir / "Common";
+    info.userRoot   = dir / "User";
+    fs::create_directories(info.commonRoot);
+    fs::create_directories(info.userRoot);
+
+    std::mt19937 rng(spec.seed);
+    auto pick = [&rng](const auto& list) {
+        return std::wstring(list[rng() % (sizeof(list) / sizeof(list[0]))]);
+    };
+    auto upper = [](std::wstring s) {
+        for (wchar_t& c : s) if (c >= L'a' && c <= L'z') c = static_cast<wchar_t>(c - 32);
+        return s;
+    };
+
+    // Each batch fills one leaf folder of a vendor tree with a few shortcuts.
+    size_t written = 0, batch = 0;
+    while (written < spec.entries) {
+        const bool user = rng() % 5 == 0;                   // ~20% in the user root
+        fs::path folder = user ? info.userRoot : info.commonRoot;
+        std::wstring vendor;
+        if (rng() % 20 != 0) {                              // ~5% loose at the top
+            vendor = pick(kVendors) + (rng() % 3 ? L"" : L" " + std::to_wstring(batch % 50));
+            folder /= ToFsPath(vendor);
+            for (unsigned depth = 1 + rng() % spec.maxDepth; depth > 1; --depth)
+                folder /= ToFsPath(pick(kProducts) + L" " + std::to_wstring(rng() % 4));
+        }
+        std::error_code ec;
+        if (fs::create_directories(folder, ec)) ++info.folders;
+
+        const size_t count = (std::min)(spec.entries - written, static_cast<size_t>(1 + rng() % 12));
+        for (size_t i = 0; i < count; ++i, ++written) {
+            const std::wstring name = (vendor.empty() ? pick(kProducts) : vendor) + L" " +
+                                      pick(kProducts) + pick(kSuffixes) + L" " + std::to_wstring(written);
+            if (rng() % 10 == 0) {
+                WriteFile(folder / ToFsPath(name + L".url"), UrlBytes(name, rng));
+                ++info.url;
+                continue;
+            }
+            WriteFile(folder / ToFsPath(name + L".lnk"), LinkBytes(name, rng));
+            ++info.lnk;
+
+            if (!user && rng() % 25 == 0) {
+                // Same folder (upper-cased) and shortcut in the user root.
+                const fs::path rel = fs::relative(folder, info.commonRoot);
+                fs::path mirror = info.userRoot;
+                for (const auto& part : rel) mirror /= ToFsPath(upper(FromFsPath(part)));
+                fs::create_directories(mirror, ec);
+                WriteFile(mirror / ToFsPath(name + L".lnk"), LinkBytes(name + L" User", rng));
+                ++info.sharedLinks;
+            } else if (!user && rng() % 40 == 0) {
+                WriteFile(folder / ToFsPath(name + L".url"), UrlBytes(name, rng));
+                ++info.sameStemUrls;
+            }
+        }
+
+        if (rng() % 15 == 0) {
+            WriteFile(folder / L"desktop.ini", { '[', '.', ']' });
+            WriteFile(folder / L".hidden.lnk", LinkBytes(L"Hidden", rng));
+            WriteFile(folder / L"Readme.txt", { 'h', 'i' });
+            info.ignored += 3;
+        }
+        ++batch;
+    }
+    return info;
+}
+
+/// A fresh, empty directory under the system temp directory.
+inline std::filesystem::path MakeScratchDir(const char* tag) {
+    std::random_device rd;
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() /
+        (std::string("glassbar-") + tag + "-" + std::to_string(rd()));
+    std::filesystem::create_directories(dir);
+    return dir;
+}
+
+} // namespace GlassBar::Test
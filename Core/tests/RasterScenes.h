@@ -0,0 +1,232 @@
+#pragma once
+#include "RasterSurface.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace GlassBar::Test {
+
+// ── Raster scenes ─────────────────────────────────────────────────────────────
+// Deterministic drawings for the RasterSurface golden images and frame-time
+// benchmark: one per primitive family, plus a mock Start Menu frame laid out
+// like StartMenuWindow's (list rows with icons and labels, hover highlight,
+// right column, search box, bottom bar). Glyphs and icons are synthetic so
+// nothing depends on a font or icon on the build machine.
+
+/// Coverage masks for printable ASCII: a glyph of each width with stems,
+/// bars and soft edges, so runs exercise opaque, partial and blank pixels.
+class SyntheticFont {
+public:
+    static constexpr int kHeight = 9;
+
+    SyntheticFont() {
+        for (int ch = 0x20; ch < 0x7F; ++ch) {
+            RasterGlyph& g = m_glyphs[ch];
+            g.height  = kHeight;
+            g.offsetY = -kHeight + 2;          // two rows of descender
+            g.width   = ch == ' ' ? 0 : 4 + ch % 4;
+            g.pitch   = g.width;
+            g.advance = ch == ' ' ? 4 : g.width + 1;
+            if (ch == ' ') continue;
+            std::vector<std::uint8_t>& mask = m_masks[ch];
+            mask.resize(static_cast<size_t>(g.width) * kHeight);
+            for (int y = 0; y < kHeight; ++y) {
+                for (int x = 0; x < g.width; ++x) {
+                    std::uint8_t c = 0;
+                    if (x == 0 || (ch & 1 && x == g.width - 1)) c = 255;           // stems
+                    else if (y == 2 + ch % 3 || (ch & 2 && y == kHeight - 3)) c = 255; // bars
+                    else if ((x + y + ch) % 5 == 0) c = 96;                         // soft edge
+                    mask[static_cast<size_t>(y) * g.width + x] = c;
+                }
+            }
+            g.coverage = mask.data();
+        }
+    }
+
+    std::vector<RasterGlyph> Shape(std::string_view text) const {
+        std::vector<RasterGlyph> run;
+        run.reserve(text.size());
+        for (char c : text)
+            run.push_back(m_glyphs[(c >= 0x20 && c < 0x7F) ? c : '?']);
+        return run;
+    }
+
+private:
+    std::array<RasterGlyph, 128>               m_glyphs{};
+    std::array<std::vector<std::uint8_t>, 128> m_masks;
+};
+
+/// A premultiplied |size|² icon: an anti-aliased disc in a color picked by
+/// |seed|, translucent towards the rim, on a clear background.
+inline std::vector<std::uint32_t> SyntheticIcon(int size, unsigned seed) {
+    std::vector<std::uint32_t> px(static_cast<size_t>(size) * size);
+    const std::uint8_t r = static_cast<std::uint8_t>(60 + seed * 37 % 180);
+    const std::uint8_t g = static_cast<std::uint8_t>(60 + seed * 71 % 180);
+    const std::uint8_t b = static_cast<std::uint8_t>(60 + seed * 113 % 180);
+    const float c = size * 0.5f, radius = size * 0.45f;
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            const float dx = x + 0.5f - c, dy = y + 0.5f - c;
+            const float d2 = (dx * dx + dy * dy) / (radius * radius);
+            const float edge = (radius - std::sqrt(dx * dx + dy * dy)) + 0.5f;
+            const float a = (edge <= 0.0f ? 0.0f : edge >= 1.0f ? 1.0f : edge) * (d2 < 0.5f ? 1.0f : 0.75f);
+            px[static_cast<size_t>(y) * size + x] =
+                RasterSurface::Color(r, g, b, static_cast<std::uint8_t>(a * 255.0f + 0.5f));
+        }
+    }
+    return px;
+}
+
+constexpr std::uint32_t kSceneBackground = RasterSurface::Color(240, 242, 245);
+
+/// Rounded rects, filled and stroked: radii from 0 to a pill, widths 1 to
+/// 3, opaque and translucent, overlapping and partly outside the image.
+inline void DrawShapesScene(RasterSurface& s) {
+    s.FillRect({ 0, 0, s.Width(), s.Height() }, kSceneBackground);
+    s.FillRoundRect({ 4, 4, 44, 30 }, 0, RasterSurface::Color(200, 40, 40));
+    s.FillRoundRect({ 50, 4, 90, 30 }, 4, RasterSurface::Color(40, 160, 60));
+    s.FillRoundRect({ 96, 4, 124, 32 }, 14, RasterSurface::Color(40, 80, 200));
+    s.FillRoundRect({ 4, 36, 64, 52 }, 99, RasterSurface::Color(120, 60, 160));
+    s.FillRoundRect({ 30, 40, 100, 80 }, 9, RasterSurface::Color(255, 200, 0, 128));
+    s.StrokeRoundRect({ 70, 36, 124, 60 }, 6, 1, RasterSurface::Color(20, 20, 20));
+    s.StrokeRoundRect({ 4, 60, 60, 92 }, 10, 3, RasterSurface::Color(0, 120, 215));
+    s.StrokeRoundRect({ 66, 66, 124, 92 }, 12, 2, RasterSurface::Color(0, 0, 0, 96));
+    s.StrokeRoundRect({ 110, 80, 150, 110 }, 8, 2, RasterSurface::Color(220, 0, 120));   // clipped
+    s.FillRoundRect({ -10, 84, 20, 110 }, 8, RasterSurface::Color(0, 160, 160, 200));   // clipped
+}
+
+/// Axis-aligned spans in both directions, diagonals and shallow slopes at
+/// widths 1 to 3, opaque and translucent.
+inline void DrawLinesScene(RasterSurface& s) {
+    s.FillRect({ 0, 0, s.Width(), s.Height() }, kSceneBackground);
+    const std::uint32_t ink = RasterSurface::Color(30, 30, 30);
+    s.DrawLine(4, 4, 124, 4, 1, ink);
+    s.DrawLine(124, 8, 4, 8, 1, ink);
+    s.DrawLine(4, 12, 4, 92, 1, ink);
+    s.DrawLine(8, 92, 8, 12, 1, ink);
+    for (int i = 0; i < 6; ++i) {
+        const int width = 1 + i % 3;
+        const std::uint32_t c = i < 3 ? RasterSurface::Color(0, 90, 200)
+                                      : RasterSurface::Color(200, 50, 0, 160);
+        s.DrawLine(16 + i * 12, 16, 40 + i * 14, 90, width, c);
+    }
+    s.DrawLine(20, 60, 124, 70, 1, ink);
+    s.DrawLine(124, 80, 20, 94, 2, RasterSurface::Color(0, 140, 70));
+    s.DrawLine(100, 16, 140, 56, 3, RasterSurface::Color(120, 0, 160, 200));   // clipped
+}
+
+/// Glyph runs in several colors (one translucent, one crossing the clip)
+/// and icons blended over them.
+inline void DrawTextIconsScene(RasterSurface& s, const SyntheticFont& font) {
+    s.FillRect({ 0, 0, s.Width(), s.Height() }, kSceneBackground);
+    const char* const lines[] = { "Microsoft Edge", "Visual Studio 2022", "Command Prompt (x64)" };
+    const std::uint32_t colors[] = { RasterSurface::Color(20, 20, 20), RasterSurface::Color(0, 84, 166),
+                                     RasterSurface::Color(0, 0, 0, 140) };
+    for (int i = 0; i < 3; ++i) {
+        const std::vector<RasterGlyph> run = font.Shape(lines[i]);
+        s.DrawGlyphRun(run.data(), run.size(), 24, 14 + i * 14, colors[i]);
+    }
+    for (int i = 0; i < 3; ++i) {
+        const std::vector<std::uint32_t> icon = SyntheticIcon(16, i + 1);
+        s.BlendImage(4, 3 + i * 14, icon.data(), 16, 16, 16);
+    }
+    const std::vector<std::uint32_t> big = SyntheticIcon(32, 7);
+    s.BlendImage(s.Width() - 24, s.Height() - 24, big.data(), 32, 32, 32);   // clipped
+}
+
+/// Row geometry of the mock menu, shared with the benchmark's partial redraw.
+struct MenuFrameLayout {
+    int width, height;
+    int divider;       // left column width
+    int rowHeight;
+    int rows;
+    int bottomBar;     // top of the bottom bar
+
+    explicit MenuFrameLayout(int w, int h)
+        : width(w), height(h), divider(w * 62 / 100), rowHeight((std::max)(h / 15, 14)),
+          rows((h - h / 6 - h / 12) / rowHeight), bottomBar(h - h / 12) {}
+
+    RasterRect Row(int i) const {
+        return { 4, 4 + i * rowHeight, divider - 4, 4 + (i + 1) * rowHeight };
+    }
+};
+
+/// Draw |text| with the clip narrowed to |box|, as the menu cuts labels at
+/// their column.
+inline void DrawLabel(RasterSurface& s, const SyntheticFont& font, std::string_view text,
+                      const RasterRect& box, int x, int baseline, std::uint32_t color) {
+    const RasterRect clip = s.Clip();
+    s.SetClip({ (std::max)(clip.left, box.left), (std::max)(clip.top, box.top),
+                (std::min)(clip.right, box.right), (std::min)(clip.bottom, box.bottom) });
+    const std::vector<RasterGlyph> run = font.Shape(text);
+    s.DrawGlyphRun(run.data(), run.size(), x, baseline, color);
+    s.SetClip(clip);
+}
+
+/// <summary>
+/// A Start Menu frame with the menu's own primitives: background and border,
+/// |layout.rows| program rows (icon + label), a translucent hover highlight
+/// on |hoverRow| (-1 for none), the column divider, right-column links, the
+/// search box and the bottom bar with its shut-down button and arrow.
+/// </summary>
+inline void DrawMenuFrame(RasterSurface& s, const MenuFrameLayout& layout, const SyntheticFont& font,
+                          const std::vector<std::vector<std::uint32_t>>& icons, int hoverRow) {
+    const std::uint32_t bg     = RasterSurface::Color(245, 246, 248);
+    const std::uint32_t right  = RasterSurface::Color(228, 232, 238);
+    const std::uint32_t border = RasterSurface::Color(160, 166, 176);
+    const std::uint32_t text   = RasterSurface::Color(24, 24, 24);
+    const int iconSize = layout.rowHeight - 6;
+
+    s.FillRect({ 0, 0, layout.width, layout.height }, bg);
+    s.FillRect({ layout.divider, 0, layout.width, layout.bottomBar }, right);
+    s.StrokeRoundRect({ 0, 0, layout.width, layout.height }, 6, 1, border);
+
+    static const char* const kLabels[] = {
+        "Microsoft Edge", "File Explorer", "Visual Studio 2022", "Windows Terminal", "Notepad",
+        "Paint", "Calculator", "Settings", "Command Prompt", "Git Bash", "Steam", "Zoom",
+    };
+    for (int i = 0; i < layout.rows; ++i) {
+        const RasterRect row = layout.Row(i);
+        if (i == hoverRow) {
+            s.FillRoundRect(row, 4, RasterSurface::Color(0, 120, 215, 56));
+            s.StrokeRoundRect(row, 4, 1, RasterSurface::Color(0, 120, 215, 140));
+        }
+        const std::vector<std::uint32_t>& icon = icons[static_cast<size_t>(i) % icons.size()];
+        s.BlendImage(row.left + 3, row.top + 3, icon.data(), iconSize, iconSize, iconSize);
+        DrawLabel(s, font, kLabels[i % 12], { row.left, row.top, row.right - 4, row.bottom },
+                  row.left + iconSize + 9, row.top + (layout.rowHeight + SyntheticFont::kHeight) / 2 - 2, text);
+    }
+    s.DrawLine(layout.divider, 6, layout.divider, layout.bottomBar - 6, 1, border);
+
+    static const char* const kLinks[] = { "Documents", "Pictures", "Music", "Computer",
+                                          "Control Panel", "Devices", "Help" };
+    for (int i = 0; i < 7; ++i) {
+        const int y = 16 + i * layout.rowHeight;
+        if (y + layout.rowHeight > layout.bottomBar) break;
+        DrawLabel(s, font, kLinks[i], { layout.divider + 1, y, layout.width - 6, y + layout.rowHeight },
+                  layout.divider + 10, y + SyntheticFont::kHeight, text);
+        if (i == 3) s.DrawLine(layout.divider + 8, y + layout.rowHeight - 4,
+                               layout.width - 8, y + layout.rowHeight - 4, 1, border);
+    }
+
+    const int searchTop = layout.bottomBar - layout.height / 12 - 4;
+    s.FillRoundRect({ 6, searchTop, layout.divider - 6, layout.bottomBar - 4 }, 8,
+                    RasterSurface::Color(255, 255, 255));
+    s.StrokeRoundRect({ 6, searchTop, layout.divider - 6, layout.bottomBar - 4 }, 8, 1, border);
+    DrawLabel(s, font, "Search programs and files", { 12, searchTop, layout.divider - 12, layout.bottomBar - 4 },
+              14, layout.bottomBar - 10, RasterSurface::Color(0, 0, 0, 110));
+
+    s.FillRect({ 1, layout.bottomBar, layout.width - 1, layout.height - 1 }, RasterSurface::Color(210, 216, 224));
+    const RasterRect button{ layout.width - 90, layout.bottomBar + 4, layout.width - 8, layout.height - 5 };
+    s.FillRoundRect(button, 3, RasterSurface::Color(0, 103, 192));
+    DrawLabel(s, font, "Shut down", { button.left, button.top, button.right - 16, button.bottom },
+              button.left + 6, button.bottom - 5, RasterSurface::Color(255, 255, 255));
+    s.DrawLine(button.right - 12, button.top + 6, button.right - 8, button.top + 10, 2, RasterSurface::Color(255, 255, 255));
+    s.DrawLine(button.right - 8, button.top + 10, button.right - 4, button.top + 6, 2, RasterSurface::Color(255, 255, 255));
+}
+
+} // namespace GlassBar::Test
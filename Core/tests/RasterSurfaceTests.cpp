@@ -0,0 +1,249 @@
+// Built twice, like IconAtlasTests: RasterSurfaceTests fills and blends with
+// SSE2 where the target has it, RasterSurfaceScalarTests against the
+// GLASSBAR_NO_SIMD library. Both compare against the same
+// golden images (tests/golden; see GoldenImage.h to regenerate them).
+
+#include "RasterSurface.h"
+#include "IconAtlas.h"
+#include "GoldenImage.h"
+#include "RasterScenes.h"
+#include "TestHarness.h"
+
+#include <random>
+
+using namespace GlassBar;
+using namespace GlassBar::Test;
+
+namespace {
+
+const char* const kGoldenDir = GLASSBAR_GOLDEN_DIR;
+
+template <typename Draw>
+Image Render(int width, int height, Draw&& draw) {
+    Image img;
+    img.width  = width;
+    img.height = height;
+    img.pixels.assign(static_cast<size_t>(width) * height, 0);
+    RasterSurface surface(img.pixels.data(), width, height, width);
+    draw(surface);
+    return img;
+}
+
+std::vector<std::vector<std::uint32_t>> MenuIcons(int size) {
+    std::vector<std::vector<std::uint32_t>> icons;
+    for (unsigned i = 0; i < 5; ++i) icons.push_back(SyntheticIcon(size, i + 1));
+    return icons;
+}
+
+/// One channel of the documented blend, computed in floating point.
+std::uint32_t ReferencePixel(std::uint32_t s, std::uint32_t d) {
+    const std::uint32_t alpha = s >> 24;
+    if (alpha == 0)   return d;
+    if (alpha == 255) return s;
+    std::uint32_t out = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        const double t = std::floor(((d >> shift) & 0xFF) * (255.0 - alpha) / 255.0 + 0.5);
+        out |= (std::min)(((s >> shift) & 0xFF) + static_cast<std::uint32_t>(t), 255u) << shift;
+    }
+    return out;
+}
+
+} // namespace
+
+// ── Golden images ─────────────────────────────────────────────────────────────
+
+GB_TEST(GoldenShapes) {
+    GB_CHECK(MatchesGolden(kGoldenDir, "shapes", Render(128, 96, DrawShapesScene)));
+}
+
+GB_TEST(GoldenLines) {
+    GB_CHECK(MatchesGolden(kGoldenDir, "lines", Render(128, 96, DrawLinesScene)));
+}
+
+GB_TEST(GoldenTextAndIcons) {
+    const SyntheticFont font;
+    GB_CHECK(MatchesGolden(kGoldenDir, "text_icons",
+                           Render(128, 48, [&](RasterSurface& s) { DrawTextIconsScene(s, font); })));
+}
+
+GB_TEST(GoldenMenuFrame) {
+    const SyntheticFont font;
+    const MenuFrameLayout layout(200, 260);
+    const auto icons = MenuIcons(layout.rowHeight - 6);
+    GB_CHECK(MatchesGolden(kGoldenDir, "menu_frame", Render(layout.width, layout.height, [&](RasterSurface& s) {
+        DrawMenuFrame(s, layout, font, icons, 2);
+    })));
+}
+
+// ── Properties ────────────────────────────────────────────────────────────────
+
+GB_TEST(ClippedRenderMatchesFullInsideAndLeavesOutside) {
+    const SyntheticFont font;
+    const MenuFrameLayout layout(400, 535);
+    const auto icons = MenuIcons(layout.rowHeight - 6);
+    const Image full = Render(layout.width, layout.height, [&](RasterSurface& s) {
+        DrawMenuFrame(s, layout, font, icons, 3);
+    });
+
+    const RasterRect clips[] = { layout.Row(3), { 37, 101, 311, 290 }, { 0, 0, 1, 1 },
+                                 { 390, 520, 999, 999 } };
+    const std::uint32_t sentinel = 0x12345678;
+    for (const RasterRect& clip : clips) {
+        Image part;
+        part.width  = layout.width;
+        part.height = layout.height;
+        part.pixels.assign(full.pixels.size(), sentinel);
+        RasterSurface s(part.pixels.data(), part.width, part.height, part.width);
+        s.SetClip(clip);
+        DrawMenuFrame(s, layout, font, icons, 3);
+        bool inside = true, outside = true;
+        for (int y = 0; y < layout.height; ++y) {
+            for (int x = 0; x < layout.width; ++x) {
+                const size_t i = static_cast<size_t>(y) * layout.width + x;
+                const bool in = x >= clip.left && x < clip.right && y >= clip.top && y < clip.bottom;
+                if (in && part.pixels[i] != full.pixels[i]) inside = false;
+                if (!in && part.pixels[i] != sentinel)      outside = false;
+            }
+        }
+        GB_CHECK(inside);
+        GB_CHECK(outside);
+    }
+}
+
+GB_TEST(TranslucentSpansMatchReferenceBlend) {
+    std::mt19937 rng(25);
+    std::vector<std::uint32_t> px(67), before;
+    for (int trial = 0; trial < 2000; ++trial) {
+        for (auto& p : px) p = 0xFF000000u | (rng() & 0xFFFFFF);
+        if (trial % 3 == 0) for (auto& p : px) p = RasterSurface::Color(rng() % 256, rng() % 256, rng() % 256, rng() % 256);
+        before = px;
+        const std::uint32_t color = RasterSurface::Color(rng() % 256, rng() % 256, rng() % 256, rng() % 256);
+        const int x0 = static_cast<int>(rng() % 20), x1 = x0 + static_cast<int>(rng() % 48);
+        RasterSurface s(px.data(), 67, 1, 67);
+        s.FillRect({ x0, 0, x1, 1 }, color);
+        bool ok = true;
+        for (int x = 0; x < 67; ++x) {
+            const std::uint32_t want = x >= x0 && x < x1 ? ReferencePixel(color, before[x]) : before[x];
+            if (px[x] != want) ok = false;
+        }
+        GB_CHECK(ok);
+        if (!ok) return;
+    }
+}
+
+GB_TEST(OpaqueFillStoresExactColorWithinEdges) {
+    std::vector<std::uint32_t> px(16 * 8, 0);
+    RasterSurface s(px.data(), 16, 8, 16);
+    s.FillRect({ 3, 2, 13, 6 }, 0xFF102030u);
+    for (int y = 0; y < 8; ++y)
+        for (int x = 0; x < 16; ++x)
+            GB_CHECK(px[static_cast<size_t>(y) * 16 + x] ==
+                     (x >= 3 && x < 13 && y >= 2 && y < 6 ? 0xFF102030u : 0u));
+
+    std::vector<std::uint32_t> round(px.size(), 0);
+    RasterSurface r(round.data(), 16, 8, 16);
+    r.FillRoundRect({ 3, 2, 13, 6 }, 0, 0xFF102030u);
+    GB_CHECK(round == px);
+}
+
+GB_TEST(RoundRectIsSymmetricAndCoversItsArea) {
+    std::vector<std::uint32_t> px(40 * 30, 0);
+    RasterSurface s(px.data(), 40, 30, 40);
+    s.FillRoundRect({ 5, 5, 35, 25 }, 7, 0xFFFFFFFFu);
+    double area = 0;
+    bool symmetric = true;
+    for (int y = 0; y < 30; ++y) {
+        for (int x = 0; x < 40; ++x) {
+            const std::uint32_t p = px[static_cast<size_t>(y) * 40 + x];
+            area += (p >> 24) / 255.0;
+            if (p != px[static_cast<size_t>(y) * 40 + (39 - x)] ||
+                p != px[static_cast<size_t>(29 - y) * 40 + x])
+                symmetric = false;
+        }
+    }
+    const double exact = 30.0 * 20.0 - (4.0 - 3.14159265358979) * 49.0;
+    GB_CHECK(symmetric);
+    GB_CHECK(std::fabs(area - exact) < 1.0);
+}
+
+GB_TEST(GlyphRunAdvancesAndSkipsBlankGlyphs) {
+    const SyntheticFont font;
+    const std::vector<RasterGlyph> run = font.Shape("a b");
+    std::vector<std::uint32_t> px(64 * 16, 0);
+    RasterSurface s(px.data(), 64, 16, 64);
+    const int end = s.DrawGlyphRun(run.data(), run.size(), 2, 12, 0xFF000000u);
+    GB_CHECK(end == 2 + run[0].advance + run[1].advance + run[2].advance);
+    // The space draws nothing: the columns between the two glyphs stay clear.
+    const int gapLeft = 2 + run[0].advance, gapRight = gapLeft + run[1].advance;
+    bool clear = true;
+    for (int y = 0; y < 16; ++y)
+        for (int x = gapLeft; x < gapRight; ++x)
+            if (px[static_cast<size_t>(y) * 64 + x] != 0) clear = false;
+    GB_CHECK(clear);
+}
+
+GB_TEST(GlyphLineAlignsCentresAndCutsForEllipsis) {
+    const SyntheticFont font;
+    const std::vector<RasterGlyph> run  = font.Shape("Control Panel");
+    const std::vector<RasterGlyph> dots = font.Shape("...");
+    int width = 0, dotsWidth = 0;
+    for (const RasterGlyph& g : run)  width += g.advance;
+    for (const RasterGlyph& g : dots) dotsWidth += g.advance;
+
+    // Wide enough: every glyph, placed like DrawTextW's DT_VCENTER.
+    const RasterRect box{ 10, 4, 10 + width + 20, 30 };
+    GlyphLine line = LayoutGlyphLine(run.data(), run.size(), box, 7, 2, GlyphAlign::Left,
+                                     dots.data(), dots.size());
+    GB_CHECK(line.x == 10 && line.count == run.size() && !line.ellipsis);
+    GB_CHECK(line.baseline == 4 + (26 - 9) / 2 + 7);
+    line = LayoutGlyphLine(run.data(), run.size(), box, 7, 2, GlyphAlign::Center);
+    GB_CHECK(line.x == 20);
+    line = LayoutGlyphLine(run.data(), run.size(), box, 7, 2, GlyphAlign::Right);
+    GB_CHECK(line.x == box.right - width);
+
+    // Too narrow: the glyphs kept plus the dots fit, one more would not.
+    const RasterRect narrow{ 0, 0, width - 10, 16 };
+    line = LayoutGlyphLine(run.data(), run.size(), narrow, 7, 2, GlyphAlign::Left,
+                           dots.data(), dots.size());
+    GB_CHECK(line.ellipsis && line.count < run.size());
+    int kept = 0;
+    for (size_t i = 0; i < line.count; ++i) kept += run[i].advance;
+    GB_CHECK(kept + dotsWidth <= narrow.right);
+    GB_CHECK(kept + run[line.count].advance + dotsWidth > narrow.right);
+
+    // Without an ellipsis run the line overflows instead.
+    line = LayoutGlyphLine(run.data(), run.size(), narrow, 7, 2, GlyphAlign::Right);
+    GB_CHECK(line.count == run.size() && !line.ellipsis && line.x == narrow.right - width);
+}
+
+GB_TEST(ClearAndMakeOpaqueStayInsideTheClip) {
+    std::vector<std::uint32_t> px(16 * 8, 0x00336699u);
+    RasterSurface s(px.data(), 16, 8, 16);
+    s.SetClip({ 2, 1, 12, 7 });
+    s.MakeOpaque({ 0, 0, 8, 8 });
+    s.Clear({ 8, 0, 16, 4 });
+    for (int y = 0; y < 8; ++y) {
+        for (int x = 0; x < 16; ++x) {
+            const bool inClip = x >= 2 && x < 12 && y >= 1 && y < 7;
+            std::uint32_t expected = 0x00336699u;
+            if (inClip && x < 8)           expected = 0xFF336699u;
+            else if (inClip && y < 4)      expected = 0;
+            GB_CHECK(px[static_cast<size_t>(y) * 16 + x] == expected);
+        }
+    }
+}
+
+GB_TEST(BlendImageMatchesBlendPremultiplied) {
+    std::mt19937 rng(7);
+    const std::vector<std::uint32_t> icon = SyntheticIcon(24, 3);
+    for (int trial = 0; trial < 200; ++trial) {
+        std::vector<std::uint32_t> a(50 * 40), b;
+        for (auto& p : a) p = 0xFF000000u | (rng() & 0xFFFFFF);
+        b = a;
+        const int x = static_cast<int>(rng() % 70) - 20, y = static_cast<int>(rng() % 60) - 20;
+        RasterSurface s(a.data(), 50, 40, 50);
+        s.BlendImage(x, y, icon.data(), 24, 24, 24);
+        BlendPremultiplied(b.data(), 50, 50, 40, x, y, icon.data(), 24, 24, 24);
+        GB_CHECK(a == b);
+    }
+}
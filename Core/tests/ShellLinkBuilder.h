@@ -0,0 +1,198 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace GlassBar::Test {
+
+// ── Shell link writer ─────────────────────────────────────────────────────────
+// Builds .lnk files byte by byte (MS-SHLLINK) for the ParseShellLink tests,
+// fuzzer and benchmark: header, optional ItemID list, LinkInfo with a local
+// or network base path (ANSI or Unicode), StringData and the environment
+// data blocks. Strings are UTF-16 code units held in std::wstring.
+
+struct LinkSpec {
+    // LinkInfo — written when either is set.
+    std::wstring localBasePath;
+    std::wstring netName;              // CommonNetworkRelativeLink
+    std::wstring commonPathSuffix;
+    bool         unicodeLinkInfo = true;   // also the *Unicode offsets
+    bool         forceNoLinkInfo = false;
+
+    // StringData.
+    std::wstring name;
+    std::wstring relativePath;
+    std::wstring workingDir;
+    std::wstring arguments;
+    std::wstring iconLocation;
+    bool         unicodeStrings = true;    // IsUnicode
+
+    // ExtraData.
+    std::wstring envTarget;            // EnvironmentVariableDataBlock (HasExpString)
+    std::wstring envIcon;              // IconEnvironmentDataBlock (HasExpIcon)
+
+    std::vector<std::uint8_t> idList;  // LinkTargetIDList payload, when non-empty
+    int          iconIndex = 0;
+    bool         darwin    = false;    // HasDarwinID (MSI advertised shortcut)
+};
+
+class ByteWriter {
+public:
+    std::vector<std::uint8_t> bytes;
+
+    size_t Size() const { return bytes.size(); }
+    void U8(std::uint8_t v) { bytes.push_back(v); }
+    void U16(std::uint16_t v) { U8(static_cast<std::uint8_t>(v)); U8(static_cast<std::uint8_t>(v >> 8)); }
+    void U32(std::uint32_t v) { U16(static_cast<std::uint16_t>(v)); U16(static_cast<std::uint16_t>(v >> 16)); }
+    void Zeros(size_t n) { bytes.insert(bytes.end(), n, 0); }
+    void Append(const std::vector<std::uint8_t>& v) { bytes.insert(bytes.end(), v.begin(), v.end()); }
+    void PutU32(size_t at, std::uint32_t v) {
+        for (int i = 0; i < 4; ++i) bytes[at + i] = static_cast<std::uint8_t>(v >> (8 * i));
+    }
+    void AsciiZ(const std::wstring& s) {
+        for (wchar_t c : s) U8(static_cast<std::uint8_t>(c));
+        U8(0);
+    }
+    void UnicodeZ(const std::wstring& s) {
+        for (wchar_t c : s) U16(static_cast<std::uint16_t>(c));
+        U16(0);
+    }
+    // NUL-padded fixed field of |chars| units (env blocks).
+    void UnicodeFixed(const std::wstring& s, size_t chars) {
+        for (size_t i = 0; i < chars; ++i)
+            U16(i < s.size() ? static_cast<std::uint16_t>(s[i]) : 0);
+    }
+    void AsciiFixed(const std::wstring& s, size_t chars) {
+        for (size_t i = 0; i < chars; ++i)
+            U8(i < s.size() ? static_cast<std::uint8_t>(s[i]) : 0);
+    }
+};
+
+inline void WriteLinkInfo(ByteWriter& w, const LinkSpec& spec) {
+    const size_t start  = w.Size();
+    const bool   wide   = spec.unicodeLinkInfo;
+    const bool   local  = !spec.localBasePath.empty();
+    const bool   net    = !spec.netName.empty();
+    const std::uint32_t hdrSize = wide ? 0x24 : 0x1C;
+
+    w.U32(0);                                   // LinkInfoSize, patched below
+    w.U32(hdrSize);
+    w.U32((local ? 0x1u : 0u) | (net ? 0x2u : 0u));
+    const size_t volumeAt = w.Size();  w.U32(0);
+    const size_t localAt  = w.Size();  w.U32(0);
+    const size_t netAt    = w.Size();  w.U32(0);
+    const size_t suffixAt = w.Size();  w.U32(0);
+    size_t localWAt = 0, suffixWAt = 0;
+    if (wide) {
+        localWAt  = w.Size();  w.U32(0);
+        suffixWAt = w.Size();  w.U32(0);
+    }
+    auto rel = [&]() { return static_cast<std::uint32_t>(w.Size() - start); };
+
+    if (local) {
+        w.PutU32(volumeAt, rel());              // minimal VolumeID, empty label
+        w.U32(0x11); w.U32(3); w.U32(0x1234); w.U32(0x10); w.U8(0);
+        w.PutU32(localAt, rel());
+        w.AsciiZ(wide ? std::wstring() : spec.localBasePath);
+    }
+    if (net) {
+        const size_t cnrl = w.Size();
+        w.PutU32(netAt, rel());
+        const std::uint32_t cnrlHdr = wide ? 0x1C : 0x14;
+        w.U32(0);                               // CommonNetworkRelativeLinkSize
+        w.U32(0);                               // flags
+        w.U32(cnrlHdr);                         // NetNameOffset (> 0x14: Unicode present)
+        w.U32(0);                               // DeviceNameOffset
+        w.U32(0);                               // NetworkProviderType
+        size_t netWAt = 0;
+        if (wide) {
+            netWAt = w.Size();  w.U32(0);       // NetNameOffsetUnicode
+            w.U32(0);                           // DeviceNameOffsetUnicode
+        }
+        w.AsciiZ(wide ? std::wstring() : spec.netName);
+        if (wide) {
+            w.PutU32(netWAt, static_cast<std::uint32_t>(w.Size() - cnrl));
+            w.UnicodeZ(spec.netName);
+        }
+        w.PutU32(cnrl, static_cast<std::uint32_t>(w.Size() - cnrl));
+    }
+    w.PutU32(suffixAt, rel());
+    w.AsciiZ(wide ? std::wstring() : spec.commonPathSuffix);
+    if (wide) {
+        if (local) {
+            w.PutU32(localWAt, rel());
+            w.UnicodeZ(spec.localBasePath);
+        }
+        w.PutU32(suffixWAt, rel());
+        w.UnicodeZ(spec.commonPathSuffix);
+    }
+    w.PutU32(start, rel());
+}
+
+inline std::vector<std::uint8_t> BuildShellLink(const LinkSpec& spec) {
+    const bool linkInfo = !spec.localBasePath.empty() || !spec.netName.empty();
+    std::uint32_t flags = 0;
+    if (!spec.idList.empty())       flags |= 0x0001;   // HasLinkTargetIDList
+    if (linkInfo)                   flags |= 0x0002;   // HasLinkInfo
+    if (!spec.name.empty())         flags |= 0x0004;
+    if (!spec.relativePath.empty()) flags |= 0x0008;
+    if (!spec.workingDir.empty())   flags |= 0x0010;
+    if (!spec.arguments.empty())    flags |= 0x0020;
+    if (!spec.iconLocation.empty()) flags |= 0x0040;
+    if (spec.unicodeStrings)        flags |= 0x0080;
+    if (spec.forceNoLinkInfo)       flags |= 0x0100;
+    if (!spec.envTarget.empty())    flags |= 0x0200;   // HasExpString
+    if (spec.darwin)                flags |= 0x1000;
+    if (!spec.envIcon.empty())      flags |= 0x4000;   // HasExpIcon
+
+    static const std::uint8_t kClsid[16] = {
+        0x01, 0x14, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x46,
+    };
+    ByteWriter w;
+    w.U32(0x4C);
+    w.bytes.insert(w.bytes.end(), kClsid, kClsid + 16);
+    w.U32(flags);
+    w.U32(0x20);                                // FileAttributes
+    w.Zeros(24);                                // Creation/Access/WriteTime
+    w.U32(0);                                   // FileSize
+    w.U32(static_cast<std::uint32_t>(spec.iconIndex));
+    w.U32(1);                                   // ShowCommand
+    w.U16(0);                                   // HotKey
+    w.Zeros(10);                                // Reserved1-3
+
+    if (!spec.idList.empty()) {
+        w.U16(static_cast<std::uint16_t>(spec.idList.size()));
+        w.Append(spec.idList);
+    }
+    if (linkInfo) WriteLinkInfo(w, spec);
+
+    auto counted = [&](const std::wstring& s) {
+        if (s.empty()) return;
+        w.U16(static_cast<std::uint16_t>(s.size()));
+        for (wchar_t c : s) {
+            if (spec.unicodeStrings) w.U16(static_cast<std::uint16_t>(c));
+            else                     w.U8(static_cast<std::uint8_t>(c));
+        }
+    };
+    counted(spec.name);
+    counted(spec.relativePath);
+    counted(spec.workingDir);
+    counted(spec.arguments);
+    counted(spec.iconLocation);
+
+    auto envBlock = [&](std::uint32_t signature, const std::wstring& value) {
+        if (value.empty()) return;
+        w.U32(0x314);
+        w.U32(signature);
+        w.AsciiFixed(value, 260);
+        w.UnicodeFixed(value, 260);
+    };
+    envBlock(0xA0000001, spec.envTarget);
+    envBlock(0xA0000007, spec.envIcon);
+    w.U32(0);                                   // TerminalBlock
+    return w.bytes;
+}
+
+} // namespace GlassBar::Test
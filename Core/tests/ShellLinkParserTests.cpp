@@ -0,0 +1,198 @@
+#include "ShellLinkParser.h"
+#include "ShellLinkBuilder.h"
+#include "TestHarness.h"
+
+using namespace GlassBar;
+using namespace GlassBar::Test;
+
+namespace {
+
+bool Parse(const std::vector<std::uint8_t>& bytes, ShellLinkInfo& info) {
+    return ParseShellLink(bytes.data(), bytes.size(), info);
+}
+
+} // namespace
+
+// ── Targets ───────────────────────────────────────────────────────────────────
+
+GB_TEST(UnicodeLocalPathWithStrings) {
+    LinkSpec spec;
+    spec.localBasePath = L"C:\\Program Files\\App\\app.exe";
+    spec.workingDir    = L"C:\\Program Files\\App";
+    spec.arguments     = L"--flag \"quoted arg\"";
+    spec.iconLocation  = L"C:\\Program Files\\App\\app.ico";
+    spec.iconIndex     = -3;
+    ShellLinkInfo info;
+    GB_CHECK(Parse(BuildShellLink(spec), info));
+    GB_CHECK_WSTR(info.target, L"C:\\Program Files\\App\\app.exe");
+    GB_CHECK_WSTR(info.workingDir, L"C:\\Program Files\\App");
+    GB_CHECK_WSTR(info.arguments, L"--flag \"quoted arg\"");
+    GB_CHECK_WSTR(info.iconLocation, L"C:\\Program Files\\App\\app.ico");
+    GB_CHECK(info.iconIndex == -3);
+}
+
+GB_TEST(AnsiLocalPathJoinsSuffix) {
+    LinkSpec spec;
+    spec.unicodeLinkInfo  = false;
+    spec.localBasePath    = L"D:\\Tools";
+    spec.commonPathSuffix = L"bin\\tool.exe";
+    ShellLinkInfo info;
+    GB_CHECK(Parse(BuildShellLink(spec), info));
+    GB_CHECK_WSTR(info.target, L"D:\\Tools\\bin\\tool.exe");
+
+    spec.localBasePath = L"D:\\";   // no second separator
+    GB_CHECK(Parse(BuildShellLink(spec), info));
+    GB_CHECK_WSTR(info.target, L"D:\\bin\\tool.exe");
+}
+
+GB_TEST(NetworkPath) {
+    LinkSpec spec;
+    spec.netName          = L"\\\\server\\share";
+    spec.commonPathSuffix = L"setup.exe";
+    ShellLinkInfo info;
+    GB_CHECK(Parse(BuildShellLink(spec), info));
+    GB_CHECK_WSTR(info.target, L"\\\\server\\share\\setup.exe");
+
+    spec.unicodeLinkInfo = false;
+    GB_CHECK(Parse(BuildShellLink(spec), info));
+    GB_CHECK_WSTR(info.target, L"\\\\server\\share\\setup.exe");
+}
+
+GB_TEST(LocalPathWinsOverNetwork) {
+    LinkSpec spec;
+    spec.localBasePath = L"C:\\local.exe";
+    spec.netName       = L"\\\\server\\share";
+    ShellLinkInfo info;
+    GB_CHECK(Parse(BuildShellLink(spec), info));
+    GB_CHECK_WSTR(info.target, L"C:\\local.exe");
+}
+
+GB_TEST(EnvironmentTargetWins) {
+    LinkSpec spec;
+    spec.localBasePath = L"C:\\Windows\\System32\\notepad.exe";
+    spec.envTarget     = L"%windir%\\system32\\notepad.exe";
+    ShellLinkInfo info;
+    GB_CHECK(Parse(BuildShellLink(spec), info));
+    GB_CHECK_WSTR(info.target, L"%windir%\\system32\\notepad.exe");
+
+    // ForceNoLinkInfo: the LinkInfo is skipped unread.
+    spec.forceNoLinkInfo = true;
+    spec.localBasePath   = L"C:\\ignored.exe";
+    GB_CHECK(Parse(BuildShellLink(spec), info));
+    GB_CHECK_WSTR(info.target, L"%windir%\\system32\\notepad.exe");
+}
+
+GB_TEST(IconEnvironmentBlockReplacesIconLocation) {
+    LinkSpec spec;
+    spec.localBasePath = L"C:\\app.exe";
+    spec.iconLocation  = L"C:\\Users\\me\\app.ico";
+    spec.envIcon       = L"%USERPROFILE%\\app.ico";
+    ShellLinkInfo info;
+    GB_CHECK(Parse(BuildShellLink(spec), info));
+    GB_CHECK_WSTR(info.iconLocation, L"%USERPROFILE%\\app.ico");
+}
+
+GB_TEST(ItemIdListIsSkipped) {
+    LinkSpec spec;
+    spec.idList        = std::vector<std::uint8_t>(40, 0xAB);
+    spec.localBasePath = L"C:\\app.exe";
+    spec.name          = L"Description";
+    spec.relativePath  = L"..\\app.exe";
+    spec.arguments     = L"-x";
+    ShellLinkInfo info;
+    GB_CHECK(Parse(BuildShellLink(spec), info));
+    GB_CHECK_WSTR(info.target, L"C:\\app.exe");
+    GB_CHECK_WSTR(info.arguments, L"-x");
+}
+
+GB_TEST(AnsiStringData) {
+    LinkSpec spec;
+    spec.localBasePath  = L"C:\\app.exe";
+    spec.unicodeStrings = false;
+    spec.arguments      = L"/quiet";
+    ShellLinkInfo info;
+    GB_CHECK(Parse(BuildShellLink(spec), info));
+    GB_CHECK_WSTR(info.arguments, L"/quiet");
+}
+
+// ── Declined links (IShellLinkW fallback) ─────────────────────────────────────
+
+GB_TEST(DarwinLinkDeclined) {
+    LinkSpec spec;
+    spec.localBasePath = L"C:\\app.exe";
+    spec.darwin        = true;
+    ShellLinkInfo info;
+    GB_CHECK(!Parse(BuildShellLink(spec), info));
+}
+
+GB_TEST(IdListOnlyDeclined) {
+    LinkSpec spec;
+    spec.idList = std::vector<std::uint8_t>(20, 0x01);
+    ShellLinkInfo info;
+    GB_CHECK(!Parse(BuildShellLink(spec), info));
+}
+
+GB_TEST(NonAsciiAnsiDeclined) {
+    LinkSpec spec;
+    spec.unicodeLinkInfo = false;
+    spec.localBasePath   = L"C:\\Caf\u00E9\\app.exe";   // written as byte 0xE9
+    ShellLinkInfo info;
+    GB_CHECK(!Parse(BuildShellLink(spec), info));
+
+    LinkSpec strings;
+    strings.localBasePath  = L"C:\\app.exe";
+    strings.unicodeStrings = false;
+    strings.arguments      = L"\u00FC";
+    GB_CHECK(!Parse(BuildShellLink(strings), info));
+}
+
+GB_TEST(BadHeaderDeclined) {
+    LinkSpec spec;
+    spec.localBasePath = L"C:\\app.exe";
+    std::vector<std::uint8_t> bytes = BuildShellLink(spec);
+    ShellLinkInfo info;
+
+    std::vector<std::uint8_t> badSize = bytes;
+    badSize[0] = 0x4D;
+    GB_CHECK(!Parse(badSize, info));
+
+    std::vector<std::uint8_t> badClsid = bytes;
+    badClsid[4] ^= 0xFF;
+    GB_CHECK(!Parse(badClsid, info));
+
+    GB_CHECK(!ParseShellLink(nullptr, 0, info));
+}
+
+GB_TEST(TruncatedLinksNeverReadPastTheEnd) {
+    LinkSpec spec;
+    spec.idList        = std::vector<std::uint8_t>(12, 0x02);
+    spec.netName       = L"\\\\server\\share";
+    spec.commonPathSuffix = L"x.exe";
+    spec.arguments     = L"-a -b -c";
+    spec.iconLocation  = L"x.ico";
+    spec.envIcon       = L"%x%\\x.ico";
+    const std::vector<std::uint8_t> full = BuildShellLink(spec);
+    ShellLinkInfo info;
+    GB_CHECK(Parse(full, info));
+    // Each prefix in its own allocation, so a sanitizer sees any overread.
+    for (size_t n = 0; n < full.size(); ++n) {
+        std::vector<std::uint8_t> prefix(full.begin(), full.begin() + n);
+        const bool ok = ParseShellLink(prefix.data(), prefix.size(), info);
+        if (n < 0x4C) GB_CHECK(!ok);
+    }
+}
+
+GB_TEST(OutputIsResetBetweenCalls) {
+    LinkSpec spec;
+    spec.localBasePath = L"C:\\a.exe";
+    spec.arguments     = L"-a";
+    ShellLinkInfo info;
+    GB_CHECK(Parse(BuildShellLink(spec), info));
+
+    LinkSpec bare;
+    bare.localBasePath = L"C:\\b.exe";
+    GB_CHECK(Parse(BuildShellLink(bare), info));
+    GB_CHECK_WSTR(info.target, L"C:\\b.exe");
+    GB_CHECK(info.arguments.empty());
+    GB_CHECK(info.iconIndex == 0);
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace GlassBar::Test {
+
+// ── Minimal test harness ──────────────────────────────────────────────────────
+// Self-registering cases and non-fatal checks, so the portable tests need no
+// third-party framework. TestMain.cpp runs every case (or those whose name
+// contains argv[1]) and exits non-zero if any check failed.
+
+struct Case {
+    const char* name;
+    void      (*run)();
+};
+
+inline std::vector<Case>& Cases() {
+    static std::vector<Case> cases;
+    return cases;
+}
+
+inline int& FailureCount() {
+    static int failures = 0;
+    return failures;
+}
+
+struct Registrar {
+    Registrar(const char* name, void (*run)()) { Cases().push_back({ name, run }); }
+};
+
+inline void ReportFailure(const char* file, int line, const char* what) {
+    ++FailureCount();
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what);
+}
+
+/// Printable form of a UTF-16 string for failure messages (non-ASCII as \uXXXX).
+inline std::string Printable(const std::wstring& s) {
+    std::string out;
+    for (wchar_t c : s) {
+        if (c >= 0x20 && c < 0x7F) {
+            out.push_back(static_cast<char>(c));
+        } else {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04X", static_cast<unsigned>(c) & 0xFFFF);
+            out += buf;
+        }
+    }
+    return out;
+}
+
+} // namespace GlassBar::Test
+
+#define GB_TEST(name)                                                          \
+    static void name();                                                        \
+    static ::GlassBar::Test::Registrar name##Registrar(#name, &name);          \
+    static void name()
+
+#define GB_CHECK(expr)                                                         \
+    do {                                                                       \
+        if (!(expr)) ::GlassBar::Test::ReportFailure(__FILE__, __LINE__, #expr); \
+    } while (0)
+
+/// Equality of two std::wstring values; both are printed on failure.
+#define GB_CHECK_WSTR(actual, expected)                                        \
+    do {                                                                       \
+        const std::wstring gbActual_(actual), gbExpected_(expected);           \
+        if (gbActual_ != gbExpected_) {                                        \
+            const std::string gbWhat_ = std::string(#actual) + " == \"" +      \
+                ::GlassBar::Test::Printable(gbActual_) + "\", expected \"" +   \
+                ::GlassBar::Test::Printable(gbExpected_) + "\"";               \
+            ::GlassBar::Test::ReportFailure(__FILE__, __LINE__, gbWhat_.c_str()); \
+        }                                                                      \
+    } while (0)
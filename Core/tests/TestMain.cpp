@@ -0,0 +1,19 @@
+#include "TestHarness.h"
+
+#include <cstring>
+
+int main(int argc, char** argv) {
+    using namespace GlassBar::Test;
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+
+    int run = 0;
+    for (const Case& c : Cases()) {
+        if (filter && !std::strstr(c.name, filter)) continue;
+        const int before = FailureCount();
+        c.run();
+        ++run;
+        std::printf("[%s] %s\n", FailureCount() == before ? "  ok  " : " FAIL ", c.name);
+    }
+    std::printf("%d case(s), %d failed check(s)\n", run, FailureCount());
+    return FailureCount() == 0 && run > 0 ? 0 : 1;
+}
@@ -0,0 +1,214 @@
+#include "UserAssist.h"
+#include "NameFold.h"
+#include "TestHarness.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+using namespace GlassBar;
+using namespace GlassBar::Test;
+
+namespace {
+
+std::wstring Rot13(std::wstring s) {
+    Rot13InPlace(s.data(), s.size());
+    return s;
+}
+
+/// A Windows 7+ Count value: 72 bytes, run count at 4, FILETIME at 16.
+std::vector<std::uint8_t> CountData(std::uint32_t runCount, std::uint64_t lastRun, size_t size = 72) {
+    std::vector<std::uint8_t> data(size, 0);
+    if (size >= 8)  std::memcpy(data.data() + 4, &runCount, sizeof(runCount));
+    if (size >= 24) std::memcpy(data.data() + 16, &lastRun, sizeof(lastRun));
+    return data;
+}
+
+bool Decode(const std::wstring& encoded, const std::vector<std::uint8_t>& data, UserAssistRecord& out) {
+    return DecodeUserAssistValue(encoded, data.data(), data.size(), out);
+}
+
+constexpr std::uint64_t kTicks2024 = 133485408000000000ull;   // 2024-01-01
+
+} // namespace
+
+// ── ROT13 ─────────────────────────────────────────────────────────────────────
+
+GB_TEST(Rot13KnownValues) {
+    // Explorer's own encoding of FOLDERID_System\notepad.exe.
+    GB_CHECK_WSTR(Rot13(L"{1NP14R77-02R7-4R5Q-O744-2RO1NR5198O7}\\abgrcnq.rkr"),
+                  L"{1AC14E77-02E7-4E5D-B744-2EB1AE5198B7}\\notepad.exe");
+    GB_CHECK_WSTR(Rot13(L"HRZR_PGYFRFFVBA"), L"UEME_CTLSESSION");
+    GB_CHECK_WSTR(Rot13(L"@AZ[`az{"), L"@NM[`nm{");
+    GB_CHECK_WSTR(Rot13(L""), L"");
+}
+
+GB_TEST(Rot13EveryUnitAtEveryOffset) {
+    // Each unit at each position of buffers up to 40 long, so the vector
+    // loop and the scalar tail both see every value.
+    static const unsigned kWrapUnits[] = { 0x80, 0xC1, 0xE9, 0x100, 0x141, 0x7FFF, 0x8041, 0xFF21, 0xFF41, 0xFFE1, 0xFFFF };
+    std::vector<unsigned> units;
+    for (unsigned c = 0; c < 128; ++c) units.push_back(c);
+    units.insert(units.end(), std::begin(kWrapUnits), std::end(kWrapUnits));
+
+    for (size_t n = 1; n <= 40; ++n) {
+        for (unsigned u : units) {
+            const size_t at = (u * 7 + n) % n;
+            std::wstring s(n, L'm');
+            s[at] = static_cast<wchar_t>(u);
+            const std::wstring r = Rot13(s);
+            wchar_t expected = static_cast<wchar_t>(u);
+            if (u >= 'a' && u <= 'z') expected = static_cast<wchar_t>('a' + (u - 'a' + 13) % 26);
+            if (u >= 'A' && u <= 'Z') expected = static_cast<wchar_t>('A' + (u - 'A' + 13) % 26);
+            if (r[at] != expected || r[(at + 1) % n] != (n == 1 ? expected : L'z')) {
+                GB_CHECK(!"rot13 mismatch");
+                std::printf("  n=%zu unit=U+%04X\n", n, u);
+                return;
+            }
+            GB_CHECK(Rot13(r) == s);
+        }
+    }
+}
+
+// ── Paths ─────────────────────────────────────────────────────────────────────
+
+GB_TEST(ProgramPaths) {
+    GB_CHECK(IsProgramPath(L"C:\\a.exe"));
+    GB_CHECK(IsProgramPath(L"A.EXE"));
+    GB_CHECK(IsProgramPath(L"x.Lnk"));
+    GB_CHECK(!IsProgramPath(L".exe"));       // the extension alone is no program
+    GB_CHECK(!IsProgramPath(L"a.exe.txt"));
+    GB_CHECK(!IsProgramPath(L"Microsoft.Windows.Explorer"));
+    GB_CHECK(!IsProgramPath(L""));
+
+    std::wstring name = L"Paint.EXE";
+    TrimProgramExtension(name);
+    GB_CHECK_WSTR(name, L"Paint");
+    name = L"Paint.png";
+    TrimProgramExtension(name);
+    GB_CHECK_WSTR(name, L"Paint.png");
+}
+
+// ── Count values ──────────────────────────────────────────────────────────────
+
+GB_TEST(DecodeWindows7Record) {
+    UserAssistRecord rec;
+    GB_CHECK(Decode(L"{1NP14R77-02R7-4R5Q-O744-2RO1NR5198O7}\\abgrcnq.rkr", CountData(5, kTicks2024), rec));
+    GB_CHECK_WSTR(rec.path, L"{1AC14E77-02E7-4E5D-B744-2EB1AE5198B7}\\notepad.exe");
+    GB_CHECK(rec.runCount == 5);
+    GB_CHECK(rec.lastRunTicks == kTicks2024);
+
+    // The minimum size holds the time; bytes past it do not matter.
+    GB_CHECK(Decode(L"P:\\n.rkr", CountData(1, 42, kUserAssistMinData), rec));
+    GB_CHECK(rec.lastRunTicks == 42);
+    GB_CHECK(!Decode(L"P:\\n.rkr", CountData(1, 42, kUserAssistMinData - 1), rec));
+    GB_CHECK(!DecodeUserAssistValue(L"P:\\n.rkr", nullptr, 72, rec));
+}
+
+GB_TEST(DecodeSkipsBookkeepingAndNonPrograms) {
+    UserAssistRecord rec;
+    GB_CHECK(!Decode(L"P:\\n.rkr", CountData(0, kTicks2024), rec));               // never run
+    GB_CHECK(!Decode(L"HRZR_PGYFRFFVBA", CountData(3, kTicks2024), rec));          // UEME_CTLSESSION
+    GB_CHECK(!Decode(L"HRZR_EHACNGU:p:\\n.rkr", CountData(3, kTicks2024), rec));   // UEME_RUNPATH:...
+    GB_CHECK(!Decode(L"Zvpebfbsg.Jvaqbjf.Rkcybere", CountData(3, kTicks2024), rec)); // AppUserModelID
+    GB_CHECK(!Decode(L"P:\\ernqzr.gkg", CountData(3, kTicks2024), rec));           // .txt
+    GB_CHECK(!Decode(L"", CountData(3, kTicks2024), rec));
+}
+
+GB_TEST(DecodeCutsAtEmbeddedNul) {
+    UserAssistRecord rec;
+    const std::wstring name(L"P:\\n.rkr\0Jvaqbj gvgyr", 21);
+    GB_CHECK(Decode(name, CountData(2, 1), rec));
+    GB_CHECK_WSTR(rec.path, L"C:\\a.exe");
+    GB_CHECK(!Decode(std::wstring(L"\0P:\\n.rkr", 9), CountData(2, 1), rec));
+}
+
+// ── RecentCandidates ──────────────────────────────────────────────────────────
+
+GB_TEST(CandidatesComeOutInFullSortOrder) {
+    std::mt19937 rng(3);
+    for (size_t count : { 0u, 1u, 15u, 16u, 17u, 100u, 1000u }) {
+        RecentCandidates set;
+        set.Reserve(count);
+        std::vector<std::pair<double, std::wstring>> expected;
+        for (size_t i = 0; i < count; ++i) {
+            UserAssistRecord rec;
+            rec.path         = L"C:\\app" + std::to_wstring(i) + L".exe";
+            rec.runCount     = 1 + rng() % 40;
+            // Coarse times, so equal ranks occur and the path breaks the tie.
+            rec.lastRunTicks = kTicks2024 + (rng() % 8) * 864000000000ull;
+            set.Add(rec);
+            expected.emplace_back(FrecencyStore::RankFromUserAssist(rec.lastRunTicks, rec.runCount), rec.path);
+        }
+        std::sort(expected.begin(), expected.end(), [](const auto& a, const auto& b) {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        });
+        GB_CHECK(set.Size() == count);
+        for (const auto& e : expected) {
+            const RecentCandidates::Candidate* c = set.Next();
+            GB_CHECK(c != nullptr);
+            if (!c) return;
+            GB_CHECK(c->rank == e.first);
+            GB_CHECK_WSTR(std::wstring(c->path), e.second);
+            GB_CHECK(c->path.data()[c->path.size()] == L'\0');
+        }
+        GB_CHECK(set.Next() == nullptr);
+    }
+}
+
+GB_TEST(CandidatesCombinePerTarget) {
+    RecentCandidates set;
+    UserAssistRecord a;
+    a.path = L"C:\\Tools\\App.exe";  a.runCount = 3;  a.lastRunTicks = kTicks2024;
+    UserAssistRecord b = a;
+    b.path = L"c:\\tools\\app.EXE";  b.runCount = 4;  b.lastRunTicks = kTicks2024 + 10;
+    set.Add(a);
+    set.Add(b);
+    GB_CHECK(set.Size() == 1);
+
+    FrecencyStore::Entry launches{ FrecencyStore::KeyOf(a.path), FrecencyStore::RankFromUsage(kTicks2024, 2), a.path };
+    set.AddLaunches(launches);
+    FrecencyStore::Entry doc{ FrecencyStore::KeyOf(L"C:\\doc.txt"), 100.0, L"C:\\doc.txt" };
+    set.AddLaunches(doc);                           // not a program, not known: skipped
+    FrecencyStore::Entry menuOnly{ FrecencyStore::KeyOf(L"C:\\menu.lnk"), -100.0, L"C:\\menu.lnk" };
+    set.AddLaunches(menuOnly);
+    GB_CHECK(set.Size() == 2);
+
+    const RecentCandidates::Candidate* c = set.Next();
+    GB_CHECK(c && c->runCount == 7 && c->lastRunTicks == kTicks2024 + 10);
+    GB_CHECK(c && std::wstring(c->path) == a.path);  // first spelling kept
+    const double combined = FrecencyStore::Combine(
+        FrecencyStore::Combine(FrecencyStore::RankFromUserAssist(a.lastRunTicks, a.runCount),
+                               FrecencyStore::RankFromUserAssist(b.lastRunTicks, b.runCount)),
+        launches.rank);
+    GB_CHECK(c && c->rank == combined);
+    c = set.Next();
+    GB_CHECK(c && c->runCount == 0 && std::wstring(c->path) == L"C:\\menu.lnk");
+    GB_CHECK(set.Next() == nullptr);
+}
+
+GB_TEST(AddingRestartsTheOrder) {
+    RecentCandidates set;
+    UserAssistRecord rec;
+    rec.path = L"C:\\old.exe";  rec.runCount = 1;  rec.lastRunTicks = kTicks2024;
+    set.Add(rec);
+    GB_CHECK(set.Next() != nullptr);
+    GB_CHECK(set.Next() == nullptr);
+    rec.path = L"C:\\new.exe";  rec.lastRunTicks = kTicks2024 + 864000000000ull * 30;
+    set.Add(rec);
+    const RecentCandidates::Candidate* c = set.Next();
+    GB_CHECK(c && std::wstring(c->path) == L"C:\\new.exe");
+}
+
+// ── RecentNameFilter ──────────────────────────────────────────────────────────
+
+GB_TEST(NameFilterAdmitsOnceAndNeverPinned) {
+    RecentNameFilter filter({ L"Notepad", L"Paint" });
+    GB_CHECK(!filter.Admit(L"notepad"));
+    GB_CHECK(!filter.Admit(L"PAINT"));
+    GB_CHECK(filter.Admit(L"Calculator"));
+    GB_CHECK(!filter.Admit(L"calculator"));
+    GB_CHECK(filter.Admit(L"Calculator 2"));
+    GB_CHECK(filter.Admit(L""));
+    GB_CHECK(!filter.Admit(L""));
+}
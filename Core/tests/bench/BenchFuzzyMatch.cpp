@@ -0,0 +1,68 @@
+// FuzzyPrefilter and FuzzyScore over a synthetic catalogue of Start-menu-like
+// names. Built twice — BenchFuzzyMatch (SIMD) and BenchFuzzyMatchScalar
+// (GLASSBAR_NO_SIMD) — so the two kernels can be compared on one machine.
+//
+//   BenchFuzzyMatch[Scalar] [--quick]
+
+#include "FuzzyMatch.h"
+#include "FuzzyReference.h"
+#include "bench/BenchUtil.h"
+
+#include <random>
+#include <string>
+
+using namespace GlassBar;
+using namespace GlassBar::Test;
+
+int main(int argc, char** argv) {
+    const bool   quick  = Bench::QuickMode(argc, argv);
+    const size_t count  = quick ? 2000 : 50000;
+    const int    rounds = quick ? 3 : 30;
+
+    static const wchar_t* kWords[] = {
+        L"microsoft", L"visual", L"studio", L"code", L"office", L"word", L"excel",
+        L"adobe", L"acrobat", L"reader", L"steam", L"game", L"tools", L"uninstall",
+        L"help", L"manual", L"settings", L"git", L"bash", L"python", L"node", L"sdk",
+        L"command", L"prompt", L"x64", L"native", L"developer", L"2022", L"media", L"player",
+    };
+    std::mt19937 rng(2024);
+    std::vector<std::wstring> names;
+    std::vector<std::vector<std::uint8_t>> bounds;
+    std::vector<std::uint64_t> masks;
+    for (size_t i = 0; i < count; ++i) {
+        std::wstring name;
+        const size_t words = 1 + rng() % (i % 10 == 0 ? 12 : 5);   // some names > 64 units
+        for (size_t w = 0; w < words; ++w) {
+            if (w) name += L' ';
+            name += kWords[rng() % (sizeof(kWords) / sizeof(kWords[0]))];
+        }
+        bounds.push_back(WordStarts(name));
+        masks.push_back(FuzzyCharMask(name));
+        names.push_back(std::move(name));
+    }
+
+    std::printf("kernel: %s, %zu names\n", FuzzySimdLevel(), names.size());
+    for (const wchar_t* pattern : { L"vsc", L"msedge", L"devcmd", L"ar" }) {
+        const std::uint64_t need = FuzzyCharMask(pattern);
+        std::vector<std::uint32_t> candidates;
+        const Bench::Timing pre = Bench::Measure(rounds * 10, [&]() {
+            candidates.clear();
+            FuzzyPrefilter(masks.data(), masks.size(), need, candidates);
+            Bench::DoNotOptimize(candidates);
+        });
+        int hits = 0;
+        const Bench::Timing score = Bench::Measure(rounds, [&]() {
+            hits = 0;
+            for (std::uint32_t i : candidates)
+                hits += FuzzyScore(names[i], bounds[i].data(), pattern) >= 0 ? 1 : 0;
+            Bench::DoNotOptimize(hits);
+        });
+        char label[64];
+        std::snprintf(label, sizeof(label), "prefilter \"%ls\"", pattern);
+        Bench::Report(label, pre, static_cast<double>(masks.size()), "name");
+        std::snprintf(label, sizeof(label), "score \"%ls\" (%zu cand, %d hits)", pattern,
+                      candidates.size(), hits);
+        Bench::Report(label, score, static_cast<double>((std::max)(candidates.size(), size_t{1})), "cand");
+    }
+    return 0;
+}
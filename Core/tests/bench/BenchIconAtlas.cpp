@@ -0,0 +1,94 @@
+// Headless icon painting: fill an IconAtlas with a menu's worth of icons at
+// three sizes, then paint frames of a 400×640 start menu from it — the
+// per-frame work of the atlas path with no GDI involved. Built twice, like
+// BenchFuzzyMatch, as BenchIconAtlas and BenchIconAtlasScalar.
+//
+//   BenchIconAtlas[Scalar] [--quick]
+
+#include "IconAtlas.h"
+#include "bench/BenchUtil.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace GlassBar;
+
+namespace {
+
+/// A round icon with an antialiased edge: opaque inside, partial alpha on
+/// the rim, clear in the corners — the mix real icons have.
+std::vector<std::uint32_t> RoundIcon(int size, std::uint32_t rgb) {
+    std::vector<std::uint32_t> px(static_cast<size_t>(size) * size);
+    const double r = size / 2.0;
+    for (int y = 0; y < size; ++y)
+        for (int x = 0; x < size; ++x) {
+            const double dist  = std::hypot(x + 0.5 - r, y + 0.5 - r);
+            const double cover = (std::max)(0.0, (std::min)(1.0, r - dist));
+            const std::uint32_t a = static_cast<std::uint32_t>(cover * 255.0 + 0.5);
+            std::uint32_t p = a << 24;
+            for (int shift = 0; shift < 24; shift += 8)
+                p |= (((rgb >> shift) & 0xFF) * a / 255) << shift;
+            px[static_cast<size_t>(y) * size + x] = p;
+        }
+    return px;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const bool quick  = Bench::QuickMode(argc, argv);
+    const int  icons  = quick ? 50 : 400;
+    const int  rounds = quick ? 5 : 200;
+    static const int kSizes[] = { 16, 24, 32 };
+
+    std::mt19937 rng(18);
+    std::vector<std::vector<std::uint32_t>> rasters;
+    for (int i = 0; i < icons; ++i)
+        rasters.push_back(RoundIcon(kSizes[i % 3], static_cast<std::uint32_t>(rng())));
+
+    IconAtlas atlas;
+    const Bench::Timing fill = Bench::Measure(rounds, [&]() {
+        atlas.Clear();
+        for (int i = 0; i < icons; ++i)
+            atlas.Insert(static_cast<std::uint64_t>(i), kSizes[i % 3], rasters[static_cast<size_t>(i)].data());
+    });
+
+    // One frame: 20 rows of 32 px icons on the left, 40 rows of 16 px icons
+    // on the right, over an opaque background.
+    const int frameW = 400, frameH = 640;
+    std::vector<std::uint32_t> frame(static_cast<size_t>(frameW) * frameH);
+    size_t blended = 0;
+    const Bench::Timing paint = Bench::Measure(rounds, [&]() {
+        std::fill(frame.begin(), frame.end(), 0xFF202020u);
+        blended = 0;
+        for (int row = 0; row < 40; ++row) {
+            for (int col = 0; col < 2; ++col) {
+                const int size = col == 0 ? 32 : 16;
+                if (col == 0 && row >= 20) continue;
+                const std::uint64_t id = static_cast<std::uint64_t>(row * 3 + (col == 0 ? 2 : 0)) % icons;
+                const IconAtlas::Slot* s = atlas.Find(id, size);
+                if (!s) continue;
+                const int y = col == 0 ? row * 32 : row * 16;
+                BlendPremultiplied(frame.data(), frameW, frameW, frameH, col == 0 ? 8 : 208, y,
+                                   atlas.Pixels() + static_cast<size_t>(s->y) * IconAtlas::kWidth + s->x,
+                                   IconAtlas::kWidth, size, size);
+                blended += static_cast<size_t>(size) * size;
+            }
+        }
+        Bench::DoNotOptimize(frame);
+    });
+
+    // Large uniformly translucent blend: the pure per-pixel cost.
+    std::vector<std::uint32_t> glass(static_cast<size_t>(frameW) * frameH, 0x80101010u);
+    const Bench::Timing full = Bench::Measure(rounds / 5 + 1, [&]() {
+        BlendPremultiplied(frame.data(), frameW, frameW, frameH, 0, 0, glass.data(), frameW, frameW, frameH);
+        Bench::DoNotOptimize(frame);
+    });
+
+    std::printf("%d icons, atlas %dx%d\n", icons, IconAtlas::kWidth, atlas.Height());
+    Bench::Report("atlas fill", fill, icons, "icon");
+    Bench::Report("paint menu icons (one frame)", paint, static_cast<double>(blended), "px");
+    Bench::Report("blend 400x640 translucent", full, static_cast<double>(frameW) * frameH, "px");
+    return 0;
+}
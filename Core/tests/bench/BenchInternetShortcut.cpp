@@ -0,0 +1,58 @@
+// ParseInternetShortcut throughput over a synthetic set of .url files in the
+// three encodings, as browsers, launchers (steam://) and installers write them.
+//
+//   BenchInternetShortcut [--quick]
+
+#include "ShellLinkParser.h"
+#include "InternetShortcutBuilder.h"
+#include "bench/BenchUtil.h"
+
+#include <string>
+
+using namespace GlassBar;
+using namespace GlassBar::Test;
+
+int main(int argc, char** argv) {
+    const bool quick  = Bench::QuickMode(argc, argv);
+    const int  count  = quick ? 500 : 10000;
+    const int  rounds = quick ? 5 : 50;
+
+    std::vector<std::vector<std::uint8_t>> files;
+    size_t bytes = 0;
+    for (int i = 0; i < count; ++i) {
+        const std::wstring n = std::to_wstring(i);
+        std::wstring text;
+        switch (i % 3) {
+        case 0:   // Steam-style: a property section ahead of the shortcut
+            text = L"[{000214A0-0000-0000-C000-000000000046}]\r\nProp3=19,0\r\n"
+                   L"[InternetShortcut]\r\nIDList=\r\nIconIndex=0\r\n"
+                   L"URL=steam://rungameid/" + n + L"\r\n"
+                   L"IconFile=C:\\Program Files (x86)\\Steam\\steam\\games\\" + n + L".ico\r\n";
+            break;
+        case 1:   // browser-style
+            text = L"[InternetShortcut]\r\nURL=https://www.example.com/products/" + n +
+                   L"/index.html?ref=startmenu\r\n";
+            break;
+        default:  // installer-style, quoted values
+            text = L"[InternetShortcut]\nURL=\"https://support.vendor.example/app" + n + L"\"\n"
+                   L"IconFile=\"C:\\Program Files\\Vendor\\help.ico\"\nIconIndex=1\n";
+            break;
+        }
+        const auto encoding = static_cast<UrlFileEncoding>(i % 7 == 0 ? 2 : i % 5 == 0 ? 1 : 0);
+        files.push_back(EncodeUrlFile(text, encoding));
+        bytes += files.back().size();
+    }
+
+    InternetShortcutInfo info;
+    size_t parsed = 0;
+    const Bench::Timing t = Bench::Measure(rounds, [&]() {
+        parsed = 0;
+        for (const auto& file : files)
+            parsed += ParseInternetShortcut(file.data(), file.size(), info) ? 1 : 0;
+        Bench::DoNotOptimize(info);
+    });
+    Bench::Report("ParseInternetShortcut, mixed encodings", t, static_cast<double>(files.size()), "file");
+    std::printf("%zu files, %zu KB, %zu parsed; %.0f MB/s\n", files.size(), bytes / 1024, parsed,
+                bytes / t.p50Us);
+    return parsed == files.size() ? 0 : 1;
+}
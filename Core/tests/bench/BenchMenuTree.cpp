@@ -0,0 +1,190 @@
+// The frozen MenuTree arena against the nested std::vector<MenuNode> layout it
+// replaced, on scanned synthetic Start Menus: heap taken by each (counted
+// allocations, next to the arena's own MemoryBytes / NestedLayoutBytes
+// estimates), a full depth-first walk, painting every folder's level the way
+// the menu does, and the by-name lookup launches go through.
+//
+//   BenchMenuTree [--quick] [entries...]
+
+#include "ProgramTree.h"
+#include "MenuTree.h"
+#include "ProgramsCorpus.h"
+#include "bench/BenchUtil.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+using namespace GlassBar;
+using namespace GlassBar::Test;
+
+// ── Heap accounting ───────────────────────────────────────────────────────────
+// Every allocation carries its size in a 16-byte header so live bytes can be
+// read before and after building each layout.
+
+static std::atomic<size_t> g_liveBytes{0};
+
+void* operator new(size_t size) {
+    void* p = std::malloc(size + 16);
+    if (!p) throw std::bad_alloc();
+    *static_cast<size_t*>(p) = size;
+    g_liveBytes.fetch_add(size, std::memory_order_relaxed);
+    return static_cast<char*>(p) + 16;
+}
+
+void operator delete(void* p) noexcept {
+    if (!p) return;
+    char* block = static_cast<char*>(p) - 16;
+    g_liveBytes.fetch_sub(*reinterpret_cast<size_t*>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+
+namespace {
+
+// ── Nested layout ─────────────────────────────────────────────────────────────
+
+void WalkNested(const std::vector<MenuNode>& level, size_t& chars, size_t& folders) {
+    for (const MenuNode& n : level) {
+        chars += n.name.size() + n.target.size();
+        if (n.isFolder) {
+            ++folders;
+            WalkNested(n.children, chars, folders);
+        }
+    }
+}
+
+// One pass over a level as the painter does it: name, icon, folder flag.
+size_t PaintNested(const std::vector<MenuNode>& level) {
+    size_t sum = 0;
+    for (const MenuNode& n : level) sum += n.name.size() + (n.hIcon ? 1 : 0) + n.isFolder;
+    for (const MenuNode& n : level)
+        if (n.isFolder) sum += PaintNested(n.children);
+    return sum;
+}
+
+const MenuNode* FindNested(const std::vector<MenuNode>& level, std::wstring_view name) {
+    for (const MenuNode& n : level) {
+        if (n.isFolder) {
+            if (const MenuNode* hit = FindNested(n.children, name)) return hit;
+        } else if (CompareNodeNames(n.name, name) == 0) {
+            return &n;
+        }
+    }
+    return nullptr;
+}
+
+// ── Arena ─────────────────────────────────────────────────────────────────────
+
+void WalkArena(MenuNodeRange level, size_t& chars, size_t& folders) {
+    for (MenuNodeView n : level) {
+        chars += n.name().size() + n.target().size();
+        if (n.isFolder()) {
+            ++folders;
+            WalkArena(n.children(), chars, folders);
+        }
+    }
+}
+
+// Breadth-first layout: every level is a run, so painting them all is a
+// single pass over the node arrays.
+size_t PaintArena(const MenuTree& tree) {
+    size_t sum = 0;
+    for (uint32_t i = 0; i < tree.NodeCount(); ++i) {
+        const MenuNodeView n = tree.Node(i);
+        sum += n.name().size() + (tree.Icon(i) ? 1 : 0) + n.isFolder();
+    }
+    return sum;
+}
+
+void CollectNames(const std::vector<MenuNode>& level, std::vector<std::wstring>& out) {
+    for (const MenuNode& n : level) {
+        if (n.isFolder) CollectNames(n.children, out);
+        else            out.push_back(n.name);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const bool quick = Bench::QuickMode(argc, argv);
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i)
+        if (argv[i][0] != '-') sizes.push_back(std::strtoul(argv[i], nullptr, 10));
+    if (sizes.empty()) sizes = quick ? std::vector<size_t>{ 1000 }
+                                     : std::vector<size_t>{ 1000, 10000, 50000 };
+    const int rounds = quick ? 3 : 30;
+
+    const std::filesystem::path scratch = MakeScratchDir("menutree-bench");
+    for (size_t entries : sizes) {
+        CorpusSpec spec;
+        spec.entries = entries;
+        const CorpusInfo info = WriteProgramsCorpus(scratch / std::to_string(entries), spec);
+        const std::wstring dirs[2] = { FromFsPath(info.commonRoot), FromFsPath(info.userRoot) };
+        size_t shortcuts = 0;
+        bool   found     = false;
+
+        // Count each layout on its own: a copy of the scanned tree (so scanner
+        // buffers and spare capacity stay out of it), then the arena.
+        const std::vector<MenuNode> scanned =
+            ScanAndMerge(FileSystemScanBackend(), dirs, 4, shortcuts, found);
+        size_t before = g_liveBytes.load();
+        const std::vector<MenuNode> nested = scanned;
+        const size_t nestedHeap = g_liveBytes.load() - before;
+
+        before = g_liveBytes.load();
+        MenuTree arena;
+        arena.Assign(nested);
+        const size_t arenaHeap = g_liveBytes.load() - before;
+
+        std::printf("\n%zu entries: %zu nodes, %zu shortcuts\n", entries, arena.NodeCount(), shortcuts);
+        std::printf("%-44s nested %8zu KB  arena %8zu KB  (%.0f%%)\n", "heap (counted allocations)",
+                    nestedHeap / 1024, arenaHeap / 1024, 100.0 * arenaHeap / (std::max)(nestedHeap, size_t(1)));
+        std::printf("%-44s nested %8zu KB  arena %8zu KB\n", "heap (NestedLayoutBytes / MemoryBytes)",
+                    MenuTree::NestedLayoutBytes(nested) / 1024, arena.MemoryBytes() / 1024);
+
+        const double nodes = static_cast<double>(arena.NodeCount());
+        size_t chars = 0, folders = 0;
+        Bench::Report("walk, nested", Bench::Measure(rounds, [&]() {
+            chars = folders = 0;
+            WalkNested(nested, chars, folders);
+            Bench::DoNotOptimize(chars);
+        }), nodes, "node");
+        Bench::Report("walk, arena", Bench::Measure(rounds, [&]() {
+            chars = folders = 0;
+            WalkArena(arena.Roots(), chars, folders);
+            Bench::DoNotOptimize(chars);
+        }), nodes, "node");
+
+        size_t painted = 0;
+        Bench::Report("paint every level, nested", Bench::Measure(rounds, [&]() {
+            painted = PaintNested(nested);
+            Bench::DoNotOptimize(painted);
+        }), nodes, "node");
+        Bench::Report("paint every level, arena", Bench::Measure(rounds, [&]() {
+            painted = PaintArena(arena);
+            Bench::DoNotOptimize(painted);
+        }), nodes, "node");
+
+        // Look up a spread of shortcut names (later ones mean deeper searches).
+        std::vector<std::wstring> names;
+        CollectNames(nested, names);
+        std::vector<std::wstring> queries;
+        for (size_t i = 0; i < names.size(); i += (std::max)(size_t(1), names.size() / 64))
+            queries.push_back(names[i]);
+        const double lookups = static_cast<double>(queries.size());
+        Bench::Report("find by name, nested", Bench::Measure(rounds, [&]() {
+            for (const auto& q : queries) Bench::DoNotOptimize(FindNested(nested, q));
+        }), lookups, "lookup");
+        Bench::Report("find by name, arena", Bench::Measure(rounds, [&]() {
+            for (const auto& q : queries) Bench::DoNotOptimize(arena.FindShortcutByName(q));
+        }), lookups, "lookup");
+    }
+    std::printf("\npeak memory %zu KB\n", Bench::PeakMemoryKB());
+
+    std::error_code ec;
+    std::filesystem::remove_all(scratch, ec);
+    return 0;
+}
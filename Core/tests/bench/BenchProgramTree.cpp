@@ -0,0 +1,94 @@
+// The All Programs build pipeline over synthetic Start Menus of growing size:
+// the full scan + merge (FileSystemScanBackend), the common/user MergeTree on
+// its own, and freezing the result into a MenuTree — with the scanner's own
+// stage times from the last run.
+//
+//   BenchProgramTree [--quick] [--threads=N] [entries...]
+
+#include "ProgramTree.h"
+#include "MenuTree.h"
+#include "ProgramsCorpus.h"
+#include "bench/BenchUtil.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+using namespace GlassBar;
+using namespace GlassBar::Test;
+
+int main(int argc, char** argv) {
+    const bool quick = Bench::QuickMode(argc, argv);
+    unsigned threads = (std::max)(1u, (std::min)(8u, std::thread::hardware_concurrency()));
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--threads=", 10) == 0)
+            threads = (std::max)(1u, static_cast<unsigned>(std::strtoul(argv[i] + 10, nullptr, 10)));
+        else if (argv[i][0] != '-')
+            sizes.push_back(std::strtoul(argv[i], nullptr, 10));
+    }
+    if (sizes.empty()) sizes = quick ? std::vector<size_t>{ 100, 1000 }
+                                     : std::vector<size_t>{ 100, 1000, 10000, 50000 };
+    const int rounds = quick ? 3 : 20;
+
+    const std::filesystem::path scratch = MakeScratchDir("tree-bench");
+    std::printf("%u scan threads\n", threads);
+    for (size_t entries : sizes) {
+        CorpusSpec spec;
+        spec.entries = entries;
+        const std::filesystem::path dir = scratch / std::to_string(entries);
+        const CorpusInfo info = WriteProgramsCorpus(dir, spec);
+        const std::wstring dirs[2]   = { FromFsPath(info.commonRoot), FromFsPath(info.userRoot) };
+        const std::wstring common[2] = { FromFsPath(info.commonRoot), std::wstring() };
+        const std::wstring user[2]   = { std::wstring(), FromFsPath(info.userRoot) };
+
+        size_t shortcuts = 0;
+        bool   found     = false;
+        std::vector<MenuNode> tree;
+        ScanStageTimes stages;
+        const Bench::Timing scan = Bench::Measure(rounds, [&]() {
+            stages = {};
+            tree = ScanAndMerge(FileSystemScanBackend(), dirs, threads, shortcuts, found, false, &stages);
+        });
+
+        // Merge alone: the two roots scanned separately, merged from fresh copies.
+        size_t n = 0;
+        const std::vector<MenuNode> commonTree = ScanAndMerge(FileSystemScanBackend(), common, threads, n, found);
+        const std::vector<MenuNode> userTree   = ScanAndMerge(FileSystemScanBackend(), user, threads, n, found);
+        std::vector<double> mergeSamples;
+        for (int r = 0; r <= rounds; ++r) {
+            std::vector<MenuNode> base = commonTree, overlay = userTree;
+            const auto t0 = std::chrono::steady_clock::now();
+            MergeTree(base, std::move(overlay));
+            const double us = std::chrono::duration<double, std::micro>(
+                std::chrono::steady_clock::now() - t0).count();
+            if (r > 0) mergeSamples.push_back(us);            // round 0 warms up
+            Bench::DoNotOptimize(base);
+        }
+        const Bench::Timing merge = Bench::Summarize(std::move(mergeSamples));
+
+        MenuTree frozen;
+        const Bench::Timing assign = Bench::Measure(rounds, [&]() {
+            frozen.Assign(tree);
+            Bench::DoNotOptimize(frozen);
+        });
+
+        std::printf("\n%zu entries: %zu shortcuts scanned, %zu folders\n", entries, shortcuts, info.folders);
+        const double items = static_cast<double>(shortcuts);
+        Bench::Report("scan + merge", scan, items, "shortcut");
+        Bench::Report("merge only (common + user)", merge, items, "shortcut");
+        Bench::Report("MenuTree::Assign", assign, items, "shortcut");
+        std::printf("stages (last run, summed over threads): enumerate %llu us, resolve %llu us, "
+                    "assemble %llu us, merge %llu us\n",
+                    static_cast<unsigned long long>(stages.enumerateUs),
+                    static_cast<unsigned long long>(stages.resolveUs),
+                    static_cast<unsigned long long>(stages.assembleUs),
+                    static_cast<unsigned long long>(stages.mergeUs));
+    }
+    std::printf("\npeak memory %zu KB\n", Bench::PeakMemoryKB());
+
+    std::error_code ec;
+    std::filesystem::remove_all(scratch, ec);
+    return 0;
+}
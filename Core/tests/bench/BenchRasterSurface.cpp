@@ -0,0 +1,76 @@
+// Frame times of the software rasterizer on a mock Start Menu at the menu's
+// real size: a full frame, the hover redraw of one row (clipped, as Paint()
+// does for the update region) and the primitives on their own, including a
+// translucent full-window fill — the per-pixel alpha case.
+//
+//   BenchRasterSurface [--quick]
+
+#include "RasterSurface.h"
+#include "RasterScenes.h"
+#include "bench/BenchUtil.h"
+
+using namespace GlassBar;
+using namespace GlassBar::Test;
+
+int main(int argc, char** argv) {
+    const bool quick  = Bench::QuickMode(argc, argv);
+    const int  rounds = quick ? 5 : 300;
+
+    const SyntheticFont   font;
+    const MenuFrameLayout layout(400, 535);
+    std::vector<std::vector<std::uint32_t>> icons;
+    for (unsigned i = 0; i < 5; ++i) icons.push_back(SyntheticIcon(layout.rowHeight - 6, i + 1));
+
+    std::vector<std::uint32_t> frame(static_cast<size_t>(layout.width) * layout.height);
+    RasterSurface surface(frame.data(), layout.width, layout.height, layout.width);
+    const double pixels = static_cast<double>(frame.size());
+
+    int hover = 0;
+    Bench::Report("menu frame, full", Bench::Measure(rounds, [&]() {
+        surface.SetClip({ 0, 0, layout.width, layout.height });
+        DrawMenuFrame(surface, layout, font, icons, hover);
+        Bench::DoNotOptimize(frame);
+    }), pixels, "px");
+
+    Bench::Report("menu frame, hover row redraw", Bench::Measure(rounds * 4, [&]() {
+        hover = (hover + 1) % layout.rows;
+        surface.SetClip(layout.Row(hover));
+        DrawMenuFrame(surface, layout, font, icons, hover);
+        Bench::DoNotOptimize(frame);
+    }));
+    surface.SetClip({ 0, 0, layout.width, layout.height });
+
+    const RasterRect all{ 0, 0, layout.width, layout.height };
+    Bench::Report("opaque fill, full window", Bench::Measure(rounds, [&]() {
+        surface.FillRect(all, RasterSurface::Color(245, 246, 248));
+        Bench::DoNotOptimize(frame);
+    }), pixels, "px");
+    Bench::Report("translucent fill, full window", Bench::Measure(rounds, [&]() {
+        surface.FillRect(all, RasterSurface::Color(0, 120, 215, 56));
+        Bench::DoNotOptimize(frame);
+    }), pixels, "px");
+    Bench::Report("rounded rects, 20 rows", Bench::Measure(rounds, [&]() {
+        for (int i = 0; i < 20; ++i) {
+            const RasterRect row{ 4, 4 + i * 26, 396, 28 + i * 26 };
+            surface.FillRoundRect(row, 4, RasterSurface::Color(0, 120, 215, 56));
+            surface.StrokeRoundRect(row, 4, 1, RasterSurface::Color(0, 120, 215, 140));
+        }
+        Bench::DoNotOptimize(frame);
+    }));
+
+    const std::vector<RasterGlyph> run = font.Shape("Microsoft Visual Studio 2022 Command Prompt");
+    Bench::Report("glyph runs, 40 lines", Bench::Measure(rounds, [&]() {
+        for (int i = 0; i < 40; ++i)
+            surface.DrawGlyphRun(run.data(), run.size(), 8, 12 + i * 13, RasterSurface::Color(24, 24, 24));
+        Bench::DoNotOptimize(frame);
+    }), 40.0 * run.size(), "glyph");
+    Bench::Report("icon blits, 40 row icons", Bench::Measure(rounds, [&]() {
+        const std::vector<std::uint32_t>& icon = icons[0];
+        const int size = layout.rowHeight - 6;
+        for (int i = 0; i < 40; ++i)
+            surface.BlendImage(8 + (i % 10) * 38, 8 + (i / 10) * 38, icon.data(), size, size, size);
+        Bench::DoNotOptimize(frame);
+    }), 40.0, "icon");
+    std::printf("peak memory %zu KB\n", Bench::PeakMemoryKB());
+    return 0;
+}
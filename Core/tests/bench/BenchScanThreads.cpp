@@ -0,0 +1,75 @@
+// How the parallel scan scales with its pool size on a synthetic 10k-shortcut
+// Start Menu: once with the plain std::filesystem backend (warm cache, CPU
+// bound) and once with a fixed wait added to every resolve, standing in for
+// the IShellLink / slow-disk cost the Win32 backend sees.
+//
+//   BenchScanThreads [--quick] [--latency-us=N] [entries]
+
+#include "ProgramTree.h"
+#include "ProgramsCorpus.h"
+#include "bench/BenchUtil.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+using namespace GlassBar;
+using namespace GlassBar::Test;
+
+int main(int argc, char** argv) {
+    const bool quick = Bench::QuickMode(argc, argv);
+    size_t entries   = quick ? 1000 : 10000;
+    unsigned latencyUs = 50;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--latency-us=", 13) == 0)
+            latencyUs = static_cast<unsigned>(std::strtoul(argv[i] + 13, nullptr, 10));
+        else if (argv[i][0] != '-')
+            entries = std::strtoul(argv[i], nullptr, 10);
+    }
+    const int rounds = quick ? 2 : 10;
+    const unsigned hw = (std::max)(1u, std::thread::hardware_concurrency());
+
+    const std::filesystem::path scratch = MakeScratchDir("scan-threads");
+    CorpusSpec spec;
+    spec.entries = entries;
+    const CorpusInfo info = WriteProgramsCorpus(scratch, spec);
+    const std::wstring dirs[2] = { FromFsPath(info.commonRoot), FromFsPath(info.userRoot) };
+
+    ScanBackend slow = FileSystemScanBackend();
+    slow.resolve = [latencyUs](const std::wstring& path, std::wstring& target, std::wstring& args) {
+        std::this_thread::sleep_for(std::chrono::microseconds(latencyUs));
+        return FileSystemScanBackend().resolve(path, target, args);
+    };
+
+    std::vector<unsigned> counts = { 1, 2, 4, 8, 16 };
+    if (quick) counts = { 1, 4 };
+    std::printf("%zu entries, %u hardware threads\n", entries, hw);
+
+    const struct { std::string label; const ScanBackend* backend; int rounds; } runs[] = {
+        { "std::filesystem", &FileSystemScanBackend(), rounds },
+        { "+ " + std::to_string(latencyUs) + " us per resolve", &slow, quick ? 1 : 3 },
+    };
+    for (const auto& run : runs) {
+        std::printf("\n%s\n", run.label.c_str());
+        double base = 0;
+        for (unsigned threads : counts) {
+            size_t shortcuts = 0;
+            bool   found     = false;
+            const Bench::Timing t = Bench::Measure(run.rounds, [&]() {
+                std::vector<MenuNode> tree = ScanAndMerge(*run.backend, dirs, threads, shortcuts, found);
+                Bench::DoNotOptimize(tree);
+            });
+            if (threads == 1) base = t.p50Us;
+            const std::string name = std::to_string(threads) + (threads == 1 ? " thread" : " threads");
+            std::printf("  ");
+            Bench::Report(name.c_str(), t, static_cast<double>(shortcuts), "shortcut");
+            std::printf("    speed-up %.2fx\n", base / t.p50Us);
+        }
+    }
+    std::printf("\npeak memory %zu KB\n", Bench::PeakMemoryKB());
+
+    std::error_code ec;
+    std::filesystem::remove_all(scratch, ec);
+    return 0;
+}
@@ -0,0 +1,71 @@
+// ParseShellLink throughput over a synthetic Start Menu's worth of links:
+// the mix a real Programs folder holds (local Unicode LinkInfo with
+// arguments and icons, env-var targets, ItemID lists, a few ANSI and
+// network links).
+//
+//   BenchShellLink [--quick]
+
+#include "ShellLinkParser.h"
+#include "ShellLinkBuilder.h"
+#include "bench/BenchUtil.h"
+
+#include <string>
+
+using namespace GlassBar;
+using namespace GlassBar::Test;
+
+int main(int argc, char** argv) {
+    const bool quick  = Bench::QuickMode(argc, argv);
+    const int  count  = quick ? 500 : 10000;
+    const int  rounds = quick ? 5 : 50;
+
+    std::vector<std::vector<std::uint8_t>> links;
+    size_t bytes = 0;
+    for (int i = 0; i < count; ++i) {
+        const std::wstring app = L"Vendor " + std::to_wstring(i % 97) + L"\\App" + std::to_wstring(i);
+        LinkSpec spec;
+        spec.idList = std::vector<std::uint8_t>(120 + i % 200, 0x14);
+        switch (i % 10) {
+        case 0: case 1: case 2: case 3: case 4:
+            spec.localBasePath = L"C:\\Program Files\\" + app + L".exe";
+            spec.workingDir    = L"C:\\Program Files\\" + app;
+            spec.arguments     = (i % 3) ? L"" : L"--profile default";
+            spec.iconLocation  = spec.localBasePath;
+            break;
+        case 5: case 6:
+            spec.localBasePath = L"C:\\Windows\\System32\\tool" + std::to_wstring(i) + L".exe";
+            spec.envTarget     = L"%windir%\\system32\\tool" + std::to_wstring(i) + L".exe";
+            spec.envIcon       = L"%windir%\\system32\\shell32.dll";
+            break;
+        case 7:
+            spec.unicodeLinkInfo = false;
+            spec.localBasePath   = L"D:\\Games\\";
+            spec.commonPathSuffix = app + L".exe";
+            break;
+        case 8:
+            spec.netName          = L"\\\\server\\apps";
+            spec.commonPathSuffix = app + L".exe";
+            break;
+        default:
+            spec.localBasePath  = L"C:\\Tools\\" + app + L".exe";
+            spec.unicodeStrings = false;
+            spec.arguments      = L"/silent";
+            break;
+        }
+        links.push_back(BuildShellLink(spec));
+        bytes += links.back().size();
+    }
+
+    ShellLinkInfo info;
+    size_t parsed = 0;
+    const Bench::Timing t = Bench::Measure(rounds, [&]() {
+        parsed = 0;
+        for (const auto& link : links)
+            parsed += ParseShellLink(link.data(), link.size(), info) ? 1 : 0;
+        Bench::DoNotOptimize(info);
+    });
+    Bench::Report("ParseShellLink, synthetic Start Menu", t, static_cast<double>(links.size()), "link");
+    std::printf("%zu links, %zu KB, %zu parsed natively; %.0f MB/s\n", links.size(), bytes / 1024,
+                parsed, bytes / t.p50Us);
+    return parsed == links.size() ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+// The recent-list pipeline over a synthetic UserAssist history: decode every
+// Count value (ROT13 + filter), rank them in RecentCandidates and take the
+// first 20 — against a full sort of the same candidates.
+//
+//   BenchUserAssist [--quick] [entries]
+
+#include "UserAssist.h"
+#include "bench/BenchUtil.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+using namespace GlassBar;
+
+int main(int argc, char** argv) {
+    const bool quick = Bench::QuickMode(argc, argv);
+    size_t entries = quick ? 2000 : 20000;
+    for (int i = 1; i < argc; ++i)
+        if (argv[i][0] != '-') entries = std::strtoul(argv[i], nullptr, 10);
+    const int rounds = quick ? 3 : 30;
+
+    // Value names as Explorer stores them: ROT13 paths, a few UEME_ entries,
+    // documents and AppUserModelIDs that the decoder has to reject.
+    std::mt19937 rng(16);
+    std::vector<std::wstring> names;
+    std::vector<std::vector<std::uint8_t>> values;
+    for (size_t i = 0; i < entries; ++i) {
+        std::wstring path;
+        switch (i % 10) {
+        case 0:  path = L"UEME_CTLCUACount:ctor"; break;
+        case 1:  path = L"C:\\Users\\me\\Documents\\report" + std::to_wstring(i) + L".docx"; break;
+        case 2:  path = L"Vendor.App" + std::to_wstring(i) + L"_8wekyb3d8bbwe!App"; break;
+        default:
+            path = L"{6D809377-6AF0-444B-8957-A3773F02200E}\\Vendor " + std::to_wstring(i % 997) +
+                   L"\\Product\\bin\\app" + std::to_wstring(i) + L".exe";
+            break;
+        }
+        Rot13InPlace(path.data(), path.size());
+        names.push_back(std::move(path));
+        std::vector<std::uint8_t> value(72, 0);
+        const std::uint32_t runs  = rng() % 50;
+        const std::uint64_t ticks = 133485408000000000ull + (rng() % 365) * 864000000000ull;
+        std::memcpy(value.data() + 4, &runs, sizeof(runs));
+        std::memcpy(value.data() + 16, &ticks, sizeof(ticks));
+        values.push_back(std::move(value));
+    }
+
+    UserAssistRecord rec;
+    size_t decoded = 0;
+    const Bench::Timing decode = Bench::Measure(rounds, [&]() {
+        decoded = 0;
+        for (size_t i = 0; i < names.size(); ++i)
+            decoded += DecodeUserAssistValue(names[i], values[i].data(), values[i].size(), rec) ? 1 : 0;
+        Bench::DoNotOptimize(rec);
+    });
+
+    std::vector<UserAssistRecord> records;
+    for (size_t i = 0; i < names.size(); ++i)
+        if (DecodeUserAssistValue(names[i], values[i].data(), values[i].size(), rec)) records.push_back(rec);
+
+    const Bench::Timing top = Bench::Measure(rounds, [&]() {
+        RecentCandidates set;
+        set.Reserve(records.size());
+        for (const auto& r : records) set.Add(r);
+        for (int k = 0; k < 20 && set.Next(); ++k) {}
+        Bench::DoNotOptimize(set);
+    });
+    const Bench::Timing full = Bench::Measure(rounds, [&]() {
+        RecentCandidates set;
+        set.Reserve(records.size());
+        for (const auto& r : records) set.Add(r);
+        while (set.Next()) {}
+        Bench::DoNotOptimize(set);
+    });
+
+    std::printf("%zu values, %zu programs\n", names.size(), decoded);
+    Bench::Report("decode (ROT13 + filter)", decode, static_cast<double>(names.size()), "value");
+    Bench::Report("rank, take 20", top, static_cast<double>(records.size()), "record");
+    Bench::Report("rank, take all (full sort)", full, static_cast<double>(records.size()), "record");
+    std::printf("peak memory %zu KB\n", Bench::PeakMemoryKB());
+    return 0;
+}
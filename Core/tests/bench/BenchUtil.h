@@ -0,0 +1,90 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace GlassBar::Bench {
+
+// ── Benchmark helpers ─────────────────────────────────────────────────────────
+// Benchmarks time |rounds| runs of a body with steady_clock and report the
+// median and 99th percentile. --quick (used by ctest) cuts the work so the
+// benchmark stays a smoke test; numbers are only meaningful without it.
+
+inline bool QuickMode(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i)
+        if (std::strcmp(argv[i], "--quick") == 0) return true;
+    return false;
+}
+
+struct Timing {
+    double p50Us = 0;
+    double p99Us = 0;
+    double minUs = 0;
+};
+
+/// Percentiles of timings taken by hand (non-empty, microseconds).
+inline Timing Summarize(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    auto at = [&](double q) {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(q * samples.size()))];
+    };
+    return { at(0.50), at(0.99), samples.front() };
+}
+
+/// Run |body| |rounds| times (after one untimed warm-up run).
+template <typename Body>
+Timing Measure(int rounds, Body&& body) {
+    body();
+    std::vector<double> samples;
+    samples.reserve(static_cast<size_t>(rounds));
+    for (int i = 0; i < rounds; ++i) {
+        const auto t0 = std::chrono::steady_clock::now();
+        body();
+        samples.push_back(std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - t0).count());
+    }
+    return Summarize(std::move(samples));
+}
+
+inline void Report(const char* name, const Timing& t, double items = 0, const char* unit = "item") {
+    std::printf("%-44s p50 %10.1f us  p99 %10.1f us", name, t.p50Us, t.p99Us);
+    if (items > 0)
+        std::printf("  (%.1f ns/%s)", t.p50Us * 1000.0 / items, unit);
+    std::printf("\n");
+}
+
+/// Peak resident set of this process so far, in KB.
+inline size_t PeakMemoryKB() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc = {};
+    pmc.cb = sizeof(pmc);
+    return GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))
+               ? pmc.PeakWorkingSetSize / 1024 : 0;
+#else
+    rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<size_t>(usage.ru_maxrss);   // KB on Linux
+#endif
+}
+
+/// Keep |value| alive so the optimiser cannot drop the work producing it.
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+#if defined(_MSC_VER)
+    static volatile const void* sink;
+    sink = &value;
+#else
+    asm volatile("" : : "g"(&value) : "memory");
+#endif
+}
+
+} // namespace GlassBar::Bench
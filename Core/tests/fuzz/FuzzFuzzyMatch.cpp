@@ -0,0 +1,38 @@
+// FuzzyScore / FuzzyPrefilter fuzz target: a name (up to 130 units, so both
+// the bitmask and the scan path run), word-start flags and a pattern drawn
+// from the input; the result must equal the reference in FuzzyReference.h.
+
+#include "FuzzyMatch.h"
+#include "FuzzyReference.h"
+#include "fuzz/FuzzInput.h"
+
+#include <cstdlib>
+
+using namespace GlassBar;
+using namespace GlassBar::Test;
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+    FuzzInput in(data, size);
+    static const wchar_t kSmall[] = L"abcab ";
+    const bool small = in.Bool();
+    const std::wstring name    = in.String(130, small ? kSmall : nullptr);
+    const std::wstring pattern = in.String(40, small ? kSmall : nullptr);
+    std::vector<std::uint8_t> bounds(name.size());
+    for (auto& b : bounds) b = static_cast<std::uint8_t>(in.Range(3) == 0 ? 1 : 0);
+
+    if (FuzzyScore(name, bounds.data(), pattern) != ReferenceFuzzyScore(name, bounds.data(), pattern))
+        std::abort();
+
+    std::vector<std::uint64_t> masks;
+    for (size_t i = 0; i + 8 <= size && masks.size() < 64; i += 8) {
+        std::uint64_t m = 0;
+        for (int k = 0; k < 8; ++k) m |= static_cast<std::uint64_t>(data[i + k]) << (8 * k);
+        masks.push_back(m);
+    }
+    const std::uint64_t need = FuzzyCharMask(pattern);
+    std::vector<std::uint32_t> out;
+    FuzzyPrefilter(masks.data(), masks.size(), need, out);
+    if (out != ReferenceFuzzyPrefilter(masks.data(), masks.size(), need))
+        std::abort();
+    return 0;
+}
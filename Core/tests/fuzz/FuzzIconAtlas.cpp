@@ -0,0 +1,102 @@
+// IconAtlas fuzz target: a sequence of Insert / Remove / Clear drawn from the
+// input, checked against a model (slots in bounds, disjoint, pixels intact),
+// then one clipped BlendPremultiplied checked against a per-pixel reference.
+
+#include "IconAtlas.h"
+#include "fuzz/FuzzInput.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+
+using namespace GlassBar;
+using namespace GlassBar::Test;
+
+namespace {
+
+std::uint32_t Fill(std::uint64_t id, int size) {
+    return static_cast<std::uint32_t>(id * 0x9E3779B1u) ^ static_cast<std::uint32_t>(size);
+}
+
+std::uint32_t ReferencePixel(std::uint32_t s, std::uint32_t d) {
+    const std::uint32_t alpha = s >> 24;
+    if (alpha == 0)   return d;
+    if (alpha == 255) return s;
+    std::uint32_t out = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        const std::uint32_t dc = (d >> shift) & 0xFF;
+        const std::uint32_t t  = (dc * (255 - alpha) * 2 + 255) / 510;   // round half up
+        out |= (std::min)(((s >> shift) & 0xFF) + t, 255u) << shift;
+    }
+    return out;
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+    FuzzInput in(data, size);
+    IconAtlas atlas;
+    std::map<std::uint64_t, std::vector<int>> model;
+    std::vector<std::uint32_t> px;
+
+    const unsigned ops = in.Range(80);
+    for (unsigned op = 0; op < ops; ++op) {
+        const std::uint64_t id = in.Range(15);
+        switch (in.Range(9)) {
+        case 0:
+            atlas.Remove(id);
+            model.erase(id);
+            break;
+        case 1:
+            if (in.Range(7) == 0) { atlas.Clear(); model.clear(); }
+            break;
+        default: {
+            const int s = 1 + static_cast<int>(in.Range(IconAtlas::kWidth / 2 - 1)) * (in.Bool() ? 2 : 1);
+            px.assign(static_cast<size_t>(s) * s, Fill(id, s));
+            auto& sizes = model[id];
+            const bool known = std::find(sizes.begin(), sizes.end(), s) != sizes.end();
+            const bool ok = atlas.Insert(id, s, px.data()) != nullptr;
+            if (ok != (known || sizes.size() < IconAtlas::kSizesPerIcon)) std::abort();
+            if (ok && !known) sizes.push_back(s);
+            if (sizes.empty()) model.erase(id);
+            break;
+        }
+        }
+    }
+
+    std::vector<std::uint8_t> owner(static_cast<size_t>(IconAtlas::kWidth) * atlas.Height(), 0);
+    for (const auto& [id, sizes] : model) {
+        for (int s : sizes) {
+            const IconAtlas::Slot* slot = atlas.Find(id, s);
+            if (!slot || slot->size != s || slot->x < 0 || slot->y < 0 ||
+                slot->x + s > IconAtlas::kWidth || slot->y + s > atlas.Height())
+                std::abort();
+            for (int row = 0; row < s; ++row)
+                for (int col = 0; col < s; ++col) {
+                    const size_t at = static_cast<size_t>(slot->y + row) * IconAtlas::kWidth + slot->x + col;
+                    if (owner[at]++ || atlas.Pixels()[at] != Fill(id, s)) std::abort();
+                }
+        }
+    }
+    if (atlas.IconCount() != model.size()) std::abort();
+
+    // One clipped blend of fuzzer-chosen pixels.
+    const int w = 1 + static_cast<int>(in.Range(15)), h = 1 + static_cast<int>(in.Range(15));
+    const int x = static_cast<int>(in.Range(40)) - 20, y = static_cast<int>(in.Range(40)) - 20;
+    std::vector<std::uint32_t> src(static_cast<size_t>(w) * h), dst(16 * 16);
+    for (auto& p : src) {
+        const std::uint32_t a = in.Byte();
+        p = (a << 24) | ((in.Byte() * a / 255) << 16) | ((in.Byte() * a / 255) << 8) | (in.Byte() * a / 255);
+    }
+    for (auto& p : dst) p = (static_cast<std::uint32_t>(in.Byte()) << 24) | (in.Byte() << 16) | (in.Byte() << 8) | in.Byte();
+    std::vector<std::uint32_t> expected = dst;
+    for (int row = 0; row < h; ++row)
+        for (int col = 0; col < w; ++col)
+            if (x + col >= 0 && x + col < 16 && y + row >= 0 && y + row < 16) {
+                std::uint32_t& d = expected[static_cast<size_t>(y + row) * 16 + x + col];
+                d = ReferencePixel(src[static_cast<size_t>(row) * w + col], d);
+            }
+    BlendPremultiplied(dst.data(), 16, 16, 16, x, y, src.data(), w, w, h);
+    if (dst != expected) std::abort();
+    return 0;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace GlassBar::Test {
+
+/// <summary>
+/// Consumes a fuzzer's bytes as typed values, for structure-aware targets
+/// that build a well-formed input from them (FuzzedDataProvider in spirit).
+/// Reads past the end yield zeros, so every input maps to some structure.
+/// </summary>
+class FuzzInput {
+public:
+    FuzzInput(const std::uint8_t* data, std::size_t size) : m_data(data), m_size(size) {}
+
+    std::uint8_t Byte() { return m_pos < m_size ? m_data[m_pos++] : 0; }
+    bool         Bool() { return (Byte() & 1) != 0; }
+    std::uint32_t Range(std::uint32_t limit) { return limit ? Byte() % (limit + 1) : 0; }
+
+    /// Up to |maxLength| UTF-16 units drawn from |alphabet|, or any 16-bit
+    /// unit (NUL excluded) when |alphabet| is null.
+    std::wstring String(std::size_t maxLength, const wchar_t* alphabet) {
+        std::wstring s(Range(static_cast<std::uint32_t>(maxLength)), L'a');
+        for (wchar_t& c : s) {
+            if (alphabet) {
+                const std::size_t n = std::char_traits<wchar_t>::length(alphabet);
+                c = alphabet[Byte() % n];
+            } else {
+                const unsigned v = (static_cast<unsigned>(Byte()) << 8) | Byte();
+                c = static_cast<wchar_t>(v ? v : 1);
+            }
+        }
+        return s;
+    }
+
+    std::vector<std::uint8_t> Bytes(std::size_t maxLength) {
+        std::vector<std::uint8_t> v(Range(static_cast<std::uint32_t>(maxLength)));
+        for (auto& b : v) b = Byte();
+        return v;
+    }
+
+private:
+    const std::uint8_t* m_data;
+    std::size_t         m_size;
+    std::size_t         m_pos = 0;
+};
+
+} // namespace GlassBar::Test
@@ -0,0 +1,106 @@
+// Standalone driver for the LLVMFuzzerTestOneInput targets, used when the
+// build is not linked against libFuzzer (GLASSBAR_LIBFUZZER=OFF):
+//
+//   FuzzShellLink [--runs=N] [--seed=N] [file...]
+//
+// Each file is run once, then N inputs are generated from a seeded PRNG:
+// fresh random buffers and byte-level mutations of earlier inputs. The same
+// seed always replays the same inputs, so a crash under ctest reproduces.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size);
+
+namespace {
+
+constexpr std::size_t kMaxInput  = 4096;
+constexpr std::size_t kMaxCorpus = 256;
+
+std::vector<std::uint8_t> RandomInput(std::mt19937_64& rng) {
+    // Mostly short inputs; every size up to kMaxInput now and then.
+    const std::size_t limit = (rng() % 8 == 0) ? kMaxInput : 256;
+    std::vector<std::uint8_t> v(rng() % (limit + 1));
+    for (auto& b : v) b = static_cast<std::uint8_t>(rng());
+    return v;
+}
+
+void Mutate(std::vector<std::uint8_t>& v, std::mt19937_64& rng) {
+    const int edits = 1 + static_cast<int>(rng() % 8);
+    for (int i = 0; i < edits; ++i) {
+        switch (rng() % 5) {
+        case 0:   // flip a bit
+            if (!v.empty()) v[rng() % v.size()] ^= static_cast<std::uint8_t>(1u << (rng() % 8));
+            break;
+        case 1:   // overwrite a byte with an interesting value
+            if (!v.empty()) {
+                static const std::uint8_t kValues[] = { 0x00, 0x01, 0x7F, 0x80, 0xFF, 0x4C, '=', '[', '\n' };
+                v[rng() % v.size()] = kValues[rng() % sizeof(kValues)];
+            }
+            break;
+        case 2:   // insert a byte
+            if (v.size() < kMaxInput)
+                v.insert(v.begin() + static_cast<std::ptrdiff_t>(rng() % (v.size() + 1)),
+                         static_cast<std::uint8_t>(rng()));
+            break;
+        case 3:   // erase a byte
+            if (!v.empty()) v.erase(v.begin() + static_cast<std::ptrdiff_t>(rng() % v.size()));
+            break;
+        default:  // truncate
+            if (!v.empty()) v.resize(rng() % v.size());
+            break;
+        }
+    }
+}
+
+void RunOne(const std::vector<std::uint8_t>& input) {
+    // A private copy of exactly |size| bytes, so overreads hit the allocation end.
+    std::uint8_t* copy = static_cast<std::uint8_t*>(std::malloc(input.size() ? input.size() : 1));
+    if (!input.empty()) std::memcpy(copy, input.data(), input.size());
+    LLVMFuzzerTestOneInput(copy, input.size());
+    std::free(copy);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    unsigned long long runs = 10000, seed = 1;
+    std::vector<std::vector<std::uint8_t>> corpus;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--runs=", 7) == 0) {
+            runs = std::strtoull(argv[i] + 7, nullptr, 10);
+        } else if (std::strncmp(argv[i], "--seed=", 7) == 0) {
+            seed = std::strtoull(argv[i] + 7, nullptr, 10);
+        } else {
+            std::ifstream f(argv[i], std::ios::binary);
+            if (!f) {
+                std::fprintf(stderr, "cannot read %s\n", argv[i]);
+                return 2;
+            }
+            corpus.emplace_back(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+            RunOne(corpus.back());
+        }
+    }
+
+    std::mt19937_64 rng(seed);
+    for (unsigned long long i = 0; i < runs; ++i) {
+        std::vector<std::uint8_t> input;
+        if (corpus.empty() || rng() % 2 == 0) {
+            input = RandomInput(rng);
+        } else {
+            input = corpus[rng() % corpus.size()];
+            Mutate(input, rng);
+        }
+        RunOne(input);
+        if (corpus.size() < kMaxCorpus) corpus.push_back(std::move(input));
+        else corpus[rng() % kMaxCorpus] = std::move(input);
+    }
+    std::printf("%llu inputs (seed %llu): no crash\n", runs, seed);
+    return 0;
+}
@@ -0,0 +1,56 @@
+// ParseShellLink fuzz target.
+//
+// Raw half: the input bytes as a .lnk file — any result, but no crash and no
+// read outside [data, data + size).
+// Structured half: the same bytes drive ShellLinkBuilder to write a valid
+// link (LinkInfo local or network, ANSI or Unicode, ItemID list, strings,
+// environment blocks); it must parse and give back the target written.
+
+#include "ShellLinkParser.h"
+#include "ShellLinkBuilder.h"
+#include "fuzz/FuzzInput.h"
+
+#include <cstdlib>
+
+using namespace GlassBar;
+using namespace GlassBar::Test;
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+    ShellLinkInfo info;
+    ParseShellLink(data, size, info);
+
+    static const wchar_t kPathChars[] = L"abcXYZ019 .\\:%_-~";
+    FuzzInput in(data, size);
+    LinkSpec spec;
+    spec.unicodeLinkInfo = in.Bool();
+    spec.unicodeStrings  = in.Bool();
+    if (in.Bool()) spec.localBasePath = L"C:" + in.String(60, kPathChars);
+    else           spec.netName       = L"\\\\" + in.String(60, kPathChars);
+    spec.commonPathSuffix = in.String(40, kPathChars);
+    if (in.Bool()) spec.envTarget = L"%" + in.String(120, kPathChars);
+    if (in.Bool()) spec.envIcon   = L"%" + in.String(120, kPathChars);
+    spec.idList = in.Bytes(80);
+    // ANSI StringData must stay ASCII or the parser (rightly) declines it.
+    const wchar_t* textChars = spec.unicodeStrings ? nullptr : kPathChars;
+    spec.name         = in.String(30, textChars);
+    spec.relativePath = in.String(30, textChars);
+    spec.workingDir   = in.String(30, textChars);
+    spec.arguments    = in.String(60, textChars);
+    spec.iconLocation = in.String(30, textChars);
+    spec.iconIndex    = static_cast<int>(in.Byte()) - 128;
+
+    std::wstring expected = spec.envTarget;
+    if (expected.empty()) {
+        const std::wstring& base = !spec.localBasePath.empty() ? spec.localBasePath : spec.netName;
+        const std::wstring& suffix = spec.commonPathSuffix;
+        expected = suffix.empty() ? base
+                 : base.back() == L'\\' ? base + suffix
+                 : base + L'\\' + suffix;
+    }
+
+    const std::vector<std::uint8_t> link = BuildShellLink(spec);
+    if (!ParseShellLink(link.data(), link.size(), info) || info.target != expected ||
+        info.arguments != spec.arguments || info.iconIndex != spec.iconIndex)
+        std::abort();
+    return 0;
+}
@@ -0,0 +1,63 @@
+// UserAssist fuzz target: raw Count value names and data through
+// DecodeUserAssistValue (ROT13 must match the table definition and undo
+// itself), and a generated history through RecentCandidates, whose batched
+// order must equal a full sort.
+
+#include "UserAssist.h"
+#include "fuzz/FuzzInput.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace GlassBar;
+using namespace GlassBar::Test;
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+    FuzzInput in(data, size);
+    static const wchar_t kPathChars[] = L"abnopzAMNZ:\\.rkeyx _HR\u00E9";
+    const std::wstring name = in.String(60, in.Bool() ? kPathChars : nullptr);
+    const std::vector<std::uint8_t> value = in.Bytes(80);
+
+    std::wstring rot = name;
+    Rot13InPlace(rot.data(), rot.size());
+    for (size_t i = 0; i < name.size(); ++i) {
+        const unsigned u = static_cast<unsigned>(name[i]) & 0xFFFF;
+        unsigned e = u;
+        if (u >= 'a' && u <= 'z') e = 'a' + (u - 'a' + 13) % 26;
+        if (u >= 'A' && u <= 'Z') e = 'A' + (u - 'A' + 13) % 26;
+        if ((static_cast<unsigned>(rot[i]) & 0xFFFF) != e) std::abort();
+    }
+    Rot13InPlace(rot.data(), rot.size());
+    if (rot != name) std::abort();
+
+    UserAssistRecord rec;
+    if (DecodeUserAssistValue(name, value.data(), value.size(), rec) &&
+        (rec.runCount == 0 || !IsProgramPath(rec.path) || rec.path.size() > name.size()))
+        std::abort();
+
+    // Up to 60 candidates over 12 targets with coarse ranks (ties included).
+    RecentCandidates set;
+    std::vector<std::pair<double, std::wstring>> expected;
+    const unsigned count = in.Range(60);
+    for (unsigned i = 0; i < count; ++i) {
+        UserAssistRecord r;
+        r.path         = L"C:\\p" + std::to_wstring(in.Range(11)) + L".exe";
+        r.runCount     = 1 + in.Range(3);
+        r.lastRunTicks = 133485408000000000ull + in.Range(3) * 864000000000ull;
+        set.Add(r);
+        const double rank = FrecencyStore::RankFromUserAssist(r.lastRunTicks, r.runCount);
+        auto it = std::find_if(expected.begin(), expected.end(),
+                               [&](const auto& e) { return e.second == r.path; });
+        if (it == expected.end()) expected.emplace_back(rank, r.path);
+        else                      it->first = FrecencyStore::Combine(it->first, rank);
+    }
+    std::sort(expected.begin(), expected.end(), [](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+    for (const auto& e : expected) {
+        const RecentCandidates::Candidate* c = set.Next();
+        if (!c || c->path != e.second || c->rank != e.first) std::abort();
+    }
+    if (set.Next()) std::abort();
+    return 0;
+}